@@ -166,6 +166,26 @@ struct PUBLIC NetworkConfig {
     // network init or reshape may cost more time to select opt kernel implement if enable tune kernel
     // cache_path can set to store tune kernel info.
     bool enable_tune_kernel = false;
+
+    // collect per layer cumulative time, call count and latency histogram on every forward.
+    // the overhead is two clock reads per layer, see Instance::GetRuntimeStats. the batch is not split if it is
+    // set, the layers of a forward are timed once over the whole batch.
+    bool enable_runtime_stats = false;
+
+    // keep the hidden and cell state of lstm and gru layers and the left context of causal conv1d layers between
+    // forwards, so that a stream can be fed chunk by chunk, see Instance::ResetState. currently supported by x86.
+    bool enable_stateful_forward = false;
+
+    // split a forward of batch > 1 into one sub-batch per cpu thread, every sub-batch runs all layers on one thread
+    // with its own blobs and workspace. only for models whose layers compute every batch item independently, the
+    // batch is not split if the blob shapes do not scale with it, or if enable_runtime_stats or
+    // enable_stateful_forward is set. currently supported by x86.
+    bool enable_batch_split = false;
+
+    // run the threads of the instance on the cpus of this numa node and allocate its blobs, workspaces and packed
+    // weights there. clones on different nodes keep one replica of the packed weights per node, see
+    // Instance::Clone. -1 does not bind the instance. currently supported by x86 on linux.
+    int numa_node = -1;
 };
 
 struct PUBLIC ModelConfig {
@@ -16,12 +16,14 @@
 #define TNN_INCLUDE_TNN_CORE_INSTANCE_H_
 
 #include <functional>
+#include <future>
 #include <memory>
 #include <vector>
 
 #include "tnn/core/blob.h"
 #include "tnn/core/common.h"
 #include "tnn/core/macro.h"
+#include "tnn/core/runtime_stats.h"
 #include "tnn/core/status.h"
 #include "tnn/utils/blob_converter.h"
 
@@ -32,6 +34,8 @@ namespace TNN_NS {
 
 class AbstractNetwork;
 class AbstractModelInterpreter;
+class DefaultNetwork;
+class ForwardWorker;
 
 struct LayerInfo;
 
@@ -51,6 +55,15 @@ public:
     // init with model interpeter, min inputs shape and max inputs shape.
     Status Init(std::shared_ptr<AbstractModelInterpreter> interpreter, InputShapesMap min_inputs_shape, InputShapesMap max_inputs_shape);
 
+    // create an instance of the same model and config initialized with the inputs shape of Init. the clone shares
+    // the optimized model and the packed weights with this instance read-only, only its blob memory, workspaces
+    // and state are its own. only supported by the default network.
+    Status Clone(std::shared_ptr<Instance>& instance);
+
+    // create a clone running on numa_node, see NetworkConfig::numa_node. clones on the same node share one replica
+    // of the packed weights.
+    Status Clone(std::shared_ptr<Instance>& instance, int numa_node);
+
     // deinit, release network
     Status DeInit();
 
@@ -89,8 +102,14 @@ public:
 
     // tnn instance network infer async.
     // device gpu, all layer infer complete will call Callback.
+    // device cpu, the forward is queued to the worker thread of the instance and the call returns at once,
+    // Callback is called on the worker thread after the forward. other calls on the instance wait for the
+    // queued forwards to complete, except GetRuntimeStats and calls made from Callback.
     Status ForwardAsync(Callback call_back);
 
+    // same as ForwardAsync(Callback), future gets the status of the forward when it completes.
+    Status ForwardAsync(std::future<Status>& future);
+
     // get all input blobs
     Status GetAllInputBlobs(BlobMap& blobs);
 
@@ -100,6 +119,22 @@ public:
     // set threads run on cpu
     Status SetCpuNumThreads(int num_threads);
 
+    // bind cpu threads of this instance to cpu_list, thread i runs on cpu_list[i % cpu_list.size()].
+    // currently supported by x86.
+    Status SetCpuAffinity(const std::vector<int>& cpu_list);
+
+    // get per layer cumulative time, call count and latency histogram collected since init or last reset.
+    // only available if NetworkConfig::enable_runtime_stats is set, it is safe to call while another
+    // thread is running forward.
+    Status GetRuntimeStats(RuntimeStats& stats);
+
+    // clear runtime stats
+    Status ResetRuntimeStats();
+
+    // clear the state carried between forwards, the next forward starts a new stream.
+    // only available if NetworkConfig::enable_stateful_forward is set.
+    Status ResetState();
+
 #if TNN_PROFILE
 public:
     /**start to profile each layer, dont call this func if you only want to profile the whole mode*/
@@ -114,6 +149,13 @@ private:
     std::shared_ptr<AbstractNetwork> const_folder_ = nullptr;
     NetworkConfig net_config_;
     ModelConfig model_config_;
+
+    // model and inputs shape of Init, used by Clone
+    std::shared_ptr<AbstractModelInterpreter> source_interpreter_ = nullptr;
+    InputShapesMap min_inputs_shape_;
+    InputShapesMap max_inputs_shape_;
+    // the network Init shares the packed weights of
+    DefaultNetwork *weights_network_ = nullptr;
     
     AbstractNetwork *GetNetwork();
     
@@ -129,7 +171,39 @@ public:
                         MatConvertParam param = MatConvertParam(),
                         std::string output_name = "",
                         DeviceType device = DEVICE_ARM, MatType mat_type = NCHW_FLOAT);
-    
+
+    // bind mat to an input for the next forward, if input_name is not set, take the first input as default.
+    // the mat memory is used as the input blob without a copy if it is NCHW_FLOAT cpu memory aligned to
+    // 32 bytes and the blob holds NCHW float data of the same dims, otherwise the mat is converted into the
+    // blob with the default MatConvertParam when forward starts. the mat must be valid until forward returns.
+    Status BindInputMat(std::shared_ptr<Mat> mat, std::string input_name = "");
+
+    // bind mat to an output for the next forward, if output_name is not set, take the first output as default.
+    // the output is written into the mat memory directly under the same conditions as BindInputMat, otherwise
+    // the blob is converted into the mat when forward finishes. results written into a bound mat are not seen
+    // by GetOutputMat.
+    Status BindOutputMat(std::shared_ptr<Mat> mat, std::string output_name = "");
+
+private:
+    // swap bound mat memory into the blobs, or convert inputs that can not be bound
+    Status BeginForwardBinding();
+    // restore blob memory and convert outputs that could not be bound
+    Status EndForwardBinding(Status forward_status);
+
+    Status ForwardAsync(Callback call_back, std::future<Status>* future);
+    // cpu devices run ForwardAsync on forward_worker_
+    bool IsWorkerForwardAsync();
+    // wait for the forwards queued by ForwardAsync
+    void WaitForwardAsync();
+
+    std::shared_ptr<ForwardWorker> forward_worker_ = nullptr;
+
+    // mats bound for the next forward
+    std::map<std::string, std::shared_ptr<Mat>> bound_input_mats_  = {};
+    std::map<std::string, std::shared_ptr<Mat>> bound_output_mats_ = {};
+    // blob handles replaced by bound mat memory during forward
+    std::vector<std::pair<Blob *, BlobHandle>> bound_blob_handles_ = {};
+
 private:
     // input converter
     std::map<std::string, std::shared_ptr<BlobConverter>> input_converters_ = {};
@@ -0,0 +1,118 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef TNN_INCLUDE_TNN_CORE_PIPELINE_H_
+#define TNN_INCLUDE_TNN_CORE_PIPELINE_H_
+
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tnn/core/macro.h"
+#include "tnn/core/mat.h"
+#include "tnn/core/status.h"
+#include "tnn/utils/blob_converter.h"
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+
+namespace TNN_NS {
+
+class Instance;
+class PipelineImpl;
+
+// mats of a frame by name
+typedef std::map<std::string, std::shared_ptr<Mat>> MatMap;
+
+struct PUBLIC PipelineConfig {
+    // max number of frames pushed and not yet popped, Push blocks while it is reached. it bounds the queues
+    // between the stages.
+    int max_frames = 4;
+};
+
+struct PUBLIC PipelineStageStats {
+    // stage name
+    std::string name = "";
+    // number of frames the stage finished
+    uint64_t frame_count = 0;
+    // cumulative time in ms the stage worked on frames
+    double total_time_ms = 0;
+    // slowest frame in ms
+    double max_time_ms = 0;
+    // cumulative time in ms frames waited in the queue of the stage for a free thread
+    double total_wait_time_ms = 0;
+};
+
+// @brief Pipeline runs a graph of stages over a stream of frames. A frame is a set of named mats, every stage
+// reads some mats of a frame and adds new ones, an edge of the graph is a mat produced by one stage and read by
+// others. Every stage runs on its own threads, so successive frames are processed by different stages at the
+// same time and the throughput is bounded by the slowest stage instead of the sum of all stages.
+//
+// Instance stages bind the frame mats to the instance blobs, mats are used without a copy if the layout allows
+// it, see Instance::BindInputMat and Instance::BindOutputMat. Op stages run a function, e.g. a MatUtils call.
+class PUBLIC Pipeline {
+public:
+    // @brief op stage function, inputs holds the mats named by the stage inputs, the function adds the mats
+    // named by the stage outputs to outputs.
+    typedef std::function<Status(MatMap& inputs, MatMap& outputs)> OpFunc;
+
+    explicit Pipeline(PipelineConfig config = PipelineConfig());
+
+    // @brief stops the pipeline
+    ~Pipeline();
+
+    // @brief add a stage running forward of the instances, one thread per instance, so clones of an instance
+    // process frames in parallel, see Instance::Clone.
+    // @param inputs blob name to frame mat name of the instance inputs. the instance is reshaped if the batch,
+    // height or width of a mat differ from the blob.
+    // @param outputs blob name to frame mat name of the instance outputs, mats are NCHW_FLOAT.
+    // @param input_params optional convert params of the inputs by blob name, mats of inputs with a param are
+    // converted with Instance::SetInputMat instead of being bound.
+    Status AddInstanceStage(const std::string& name, std::vector<std::shared_ptr<Instance>> instances,
+                            std::map<std::string, std::string> inputs, std::map<std::string, std::string> outputs,
+                            std::map<std::string, MatConvertParam> input_params = {});
+
+    // @brief add a stage calling func on num_threads threads, func must be thread safe if num_threads > 1.
+    Status AddOpStage(const std::string& name, OpFunc func, std::vector<std::string> inputs,
+                      std::vector<std::string> outputs, int num_threads = 1);
+
+    // @brief check the graph and start the stage threads. mats read by stages and produced by none must be
+    // pushed with every frame.
+    Status Start();
+
+    // @brief push a frame, blocks while PipelineConfig::max_frames frames are in the pipeline
+    Status Push(MatMap frame);
+
+    // @brief pop the next frame in push order with the mats added by the stages, blocks until it is done.
+    // returns the status of the first stage that failed on the frame, the stages after it are skipped.
+    Status Pop(MatMap& frame);
+
+    // @brief wait for the pushed frames and stop the stage threads, the done frames can still be popped
+    Status Stop();
+
+    // @brief get the statistics of every stage in the order the stages were added
+    Status GetStageStats(std::vector<PipelineStageStats>& stats);
+
+private:
+    std::shared_ptr<PipelineImpl> impl_ = nullptr;
+};
+
+}  // namespace TNN_NS
+
+#pragma warning(pop)
+
+#endif  // TNN_INCLUDE_TNN_CORE_PIPELINE_H_
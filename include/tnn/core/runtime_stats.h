@@ -0,0 +1,66 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef TNN_INCLUDE_TNN_CORE_RUNTIME_STATS_H_
+#define TNN_INCLUDE_TNN_CORE_RUNTIME_STATS_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "tnn/core/macro.h"
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+
+namespace TNN_NS {
+
+// number of latency histogram buckets. bucket i counts calls whose duration in
+// microseconds lies in [2^(i-1), 2^i), bucket 0 counts calls shorter than 1us and
+// the last bucket also counts every call longer than its lower bound.
+static const int RUNTIME_STATS_HISTOGRAM_BUCKETS = 24;
+
+struct PUBLIC LayerRuntimeStats {
+    // layer name
+    std::string layer_name = "";
+    // layer type string in proto
+    std::string type_name = "";
+    // number of finished forward calls
+    uint64_t count = 0;
+    // cumulative time in ms
+    double total_time_ms = 0;
+    // slowest call in ms
+    double max_time_ms = 0;
+    // log2 latency histogram, see RUNTIME_STATS_HISTOGRAM_BUCKETS
+    std::vector<uint64_t> histogram = {};
+};
+
+struct PUBLIC RuntimeStats {
+    // number of finished network forward calls
+    uint64_t forward_count = 0;
+    // cumulative network forward time in ms
+    double total_forward_time_ms = 0;
+    // slowest network forward in ms
+    double max_forward_time_ms = 0;
+    // log2 latency histogram of the whole network forward
+    std::vector<uint64_t> forward_histogram = {};
+    // per layer statistics, in execution order
+    std::vector<LayerRuntimeStats> layers = {};
+};
+
+}  // namespace TNN_NS
+
+#pragma warning(pop)
+
+#endif  // TNN_INCLUDE_TNN_CORE_RUNTIME_STATS_H_
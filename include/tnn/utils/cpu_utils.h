@@ -29,6 +29,28 @@ public:
     // @param cpu_list vector of cpuids("0,1,2,3")
     PUBLIC static Status SetCpuAffinity(const std::vector<int>& cpu_list);
 
+    // @brief get cpu affinity of the calling thread
+    // @param cpu_list vector of cpuids the thread may run on
+    PUBLIC static Status GetCpuAffinity(std::vector<int>& cpu_list);
+
+    // @brief get the number of numa nodes, 1 if the numa topology is unknown
+    PUBLIC static int GetNumaNodeCount();
+
+    // @brief get the cpus of a numa node
+    // @param cpu_list vector of cpuids on numa_node
+    PUBLIC static Status GetNumaNodeCpus(int numa_node, std::vector<int>& cpu_list);
+
+    // @brief allocate the pages first touched by the calling thread on numa_node if it has free memory
+    // @param numa_node -1 restores the default local allocation
+    PUBLIC static Status SetNumaMemoryPolicy(int numa_node);
+
+    // @brief get the memory policy of the calling thread
+    // @param mode policy mode with its flags, node_mask the nodes of the policy, as used by set_mempolicy
+    PUBLIC static Status GetMemoryPolicy(int& mode, std::vector<unsigned long>& node_mask);
+
+    // @brief restore a memory policy of the calling thread saved by GetMemoryPolicy
+    PUBLIC static Status SetMemoryPolicy(int mode, const std::vector<unsigned long>& node_mask);
+
     // @brief set cpu powersave
     // @param powersave 0:all cpus 1:little cluster 2:big cluster
     PUBLIC static Status SetCpuPowersave(int powersave);
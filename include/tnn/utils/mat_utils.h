@@ -15,6 +15,8 @@
 #ifndef TNN_INCLUDE_TNN_UTILS_MAT_UTILS_H_
 #define TNN_INCLUDE_TNN_UTILS_MAT_UTILS_H_
 
+#include <vector>
+
 #include "tnn/core/status.h"
 #include "tnn/core/mat.h"
 
@@ -71,6 +73,23 @@ struct PUBLIC CopyMakeBorderParam {
     float border_val       = 0.0f;
 };
 
+struct PUBLIC CropResizeParam {
+    // boxes in src, box i is resized bilinearly to the dst width and height and written to dst batch i
+    std::vector<CropParam> boxes = {};
+    // optional per box 2x3 affine transforms in row-major order, mapping src to dst as WarpAffineParam
+    // transform. empty or of the same size as boxes, dst batch i is warped by transforms[i] instead of
+    // cropped by boxes[i] when transforms[i] has 6 values.
+    std::vector<std::vector<float>> transforms = {};
+    // value of dst pixels mapped outside of src by a transform
+    float border_val = 0.0f;
+    // dst = src * scale + bias per dst channel, same as MatConvertParam
+    std::vector<float> scale = {1.0f, 1.0f, 1.0f, 1.0f};
+    std::vector<float> bias  = {0.0f, 0.0f, 0.0f, 0.0f};
+    bool reverse_channel     = false;
+    // number of threads the boxes are distributed on
+    int num_threads = 1;
+};
+
 class PUBLIC MatUtils {
 public:
     //copy cpu <-> device, cpu<->cpu, device<->device, src and dst dims must be equal.
@@ -92,6 +111,11 @@ public:
 
     //src and dst device type must be same. param top, bottom, left and right must be non-negative.
     static Status CopyMakeBorder(Mat& src, Mat& dst, CopyMakeBorderParam param, void* command_queue);
+
+    //src and dst device type must be same. src is a single NGRAY, N8UC3 or N8UC4 image, dst is a NCHW_FLOAT
+    //batch of param.boxes.size() images, each of dst height and width. dst channel is the src channel
+    //when it is 0, it can be smaller than the src channel to drop the alpha channel.
+    static Status CropResize(Mat& src, Mat& dst, CropResizeParam param, void* command_queue);
 };
 
 }  // namespace TNN_NS
@@ -82,6 +82,14 @@ Status AbstractLayerAcc::AfterForward(const std::vector<Blob *> &inputs, const s
     return TNN_OK;
 }
 
+bool AbstractLayerAcc::SupportInPlace(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    return false;
+}
+
+Status AbstractLayerAcc::ResetState() {
+    return TNN_OK;
+}
+
 void AbstractLayerAcc::SetRuntimeBlobMemoryPool(BlobMemoryPool *runtime_blob_pool) {
     runtime_blob_pool_ = runtime_blob_pool;
 }
@@ -93,6 +93,14 @@ public:
 
     // @brief decide Blob Data Format based on support data format list
     virtual Status ResolveBlobDataFormat(Blob *blob, BlobType blob_type);
+
+    // @brief whether outputs[0] can share the memory of inputs[0], the blob manager then runs the layer in place
+    // @param inputs    input blobs
+    // @param outputs   output blobs
+    virtual bool SupportInPlace(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+
+    // @brief clear the state kept between forwards in stateful forward, accs without state do nothing
+    virtual Status ResetState();
     
     // @brief set runtime bolob pool
     void SetRuntimeBlobMemoryPool(BlobMemoryPool *runtime_blob_pool);
@@ -33,6 +33,22 @@ Status AbstractNetwork::SetCpuNumThreads(int num_threads) {
     return TNN_OK;
 }
 
+Status AbstractNetwork::SetCpuAffinity(const std::vector<int> &cpu_list) {
+    return Status(TNNERR_COMMON_ERROR, "Subclass of AbstractNetwork does not implement SetCpuAffinity");
+}
+
+Status AbstractNetwork::GetRuntimeStats(RuntimeStats &stats) {
+    return Status(TNNERR_COMMON_ERROR, "Subclass of AbstractNetwork does not implement GetRuntimeStats");
+}
+
+Status AbstractNetwork::ResetRuntimeStats() {
+    return Status(TNNERR_COMMON_ERROR, "Subclass of AbstractNetwork does not implement ResetRuntimeStats");
+}
+
+Status AbstractNetwork::ResetState() {
+    return Status(TNNERR_COMMON_ERROR, "Subclass of AbstractNetwork does not implement ResetState");
+}
+
 #if TNN_PROFILE
 void AbstractNetwork::StartProfile() {
     LOGI("subclass should implement the func: StartProfile\n");
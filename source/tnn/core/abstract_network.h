@@ -24,6 +24,7 @@
 #include "tnn/core/instance.h"
 #include "tnn/core/macro.h"
 #include "tnn/core/profile.h"
+#include "tnn/core/runtime_stats.h"
 #include "tnn/core/status.h"
 #include "tnn/interpreter/abstract_model_interpreter.h"
 
@@ -93,6 +94,18 @@ public:
     // @brief set threads run on device
     virtual Status SetCpuNumThreads(int num_threads);
 
+    // @brief bind threads run on device to cpu_list
+    virtual Status SetCpuAffinity(const std::vector<int> &cpu_list);
+
+    // @brief get runtime stats collected since init or last reset
+    virtual Status GetRuntimeStats(RuntimeStats &stats);
+
+    // @brief clear runtime stats
+    virtual Status ResetRuntimeStats();
+
+    // @brief clear the state kept between forwards in stateful forward
+    virtual Status ResetState();
+
 #if TNN_PROFILE
 public:
     virtual void StartProfile();
@@ -191,9 +191,17 @@ Status BlobManager::AllocateBlobMemory(int flag) {
                 // calculate the use count of this blob
                 int use_count = GetBlobUseCount(layer_index, current_blob_name);
 
+                // an in place layer writes the output into the memory of its input, the input is refunded below
+                BlobMemory *blob_memory = GetInPlaceBlobMemory(layer_info, current_blob, flag);
+                if (blob_memory != nullptr) {
+                    blob_memory->SetUseCount(blob_memory->GetUseCount() + use_count);
+                    blob_memory_mapping_.insert(std::make_pair(current_blob, blob_memory));
+                    continue;
+                }
+
                 BlobMemorySizeInfo info = device_->Calculate(current_blob->GetBlobDesc());
                 // find an available BlobMemory
-                BlobMemory *blob_memory = blob_memory_pool_map_[info.dims.size()]->BorrowBlobMemory(use_count, info, false);
+                blob_memory = blob_memory_pool_map_[info.dims.size()]->BorrowBlobMemory(use_count, info, false);
                 blob_memory_mapping_.insert(std::make_pair(current_blob, blob_memory));
             }
         }
@@ -253,6 +261,47 @@ Status BlobManager::AllocateBlobMemory(int flag) {
     return status;
 }
 
+void BlobManager::SetInPlaceLayers(const std::set<std::string> &layer_names) {
+    in_place_layers_ = layer_names;
+}
+
+/*
+ * The first output of an in place layer reuses the memory of the first input if the layer is the last user of it.
+ * Model inputs and blobs of other data flags keep their own memory.
+ */
+BlobMemory *BlobManager::GetInPlaceBlobMemory(LayerInfo *layer_info, Blob *output_blob, int flag) {
+    if (in_place_layers_.count(layer_info->name) == 0 || layer_info->inputs.empty() || layer_info->outputs.empty() ||
+        blobs_[layer_info->outputs[0]] != output_blob) {
+        return nullptr;
+    }
+
+    const auto &input_name = layer_info->inputs[0];
+    Blob *input_blob       = blobs_[input_name];
+    if (net_structure_->inputs_shape_map.count(input_name) > 0 || input_blob->NeedAllocateInForward() ||
+        DataFlagUtils::ChangeStatus(input_blob->GetFlag()) != DataFlagUtils::ChangeStatus(flag)) {
+        return nullptr;
+    }
+    auto blob_memory_iter = blob_memory_mapping_.find(input_blob);
+    if (blob_memory_iter == blob_memory_mapping_.end()) {
+        return nullptr;
+    }
+    BlobMemory *blob_memory = blob_memory_iter->second;
+
+    // the memory must not be used after this layer, either by other layers or as a net output
+    int layer_use_count = (int)std::count(layer_info->inputs.begin(), layer_info->inputs.end(), input_name);
+    if (blob_memory->GetUseCount() != layer_use_count) {
+        return nullptr;
+    }
+
+    BlobMemorySizeInfo input_info  = blob_memory->GetBlobMemorySizeInfo();
+    BlobMemorySizeInfo output_info = device_->Calculate(output_blob->GetBlobDesc());
+    if (input_info.data_type != output_info.data_type || input_info.dims.size() != output_info.dims.size()) {
+        return nullptr;
+    }
+    blob_memory->UpdateBlobMemorySizeInfo(output_info);
+    return blob_memory;
+}
+
 /*
  * This function calculate the use count of the given blob.
  * output layer is regarded as an additional reference.
@@ -323,7 +372,14 @@ void BlobManager::BindBlobMemory() {
     memory_mode_state_->SetMemoryAllocatedFlag();
     // bind every blob_memory's data_ into every blob's data
     for (auto iter : blob_memory_mapping_) {
-        iter.first->SetHandle(iter.second->GetHandle());
+        auto handle = iter.second->GetHandle();
+        // x86 and naive layer accs read handle.base directly, fold the offset of unified memory into base
+        if ((device_->GetDeviceType() == DEVICE_X86 || device_->GetDeviceType() == DEVICE_NAIVE) &&
+            handle.base != nullptr && handle.bytes_offset != 0) {
+            handle.base         = reinterpret_cast<char *>(handle.base) + handle.bytes_offset;
+            handle.bytes_offset = 0;
+        }
+        iter.first->SetHandle(handle);
         // set blob data format to nchw when blob memory is 1d on opencl
         if (device_->GetDeviceType() == DEVICE_OPENCL &&
             iter.second->GetBlobMemorySizeInfo().dims.size() == 1) {
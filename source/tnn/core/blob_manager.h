@@ -17,6 +17,7 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <thread>
 
@@ -67,6 +68,9 @@ public:
     // @param blobs blob map
     virtual Status GetAllOutputBlobs(BlobMap &blobs);
 
+    // @brief set the layers whose first output may share the memory of their first input
+    void SetInPlaceLayers(const std::set<std::string> &layer_names);
+
     // @brief AllocateBlobMemory for blob with flag
     virtual Status AllocateBlobMemory(int flag = DATA_FLAG_CHANGE_ALWAYS);
 
@@ -82,6 +86,7 @@ public:
 protected:
     void BindBlobMemory();
     int GetBlobUseCount(int layer_index, std::string current_blob_name);
+    BlobMemory *GetInPlaceBlobMemory(LayerInfo *layer_info, Blob *output_blob, int flag);
 
     NetworkConfig config_;
     NetStructure *net_structure_;
@@ -93,6 +98,7 @@ protected:
     std::shared_ptr<MemoryAssignStrategy> strategy_;
     std::map<std::string, Blob *> blobs_;
     std::map<Blob *, BlobMemory *> blob_memory_mapping_;
+    std::set<std::string> in_place_layers_;
     bool shared_memory_allocated_;
 
     std::thread::id init_thread_id_;
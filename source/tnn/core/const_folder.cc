@@ -46,7 +46,14 @@ ConstFolder::~ConstFolder() {
 Status ConstFolder::Init(NetworkConfig &net_config, ModelConfig &model_config, AbstractModelInterpreter *interpreter,
                             InputShapesMap min_inputs_shape, InputShapesMap max_inputs_shape) {
     config_ = net_config;
-    config_.device_type = DEVICE_NAIVE;
+    // fold float network on x86 if it runs on x86, layers fold with naive acc until BaseLayer switches to x86 acc
+    auto default_interpreter = dynamic_cast<DefaultModelInterpreter *>(interpreter);
+    bool fold_on_x86 = config_.device_type == DEVICE_X86 && GetDevice(DEVICE_X86) != nullptr &&
+                       default_interpreter != nullptr &&
+                       !GetQuantizedInfoFromNetStructure(default_interpreter->GetNetStructure());
+    if (!fold_on_x86) {
+        config_.device_type = DEVICE_NAIVE;
+    }
     auto device         = GetDevice(DEVICE_NAIVE);
     if (nullptr == device) {
         LOGE("device in Const Floder is null, please check compile options to enable CPU (TNN_CPU_ENABLE=ON)\n");
@@ -46,6 +46,38 @@ Status Context::SetNumThreads(int num_threads) {
     return TNN_OK;
 }
 
+int Context::GetNumThreads() {
+    return 1;
+}
+
+Status Context::ParallelRun(int count, const std::function<void(int)>& task) {
+    return Status(TNNERR_DEVICE_NOT_SUPPORT, "ParallelRun is not supported by this device context");
+}
+
+Status Context::SetCpuAffinity(const std::vector<int>& cpu_list) {
+    return Status(TNNERR_DEVICE_NOT_SUPPORT, "SetCpuAffinity is not supported by this device context");
+}
+
+Status Context::SetNumaNode(int numa_node) {
+    if (numa_node >= 0) {
+        return Status(TNNERR_DEVICE_NOT_SUPPORT, "numa node binding is not supported by this device context");
+    }
+    numa_node_ = -1;
+    return TNN_OK;
+}
+
+int Context::GetNumaNode() {
+    return numa_node_;
+}
+
+Status Context::BindNumaNode() {
+    return TNN_OK;
+}
+
+Status Context::UnbindNumaNode() {
+    return TNN_OK;
+}
+
 void Context::SetPrecision(Precision precision) {
     precision_ = precision;
 }
@@ -62,6 +94,50 @@ bool Context::GetEnableTuneKernel() {
     return enable_tune_kernel_;
 }
 
+void Context::SetEnableStatefulForward(bool enable_stateful_forward) {
+    enable_stateful_forward_ = enable_stateful_forward;
+}
+
+bool Context::GetEnableStatefulForward() {
+    return enable_stateful_forward_;
+}
+
+void Context::SetShareMemoryMode(ShareMemoryMode share_memory_mode) {
+    share_memory_mode_ = share_memory_mode;
+}
+
+ShareMemoryMode Context::GetShareMemoryMode() {
+    return share_memory_mode_;
+}
+
+Status Context::GetSharedWeights(const std::string& key, RawBuffer& buffer,
+                                 std::function<Status(RawBuffer&)> pack) {
+    // instances on different numa nodes pack their own replica, packing runs on the bound node
+    const std::string node_key = numa_node_ < 0 ? key : "numa" + std::to_string(numa_node_) + "/" + key;
+    // hold the lock while packing, clones initialized at the same time pack each weight only once
+    std::lock_guard<std::mutex> guard(shared_weights_->mutex);
+    auto iter = shared_weights_->buffers.find(node_key);
+    if (iter != shared_weights_->buffers.end()) {
+        buffer = iter->second;
+        return TNN_OK;
+    }
+    RETURN_ON_NEQ(pack(buffer), TNN_OK);
+    shared_weights_->buffers[node_key] = buffer;
+    return TNN_OK;
+}
+
+void Context::ReleaseSharedWeights(const std::string& key) {
+    const std::string node_key = numa_node_ < 0 ? key : "numa" + std::to_string(numa_node_) + "/" + key;
+    std::lock_guard<std::mutex> guard(shared_weights_->mutex);
+    shared_weights_->buffers.erase(node_key);
+}
+
+void Context::ShareWeights(Context* context) {
+    if (context) {
+        shared_weights_ = context->shared_weights_;
+    }
+}
+
 void Context::SetCachePath(std::string cache_path) {
     cache_path_ = cache_path;
 }
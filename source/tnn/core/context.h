@@ -15,7 +15,10 @@
 #ifndef TNN_SOURCE_TNN_CORE_CONTEXT_H_
 #define TNN_SOURCE_TNN_CORE_CONTEXT_H_
 
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -23,6 +26,7 @@
 #include "tnn/core/status.h"
 #include "tnn/core/profile.h"
 #include "tnn/core/common.h"
+#include "tnn/interpreter/raw_buffer.h"
 
 namespace TNN_NS {
 
@@ -59,6 +63,30 @@ public:
     // @brief set threads run on device
     virtual Status SetNumThreads(int num_threads);
 
+    // @brief get threads run on device
+    virtual int GetNumThreads();
+
+    // @brief run task(index) for every index below count at the same time, one per thread. count must not exceed
+    // GetNumThreads(). used to forward the sub-batches of a split batch.
+    virtual Status ParallelRun(int count, const std::function<void(int)>& task);
+
+    // @brief bind threads run on device to cpu_list
+    virtual Status SetCpuAffinity(const std::vector<int>& cpu_list);
+
+    // @brief run the threads of this context on the cpus of numa_node and allocate its memory there, -1 removes
+    // the binding. packed weights are shared per numa node.
+    virtual Status SetNumaNode(int numa_node);
+
+    int GetNumaNode();
+
+    // @brief run the calling thread on the cpus and the numa node of this context until UnbindNumaNode, used
+    // during init, reshape and forward. no-op if neither cpu affinity nor numa node is set.
+    virtual Status BindNumaNode();
+
+    // @brief restore the cpu affinity and the memory policy the calling thread had before BindNumaNode. binds may
+    // nest, the outermost UnbindNumaNode restores the thread.
+    virtual Status UnbindNumaNode();
+
     void SetPrecision(Precision precision);
 
     Precision GetPrecision();
@@ -67,6 +95,11 @@ public:
 
     bool GetEnableTuneKernel();
 
+    // @brief in stateful forward layers keep their state between forwards until it is reset
+    void SetEnableStatefulForward(bool enable_stateful_forward);
+
+    bool GetEnableStatefulForward();
+
     void SetCachePath(std::string cache_path);
 
     std::string GetCachePath();
@@ -75,6 +108,22 @@ public:
 
     std::string GetCacheFilePath();
 
+    // @brief contexts in SHARE_MEMORY_MODE_SHARE_ONE_THREAD may share layer workspaces with other instances
+    void SetShareMemoryMode(ShareMemoryMode share_memory_mode);
+
+    ShareMemoryMode GetShareMemoryMode();
+
+    // @brief get the packed weights stored with key, pack and store them if there are none yet. packed weights
+    // are shared with the instances cloned from the same instance, so they must not be changed.
+    Status GetSharedWeights(const std::string& key, RawBuffer& buffer, std::function<Status(RawBuffer&)> pack);
+
+    // @brief remove the packed weights stored with key, e.g. packed by a kernel that lost the tuning. accs still
+    // holding them keep their buffer.
+    void ReleaseSharedWeights(const std::string& key);
+
+    // @brief share the packed weights of context, used by Instance::Clone
+    void ShareWeights(Context* context);
+
 #if TNN_PROFILE
 public:
     virtual void StartProfile();
@@ -90,8 +139,17 @@ protected:
 protected:
     Precision precision_ = PRECISION_AUTO;
     bool enable_tune_kernel_ = true;
+    bool enable_stateful_forward_ = false;
     std::string cache_path_ = ""; // dir to save cache files
     std::string cache_file_path_ = "";
+    ShareMemoryMode share_memory_mode_ = SHARE_MEMORY_MODE_DEFAULT;
+    int numa_node_ = -1;
+
+    struct SharedWeights {
+        std::mutex mutex;
+        std::map<std::string, RawBuffer> buffers;
+    };
+    std::shared_ptr<SharedWeights> shared_weights_ = std::make_shared<SharedWeights>();
 };
 
 }  // namespace TNN_NS
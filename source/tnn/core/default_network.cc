@@ -27,6 +27,7 @@
 #include "tnn/utils/blob_transfer_utils.h"
 #include "tnn/utils/cpu_utils.h"
 #include "tnn/utils/data_flag_utils.h"
+#include "tnn/utils/data_type_utils.h"
 #include "tnn/utils/dims_utils.h"
 #include "tnn/utils/md5.h"
 #include "tnn/utils/string_utils_inner.h"
@@ -41,6 +42,47 @@ NetworkImplFactoryRegister<NetworkImplFactory<DefaultNetwork>> g_network_impl_de
 
 std::mutex DefaultNetwork::optimize_mtx_;
 
+// runs the calling thread on the cpus and the numa node of the context while in scope, so that init and reshape
+// allocate and first touch blobs, workspaces and packed weights on that node
+class NumaNodeGuard {
+public:
+    explicit NumaNodeGuard(Context *context) : context_(context) {
+        auto status = context_->BindNumaNode();
+        if (status != TNN_OK) {
+            LOGE("DefaultNetwork: bind numa node %d failed, %s\n", context_->GetNumaNode(),
+                 status.description().c_str());
+        }
+    }
+
+    ~NumaNodeGuard() {
+        context_->UnbindNumaNode();
+    }
+
+private:
+    Context *context_;
+};
+
+// calls OnInstanceForwardBegin while in scope and OnInstanceForwardEnd on every exit, the x86 context binds its
+// thread pool to the calling thread in between and must unbind it even if a layer fails
+class ForwardGuard {
+public:
+    explicit ForwardGuard(Context *context) : context_(context) {
+        status_ = context_->OnInstanceForwardBegin();
+    }
+
+    ~ForwardGuard() {
+        context_->OnInstanceForwardEnd();
+    }
+
+    Status GetStatus() {
+        return status_;
+    }
+
+private:
+    Context *context_;
+    Status status_;
+};
+
 DefaultNetwork::DefaultNetwork()
     : device_(nullptr), context_(nullptr), blob_manager_(nullptr), net_structure_(nullptr) {}
 
@@ -55,6 +97,13 @@ Status DefaultNetwork::SetCpuNumThreads(int num_threads) {
         return Status(TNNERR_CONTEXT_ERR, "context is nil");
 }
 
+Status DefaultNetwork::SetCpuAffinity(const std::vector<int> &cpu_list) {
+    if (context_)
+        return context_->SetCpuAffinity(cpu_list);
+    else
+        return Status(TNNERR_CONTEXT_ERR, "context is nil");
+}
+
 /*
  * The Network holds blob, blobmanager, layers etc.
  * Those object is initialized in this function.
@@ -88,6 +137,16 @@ Status DefaultNetwork::Init(NetworkConfig &net_config, ModelConfig &model_config
 #endif
     context_->SetPrecision(net_config.precision);
     context_->SetEnableTuneKernel(net_config.enable_tune_kernel);
+    context_->SetEnableStatefulForward(net_config.enable_stateful_forward);
+    context_->SetShareMemoryMode(net_config.share_memory_mode);
+    if (weights_network_ && weights_network_->context_) {
+        context_->ShareWeights(weights_network_->context_);
+    }
+    weights_network_ = nullptr;
+
+    ret = context_->SetNumaNode(net_config.numa_node);
+    RETURN_ON_NEQ(ret, TNN_OK);
+    NumaNodeGuard numa_guard(context_);
 
     if(!net_config.cache_path.empty()) {
         auto params_md5 = default_interpreter->GetParamsMd5();
@@ -106,7 +165,7 @@ Status DefaultNetwork::Init(NetworkConfig &net_config, ModelConfig &model_config
      * The optimization process may change the network structure accoundingly.
      * eg. fuse conv+bn, conv+relu.
      */
-    if (runtime_model_ == RUNTIME_MODE_NORMAL) {
+    if (runtime_model_ == RUNTIME_MODE_NORMAL && !model_optimized_) {
         // use mutex to protect net_resource and net_structure in multi-thread
         std::unique_lock<std::mutex> lck(optimize_mtx_);
         ret = optimizer::NetOptimizerManager::Optimize(net_structure, net_resource, net_config);
@@ -121,11 +180,17 @@ Status DefaultNetwork::Init(NetworkConfig &net_config, ModelConfig &model_config
     ret = InitLayers(net_structure, net_resource);
     RETURN_ON_NEQ(ret, TNN_OK);
 
+    if (net_config.enable_runtime_stats) {
+        ret = InitRuntimeStats(net_structure);
+        RETURN_ON_NEQ(ret, TNN_OK);
+    }
+
     ret = AllocateBlobMemory();
     RETURN_ON_NEQ(ret, TNN_OK);
 
     net_structure_ = net_structure;
     net_resource_ = net_resource;
+    interpreter_ = interpreter;
     
     ret = context_->OnInstanceReshapeBegin();
     RETURN_ON_NEQ(ret, TNN_OK);
@@ -328,7 +393,65 @@ Status DefaultNetwork::InitLayers(NetStructure *net_structure, NetResource *net_
     return ret;
 }
 
+Status DefaultNetwork::InitRuntimeStats(NetStructure *net_structure) {
+    std::map<std::string, std::string> type_str_map;
+    for (auto layer_info : net_structure->layers) {
+        type_str_map[layer_info->name] = layer_info->type_str;
+    }
+
+    std::vector<std::string> layer_names;
+    std::vector<std::string> type_names;
+    for (auto layer : layers_) {
+        layer_names.push_back(layer->GetLayerName());
+        type_names.push_back(type_str_map[layer->GetLayerName()]);
+    }
+
+    runtime_stats_ = std::make_shared<RuntimeStatsCollector>();
+    runtime_stats_->Init(layer_names, type_names);
+    return TNN_OK;
+}
+
+Status DefaultNetwork::GetRuntimeStats(RuntimeStats &stats) {
+    if (!runtime_stats_) {
+        return Status(TNNERR_NET_ERR, "runtime stats is not enabled, set enable_runtime_stats in network config");
+    }
+    runtime_stats_->GetStats(stats);
+    return TNN_OK;
+}
+
+Status DefaultNetwork::ResetRuntimeStats() {
+    if (!runtime_stats_) {
+        return Status(TNNERR_NET_ERR, "runtime stats is not enabled, set enable_runtime_stats in network config");
+    }
+    runtime_stats_->Reset();
+    return TNN_OK;
+}
+
+Status DefaultNetwork::ResetState() {
+    if (!config_.enable_stateful_forward) {
+        return Status(TNNERR_NET_ERR, "stateful forward is not enabled, set enable_stateful_forward in network config");
+    }
+    for (auto layer : layers_) {
+        RETURN_ON_NEQ(layer->ResetState(), TNN_OK);
+    }
+    return TNN_OK;
+}
+
+void DefaultNetwork::ShareWeights(DefaultNetwork *network, bool model_optimized) {
+    weights_network_ = network;
+    model_optimized_ = model_optimized;
+}
+
 Status DefaultNetwork::AllocateBlobMemory() {
+    // layers whose acc can write the output into the input memory
+    std::set<std::string> in_place_layers;
+    for (auto layer : layers_) {
+        if (layer->IsSupportInPlace()) {
+            in_place_layers.insert(layer->GetLayerName());
+        }
+    }
+    blob_manager_->SetInPlaceLayers(in_place_layers);
+
     return blob_manager_->AllocateBlobMemory(DATA_FLAG_CHANGE_ALWAYS);
 }
 
@@ -481,6 +604,7 @@ Status DefaultNetwork::PrepareDoReshape(const InputShapesMap& inputs, bool& shap
 
 Status DefaultNetwork::DoReshape() {
     Status ret = TNN_OK;
+    NumaNodeGuard numa_guard(context_);
     ret = context_->OnInstanceReshapeBegin();
     if (ret != TNN_OK) {
         return ret;
@@ -497,12 +621,17 @@ Status DefaultNetwork::DoReshape() {
 }
 
 Status DefaultNetwork::DeInit() {
+    split_networks_.clear();
+    split_interpreters_.clear();
+    split_inputs_shape_.clear();
+
     for (size_t i = 0; i < layers_.size(); i++) {
         if (layers_[i] != NULL) {
             delete layers_[i];
         }
     }
     layers_.clear();
+    runtime_stats_ = nullptr;
 
     if (blob_manager_ != NULL) {
         delete blob_manager_;
@@ -555,15 +684,29 @@ Context* DefaultNetwork::GetContext() {
 Status DefaultNetwork::Forward() {
     auto status = blob_manager_->CheckBlobMemoryState();
     RETURN_ON_NEQ(status, TNN_OK);
+
+    if (config_.enable_batch_split && runtime_model_ == RUNTIME_MODE_NORMAL) {
+        bool forwarded = false;
+        RETURN_ON_NEQ(ForwardBatchSplit(forwarded), TNN_OK);
+        if (forwarded) {
+            return TNN_OK;
+        }
+    }
     
     if (runtime_blob_pool_) {
         //now we allocate blob eachtime when running acc, so clear blob pool to avoid memory leak
         runtime_blob_pool_->ClearBlobMemoryPool();
     }
     
-    status = context_->OnInstanceForwardBegin();
-    RETURN_ON_NEQ(status, TNN_OK);
-    
+    auto runtime_stats = runtime_stats_.get();
+    RuntimeStatsCollector::Clock::time_point forward_begin, layer_begin;
+    if (runtime_stats) {
+        forward_begin = RuntimeStatsCollector::Clock::now();
+    }
+
+    ForwardGuard forward_guard(context_);
+    RETURN_ON_NEQ(forward_guard.GetStatus(), TNN_OK);
+
     int cnt = 0;
     for (auto layer : layers_) {
         std::vector<Blob *> inputs  = layer->GetInputBlobs();
@@ -593,7 +736,15 @@ Status DefaultNetwork::Forward() {
             }
 #endif  // DUMP_INPUT_BLOB
             
+            if (runtime_stats) {
+                layer_begin = RuntimeStatsCollector::Clock::now();
+            }
+
             status = layer->Forward();
+
+            if (runtime_stats) {
+                runtime_stats->RecordLayer(cnt, layer_begin, RuntimeStatsCollector::Clock::now());
+            }
             LOGD("layer name: %s, forward result: %d \n", layer->GetLayerName().c_str(), (int)status);
             LOGD("Output Shape: [%s]\n", layer->GetOutputBlobs()[0]->GetBlobDesc().description().c_str());
             if (status != TNN_OK) {
@@ -626,11 +777,176 @@ Status DefaultNetwork::Forward() {
         
         cnt++;
     }
-    context_->OnInstanceForwardEnd();
     context_->Synchronize();
+
+    if (runtime_stats) {
+        runtime_stats->RecordForward(forward_begin, RuntimeStatsCollector::Clock::now());
+    }
     return status;
 }
 
+/*
+ * Batch split runs every sub-batch through all layers on one cpu thread, so layers with little work per image
+ * scale with the batch instead of the threads of one layer. The input and output blobs of the sub networks
+ * point into the blobs of this network during forward, nothing is copied.
+ */
+Status DefaultNetwork::ForwardBatchSplit(bool &forwarded) {
+    forwarded = false;
+    if (config_.device_type != DEVICE_X86 || runtime_stats_ || config_.enable_stateful_forward) {
+        return TNN_OK;
+    }
+
+    BlobMap input_blobs, output_blobs;
+    RETURN_ON_NEQ(GetAllInputBlobs(input_blobs), TNN_OK);
+    RETURN_ON_NEQ(GetAllOutputBlobs(output_blobs), TNN_OK);
+    InputShapesMap inputs_shape;
+    int batch = 0;
+    for (auto &iter : input_blobs) {
+        auto dims = iter.second->GetBlobDesc().dims;
+        if (dims.empty() || (batch > 0 && dims[0] != batch)) {
+            return TNN_OK;
+        }
+        batch                    = dims[0];
+        inputs_shape[iter.first] = dims;
+    }
+    const int split_count = MIN(context_->GetNumThreads(), batch);
+    if (split_count <= 1) {
+        return TNN_OK;
+    }
+
+    if (inputs_shape != split_inputs_shape_ || split_count != split_count_) {
+        std::vector<int> batches(split_count, batch / split_count);
+        for (int i = 0; i < batch % split_count; ++i) {
+            batches[i]++;
+        }
+        split_inputs_shape_ = inputs_shape;
+        split_count_        = split_count;
+        auto status         = InitBatchSplit(inputs_shape, batches);
+        if (status != TNN_OK) {
+            LOGD("DefaultNetwork: batch %d is not split, %s\n", batch, status.description().c_str());
+            split_networks_.clear();
+            split_interpreters_.clear();
+        }
+    }
+    if (split_networks_.empty()) {
+        return TNN_OK;
+    }
+
+    std::vector<Status> results(split_count, TNN_OK);
+    auto task = [&](int index) {
+        auto network     = split_networks_[index].get();
+        int batch_offset = 0;
+        for (int i = 0; i < index; ++i) {
+            batch_offset += split_batches_[i];
+        }
+
+        BlobMap sub_input_blobs, sub_output_blobs;
+        network->GetAllInputBlobs(sub_input_blobs);
+        network->GetAllOutputBlobs(sub_output_blobs);
+        std::vector<std::pair<Blob *, BlobHandle>> sub_handles;
+        auto bind_slice = [&](BlobMap &blobs, BlobMap &sub_blobs) {
+            for (auto &iter : sub_blobs) {
+                auto desc          = blobs[iter.first]->GetBlobDesc();
+                BlobHandle handle  = blobs[iter.first]->GetHandle();
+                // most cpu layer accs ignore bytes_offset, so the slice moves the base
+                handle.base = reinterpret_cast<char *>(handle.base) + (size_t)batch_offset *
+                              DimsVectorUtils::Count(desc.dims, 1) * DataTypeUtils::GetBytesSize(desc.data_type);
+                sub_handles.push_back(std::make_pair(iter.second, iter.second->GetHandle()));
+                iter.second->SetHandle(handle);
+            }
+        };
+        bind_slice(input_blobs, sub_input_blobs);
+        bind_slice(output_blobs, sub_output_blobs);
+
+        results[index] = network->Forward();
+
+        for (auto &iter : sub_handles) {
+            iter.first->SetHandle(iter.second);
+        }
+    };
+    RETURN_ON_NEQ(context_->ParallelRun(split_count, task), TNN_OK);
+    for (auto &result : results) {
+        RETURN_ON_NEQ(result, TNN_OK);
+    }
+    forwarded = true;
+    return TNN_OK;
+}
+
+int DefaultNetwork::GetBatchSplitCount() {
+    return (int)split_networks_.size();
+}
+
+Status DefaultNetwork::InitBatchSplit(const InputShapesMap &inputs_shape, const std::vector<int> &batches) {
+    split_networks_.clear();
+    split_interpreters_.clear();
+    split_batches_ = batches;
+    // folded constants such as shapes are only valid for the batch of this network
+    if (!interpreter_ || NeedDoConstantFolding(net_structure_)) {
+        return Status(TNNERR_NET_ERR, "batch split does not support models with constant folding");
+    }
+
+    // sub networks run at the same time, so they must not share workspaces
+    NetworkConfig config      = config_;
+    config.enable_batch_split = false;
+    config.share_memory_mode  = SHARE_MEMORY_MODE_DEFAULT;
+    config.cache_path         = "";
+    ModelConfig model_config;
+    const int batch = inputs_shape.begin()->second[0];
+    for (auto sub_batch : batches) {
+        InputShapesMap sub_inputs_shape = inputs_shape;
+        for (auto &iter : sub_inputs_shape) {
+            iter.second[0] = sub_batch;
+        }
+        // layers may update their params in reshape, so every sub network runs its own copy of the model
+        auto interpreter = interpreter_->Copy();
+        if (!interpreter) {
+            return Status(TNNERR_NET_ERR, "batch split needs a model interpreter supporting Copy");
+        }
+        auto network = std::make_shared<DefaultNetwork>();
+        network->ShareWeights(this, true);
+        RETURN_ON_NEQ(network->Init(config, model_config, interpreter.get(), sub_inputs_shape, sub_inputs_shape, true),
+                      TNN_OK);
+        RETURN_ON_NEQ(CheckBatchSplitShapes(network.get(), batch, sub_batch), TNN_OK);
+        split_interpreters_.push_back(interpreter);
+        split_networks_.push_back(network);
+    }
+    return TNN_OK;
+}
+
+Status DefaultNetwork::CheckBatchSplitShapes(DefaultNetwork *network, int batch, int sub_batch) {
+    for (auto &name : net_structure_->blobs) {
+        auto blob     = blob_manager_->GetBlob(name);
+        auto sub_blob = network->blob_manager_->GetBlob(name);
+        if (!blob || !sub_blob || DataFlagUtils::ChangeStatus(blob->GetFlag()) == DATA_FLAG_CHANGE_NEVER) {
+            continue;
+        }
+        if (blob->NeedAllocateInForward()) {
+            return Status(TNNERR_NET_ERR, "batch split does not support blobs allocated in forward");
+        }
+        auto dims = blob->GetBlobDesc().dims;
+        if (!dims.empty() && dims[0] == batch) {
+            dims[0] = sub_batch;
+        }
+        if (!DimsVectorUtils::Equal(dims, sub_blob->GetBlobDesc().dims)) {
+            return Status(TNNERR_NET_ERR, "blob shapes do not scale with the batch");
+        }
+    }
+
+    // inputs and outputs are sliced along the batch
+    BlobMap input_blobs, output_blobs;
+    RETURN_ON_NEQ(GetAllInputBlobs(input_blobs), TNN_OK);
+    RETURN_ON_NEQ(GetAllOutputBlobs(output_blobs), TNN_OK);
+    for (auto blobs : {input_blobs, output_blobs}) {
+        for (auto &iter : blobs) {
+            const auto &desc = iter.second->GetBlobDesc();
+            if (desc.data_format != DATA_FORMAT_NCHW || desc.dims.empty() || desc.dims[0] != batch) {
+                return Status(TNNERR_NET_ERR, "inputs and outputs must be NCHW blobs of the batch");
+            }
+        }
+    }
+    return TNN_OK;
+}
+
 #ifdef FORWARD_CALLBACK_ENABLE
 Status DefaultNetwork::ForwardWithCallback(BlobStatisticCallback before, BlobStatisticCallback after) {
     Status result = TNN_OK;
@@ -639,7 +955,7 @@ Status DefaultNetwork::ForwardWithCallback(BlobStatisticCallback before, BlobSta
         return result;
     }
 
-    context_->OnInstanceForwardBegin();
+    ForwardGuard forward_guard(context_);
     int cnt = 0;
     for (auto layer : layers_) {
         std::vector<Blob *> inputs  = layer->GetInputBlobs();
@@ -661,7 +977,6 @@ Status DefaultNetwork::ForwardWithCallback(BlobStatisticCallback before, BlobSta
 
         cnt++;
     }
-    context_->OnInstanceForwardEnd();
     return result;
 }
 #endif  // end of FORWARD_CALLBACK_ENABLE
@@ -675,12 +990,27 @@ Status DefaultNetwork::ForwardAsync(Callback call_back) {
         return result;
     }
 
-    context_->OnInstanceForwardBegin();
-    for (auto layer : layers_) {
-        result = layer->Forward();
+    auto runtime_stats = runtime_stats_.get();
+    RuntimeStatsCollector::Clock::time_point forward_begin, layer_begin;
+    if (runtime_stats) {
+        forward_begin = RuntimeStatsCollector::Clock::now();
+    }
+
+    ForwardGuard forward_guard(context_);
+    for (size_t i = 0; i < layers_.size(); ++i) {
+        if (runtime_stats) {
+            layer_begin = RuntimeStatsCollector::Clock::now();
+        }
+        result = layers_[i]->Forward();
         RETURN_ON_NEQ(result, TNN_OK);
+        if (runtime_stats) {
+            runtime_stats->RecordLayer(i, layer_begin, RuntimeStatsCollector::Clock::now());
+        }
+    }
+
+    if (runtime_stats) {
+        runtime_stats->RecordForward(forward_begin, RuntimeStatsCollector::Clock::now());
     }
-    context_->OnInstanceForwardEnd();
     return result;
 }
 
@@ -25,6 +25,7 @@
 #include "tnn/core/context.h"
 #include "tnn/core/macro.h"
 #include "tnn/core/profile.h"
+#include "tnn/core/runtime_stats_collector.h"
 #include "tnn/core/status.h"
 #include "tnn/interpreter/abstract_model_interpreter.h"
 #include "tnn/interpreter/layer_resource.h"
@@ -92,6 +93,25 @@ public:
     // @brief set threads run on device
     virtual Status SetCpuNumThreads(int num_threads);
 
+    // @brief bind threads run on device to cpu_list
+    virtual Status SetCpuAffinity(const std::vector<int> &cpu_list);
+
+    // @brief get runtime stats, only available if enable_runtime_stats is set in network config
+    virtual Status GetRuntimeStats(RuntimeStats &stats);
+
+    // @brief clear runtime stats
+    virtual Status ResetRuntimeStats();
+
+    // @brief clear the state of all layers, only available if enable_stateful_forward is set in network config
+    virtual Status ResetState();
+
+    // @brief the next Init shares the packed weights of network, which must run the same model with the same config.
+    // if model_optimized is set, the model was optimized by network and is not optimized again.
+    void ShareWeights(DefaultNetwork *network, bool model_optimized);
+
+    // @brief number of sub networks created to split the batch, 0 if the batch can not be split
+    int GetBatchSplitCount();
+
 #if TNN_PROFILE
 public:
     virtual void StartProfile();
@@ -126,12 +146,34 @@ protected:
 
     NetworkConfig config_;
 
+    std::shared_ptr<RuntimeStatsCollector> runtime_stats_ = nullptr;
+
     static std::mutex optimize_mtx_;
 
+    DefaultNetwork *weights_network_ = nullptr;
+    bool model_optimized_            = false;
+
 private:
 
    Status ReshapeLayers();
 
+   Status InitRuntimeStats(NetStructure *net_structure);
+
+   // @brief forward the sub-batches of a split batch in parallel, forwarded is false if the batch can not be split
+   Status ForwardBatchSplit(bool &forwarded);
+   // @brief create a network per sub-batch sharing the optimized model and the packed weights of this network
+   Status InitBatchSplit(const InputShapesMap &inputs_shape, const std::vector<int> &batches);
+   // @brief blobs of the sub network must have the shapes of this network with batch scaled to sub_batch
+   Status CheckBatchSplitShapes(DefaultNetwork *network, int batch, int sub_batch);
+
+   AbstractModelInterpreter *interpreter_ = nullptr;
+   // inputs shape the sub networks are created for, the batch is not split if split_networks_ is empty
+   InputShapesMap split_inputs_shape_;
+   int split_count_ = 0;
+   std::vector<int> split_batches_;
+   std::vector<std::shared_ptr<AbstractModelInterpreter>> split_interpreters_;
+   std::vector<std::shared_ptr<DefaultNetwork>> split_networks_;
+
 };
 
 }  // namespace TNN_NS
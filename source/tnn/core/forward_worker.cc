@@ -0,0 +1,72 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "tnn/core/forward_worker.h"
+
+namespace TNN_NS {
+
+ForwardWorker::~ForwardWorker() {
+    {
+        std::unique_lock<std::mutex> lck(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+std::future<Status> ForwardWorker::Post(std::function<Status()> task) {
+    std::packaged_task<Status()> packaged(std::move(task));
+    auto future = packaged.get_future();
+    {
+        std::unique_lock<std::mutex> lck(mutex_);
+        tasks_.push_back(std::move(packaged));
+        if (!thread_.joinable()) {
+            thread_ = std::thread(&ForwardWorker::Loop, this);
+        }
+    }
+    cond_.notify_all();
+    return future;
+}
+
+void ForwardWorker::Wait() {
+    std::unique_lock<std::mutex> lck(mutex_);
+    if (std::this_thread::get_id() == thread_.get_id()) {
+        return;
+    }
+    cond_.wait(lck, [this] { return tasks_.empty() && !running_; });
+}
+
+void ForwardWorker::Loop() {
+    std::unique_lock<std::mutex> lck(mutex_);
+    while (true) {
+        cond_.wait(lck, [this] { return !tasks_.empty() || stop_; });
+        if (tasks_.empty()) {
+            return;
+        }
+        auto task = std::move(tasks_.front());
+        tasks_.pop_front();
+        running_ = true;
+        // the task may call back into the instance, so it runs without the lock
+        lck.unlock();
+        task();
+        lck.lock();
+        running_ = false;
+        cond_.notify_all();
+    }
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,56 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#ifndef TNN_SOURCE_TNN_CORE_FORWARD_WORKER_H_
+#define TNN_SOURCE_TNN_CORE_FORWARD_WORKER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "tnn/core/status.h"
+
+namespace TNN_NS {
+
+// @brief ForwardWorker runs the asynchronous forwards of an instance on its own thread.
+// Tasks run one after another in the order they are posted. The thread is started by
+// the first Post and joined after the remaining tasks when the worker is destroyed.
+class ForwardWorker {
+public:
+    ~ForwardWorker();
+
+    // @brief queue task to run on the worker thread, future gets its status
+    std::future<Status> Post(std::function<Status()> task);
+
+    // @brief wait until all posted tasks are done, returns at once if called from a task
+    void Wait();
+
+private:
+    void Loop();
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<std::packaged_task<Status()>> tasks_;
+    bool running_ = false;
+    bool stop_    = false;
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_SOURCE_TNN_CORE_FORWARD_WORKER_H_
@@ -19,6 +19,8 @@
 #include "tnn/core/abstract_network.h"
 #include "tnn/core/common.h"
 #include "tnn/core/const_folder.h"
+#include "tnn/core/default_network.h"
+#include "tnn/core/forward_worker.h"
 #include "tnn/core/macro.h"
 #include "tnn/core/profile.h"
 #include "tnn/core/status.h"
@@ -48,6 +50,9 @@ Status Instance::Init(std::shared_ptr<AbstractModelInterpreter> interpreter, Inp
 Status Instance::Init(std::shared_ptr<AbstractModelInterpreter> interpreter, InputShapesMap min_inputs_shape, InputShapesMap max_inputs_shape) {
     auto device = GetDevice(net_config_.device_type);
     RETURN_VALUE_ON_NEQ(device != NULL, true, TNNERR_DEVICE_NOT_SUPPORT);
+    source_interpreter_ = interpreter;
+    min_inputs_shape_   = min_inputs_shape;
+    max_inputs_shape_   = max_inputs_shape;
     interpreter_ = interpreter->Copy();
     if (nullptr == interpreter_) {
         // The ModelInterpreter not implement Copy API, just use interpreter
@@ -105,13 +110,67 @@ Status Instance::Init(std::shared_ptr<AbstractModelInterpreter> interpreter, Inp
     }
 
     network_ = NetworkImplManager::GetNetworkImpl(network_type);
+    auto default_network = dynamic_cast<DefaultNetwork *>(network_.get());
+    if (default_network && weights_network_) {
+        default_network->ShareWeights(weights_network_, false);
+    }
     auto ret = network_->Init(net_config_, model_config_, interpreter_.get(), min_inputs_shape, max_inputs_shape, true);
     RETURN_ON_NEQ(ret, TNN_OK);
 
     return TNN_OK;
 }
 
+Status Instance::Clone(std::shared_ptr<Instance> &instance) {
+    return Clone(instance, net_config_.numa_node);
+}
+
+Status Instance::Clone(std::shared_ptr<Instance> &instance, int numa_node) {
+    WaitForwardAsync();
+    auto network      = dynamic_cast<DefaultNetwork *>(network_.get());
+    auto device       = GetDevice(net_config_.device_type);
+    auto network_type = net_config_.network_type;
+    if (network_type == NETWORK_TYPE_AUTO && device) {
+        network_type = device->ConvertAutoNetworkType();
+    }
+    if (!network || network_type != NETWORK_TYPE_DEFAULT || !source_interpreter_) {
+        LOGE("Clone is only supported by instances of the default network\n");
+        return Status(TNNERR_NET_ERR, "Clone is only supported by instances of the default network");
+    }
+
+    NetworkConfig clone_config = net_config_;
+    clone_config.numa_node     = numa_node;
+    auto clone = std::make_shared<Instance>(clone_config, model_config_);
+    if (const_folder_) {
+        // constants are folded into the model for the inputs shape of each instance, so the clone optimizes and
+        // folds its own copy of the model, only the packed weights are shared
+        clone->weights_network_ = network;
+        auto status             = clone->Init(source_interpreter_, min_inputs_shape_, max_inputs_shape_);
+        clone->weights_network_ = nullptr;
+        RETURN_ON_NEQ(status, TNN_OK);
+    } else {
+        // the model is already optimized, layer params are copied since layers may update them in reshape
+        clone->source_interpreter_ = source_interpreter_;
+        clone->min_inputs_shape_   = min_inputs_shape_;
+        clone->max_inputs_shape_   = max_inputs_shape_;
+        clone->interpreter_        = interpreter_->Copy();
+        if (nullptr == clone->interpreter_) {
+            clone->interpreter_ = interpreter_;
+        }
+
+        auto clone_network = std::make_shared<DefaultNetwork>();
+        clone_network->ShareWeights(network, true);
+        RETURN_ON_NEQ(clone_network->Init(clone->net_config_, clone->model_config_, clone->interpreter_.get(),
+                                          min_inputs_shape_, max_inputs_shape_, true),
+                      TNN_OK);
+        clone->network_ = clone_network;
+    }
+
+    instance = clone;
+    return TNN_OK;
+}
+
 Status Instance::DeInit() {
+    WaitForwardAsync();
     network_ = nullptr;
     return TNN_OK;
 }
@@ -121,10 +180,12 @@ Status Instance::GetForwardMemorySize(int &memory_size) {
 }
 
 Status Instance::SetForwardMemory(void *memory) {
+    WaitForwardAsync();
     return network_->SetForwardMemory(memory);
 }
 
 Status Instance::Reshape(const InputShapesMap &inputs) {
+    WaitForwardAsync();
     Status status = TNN_OK;
     if (const_folder_) {
         auto folder = dynamic_cast<ConstFolder*>(const_folder_.get());
@@ -148,14 +209,18 @@ AbstractNetwork *Instance::GetNetwork() {
 }
 
 Status Instance::Forward() {
+    WaitForwardAsync();
     output_mats_convert_status_.clear();
-    return network_->Forward();
+    RETURN_ON_NEQ(BeginForwardBinding(), TNN_OK);
+    return EndForwardBinding(network_->Forward());
 }
 
 #ifdef FORWARD_CALLBACK_ENABLE
 Status Instance::ForwardWithCallback(BlobStatisticCallback before, BlobStatisticCallback after) {
+    WaitForwardAsync();
     output_mats_convert_status_.clear();
-    return network_->ForwardWithCallback(before, after);
+    RETURN_ON_NEQ(BeginForwardBinding(), TNN_OK);
+    return EndForwardBinding(network_->ForwardWithCallback(before, after));
 }
 #endif  // end of FORWARD_CALLBACK_ENABLE
 
@@ -167,24 +232,106 @@ std::shared_ptr<AbstractModelInterpreter> Instance::GetInterpreter() {
 #endif  // end of GET_INTERP_ENABLE
 
 Status Instance::ForwardAsync(Callback call_back) {
+    return ForwardAsync(call_back, nullptr);
+}
+
+Status Instance::ForwardAsync(std::future<Status> &future) {
+    return ForwardAsync(nullptr, &future);
+}
+
+Status Instance::ForwardAsync(Callback call_back, std::future<Status> *future) {
+    WaitForwardAsync();
     output_mats_convert_status_.clear();
-    return (Status)network_->ForwardAsync(call_back);
+
+    if (IsWorkerForwardAsync()) {
+        RETURN_ON_NEQ(BeginForwardBinding(), TNN_OK);
+        if (!forward_worker_) {
+            forward_worker_ = std::make_shared<ForwardWorker>();
+        }
+        auto result = forward_worker_->Post([this, call_back]() {
+            Status status = EndForwardBinding(network_->Forward());
+            if (call_back) {
+                call_back();
+            }
+            return status;
+        });
+        if (future) {
+            *future = std::move(result);
+        }
+        return TNN_OK;
+    }
+
+    if (!bound_input_mats_.empty() || !bound_output_mats_.empty()) {
+        // bound blob memory is restored right after the call, which requires it to complete
+        auto device_type = net_config_.device_type;
+        if (device_type != DEVICE_NAIVE && device_type != DEVICE_X86 && device_type != DEVICE_ARM) {
+            return Status(TNNERR_PARAM_ERR, "bound mats are not supported by ForwardAsync on this device");
+        }
+    }
+    RETURN_ON_NEQ(BeginForwardBinding(), TNN_OK);
+    Status status = EndForwardBinding((Status)network_->ForwardAsync(call_back));
+    if (future) {
+        std::promise<Status> promise;
+        promise.set_value(status);
+        *future = promise.get_future();
+    }
+    return status;
+}
+
+bool Instance::IsWorkerForwardAsync() {
+    auto device_type = net_config_.device_type;
+    if (device_type != DEVICE_NAIVE && device_type != DEVICE_X86 && device_type != DEVICE_ARM) {
+        return false;
+    }
+    // instances sharing memory in one thread must not run forward on another thread
+    if (net_config_.share_memory_mode == SHARE_MEMORY_MODE_SHARE_ONE_THREAD) {
+        return false;
+    }
+    return dynamic_cast<DefaultNetwork *>(network_.get()) != nullptr;
+}
+
+void Instance::WaitForwardAsync() {
+    if (forward_worker_) {
+        forward_worker_->Wait();
+    }
 }
 
 Status Instance::GetAllInputBlobs(BlobMap &blobs) {
+    WaitForwardAsync();
     return network_->GetAllInputBlobs(blobs);
 }
 
 Status Instance::GetAllOutputBlobs(BlobMap &blobs) {
+    WaitForwardAsync();
     return network_->GetAllOutputBlobs(blobs);
 }
 
 Status Instance::SetCpuNumThreads(int num_threads) {
+    WaitForwardAsync();
     return network_->SetCpuNumThreads(num_threads);
 }
 
+Status Instance::SetCpuAffinity(const std::vector<int> &cpu_list) {
+    WaitForwardAsync();
+    return network_->SetCpuAffinity(cpu_list);
+}
+
+Status Instance::GetRuntimeStats(RuntimeStats &stats) {
+    return network_->GetRuntimeStats(stats);
+}
+
+Status Instance::ResetRuntimeStats() {
+    return network_->ResetRuntimeStats();
+}
+
+Status Instance::ResetState() {
+    WaitForwardAsync();
+    return network_->ResetState();
+}
+
 // set input Mat
 Status Instance::SetInputMat(std::shared_ptr<Mat> mat, MatConvertParam param, std::string input_name) {
+    WaitForwardAsync();
     if (!mat) {
         LOGE("input mat is empty ,please check!\n");
         return Status(TNNERR_PARAM_ERR, "input mat is empty ,please check!");
@@ -234,6 +381,7 @@ Status Instance::SetInputMat(std::shared_ptr<Mat> mat, MatConvertParam param, st
 // get output Mat
 Status Instance::GetOutputMat(std::shared_ptr<Mat> &mat, MatConvertParam param, std::string output_name,
                               DeviceType device, MatType mat_type) {
+    WaitForwardAsync();
     // get output blobs
     BlobMap output_blobs;
     auto status = network_->GetAllOutputBlobs(output_blobs);
@@ -302,6 +450,150 @@ Status Instance::GetOutputMat(std::shared_ptr<Mat> &mat, MatConvertParam param,
     return status;
 }
 
+// memory alignment required to use mat memory as blob memory
+static const int BIND_MAT_ALIGNMENT = 32;
+
+static bool CanBindMatToBlob(Mat &mat, Blob *blob) {
+    auto &desc = blob->GetBlobDesc();
+    if (mat.GetMatType() != NCHW_FLOAT || desc.data_type != DATA_TYPE_FLOAT ||
+        desc.data_format != DATA_FORMAT_NCHW) {
+        return false;
+    }
+    if (!DimsVectorUtils::Equal(mat.GetDims(), desc.dims)) {
+        return false;
+    }
+    // mat memory is on cpu, it can only be used by devices running on cpu
+    bool cpu_blob = desc.device_type == DEVICE_NAIVE || desc.device_type == DEVICE_X86 ||
+                    desc.device_type == DEVICE_ARM;
+    if (!cpu_blob || (mat.GetDeviceType() != desc.device_type && mat.GetDeviceType() != DEVICE_NAIVE)) {
+        return false;
+    }
+    return reinterpret_cast<uintptr_t>(mat.GetData()) % BIND_MAT_ALIGNMENT == 0;
+}
+
+static Status CheckBindName(BlobMap &blobs, std::string &name) {
+    if (blobs.size() <= 0) {
+        return Status(TNNERR_MODEL_ERR, "instance has no blob to bind");
+    }
+    // take the first blob for default
+    if (name.length() <= 0) {
+        name = blobs.begin()->first;
+    } else if (blobs.find(name) == blobs.end()) {
+        LOGE("instance dont have the blob with name: %s\n", name.c_str());
+        return Status(TNNERR_MODEL_ERR, "instance dont have the blob with name");
+    }
+    return TNN_OK;
+}
+
+Status Instance::BindInputMat(std::shared_ptr<Mat> mat, std::string input_name) {
+    WaitForwardAsync();
+    if (!mat || !mat->GetData()) {
+        LOGE("input mat is empty ,please check!\n");
+        return Status(TNNERR_PARAM_ERR, "input mat is empty ,please check!");
+    }
+
+    BlobMap input_blobs;
+    RETURN_ON_NEQ(network_->GetAllInputBlobs(input_blobs), TNN_OK);
+    RETURN_ON_NEQ(CheckBindName(input_blobs, input_name), TNN_OK);
+
+    bound_input_mats_[input_name] = mat;
+    return TNN_OK;
+}
+
+Status Instance::BindOutputMat(std::shared_ptr<Mat> mat, std::string output_name) {
+    WaitForwardAsync();
+    if (!mat || !mat->GetData()) {
+        LOGE("output mat is empty ,please check!\n");
+        return Status(TNNERR_PARAM_ERR, "output mat is empty ,please check!");
+    }
+
+    BlobMap output_blobs;
+    RETURN_ON_NEQ(network_->GetAllOutputBlobs(output_blobs), TNN_OK);
+    RETURN_ON_NEQ(CheckBindName(output_blobs, output_name), TNN_OK);
+
+    bound_output_mats_[output_name] = mat;
+    return TNN_OK;
+}
+
+Status Instance::BeginForwardBinding() {
+    if (bound_input_mats_.empty() && bound_output_mats_.empty()) {
+        return TNN_OK;
+    }
+
+    // shapes may have changed since binding, so the checks are done here
+    BlobMap input_blobs, output_blobs;
+    Status status = network_->GetAllInputBlobs(input_blobs);
+    if (status == TNN_OK) {
+        status = network_->GetAllOutputBlobs(output_blobs);
+    }
+
+    for (auto iter = bound_input_mats_.begin(); status == TNN_OK && iter != bound_input_mats_.end(); ++iter) {
+        auto blob = input_blobs[iter->first];
+        if (CanBindMatToBlob(*iter->second, blob)) {
+            BlobHandle handle;
+            handle.base = iter->second->GetData();
+            bound_blob_handles_.push_back(std::make_pair(blob, blob->GetHandle()));
+            blob->SetHandle(handle);
+        } else {
+            status = SetInputMat(iter->second, MatConvertParam(), iter->first);
+        }
+    }
+
+    for (auto iter = bound_output_mats_.begin(); status == TNN_OK && iter != bound_output_mats_.end();) {
+        auto blob = output_blobs[iter->first];
+        if (CanBindMatToBlob(*iter->second, blob)) {
+            BlobHandle handle;
+            handle.base = iter->second->GetData();
+            bound_blob_handles_.push_back(std::make_pair(blob, blob->GetHandle()));
+            blob->SetHandle(handle);
+            // written in place, nothing left to do after forward
+            iter = bound_output_mats_.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
+    if (status != TNN_OK) {
+        return EndForwardBinding(status);
+    }
+    return TNN_OK;
+}
+
+Status Instance::EndForwardBinding(Status forward_status) {
+    for (auto iter = bound_blob_handles_.rbegin(); iter != bound_blob_handles_.rend(); ++iter) {
+        iter->first->SetHandle(iter->second);
+    }
+    bound_blob_handles_.clear();
+    bound_input_mats_.clear();
+
+    auto output_mats = std::move(bound_output_mats_);
+    bound_output_mats_.clear();
+    if (forward_status != TNN_OK || output_mats.empty()) {
+        return forward_status;
+    }
+
+    // outputs whose layout differs from the bound mat
+    BlobMap output_blobs;
+    RETURN_ON_NEQ(network_->GetAllOutputBlobs(output_blobs), TNN_OK);
+    void *command_queue = nullptr;
+    network_->GetCommandQueue(&command_queue);
+    for (auto &iter : output_mats) {
+        std::shared_ptr<BlobConverter> blob_converter = nullptr;
+        if (output_converters_.find(iter.first) != output_converters_.end()) {
+            blob_converter = output_converters_[iter.first];
+        } else {
+            blob_converter                 = std::make_shared<BlobConverter>(output_blobs[iter.first]);
+            output_converters_[iter.first] = blob_converter;
+        }
+        auto status = blob_converter->ConvertToMat(*(iter.second.get()), MatConvertParam(), command_queue);
+        if (status != TNN_OK) {
+            LOGE("bound output convert Error: %s\n", status.description().c_str());
+            return status;
+        }
+    }
+    return TNN_OK;
+}
+
 #if TNN_PROFILE
 void Instance::StartProfile() {
     network_->StartProfile();
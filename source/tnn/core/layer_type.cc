@@ -230,6 +230,7 @@ static std::map<std::string, LayerType> global_layer_type_map = {
     {"ConstantOfShape", LAYER_CONSTANT_OF_SHAPE},
     {"NonZero", LAYER_NONZERO},
     {"LSTMONNX", LAYER_LSTMONNX},
+    {"GRUONNX", LAYER_GRUONNX},
     {"QuantizedSigmoid", LAYER_SIGMOID},
     {"StridedSliceV2", LAYER_STRIDED_SLICE_V2},
     {"Erf", LAYER_ERF},
@@ -242,6 +243,7 @@ static std::map<std::string, LayerType> global_layer_type_map = {
     {"OneHot", LAYER_ONEHOT},
     {"CbamFusedReduce", LAYER_CBAM_FUSED_REDUCE},
     {"CbamFusedPooling", LAYER_CBAM_FUSED_POOLING},
+    {"FusedDwPwConvolution", LAYER_FUSED_DW_PW_CONVOLUTION},
     {"Softsign", LAYER_SOFTSIGN},
     {"TopK", LAYER_TOPK},
     {"LogSoftmax", LAYER_LOGSOFTMAX},
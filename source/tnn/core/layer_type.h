@@ -219,6 +219,7 @@ enum LayerType {
     LAYER_NOT                                               = 329,
     LAYER_LOGSOFTMAX                                        = 330,
     LAYER_SCATTER_ELEMENTS                                  = 331,
+    LAYER_GRUONNX                                           = 332,
 
     LAYER_BLOB_SCALE                                        = 600,
 
@@ -226,7 +227,8 @@ enum LayerType {
     LAYER_TRT_ENGINE                                        = 701,
 
     LAYER_CBAM_FUSED_REDUCE                                 = 800,
-    LAYER_CBAM_FUSED_POOLING                                = 801
+    LAYER_CBAM_FUSED_POOLING                                = 801,
+    LAYER_FUSED_DW_PW_CONVOLUTION                           = 802
 };
 
 LayerType GlobalConvertLayerType(std::string layer_type_str);
@@ -0,0 +1,502 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "tnn/core/pipeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "tnn/core/instance.h"
+#include "tnn/interpreter/raw_buffer.h"
+#include "tnn/utils/dims_utils.h"
+
+namespace TNN_NS {
+
+typedef std::chrono::steady_clock PipelineClock;
+
+// bound mats must be aligned like blob memory to be used without a copy
+static const int PIPELINE_MAT_ALIGNMENT = 32;
+
+struct PipelineFrame {
+    uint64_t index = 0;
+    MatMap mats;
+    Status status = TNN_OK;
+    // number of producers each stage still waits for
+    std::vector<int> pending;
+    // time the frame was queued to each stage
+    std::vector<PipelineClock::time_point> queue_time;
+    // number of stages not done with the frame
+    int remaining = 0;
+};
+
+struct PipelineStage {
+    PipelineStageStats stats;
+    // frame mat names
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+
+    // instance stage, blob name to frame mat name
+    std::vector<std::shared_ptr<Instance>> instances;
+    std::map<std::string, std::string> instance_inputs;
+    std::map<std::string, std::string> instance_outputs;
+    std::map<std::string, MatConvertParam> input_params;
+
+    // op stage
+    Pipeline::OpFunc func;
+    int num_threads = 1;
+
+    // stages reading mats of this stage, and the number of stages this stage reads from
+    std::vector<int> consumers;
+    int producer_count = 0;
+
+    std::deque<std::shared_ptr<PipelineFrame>> queue;
+    std::condition_variable cond;
+    std::vector<std::thread> threads;
+};
+
+class PipelineImpl {
+public:
+    explicit PipelineImpl(PipelineConfig config) : config_(config) {}
+
+    ~PipelineImpl() {
+        Stop();
+    }
+
+    Status AddStage(std::shared_ptr<PipelineStage> stage) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (running_) {
+            return Status(TNNERR_PARAM_ERR, "stages can not be added to a running pipeline");
+        }
+        for (auto &other : stages_) {
+            if (other->stats.name == stage->stats.name) {
+                LOGE("Pipeline: duplicated stage name %s\n", stage->stats.name.c_str());
+                return Status(TNNERR_PARAM_ERR, "duplicated pipeline stage name");
+            }
+        }
+        stages_.push_back(stage);
+        return TNN_OK;
+    }
+
+    Status Start();
+    Status Push(MatMap &mats);
+    Status Pop(MatMap &mats);
+    Status Stop();
+    Status GetStageStats(std::vector<PipelineStageStats> &stats);
+
+private:
+    Status BuildGraph();
+    void StageLoop(int stage_index, int thread_index);
+    Status RunInstance(Instance *instance, PipelineStage &stage, MatMap &inputs, MatMap &outputs);
+    // queue the frame to the consumers of the stage, called with mutex_ held
+    void OnStageDone(int stage_index, std::shared_ptr<PipelineFrame> frame);
+
+    PipelineConfig config_;
+    std::vector<std::shared_ptr<PipelineStage>> stages_;
+    // mats read by stages and produced by none
+    std::set<std::string> frame_inputs_;
+
+    // guards the queues, the frames and the stats
+    std::mutex mutex_;
+    std::condition_variable push_cond_;
+    std::condition_variable pop_cond_;
+    std::map<uint64_t, std::shared_ptr<PipelineFrame>> done_frames_;
+    uint64_t push_index_ = 0;
+    uint64_t pop_index_  = 0;
+    uint64_t done_count_ = 0;
+    bool running_        = false;
+    bool stop_           = false;
+};
+
+Status PipelineImpl::BuildGraph() {
+    if (stages_.empty()) {
+        return Status(TNNERR_PARAM_ERR, "pipeline has no stage");
+    }
+
+    std::map<std::string, int> producers;
+    for (int i = 0; i < (int)stages_.size(); ++i) {
+        for (auto &name : stages_[i]->outputs) {
+            if (producers.count(name) > 0) {
+                LOGE("Pipeline: mat %s is produced by more than one stage\n", name.c_str());
+                return Status(TNNERR_PARAM_ERR, "pipeline mat is produced by more than one stage");
+            }
+            producers[name] = i;
+        }
+    }
+
+    frame_inputs_.clear();
+    for (int i = 0; i < (int)stages_.size(); ++i) {
+        auto &stage = stages_[i];
+        stage->consumers.clear();
+        stage->producer_count = 0;
+    }
+    for (int i = 0; i < (int)stages_.size(); ++i) {
+        std::set<int> stage_producers;
+        for (auto &name : stages_[i]->inputs) {
+            auto iter = producers.find(name);
+            if (iter == producers.end()) {
+                frame_inputs_.insert(name);
+            } else {
+                stage_producers.insert(iter->second);
+            }
+        }
+        for (auto producer : stage_producers) {
+            stages_[producer]->consumers.push_back(i);
+        }
+        stages_[i]->producer_count = (int)stage_producers.size();
+    }
+
+    // every stage must be reachable from the frame inputs, otherwise the graph has a cycle
+    std::vector<int> pending(stages_.size());
+    std::vector<int> ready;
+    for (int i = 0; i < (int)stages_.size(); ++i) {
+        pending[i] = stages_[i]->producer_count;
+        if (pending[i] == 0) {
+            ready.push_back(i);
+        }
+    }
+    int visited = 0;
+    while (!ready.empty()) {
+        int index = ready.back();
+        ready.pop_back();
+        visited++;
+        for (auto consumer : stages_[index]->consumers) {
+            if (--pending[consumer] == 0) {
+                ready.push_back(consumer);
+            }
+        }
+    }
+    if (visited != (int)stages_.size()) {
+        return Status(TNNERR_PARAM_ERR, "pipeline stages form a cycle");
+    }
+    return TNN_OK;
+}
+
+Status PipelineImpl::Start() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (running_) {
+        return TNN_OK;
+    }
+    if (config_.max_frames <= 0) {
+        return Status(TNNERR_PARAM_ERR, "pipeline max_frames must be positive");
+    }
+    RETURN_ON_NEQ(BuildGraph(), TNN_OK);
+
+    stop_    = false;
+    running_ = true;
+    for (int i = 0; i < (int)stages_.size(); ++i) {
+        for (int t = 0; t < stages_[i]->num_threads; ++t) {
+            stages_[i]->threads.emplace_back(&PipelineImpl::StageLoop, this, i, t);
+        }
+    }
+    return TNN_OK;
+}
+
+Status PipelineImpl::Push(MatMap &mats) {
+    for (auto &name : frame_inputs_) {
+        if (mats.find(name) == mats.end() || !mats[name]) {
+            LOGE("Pipeline: frame has no mat %s\n", name.c_str());
+            return Status(TNNERR_INVALID_INPUT, "pipeline frame misses an input mat");
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    push_cond_.wait(lock, [&] { return !running_ || push_index_ - pop_index_ < (uint64_t)config_.max_frames; });
+    if (!running_) {
+        return Status(TNNERR_COMMON_ERROR, "pipeline is not running");
+    }
+
+    auto frame        = std::make_shared<PipelineFrame>();
+    frame->index      = push_index_++;
+    frame->mats       = mats;
+    frame->remaining  = (int)stages_.size();
+    frame->queue_time = std::vector<PipelineClock::time_point>(stages_.size());
+    frame->pending.resize(stages_.size());
+    auto now = PipelineClock::now();
+    for (int i = 0; i < (int)stages_.size(); ++i) {
+        frame->pending[i] = stages_[i]->producer_count;
+        if (frame->pending[i] == 0) {
+            frame->queue_time[i] = now;
+            stages_[i]->queue.push_back(frame);
+            stages_[i]->cond.notify_one();
+        }
+    }
+    return TNN_OK;
+}
+
+Status PipelineImpl::Pop(MatMap &mats) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    pop_cond_.wait(lock, [&] {
+        return done_frames_.count(pop_index_) > 0 || (!running_ && pop_index_ == push_index_);
+    });
+    auto iter = done_frames_.find(pop_index_);
+    if (iter == done_frames_.end()) {
+        return Status(TNNERR_NO_RESULT, "pipeline has no frame to pop");
+    }
+    auto frame = iter->second;
+    done_frames_.erase(iter);
+    pop_index_++;
+    push_cond_.notify_all();
+
+    mats = frame->mats;
+    return frame->status;
+}
+
+Status PipelineImpl::Stop() {
+    std::vector<std::thread> threads;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!running_) {
+            return TNN_OK;
+        }
+        // pending pushes fail, the frames already pushed run to the end
+        running_ = false;
+        push_cond_.notify_all();
+        pop_cond_.wait(lock, [&] { return done_count_ == push_index_; });
+        stop_ = true;
+        for (auto &stage : stages_) {
+            stage->cond.notify_all();
+            for (auto &thread : stage->threads) {
+                threads.push_back(std::move(thread));
+            }
+            stage->threads.clear();
+        }
+        pop_cond_.notify_all();
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    return TNN_OK;
+}
+
+Status PipelineImpl::GetStageStats(std::vector<PipelineStageStats> &stats) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stats.clear();
+    for (auto &stage : stages_) {
+        stats.push_back(stage->stats);
+    }
+    return TNN_OK;
+}
+
+void PipelineImpl::StageLoop(int stage_index, int thread_index) {
+    auto &stage = *stages_[stage_index];
+    while (true) {
+        std::shared_ptr<PipelineFrame> frame;
+        MatMap inputs, outputs;
+        bool skip = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            stage.cond.wait(lock, [&] { return stop_ || !stage.queue.empty(); });
+            if (stage.queue.empty()) {
+                return;
+            }
+            frame = stage.queue.front();
+            stage.queue.pop_front();
+            stage.stats.total_wait_time_ms += std::chrono::duration<double, std::milli>(
+                                                  PipelineClock::now() - frame->queue_time[stage_index]).count();
+            // the mats of a frame may be added by other stages at the same time, so the inputs are taken here
+            skip = frame->status != TNN_OK;
+            // a failed frame misses the mats of the stages it skipped, they are not added as empty mats
+            for (auto &name : stage.inputs) {
+                if (!skip) {
+                    inputs[name] = frame->mats[name];
+                }
+            }
+        }
+
+        Status status = TNN_OK;
+        double time_ms = 0;
+        if (!skip) {
+            auto begin = PipelineClock::now();
+            if (!stage.instances.empty()) {
+                status = RunInstance(stage.instances[thread_index].get(), stage, inputs, outputs);
+            } else {
+                status = stage.func(inputs, outputs);
+            }
+            for (auto &name : stage.outputs) {
+                if (status == TNN_OK && (outputs.find(name) == outputs.end() || !outputs[name])) {
+                    LOGE("Pipeline: stage %s did not produce mat %s\n", stage.stats.name.c_str(), name.c_str());
+                    status = Status(TNNERR_NO_RESULT, "pipeline stage did not produce an output mat");
+                }
+            }
+            time_ms = std::chrono::duration<double, std::milli>(PipelineClock::now() - begin).count();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!skip) {
+            stage.stats.frame_count++;
+            stage.stats.total_time_ms += time_ms;
+            stage.stats.max_time_ms = std::max(stage.stats.max_time_ms, time_ms);
+            if (status == TNN_OK) {
+                for (auto &name : stage.outputs) {
+                    frame->mats[name] = outputs[name];
+                }
+            } else if (frame->status == TNN_OK) {
+                frame->status = status;
+            }
+        }
+        OnStageDone(stage_index, frame);
+    }
+}
+
+void PipelineImpl::OnStageDone(int stage_index, std::shared_ptr<PipelineFrame> frame) {
+    auto now = PipelineClock::now();
+    for (auto consumer : stages_[stage_index]->consumers) {
+        if (--frame->pending[consumer] == 0) {
+            frame->queue_time[consumer] = now;
+            stages_[consumer]->queue.push_back(frame);
+            stages_[consumer]->cond.notify_one();
+        }
+    }
+    if (--frame->remaining == 0) {
+        done_frames_[frame->index] = frame;
+        done_count_++;
+        pop_cond_.notify_all();
+    }
+}
+
+// NCHW_FLOAT mat owning memory aligned for binding
+static std::shared_ptr<Mat> CreateAlignedMat(DeviceType device_type, DimsVector dims) {
+    auto buffer = std::make_shared<RawBuffer>(DimsVectorUtils::Count(dims) * sizeof(float), PIPELINE_MAT_ALIGNMENT);
+    return std::shared_ptr<Mat>(new Mat(device_type, NCHW_FLOAT, dims, buffer->force_to<void *>()),
+                                [buffer](Mat *mat) { delete mat; });
+}
+
+Status PipelineImpl::RunInstance(Instance *instance, PipelineStage &stage, MatMap &inputs, MatMap &outputs) {
+    BlobMap input_blobs, output_blobs;
+    RETURN_ON_NEQ(instance->GetAllInputBlobs(input_blobs), TNN_OK);
+
+    // follow the batch, height and width of the mats, the channel is decided by the model
+    InputShapesMap inputs_shape;
+    bool need_reshape = false;
+    for (auto &iter : stage.instance_inputs) {
+        if (input_blobs.find(iter.first) == input_blobs.end()) {
+            LOGE("Pipeline: stage %s has no input blob %s\n", stage.stats.name.c_str(), iter.first.c_str());
+            return Status(TNNERR_PARAM_ERR, "pipeline stage input blob not found");
+        }
+        auto blob_dims = input_blobs[iter.first]->GetBlobDesc().dims;
+        auto mat_dims  = inputs[iter.second]->GetDims();
+        auto dims      = blob_dims;
+        if (dims.size() == mat_dims.size() && dims.size() >= 3) {
+            dims[0] = mat_dims[0];
+            for (int i = 2; i < (int)dims.size(); ++i) {
+                dims[i] = mat_dims[i];
+            }
+        }
+        need_reshape |= !DimsVectorUtils::Equal(dims, blob_dims);
+        inputs_shape[iter.first] = dims;
+    }
+    if (need_reshape) {
+        RETURN_ON_NEQ(instance->Reshape(inputs_shape), TNN_OK);
+    }
+
+    for (auto &iter : stage.instance_inputs) {
+        auto param_iter = stage.input_params.find(iter.first);
+        if (param_iter != stage.input_params.end()) {
+            RETURN_ON_NEQ(instance->SetInputMat(inputs[iter.second], param_iter->second, iter.first), TNN_OK);
+        } else {
+            RETURN_ON_NEQ(instance->BindInputMat(inputs[iter.second], iter.first), TNN_OK);
+        }
+    }
+
+    RETURN_ON_NEQ(instance->GetAllOutputBlobs(output_blobs), TNN_OK);
+    for (auto &iter : stage.instance_outputs) {
+        if (output_blobs.find(iter.first) == output_blobs.end()) {
+            LOGE("Pipeline: stage %s has no output blob %s\n", stage.stats.name.c_str(), iter.first.c_str());
+            return Status(TNNERR_PARAM_ERR, "pipeline stage output blob not found");
+        }
+        auto &desc       = output_blobs[iter.first]->GetBlobDesc();
+        bool cpu_blob    = desc.device_type == DEVICE_NAIVE || desc.device_type == DEVICE_X86 ||
+                           desc.device_type == DEVICE_ARM;
+        auto mat         = CreateAlignedMat(cpu_blob ? desc.device_type : DEVICE_NAIVE, desc.dims);
+        outputs[iter.second] = mat;
+        RETURN_ON_NEQ(instance->BindOutputMat(mat, iter.first), TNN_OK);
+    }
+
+    return instance->Forward();
+}
+
+Pipeline::Pipeline(PipelineConfig config) : impl_(std::make_shared<PipelineImpl>(config)) {}
+
+Pipeline::~Pipeline() {
+    impl_ = nullptr;
+}
+
+Status Pipeline::AddInstanceStage(const std::string &name, std::vector<std::shared_ptr<Instance>> instances,
+                                  std::map<std::string, std::string> inputs,
+                                  std::map<std::string, std::string> outputs,
+                                  std::map<std::string, MatConvertParam> input_params) {
+    if (instances.empty()) {
+        return Status(TNNERR_PARAM_ERR, "pipeline instance stage has no instance");
+    }
+    for (auto &instance : instances) {
+        CHECK_PARAM_NULL(instance.get());
+    }
+
+    auto stage              = std::make_shared<PipelineStage>();
+    stage->stats.name       = name;
+    stage->instances        = instances;
+    stage->num_threads      = (int)instances.size();
+    stage->instance_inputs  = inputs;
+    stage->instance_outputs = outputs;
+    stage->input_params     = input_params;
+    for (auto &iter : inputs) {
+        stage->inputs.push_back(iter.second);
+    }
+    for (auto &iter : outputs) {
+        stage->outputs.push_back(iter.second);
+    }
+    return impl_->AddStage(stage);
+}
+
+Status Pipeline::AddOpStage(const std::string &name, OpFunc func, std::vector<std::string> inputs,
+                            std::vector<std::string> outputs, int num_threads) {
+    if (!func || num_threads <= 0) {
+        return Status(TNNERR_PARAM_ERR, "invalid pipeline op stage");
+    }
+
+    auto stage         = std::make_shared<PipelineStage>();
+    stage->stats.name  = name;
+    stage->func        = func;
+    stage->num_threads = num_threads;
+    stage->inputs      = inputs;
+    stage->outputs     = outputs;
+    return impl_->AddStage(stage);
+}
+
+Status Pipeline::Start() {
+    return impl_->Start();
+}
+
+Status Pipeline::Push(MatMap frame) {
+    return impl_->Push(frame);
+}
+
+Status Pipeline::Pop(MatMap &frame) {
+    return impl_->Pop(frame);
+}
+
+Status Pipeline::Stop() {
+    return impl_->Stop();
+}
+
+Status Pipeline::GetStageStats(std::vector<PipelineStageStats> &stats) {
+    return impl_->GetStageStats(stats);
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,95 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "tnn/core/runtime_stats_collector.h"
+
+namespace TNN_NS {
+
+// bucket index of a duration: 0 for < 1us, i for [2^(i-1), 2^i) us
+static inline int HistogramBucket(uint64_t duration_ns) {
+    uint64_t us = duration_ns / 1000;
+    int bucket  = 0;
+    while (us > 0 && bucket < RUNTIME_STATS_HISTOGRAM_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void RuntimeStatsCollector::Init(const std::vector<std::string> &layer_names,
+                                 const std::vector<std::string> &type_names) {
+    layer_names_ = layer_names;
+    type_names_  = type_names;
+    type_names_.resize(layer_names_.size());
+
+    layer_count_ = layer_names_.size();
+    layer_counters_.reset(new Counter[layer_count_]);
+    Reset();
+}
+
+void RuntimeStatsCollector::Record(Counter &counter, Clock::time_point begin, Clock::time_point end) {
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    uint64_t ns   = duration > 0 ? (uint64_t)duration : 0;
+
+    // only the forward thread writes, relaxed ordering is enough for monitoring readers
+    counter.count.fetch_add(1, std::memory_order_relaxed);
+    counter.total_ns.fetch_add(ns, std::memory_order_relaxed);
+    if (ns > counter.max_ns.load(std::memory_order_relaxed)) {
+        counter.max_ns.store(ns, std::memory_order_relaxed);
+    }
+    counter.histogram[HistogramBucket(ns)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void RuntimeStatsCollector::ResetCounter(Counter &counter) {
+    counter.count.store(0, std::memory_order_relaxed);
+    counter.total_ns.store(0, std::memory_order_relaxed);
+    counter.max_ns.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < RUNTIME_STATS_HISTOGRAM_BUCKETS; ++i) {
+        counter.histogram[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void RuntimeStatsCollector::SnapshotCounter(const Counter &counter, uint64_t &count, double &total_ms,
+                                            double &max_ms, std::vector<uint64_t> &histogram) {
+    count    = counter.count.load(std::memory_order_relaxed);
+    total_ms = counter.total_ns.load(std::memory_order_relaxed) / 1000000.0;
+    max_ms   = counter.max_ns.load(std::memory_order_relaxed) / 1000000.0;
+    histogram.resize(RUNTIME_STATS_HISTOGRAM_BUCKETS);
+    for (int i = 0; i < RUNTIME_STATS_HISTOGRAM_BUCKETS; ++i) {
+        histogram[i] = counter.histogram[i].load(std::memory_order_relaxed);
+    }
+}
+
+void RuntimeStatsCollector::GetStats(RuntimeStats &stats) const {
+    SnapshotCounter(forward_counter_, stats.forward_count, stats.total_forward_time_ms, stats.max_forward_time_ms,
+                    stats.forward_histogram);
+
+    stats.layers.resize(layer_count_);
+    for (size_t i = 0; i < layer_count_; ++i) {
+        auto &layer_stats      = stats.layers[i];
+        layer_stats.layer_name = layer_names_[i];
+        layer_stats.type_name  = type_names_[i];
+        SnapshotCounter(layer_counters_[i], layer_stats.count, layer_stats.total_time_ms, layer_stats.max_time_ms,
+                        layer_stats.histogram);
+    }
+}
+
+void RuntimeStatsCollector::Reset() {
+    ResetCounter(forward_counter_);
+    for (size_t i = 0; i < layer_count_; ++i) {
+        ResetCounter(layer_counters_[i]);
+    }
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,79 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef TNN_SOURCE_TNN_CORE_RUNTIME_STATS_COLLECTOR_H_
+#define TNN_SOURCE_TNN_CORE_RUNTIME_STATS_COLLECTOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tnn/core/runtime_stats.h"
+
+namespace TNN_NS {
+
+// @brief RuntimeStatsCollector keeps cumulative latency counters of a network.
+// All counters are preallocated in Init, recording is lock free and the
+// counters can be read by GetStats from any thread while forward is running.
+class RuntimeStatsCollector {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // @brief preallocate counters for layers, names in execution order
+    void Init(const std::vector<std::string> &layer_names, const std::vector<std::string> &type_names);
+
+    // @brief record the duration of one layer forward
+    inline void RecordLayer(size_t index, Clock::time_point begin, Clock::time_point end) {
+        if (index < layer_count_) {
+            Record(layer_counters_[index], begin, end);
+        }
+    }
+
+    // @brief record the duration of one network forward
+    inline void RecordForward(Clock::time_point begin, Clock::time_point end) {
+        Record(forward_counter_, begin, end);
+    }
+
+    // @brief snapshot all counters
+    void GetStats(RuntimeStats &stats) const;
+
+    // @brief clear all counters
+    void Reset();
+
+private:
+    struct Counter {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> total_ns;
+        std::atomic<uint64_t> max_ns;
+        std::atomic<uint64_t> histogram[RUNTIME_STATS_HISTOGRAM_BUCKETS];
+    };
+
+    static void Record(Counter &counter, Clock::time_point begin, Clock::time_point end);
+    static void ResetCounter(Counter &counter);
+    static void SnapshotCounter(const Counter &counter, uint64_t &count, double &total_ms, double &max_ms,
+                                std::vector<uint64_t> &histogram);
+
+    std::unique_ptr<Counter[]> layer_counters_;
+    size_t layer_count_ = 0;
+    Counter forward_counter_;
+
+    std::vector<std::string> layer_names_;
+    std::vector<std::string> type_names_;
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_SOURCE_TNN_CORE_RUNTIME_STATS_COLLECTOR_H_
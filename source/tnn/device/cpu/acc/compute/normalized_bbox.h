@@ -16,6 +16,7 @@
 #define TNN_CPU_COMPUTE_NORMALIZED_BBOX_HPP
 #include <cstddef>
 #include <cstring>
+#include <vector>
 #include "tnn/core/status.h"
 
 namespace TNN_NS {
@@ -376,6 +377,41 @@ inline void NormalizedBBox::set_size(float value) {
     // @@protoc_insertion_point(field_set:caffe.NormalizedBBox.size)
 }
 
+// Boxes stored as struct of arrays, so that one box can be compared with
+// several boxes at once. size is the BBoxSize of each box.
+struct BBoxArray {
+    std::vector<float> xmin;
+    std::vector<float> ymin;
+    std::vector<float> xmax;
+    std::vector<float> ymax;
+    std::vector<float> size;
+
+    int count() const {
+        return static_cast<int>(size.size());
+    }
+
+    void reserve(const size_t num) {
+        xmin.reserve(num);
+        ymin.reserve(num);
+        xmax.reserve(num);
+        ymax.reserve(num);
+        size.reserve(num);
+    }
+
+    void push_back(const NormalizedBBox& bbox, const float bbox_size) {
+        xmin.push_back(bbox.xmin());
+        ymin.push_back(bbox.ymin());
+        xmax.push_back(bbox.xmax());
+        ymax.push_back(bbox.ymax());
+        size.push_back(bbox_size);
+    }
+};
+
+// Returns true if the jaccard overlap between bbox and any box of bboxes is
+// larger than threshold. bbox_size is the BBoxSize of bbox.
+typedef bool (*BBoxOverlapFunc)(const NormalizedBBox& bbox, const float bbox_size, const BBoxArray& bboxes,
+                                const float threshold);
+
 }  // namespace TNN_NS
 
 #endif  // TNN_NORMALIZED_BBOX_HPP
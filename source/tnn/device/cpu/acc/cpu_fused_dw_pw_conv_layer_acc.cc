@@ -0,0 +1,77 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "tnn/device/cpu/acc/cpu_layer_acc.h"
+#include "tnn/utils/dims_utils.h"
+#include "tnn/utils/naive_compute.h"
+
+namespace TNN_NS {
+
+DECLARE_CPU_ACC_WITH_FP32_RESOURCE(FusedDwPwConv, LAYER_FUSED_DW_PW_CONVOLUTION);
+
+Status CpuFusedDwPwConvLayerAcc::Reshape(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    return TNN_OK;
+}
+
+Status CpuFusedDwPwConvLayerAcc::Forward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto param    = dynamic_cast<FusedDwPwConvLayerParam *>(param_);
+    auto resource = dynamic_cast<FusedDwPwConvLayerResource *>(resource_);
+    if (!param || !resource || !param->dw_param || !param->pw_param || !resource->dw_resource ||
+        !resource->pw_resource) {
+        return Status(TNNERR_MODEL_ERR, "Error: FusedDwPwConvLayerParam or FusedDwPwConvLayerResource is empty");
+    }
+    auto dw_param = param->dw_param.get();
+    auto pw_param = param->pw_param.get();
+    auto dw_res   = resource->dw_resource.get();
+    auto pw_res   = resource->pw_resource.get();
+
+    Blob *input_blob   = inputs[0];
+    Blob *output_blob  = outputs[0];
+    DataType data_type = output_blob->GetBlobDesc().data_type;
+    DimsVector input_dims  = input_blob->GetBlobDesc().dims;
+    DimsVector output_dims = output_blob->GetBlobDesc().dims;
+    DimsVector dw_dims     = {output_dims[0], input_dims[1], output_dims[2], output_dims[3]};
+
+    void *dw_bias = dw_param->bias ? dw_res->bias_handle.force_to<void *>() : nullptr;
+    void *pw_bias = pw_param->bias ? pw_res->bias_handle.force_to<void *>() : nullptr;
+
+    if (data_type == DATA_TYPE_FLOAT) {
+        RawBuffer dw_output(DimsVectorUtils::Count(dw_dims) * sizeof(float));
+        NaiveConv<float, float, float, float>(
+            input_blob->GetHandle().base, dw_output.force_to<void *>(), dw_res->filter_handle.force_to<void *>(),
+            dw_bias, input_dims, dw_dims, dw_param->strides[1], dw_param->strides[0], dw_param->kernels[1],
+            dw_param->kernels[0], dw_param->pads[2], dw_param->pads[0], dw_param->group, dw_param->dialations[1],
+            dw_param->activation_type, NULL, 0, NULL, 0);
+        NaiveConv<float, float, float, float>(
+            dw_output.force_to<void *>(), output_blob->GetHandle().base, pw_res->filter_handle.force_to<void *>(),
+            pw_bias, dw_dims, output_dims, 1, 1, 1, 1, 0, 0, 1, 1, pw_param->activation_type, NULL, 0, NULL, 0);
+    } else if (data_type == DATA_TYPE_BFP16) {
+        RawBuffer dw_output(DimsVectorUtils::Count(dw_dims) * sizeof(bfp16_t));
+        NaiveConv<bfp16_t, float, float, bfp16_t>(
+            input_blob->GetHandle().base, dw_output.force_to<void *>(), dw_res->filter_handle.force_to<void *>(),
+            dw_bias, input_dims, dw_dims, dw_param->strides[1], dw_param->strides[0], dw_param->kernels[1],
+            dw_param->kernels[0], dw_param->pads[2], dw_param->pads[0], dw_param->group, dw_param->dialations[1],
+            dw_param->activation_type, NULL, 0, NULL, 0);
+        NaiveConv<bfp16_t, float, float, bfp16_t>(
+            dw_output.force_to<void *>(), output_blob->GetHandle().base, pw_res->filter_handle.force_to<void *>(),
+            pw_bias, dw_dims, output_dims, 1, 1, 1, 1, 0, 0, 1, 1, pw_param->activation_type, NULL, 0, NULL, 0);
+    } else {
+        return Status(TNNERR_LAYER_ERR, "data type not support in fused dw pw conv");
+    }
+    return TNN_OK;
+}
+
+REGISTER_CPU_ACC(FusedDwPwConv, LAYER_FUSED_DW_PW_CONVOLUTION);
+
+}  // namespace TNN_NS
@@ -0,0 +1,180 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "cpu_layer_acc.h"
+#include "tnn/utils/data_type_utils.h"
+#include "tnn/utils/dims_utils.h"
+
+namespace TNN_NS {
+
+DECLARE_CPU_ACC(GRUONNX, LAYER_GRUONNX);
+
+static Status GRU_Single(const float *x, float *y, const float *w, const float *r, const float *b, float *h_t,
+                         const int T, const int batch_size, const int input_size, const int hidden_size,
+                         const int y_stride, int reverse, int linear_before_reset) {
+    //num_directions = 1 for all below
+    //X shape [sequence batch_size input_size]
+    const int x_page_size = batch_size * input_size;
+
+    //W[zrh], weight tensor for the gates, shape [num_directions, 3*hidden_size, input_size]
+    const int w_page_size = hidden_size * input_size;
+    auto w_x_Z = w;
+    auto w_x_R = w_x_Z + w_page_size;
+    auto w_x_H = w_x_R + w_page_size;
+
+    //R[zrh], recurrence weight tensor, shape [num_directions, 3*hidden_size, hidden_size]
+    const int r_page_size = hidden_size * hidden_size;
+    auto r_x_Z = r;
+    auto r_x_R = r_x_Z + r_page_size;
+    auto r_x_H = r_x_R + r_page_size;
+
+    //B[zrh] Concatenation of [Wb[zrh], Rb[zrh]], [num_directions, 6*hidden_size]
+    auto b_w_Z = b;
+    auto b_w_R = b_w_Z + hidden_size;
+    auto b_w_H = b_w_R + hidden_size;
+    auto b_r_Z = b_w_H + hidden_size;
+    auto b_r_R = b_r_Z + hidden_size;
+    auto b_r_H = b_r_R + hidden_size;
+
+    //temp gates z and r, the new hidden state
+    std::vector<float> gate_z(hidden_size), gate_r(hidden_size), h_new(hidden_size);
+
+    for (int t = 0; t < T; t++) {
+        int ti = reverse ? T - 1 - t : t;
+        const float *x_t = x + ti * x_page_size;
+
+        for (int b = 0; b < batch_size; b++) {
+            const float *x_t_b = x_t + b * input_size;
+            float *h_t_b       = h_t + b * hidden_size;
+
+            for (int q = 0; q < hidden_size; q++) {
+                float Z = b_w_Z[q] + b_r_Z[q];
+                float R = b_w_R[q] + b_r_R[q];
+                for (int i = 0; i < input_size; i++) {
+                    Z += w_x_Z[q * input_size + i] * x_t_b[i];
+                    R += w_x_R[q * input_size + i] * x_t_b[i];
+                }
+                for (int i = 0; i < hidden_size; i++) {
+                    Z += r_x_Z[q * hidden_size + i] * h_t_b[i];
+                    R += r_x_R[q * hidden_size + i] * h_t_b[i];
+                }
+                gate_z[q] = 1.f / (1.f + exp(-Z));
+                gate_r[q] = 1.f / (1.f + exp(-R));
+            }
+
+            for (int q = 0; q < hidden_size; q++) {
+                float H = b_w_H[q];
+                for (int i = 0; i < input_size; i++) {
+                    H += w_x_H[q * input_size + i] * x_t_b[i];
+                }
+                float H_r = b_r_H[q];
+                if (linear_before_reset) {
+                    for (int i = 0; i < hidden_size; i++) {
+                        H_r += r_x_H[q * hidden_size + i] * h_t_b[i];
+                    }
+                    H += gate_r[q] * H_r;
+                } else {
+                    for (int i = 0; i < hidden_size; i++) {
+                        H_r += r_x_H[q * hidden_size + i] * gate_r[i] * h_t_b[i];
+                    }
+                    H += H_r;
+                }
+                h_new[q] = (1.f - gate_z[q]) * tanh(H) + gate_z[q] * h_t_b[q];
+            }
+
+            float *output_data = y + (ti * batch_size + b) * y_stride;
+            for (int q = 0; q < hidden_size; q++) {
+                h_t_b[q]       = h_new[q];
+                output_data[q] = h_new[q];
+            }
+        }
+    }
+
+    return TNN_OK;
+}
+
+Status CpuGRUONNXLayerAcc::Reshape(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    return TNN_OK;
+}
+
+Status CpuGRUONNXLayerAcc::Forward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto layer_param = dynamic_cast<GRUONNXLayerParam *>(param_);
+    CHECK_PARAM_NULL(layer_param);
+    int num_directions = layer_param->direction >= 2 ? 2 : 1;
+
+    if (inputs.size() < 4) {
+        return Status(TNNERR_LAYER_ERR, "GRU has invalid inputs");
+    }
+    if (layer_param->direction < 0 || layer_param->direction > 2) {
+        return Status(TNNERR_PARAM_ERR, "GRUONNX has invalid direction param");
+    }
+    Blob *blob_W  = inputs[1];
+    Blob *blob_R  = inputs[2];
+    Blob *blob_B  = inputs[3];
+    Blob *blob_h0 = inputs.size() >= 5 ? inputs[4] : nullptr;
+
+    const auto input_dims  = inputs[0]->GetBlobDesc().dims;
+    const auto T           = input_dims[0];                           // length of sequence
+    const auto batch       = input_dims[1];                           // batch_size
+    const auto input_size  = DimsVectorUtils::Count(input_dims, 2);  // input dimension
+    const auto hidden_size = layer_param->hidden_size;                // output dimension
+
+    //X shape [sequence batch_size input_size]
+    float *x = (float *)((char *)(inputs[0]->GetHandle().base) + inputs[0]->GetHandle().bytes_offset);
+
+    //Y shape [sequence batch_size num_directions *hidden_size]
+    float *y = (float *)((char *)(outputs[0]->GetHandle().base) + outputs[0]->GetHandle().bytes_offset);
+
+    //W[zrh], weight tensor for the gates, shape [num_directions, 3*hidden_size, input_size]
+    float *w = (float *)((char *)(blob_W->GetHandle().base) + blob_W->GetHandle().bytes_offset);
+
+    //R[zrh], recurrence weight tensor, shape [num_directions, 3*hidden_size, hidden_size]
+    float *r = (float *)((char *)(blob_R->GetHandle().base) + blob_R->GetHandle().bytes_offset);
+
+    //B[zrh] Concatenation of [Wb[zrh], Rb[zrh]], [num_directions, 6*hidden_size]
+    float *b = (float *)((char *)(blob_B->GetHandle().base) + blob_B->GetHandle().bytes_offset);
+
+    // Y_h is optional, keep the state in a temp buffer if it is not an output
+    std::vector<float> h_temp;
+    float *h_t = nullptr;
+    if (outputs.size() >= 2) {
+        h_t = (float *)((char *)(outputs[1]->GetHandle().base) + outputs[1]->GetHandle().bytes_offset);
+    } else {
+        h_temp.resize(num_directions * batch * hidden_size);
+        h_t = h_temp.data();
+    }
+
+    //initial_h, initial value of the hidden, If not specified - assumed to be 0. shape [num_directions, batch_size, hidden_size]
+    if (blob_h0 != nullptr) {
+        auto h_0 = (float *)((char *)(blob_h0->GetHandle().base) + blob_h0->GetHandle().bytes_offset);
+        memcpy((void *)h_t, h_0, num_directions * batch * hidden_size * sizeof(float));
+    } else {
+        memset(h_t, 0, num_directions * batch * hidden_size * sizeof(float));
+    }
+
+    // both directions write y in place, [sequence batch_size num_directions*hidden_size]
+    const int y_stride = num_directions * hidden_size;
+    for (int d = 0; d < num_directions; d++) {
+        int reverse = layer_param->direction == 1 || d == 1;
+        GRU_Single(x, y + d * hidden_size, w + d * 3 * hidden_size * input_size, r + d * 3 * hidden_size * hidden_size,
+                   b + d * 6 * hidden_size, h_t + d * batch * hidden_size, T, batch, input_size, hidden_size, y_stride,
+                   reverse, layer_param->linear_before_reset);
+    }
+
+    return TNN_OK;
+}
+
+REGISTER_CPU_ACC(GRUONNX, LAYER_GRUONNX);
+}  // namespace TNN_NS
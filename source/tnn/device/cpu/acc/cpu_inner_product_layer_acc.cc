@@ -17,7 +17,9 @@
 #include "tnn/interpreter/layer_resource_generator.h"
 #include "tnn/utils/bfp16.h"
 #include "tnn/utils/bfp16_utils.h"
+#include "tnn/utils/dims_utils.h"
 #include "tnn/utils/naive_compute.h"
+#include "tnn/utils/weight_quant_utils.h"
 
 namespace TNN_NS {
 
@@ -47,6 +49,21 @@ Status CpuInnerProductLayerAcc::Init(Context *context, LayerParam *param, LayerR
     CHECK_PARAM_NULL(layer_param);
     auto layer_res = dynamic_cast<InnerProductLayerResource *>(resource_);
     CHECK_PARAM_NULL(layer_res);
+    if (layer_param->weight_quant_bits > 0) {
+        // weight only quantized weights run as float weights
+        const int ic = DimsVectorUtils::Count(inputs[0]->GetBlobDesc().dims, 1);
+        RawBuffer weight(layer_param->num_output * ic * sizeof(float));
+        RETURN_ON_NEQ(WeightQuantUtils::Dequantize(layer_res->weight_handle, layer_res->scale_handle,
+                                                   layer_param->num_output, ic, layer_param->weight_quant_bits,
+                                                   layer_param->weight_quant_group_size, weight.force_to<float *>()),
+                      TNN_OK);
+        weight.SetDataType(DATA_TYPE_FLOAT);
+        auto fp32_res           = std::make_shared<InnerProductLayerResource>();
+        fp32_res->weight_handle = weight;
+        fp32_res->bias_handle   = layer_res->bias_handle;
+        fp32_resource_          = fp32_res;
+        resource_               = fp32_resource_.get();
+    }
     if (outputs[0]->GetBlobDesc().data_type == DATA_TYPE_INT8) {
         if (!buffer_scale_.GetBytesSize()) {
             auto dims_output    = outputs[0]->GetBlobDesc().dims;
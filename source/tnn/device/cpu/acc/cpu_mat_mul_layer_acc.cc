@@ -14,9 +14,57 @@
 
 #include "tnn/device/cpu/acc/cpu_unary_layer_acc.h"
 #include "tnn/utils/dims_utils.h"
+#include "tnn/utils/weight_quant_utils.h"
 
 namespace TNN_NS {
-DECLARE_CPU_ACC(MatMul, LAYER_MATMUL);
+
+class CpuMatMulLayerAcc : public CpuLayerAcc {
+public:
+    virtual ~CpuMatMulLayerAcc(){};
+    Status Init(Context *context, LayerParam *param, LayerResource *resource, const std::vector<Blob *> &inputs,
+                const std::vector<Blob *> &outputs);
+    virtual Status Reshape(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+    virtual Status Forward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+
+private:
+    // float weight of a weight only quantized weight
+    RawBuffer buffer_weight_;
+};
+
+Status CpuMatMulLayerAcc::Init(Context *context, LayerParam *param, LayerResource *resource,
+                               const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    RETURN_ON_NEQ(CpuLayerAcc::Init(context, param, resource, inputs, outputs), TNN_OK);
+
+    auto layer_param = dynamic_cast<MatMulLayerParam *>(param);
+    CHECK_PARAM_NULL(layer_param);
+    if (layer_param->weight_quant_bits <= 0) {
+        return TNN_OK;
+    }
+    auto layer_res = dynamic_cast<MatMulLayerResource *>(resource);
+    CHECK_PARAM_NULL(layer_res);
+    auto weight_dims = layer_res->weight.GetBufferDims();
+    if (layer_param->weight_position != 1 || weight_dims.size() != 2) {
+        return Status(TNNERR_LAYER_ERR, "weight only quantized matmul needs a 2d weight at position 1");
+    }
+
+    // the quantized weight is stored transposed, one row per output col
+    const int rows = weight_dims[1];
+    const int cols = weight_dims[0];
+    RawBuffer weight_t(rows * cols * sizeof(float));
+    RETURN_ON_NEQ(WeightQuantUtils::Dequantize(layer_res->weight, layer_res->scale_handle, rows, cols,
+                                               layer_param->weight_quant_bits, layer_param->weight_quant_group_size,
+                                               weight_t.force_to<float *>()),
+                  TNN_OK);
+    buffer_weight_ = RawBuffer(rows * cols * sizeof(float));
+    auto src       = weight_t.force_to<float *>();
+    auto dst       = buffer_weight_.force_to<float *>();
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            dst[c * rows + r] = src[r * cols + c];
+        }
+    }
+    return TNN_OK;
+}
 
 Status CpuMatMulLayerAcc::Reshape(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     return TNN_OK;
@@ -43,7 +91,8 @@ Status CpuMatMulLayerAcc::Forward(const std::vector<Blob *> &inputs, const std::
             matrix_a = static_cast<float *>(inputs[0]->GetHandle().base);
             matrix_b = static_cast<float *>(inputs[1]->GetHandle().base);
         } else {
-            auto weight = resource->weight.force_to<float *>();
+            auto weight = param->weight_quant_bits > 0 ? buffer_weight_.force_to<float *>()
+                                                       : resource->weight.force_to<float *>();
             matrix_a    = param->weight_position == 0 ? weight : static_cast<float *>(inputs[0]->GetHandle().base);
             matrix_b    = param->weight_position == 1 ? weight : static_cast<float *>(inputs[0]->GetHandle().base);
         }
@@ -270,6 +270,38 @@ void CpuMatConverterAcc::MatMemcpy2D(void* src, void* dst, int width, int height
     }
 
 }
+Status CpuMatConverterAcc::CropResize(Mat& src, Mat& dst, CropResizeParam param, void* command_queue) {
+    Status ret = TNN_OK;
+
+    ret = CheckMatConverterParams(src, dst, true);
+    if (ret != TNN_OK)
+        return ret;
+
+    auto mat_type = src.GetMatType();
+    if (mat_type != NGRAY && mat_type != N8UC3 && mat_type != N8UC4) {
+        return Status(TNNERR_PARAM_ERR, "crop resize mat type not support yet");
+    }
+    int channel     = mat_type == NGRAY ? 1 : (mat_type == N8UC3 ? 3 : 4);
+    int dst_w       = dst.GetWidth();
+    int dst_h       = dst.GetHeight();
+    int dst_channel = dst.GetChannel();
+    for (int b = 0; b < param.boxes.size(); ++b) {
+        float* dst_ptr = (float*)dst.GetData() + b * dst_channel * dst_h * dst_w;
+        if (!param.transforms.empty() && param.transforms[b].size() == 6) {
+            const float* t        = param.transforms[b].data();
+            float transform[2][3] = {{t[0], t[1], t[2]}, {t[3], t[4], t[5]}};
+            CropResizeWarpAffine((uint8_t*)src.GetData(), src.GetWidth(), src.GetHeight(), channel, transform,
+                                 param.border_val, dst_ptr, dst_w, dst_h, dst_channel, param.scale.data(),
+                                 param.bias.data(), param.reverse_channel);
+        } else {
+            CropResizeBilinear((uint8_t*)src.GetData(), src.GetWidth(), src.GetHeight(), channel, param.boxes[b],
+                               dst_ptr, dst_w, dst_h, dst_channel, param.scale.data(), param.bias.data(),
+                               param.reverse_channel);
+        }
+    }
+
+    return ret;
+}
 
 DECLARE_MAT_CONVERTER_CREATER(Cpu);
 REGISTER_MAT_CONVERTER(Cpu, DEVICE_NAIVE);
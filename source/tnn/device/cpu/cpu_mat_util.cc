@@ -448,4 +448,68 @@ void YUVToBGRA(const unsigned char* yuv, unsigned char* bgra, int h, int w, bool
     NaiveYUVToBGROrBGRA(yuv, bgra, 4, h, w, is_nv12);
 }
 
+void CropResizeBilinear(const uint8_t* src, int src_w, int src_h, int channel, const CropParam& box, float* dst,
+                        int dst_w, int dst_h, int dst_channel, const float* scale, const float* bias,
+                        bool reverse_channel) {
+    float scale_x = (float)box.width / dst_w;
+    float scale_y = (float)box.height / dst_h;
+    for (int c = 0; c < dst_channel; ++c) {
+        int sc       = CropResizeSrcChannel(c, channel, reverse_channel);
+        float* dst_c = dst + c * dst_h * dst_w;
+        for (int y = 0; y < dst_h; ++y) {
+            int y0, y1;
+            float by;
+            CropResizePosition(y, box.top_left_y, scale_y, src_h, &y0, &y1, &by);
+            for (int x = 0; x < dst_w; ++x) {
+                int x0, x1;
+                float ax;
+                CropResizePosition(x, box.top_left_x, scale_x, src_w, &x0, &x1, &ax);
+                float v00 = src[(y0 * src_w + x0) * channel + sc];
+                float v01 = src[(y0 * src_w + x1) * channel + sc];
+                float v10 = src[(y1 * src_w + x0) * channel + sc];
+                float v11 = src[(y1 * src_w + x1) * channel + sc];
+                float v0  = v00 + (v01 - v00) * ax;
+                float v1  = v10 + (v11 - v10) * ax;
+                dst_c[y * dst_w + x] = (v0 + (v1 - v0) * by) * scale[c] + bias[c];
+            }
+        }
+    }
+}
+
+void CropResizeWarpAffine(const uint8_t* src, int src_w, int src_h, int channel, const float (*transform)[3],
+                          float border_val, float* dst, int dst_w, int dst_h, int dst_channel, const float* scale,
+                          const float* bias, bool reverse_channel) {
+    double m[6];
+    WarpAffineMatrixInverse(transform, m);
+
+    auto get_value = [&](int x, int y, int sc) -> float {
+        if (x < 0 || x >= src_w || y < 0 || y >= src_h) {
+            return border_val;
+        }
+        return src[(y * src_w + x) * channel + sc];
+    };
+
+    for (int c = 0; c < dst_channel; ++c) {
+        int sc       = CropResizeSrcChannel(c, channel, reverse_channel);
+        float* dst_c = dst + c * dst_h * dst_w;
+        for (int y = 0; y < dst_h; ++y) {
+            for (int x = 0; x < dst_w; ++x) {
+                float fx  = (float)(m[0] * x + m[1] * y + m[2]);
+                float fy  = (float)(m[3] * x + m[4] * y + m[5]);
+                int x0    = (int)std::floor(fx);
+                int y0    = (int)std::floor(fy);
+                float ax  = fx - x0;
+                float by  = fy - y0;
+                float v00 = get_value(x0, y0, sc);
+                float v01 = get_value(x0 + 1, y0, sc);
+                float v10 = get_value(x0, y0 + 1, sc);
+                float v11 = get_value(x0 + 1, y0 + 1, sc);
+                float v0  = v00 + (v01 - v00) * ax;
+                float v1  = v10 + (v11 - v10) * ax;
+                dst_c[y * dst_w + x] = (v0 + (v1 - v0) * by) * scale[c] + bias[c];
+            }
+        }
+    }
+}
+
 }  // namespace TNN_NS
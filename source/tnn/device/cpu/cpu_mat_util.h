@@ -20,6 +20,7 @@
 
 #include "tnn/core/blob.h"
 #include "tnn/core/macro.h"
+#include "tnn/utils/mat_utils.h"
 
 namespace TNN_NS {
 
@@ -41,6 +42,12 @@ void BGROrBGRAToGray(const uint8_t* src, uint8_t* dst, int h, int w, int channel
 void RGBOrRGBAToGray(const uint8_t* src, uint8_t* dst, int h, int w, int channel);
 void YUVToBGR(const unsigned char* yuv, unsigned char* bgr, int h, int w, bool is_nv12);
 void YUVToBGRA(const unsigned char* yuv, unsigned char* bgra, int h, int w, bool is_nv12);
+void CropResizeBilinear(const uint8_t* src, int src_w, int src_h, int channel, const CropParam& box, float* dst,
+                        int dst_w, int dst_h, int dst_channel, const float* scale, const float* bias,
+                        bool reverse_channel);
+void CropResizeWarpAffine(const uint8_t* src, int src_w, int src_h, int channel, const float (*transform)[3],
+                          float border_val, float* dst, int dst_w, int dst_h, int dst_channel, const float* scale,
+                          const float* bias, bool reverse_channel);
 
 }  // namespace TNN_NS
 
@@ -22,7 +22,7 @@
 #include "tnn/device/x86/acc/compute/jit/conv_gemm_config.h"
 #include "tnn/device/x86/acc/compute/jit/utils/timer.hpp"
 #include "tnn/device/x86/acc/compute/jit/conv_sgemm_driver.h"
-#include "tnn/utils/omp_utils.h"
+#include "tnn/device/x86/x86_thread_pool.h"
 #include <xbyak/xbyak.h>
 
 namespace TNN_NS {
@@ -185,9 +185,7 @@ void conv_sgemm_nn_col_major_prepack_b(
         // pack b -> K_c * N;
         const float *pack_b_k = src_b + k * divUp(N, n_block);
 
-        OMP_PARALLEL_FOR_DYNAMIC_
-        for (dim_t i = 0; i < M; i += M_c)  {
-            int thread_id = OMP_TID_;
+        X86ParallelFor(0, M, M_c, [&](dim_t i, int thread_id) {
             auto src_trans_per_t = src_trans_buf + thread_id * M_c * K_c;
             dim_t cur_m = MIN(M - i, M_c);
             // pack a -> M_c * K_c;
@@ -202,7 +200,7 @@ void conv_sgemm_nn_col_major_prepack_b(
                 conv_sgemm_block_n(cur_m, cur_n, cur_k, src_trans_per_t, lda, packed_cur_b, ldb, cur_c, ldc, cur_bias, first, post_type, conv_gemm_conf);
                 j += cur_n;
             }
-        }
+        });
         // if k != 0, first = 1
         first = 1;
     }
@@ -307,8 +305,7 @@ void conv_sgemm_tn_col_major_prepack_a(
         // pack b -> K_c * N;
         pack_col_b_n(src_b + k, ldb, pack_b_buf, K_c, cur_k, N, conv_gemm_conf);
 
-        OMP_PARALLEL_FOR_DYNAMIC_
-        for (dim_t i = 0; i < M; i += M_c)  {
+        X86ParallelFor(0, M, M_c, [&](dim_t i, int thread_id) {
             dim_t cur_m = MIN(M - i, M_c);
             // pack a -> M_c * K_c;
             auto src_a_i = src_a + k * divUp(M, m_block) + i * K_c;
@@ -322,7 +319,7 @@ void conv_sgemm_tn_col_major_prepack_a(
                 conv_sgemm_block_n(cur_m, cur_n, cur_k, src_a_i, lda, packed_cur_b, ldb, cur_c, ldc, cur_bias, first, post_type, conv_gemm_conf);
                 j += cur_n;
             }
-        }
+        });
         // if k != 0, first = 1
         first = 1;
     }
@@ -46,4 +46,18 @@ bool cpu_with_isa(x86_isa_t arch) {
     return false;
 }
 
+int cpu_data_cache_size(int level) {
+    if (level >= 1 && level <= static_cast<int>(cpu.getDataCacheLevels())) {
+        return static_cast<int>(cpu.getDataCacheSize(level - 1));
+    }
+    switch (level) {
+        case 1:
+            return 32 * 1024;
+        case 2:
+            return 256 * 1024;
+        default:
+            return 8 * 1024 * 1024;
+    }
+}
+
 }
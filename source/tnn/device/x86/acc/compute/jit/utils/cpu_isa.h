@@ -42,6 +42,10 @@ typedef enum {
 
 bool cpu_with_isa(x86_isa_t arch);
 
+// size in bytes of the data cache at level (1 for L1d, 2 for L2, ...).
+// common desktop values are returned if cpuid does not report the level.
+int cpu_data_cache_size(int level);
+
 } // namespace tnn
 
 #endif // TNN_DEVICE_X86_ACC_COMPUTE_JIT_UTILS_CPU_ISA_HPP_
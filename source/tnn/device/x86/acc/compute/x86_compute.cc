@@ -16,7 +16,8 @@
 #include "tnn/device/x86/acc/Float8.h"
 #include "tnn/device/x86/acc/Float4.h"
 #include "tnn/utils/naive_compute.h"
-#include "tnn/utils/omp_utils.h"
+#include "tnn/utils/weight_quant_utils.h"
+#include "tnn/device/x86/x86_thread_pool.h"
 
 #include <algorithm>
 #include <cstring>
@@ -75,6 +76,71 @@ Status X86_IM2COL(float* src, int channel, int height, int width, int kernelh, i
     return TNN_OK;
 }
 
+Status X86_VOL2COL(float* src, int channel, int depth, int height, int width, int out_depth, int out_height,
+                   int out_width, int kerneld, int kernelh, int kernelw, int padd, int padh, int padw, int strided,
+                   int strideh, int stridew, int dilationd, int dilationh, int dilationw, float* dst) {
+    const int channels_col = channel * kerneld * kernelh * kernelw;
+    const int out_hw       = out_height * out_width;
+    const int in_hw        = height * width;
+
+    // every row of the col buffer is independent, split them between threads
+    X86ParallelFor(0, channels_col, [&](int c, int thread_id) {
+        int w_offset = c % kernelw;
+        int h_offset = (c / kernelw) % kernelh;
+        int d_offset = (c / kernelw / kernelh) % kerneld;
+        int c_im     = c / kernelw / kernelh / kerneld;
+
+        int d_base = d_offset * dilationd - padd;
+        int h_base = h_offset * dilationh - padh;
+        int w_base = w_offset * dilationw - padw;
+
+        int h_base_start = MIN(out_height, MAX(0, (UP_DIV(-h_base, strideh))));
+        int h_base_end   = MIN(out_height, UP_DIV(height - h_base, strideh));
+        int w_base_start = MIN(out_width, MAX(0, (UP_DIV(-w_base, stridew))));
+        int w_base_end   = MIN(out_width, UP_DIV(width - w_base, stridew));
+        h_base_end       = MAX(h_base_end, h_base_start);
+        w_base_end       = MAX(w_base_end, w_base_start);
+
+        auto src_c = src + c_im * depth * in_hw;
+        auto dst_c = dst + (size_t)c * out_depth * out_hw;
+
+        for (int d = 0; d < out_depth; d++) {
+            int d_pad  = d_base + d * strided;
+            auto dst_d = dst_c + d * out_hw;
+            if (d_pad < 0 || d_pad >= depth) {
+                memset(dst_d, 0, out_hw * sizeof(float));
+                continue;
+            }
+            auto src_d = src_c + d_pad * in_hw;
+
+            memset(dst_d, 0, h_base_start * out_width * sizeof(float));
+            for (int h = h_base_start; h < h_base_end; h++) {
+                int h_pad  = h_base + h * strideh;
+                auto src_h = src_d + h_pad * width;
+                auto dst_h = dst_d + h * out_width;
+
+                for (int w = 0; w < w_base_start; w++) {
+                    dst_h[w] = 0;
+                }
+                if (stridew == 1) {
+                    memcpy(dst_h + w_base_start, src_h + w_base + w_base_start,
+                           (w_base_end - w_base_start) * sizeof(float));
+                } else {
+                    for (int w = w_base_start; w < w_base_end; w++) {
+                        dst_h[w] = src_h[w_base + w * stridew];
+                    }
+                }
+                for (int w = w_base_end; w < out_width; w++) {
+                    dst_h[w] = 0;
+                }
+            }
+            memset(dst_d + h_base_end * out_width, 0, (out_height - h_base_end) * out_width * sizeof(float));
+        }
+    });
+
+    return TNN_OK;
+}
+
 Status X86_COL2IM(float* src, int channels, int height, int width, int kernelh, int kernelw, int padh, int padw,
                   int strideh, int stridew, int dilationh, int dilationw, int output_height, int output_width, float* dst) {
     for (int c = 0; c < channels; ++c) {
@@ -504,8 +570,7 @@ template<X86ReduceOpType type>
 void reduce_kernel(float * input, float * output, size_t outer_size, size_t inner_size, size_t reduce_size) 
 {
     for(long outer_idx = 0; outer_idx < outer_size; outer_idx++) {
-        OMP_PARALLEL_FOR_GUIDED_
-        for(long inner_idx = 0; inner_idx < inner_size; inner_idx++) {
+        X86ParallelFor(0, inner_size, [&](long inner_idx, int thread_id) {
             float acc = 0;
             if (type == X86ReduceOpType::kMIN) {
                 acc = FLT_MAX;
@@ -516,7 +581,7 @@ void reduce_kernel(float * input, float * output, size_t outer_size, size_t inne
                 acc = reduce_iter_op<type>(acc, input[i * inner_size + inner_idx]);
             }
             output[inner_idx] = reduce_final_op<type>(acc, float(reduce_size));
-        }
+        });
         input += reduce_size * inner_size;
         output += inner_size;
     }
@@ -773,8 +838,7 @@ void X86Sgemv(float* dst, const float* src, const float* weight, float *bias, Di
         const float *src_batch = src + b * batch_stride;
         float *dst_batch = dst + b * dims_output[1];
 
-        OMP_PARALLEL_FOR_GUIDED_
-        for (int oc = 0; oc < oc_vec_size; oc += pack) {
+        X86ParallelFor(0, oc_vec_size, pack, [&](int oc, int thread_id) {
             auto weight_oc = weight + oc * batch_stride;
             VEC acc = VEC::loadu(bias + oc);
             size_t ic = 0;
@@ -799,7 +863,7 @@ void X86Sgemv(float* dst, const float* src, const float* weight, float *bias, Di
                 VEC::mla(acc, weight_v, src_v);
             }
             VEC::saveu(dst_batch + oc, acc);
-        }
+        });
         int left = oc_left;
         int oc = oc_vec_size;
         if (pack == 8) {
@@ -825,6 +889,369 @@ void X86Sgemv(float* dst, const float* src, const float* weight, float *bias, Di
 template void X86Sgemv<Float4, 4>(float* dst, const float* src, const float* weight, float *bias, DimsVector dims_input, DimsVector dims_output);
 template void X86Sgemv<Float8, 8>(float* dst, const float* src, const float* weight, float *bias, DimsVector dims_input, DimsVector dims_output);
 
+
+size_t X86WeightQuantBlockBytes(int ic, int bits, int group_size) {
+    if (bits == 8) {
+        return (size_t)ic * 8;
+    }
+    int group_count = WeightQuantUtils::GetGroupCount(ic, group_size);
+    int group_cols  = group_count == 1 ? ic : group_size;
+    size_t bytes    = 0;
+    for (int g = 0; g < group_count; g++) {
+        int cols = std::min(ic, (g + 1) * group_cols) - g * group_cols;
+        bytes += UP_DIV(cols, 2) * 8;
+    }
+    return bytes;
+}
+
+void X86PackWeightQuantC8(int8_t *dst_weight, float *dst_scale, const int8_t *src_weight, const float *src_scale,
+                          int oc, int ic, int bits, int group_size) {
+    const int row_bytes   = WeightQuantUtils::GetRowBytes(ic, bits);
+    const int group_count = WeightQuantUtils::GetGroupCount(ic, group_size);
+    const int group_cols  = group_count == 1 ? ic : group_size;
+    const int oc_blocks   = UP_DIV(oc, 8);
+    const size_t block_bytes = X86WeightQuantBlockBytes(ic, bits, group_size);
+
+    memset(dst_weight, 0, oc_blocks * block_bytes);
+    memset(dst_scale, 0, oc_blocks * group_count * 8 * sizeof(float));
+    for (int b = 0; b < oc_blocks; b++) {
+        int8_t *dst = dst_weight + b * block_bytes;
+        for (int g = 0; g < group_count; g++) {
+            const int col_begin = g * group_cols;
+            const int col_end   = std::min(ic, col_begin + group_cols);
+            const int step      = bits == 8 ? 1 : 2;
+            for (int c = col_begin; c < col_end; c += step) {
+                for (int i = 0; i < 8; i++) {
+                    int o = b * 8 + i;
+                    if (o >= oc) {
+                        continue;
+                    }
+                    const int8_t *src_row = src_weight + o * row_bytes;
+                    if (bits == 8) {
+                        dst[i] = src_row[c];
+                    } else {
+                        int low  = WeightQuantUtils::GetValue(src_row, c, bits);
+                        int high = c + 1 < col_end ? WeightQuantUtils::GetValue(src_row, c + 1, bits) : 0;
+                        dst[i]   = static_cast<int8_t>((low & 0xF) | ((high & 0xF) << 4));
+                    }
+                }
+                dst += 8;
+            }
+            for (int i = 0; i < 8 && b * 8 + i < oc; i++) {
+                dst_scale[(b * group_count + g) * 8 + i] = src_scale[(b * 8 + i) * group_count + g];
+            }
+        }
+    }
+}
+
+// 8 int8 values to floats
+static inline __m256 X86LoadInt8x8(const int8_t *src) {
+    return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src))));
+}
+
+/*
+a block of 8 output channels for up to 4 rows, every group accumulates value * src and is scaled once,
+int4 values are sign extended by shifting the low nibble to the top of the int32 lane and back
+*/
+template <int bits>
+static void X86GemmWeightQuantBlock(float *dst, int ldd, const float *src, int ld_src, int rows,
+                                    const int8_t *weight, const float *scale, const float *bias, int ic,
+                                    int group_count, int group_cols, int oc_left) {
+    const float *src_r[4];
+    for (int r = 0; r < 4; r++) {
+        src_r[r] = src + std::min(r, rows - 1) * ld_src;
+    }
+    __m256 total[4], acc[4];
+    const __m256 v_bias = _mm256_loadu_ps(bias);
+    for (int r = 0; r < 4; r++) {
+        total[r] = v_bias;
+    }
+
+    const int8_t *w = weight;
+    for (int g = 0; g < group_count; g++) {
+        const int col_begin = g * group_cols;
+        const int col_end   = std::min(ic, col_begin + group_cols);
+        for (int r = 0; r < 4; r++) {
+            acc[r] = _mm256_setzero_ps();
+        }
+        if (bits == 8) {
+            for (int c = col_begin; c < col_end; c++, w += 8) {
+                __m256 v_w = X86LoadInt8x8(w);
+                for (int r = 0; r < 4; r++) {
+                    acc[r] = _mm256_fmadd_ps(v_w, _mm256_broadcast_ss(src_r[r] + c), acc[r]);
+                }
+            }
+        } else {
+            int c = col_begin;
+            for (; c + 1 < col_end; c += 2, w += 8) {
+                __m256i v_packed = _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(w)));
+                __m256 v_low     = _mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(v_packed, 28), 28));
+                __m256 v_high    = _mm256_cvtepi32_ps(_mm256_srai_epi32(v_packed, 4));
+                for (int r = 0; r < 4; r++) {
+                    acc[r] = _mm256_fmadd_ps(v_low, _mm256_broadcast_ss(src_r[r] + c), acc[r]);
+                    acc[r] = _mm256_fmadd_ps(v_high, _mm256_broadcast_ss(src_r[r] + c + 1), acc[r]);
+                }
+            }
+            if (c < col_end) {
+                __m256i v_packed = _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(w)));
+                __m256 v_low     = _mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(v_packed, 28), 28));
+                for (int r = 0; r < 4; r++) {
+                    acc[r] = _mm256_fmadd_ps(v_low, _mm256_broadcast_ss(src_r[r] + c), acc[r]);
+                }
+                w += 8;
+            }
+        }
+        const __m256 v_scale = _mm256_loadu_ps(scale + g * 8);
+        for (int r = 0; r < 4; r++) {
+            total[r] = _mm256_fmadd_ps(acc[r], v_scale, total[r]);
+        }
+    }
+
+    for (int r = 0; r < rows; r++) {
+        if (oc_left >= 8) {
+            _mm256_storeu_ps(dst + r * ldd, total[r]);
+        } else {
+            float tmp[8];
+            _mm256_storeu_ps(tmp, total[r]);
+            memcpy(dst + r * ldd, tmp, oc_left * sizeof(float));
+        }
+    }
+}
+
+void X86GemmWeightQuantAvx2(float *dst, const float *src, const int8_t *weight, const float *scale, const float *bias,
+                            int rows, int ic, int oc, int bits, int group_size) {
+    const int group_count    = WeightQuantUtils::GetGroupCount(ic, group_size);
+    const int group_cols     = group_count == 1 ? ic : group_size;
+    const size_t block_bytes = X86WeightQuantBlockBytes(ic, bits, group_size);
+    auto block_func          = bits == 8 ? X86GemmWeightQuantBlock<8> : X86GemmWeightQuantBlock<4>;
+
+    // every thread streams the weights of its output channels once for every 4 rows
+    X86ParallelFor(0, UP_DIV(oc, 8), [&](int b, int thread_id) {
+        const int8_t *weight_b = weight + b * block_bytes;
+        const float *scale_b   = scale + b * group_count * 8;
+        for (int r = 0; r < rows; r += 4) {
+            block_func(dst + r * oc + b * 8, oc, src + r * ic, ic, std::min(4, rows - r), weight_b, scale_b,
+                       bias + b * 8, ic, group_count, group_cols, oc - b * 8);
+        }
+    });
+}
+
+// max ratio of nonzero blocks for the block sparse kernels, they need more loads per multiply-add than the
+// register blocked dense gemm and fall behind it above about half of the blocks
+static const float kSparseWeightMaxDensity = 0.4f;
+
+static bool X86IsZeroBlockC8(const float *weight, int oc, int ic, int b, int c) {
+    for (int o = b * 8; o < std::min(oc, b * 8 + 8); o++) {
+        if (weight[(size_t)o * ic + c] != 0.f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int X86CountSparseBlocksC8(const float *weight, int oc, int ic) {
+    int nnz_blocks = 0;
+    for (int b = 0; b < UP_DIV(oc, 8); b++) {
+        for (int c = 0; c < ic; c++) {
+            if (!X86IsZeroBlockC8(weight, oc, ic, b, c)) {
+                nnz_blocks++;
+            }
+        }
+    }
+    return nnz_blocks;
+}
+
+bool X86PreferSparseWeightC8(const float *weight, int oc, int ic) {
+    if (oc <= 0 || ic <= 0) {
+        return false;
+    }
+    const size_t total_blocks = (size_t)UP_DIV(oc, 8) * ic;
+    return X86CountSparseBlocksC8(weight, oc, ic) <= kSparseWeightMaxDensity * total_blocks;
+}
+
+size_t X86SparseIndexC8Size(int oc, int nnz_blocks) {
+    return UP_DIV(oc, 8) + 1 + nnz_blocks;
+}
+
+void X86PackSparseIndexC8(int *index, const float *weight, int oc, int ic) {
+    const int oc_blocks = UP_DIV(oc, 8);
+    int *cols           = index + oc_blocks + 1;
+    int nnz_blocks      = 0;
+    for (int b = 0; b < oc_blocks; b++) {
+        index[b] = nnz_blocks;
+        for (int c = 0; c < ic; c++) {
+            if (!X86IsZeroBlockC8(weight, oc, ic, b, c)) {
+                cols[nnz_blocks++] = c;
+            }
+        }
+    }
+    index[oc_blocks] = nnz_blocks;
+}
+
+void X86PackSparseWeightC8(float *dst, const float *weight, const int *index, int oc, int ic) {
+    const int oc_blocks = UP_DIV(oc, 8);
+    const int *cols     = index + oc_blocks + 1;
+    for (int b = 0; b < oc_blocks; b++) {
+        for (int k = index[b]; k < index[b + 1]; k++, dst += 8) {
+            for (int i = 0; i < 8; i++) {
+                int o  = b * 8 + i;
+                dst[i] = o < oc ? weight[(size_t)o * ic + cols[k]] : 0.f;
+            }
+        }
+    }
+}
+
+// a block row of 8 output channels for rows rows, only the nonzero blocks are multiplied
+template <int rows>
+static void X86GemmSparseWeightBlock(float *dst, int ldd, const float *src, int ld_src, const float *weight,
+                                     const int *cols, int nnz, const float *bias, int oc_left) {
+    __m256 acc[rows];
+    const __m256 v_bias = _mm256_loadu_ps(bias);
+    for (int r = 0; r < rows; r++) {
+        acc[r] = v_bias;
+    }
+    for (int k = 0; k < nnz; k++, weight += 8) {
+        const __m256 v_w  = _mm256_loadu_ps(weight);
+        const float *src_c = src + cols[k];
+        for (int r = 0; r < rows; r++) {
+            acc[r] = _mm256_fmadd_ps(v_w, _mm256_broadcast_ss(src_c + r * ld_src), acc[r]);
+        }
+    }
+    for (int r = 0; r < rows; r++) {
+        if (oc_left >= 8) {
+            _mm256_storeu_ps(dst + r * ldd, acc[r]);
+        } else {
+            float tmp[8];
+            _mm256_storeu_ps(tmp, acc[r]);
+            memcpy(dst + r * ldd, tmp, oc_left * sizeof(float));
+        }
+    }
+}
+
+void X86GemmSparseWeightAvx2(float *dst, const float *src, const float *weight, const int *index, const float *bias,
+                             int rows, int ic, int oc) {
+    const int oc_blocks = UP_DIV(oc, 8);
+    const int *cols     = index + oc_blocks + 1;
+
+    X86ParallelFor(0, oc_blocks, [&](int b, int thread_id) {
+        const float *weight_b = weight + (size_t)index[b] * 8;
+        const int *cols_b     = cols + index[b];
+        const int nnz         = index[b + 1] - index[b];
+        const int oc_left     = oc - b * 8;
+        int r                 = 0;
+        for (; r + 7 < rows; r += 8) {
+            X86GemmSparseWeightBlock<8>(dst + r * oc + b * 8, oc, src + r * ic, ic, weight_b, cols_b, nnz,
+                                        bias + b * 8, oc_left);
+        }
+        for (; r + 3 < rows; r += 4) {
+            X86GemmSparseWeightBlock<4>(dst + r * oc + b * 8, oc, src + r * ic, ic, weight_b, cols_b, nnz,
+                                        bias + b * 8, oc_left);
+        }
+        for (; r < rows; r++) {
+            X86GemmSparseWeightBlock<1>(dst + r * oc + b * 8, oc, src + r * ic, ic, weight_b, cols_b, nnz,
+                                        bias + b * 8, oc_left);
+        }
+    });
+}
+
+/*
+half a block row, 4 output channels x 8 * vecs pixels of a 1x1 conv, every nonzero block loads the pixels of its
+input channel once and multiplies them with the broadcast value of each output channel, a partial tile of less
+than 8 pixels uses masked loads and stores
+*/
+template <int activation_type, int vecs, bool masked>
+static void X86ConvSparseWeightTile(float *dst, const float *src, int area, const float *weight, const int *cols,
+                                    int nnz, const float *bias, int oc_left, int pixels) {
+    static const int mask_table[16] = {-1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0};
+    const __m256i v_mask = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mask_table + 8 - pixels));
+
+    __m256 acc[4][vecs];
+    for (int i = 0; i < 4; i++) {
+        for (int v = 0; v < vecs; v++) {
+            acc[i][v] = _mm256_broadcast_ss(bias + i);
+        }
+    }
+    for (int k = 0; k < nnz; k++, weight += 8) {
+        const float *src_c = src + (size_t)cols[k] * area;
+        __m256 v_src[vecs];
+        for (int v = 0; v < vecs; v++) {
+            v_src[v] = masked ? _mm256_maskload_ps(src_c, v_mask) : _mm256_loadu_ps(src_c + v * 8);
+        }
+        for (int i = 0; i < 4; i++) {
+            const __m256 v_w = _mm256_broadcast_ss(weight + i);
+            for (int v = 0; v < vecs; v++) {
+                acc[i][v] = _mm256_fmadd_ps(v_w, v_src[v], acc[i][v]);
+            }
+        }
+    }
+
+    const __m256 v_zero = _mm256_setzero_ps();
+    const __m256 v_six  = _mm256_set1_ps(6.f);
+    for (int i = 0; i < std::min(oc_left, 4); i++) {
+        for (int v = 0; v < vecs; v++) {
+            if (activation_type == ActivationType_ReLU || activation_type == ActivationType_ReLU6) {
+                acc[i][v] = _mm256_max_ps(acc[i][v], v_zero);
+            }
+            if (activation_type == ActivationType_ReLU6) {
+                acc[i][v] = _mm256_min_ps(acc[i][v], v_six);
+            }
+            if (masked) {
+                _mm256_maskstore_ps(dst + (size_t)i * area, v_mask, acc[i][v]);
+            } else {
+                _mm256_storeu_ps(dst + (size_t)i * area + v * 8, acc[i][v]);
+            }
+        }
+    }
+}
+
+template <int activation_type>
+static void X86ConvSparseWeight(float *dst, const float *src, const float *weight, const int *index,
+                                const float *bias, int area, int ic, int oc) {
+    // pixels of a task, the inputs of a chunk stay in cache while all block rows of the chunk are computed
+    const int chunk_area = 96;
+    const int oc_blocks  = UP_DIV(oc, 8);
+    const int chunks     = UP_DIV(area, chunk_area);
+    const int *cols      = index + oc_blocks + 1;
+
+    X86ParallelFor(0, chunks * oc_blocks, [&](int task, int thread_id) {
+        const int chunk  = task / oc_blocks;
+        const int b      = task % oc_blocks;
+        const int end    = std::min(area, (chunk + 1) * chunk_area);
+        const int *col_b = cols + index[b];
+        const int nnz    = index[b + 1] - index[b];
+        // the two halves of the block row, the second one is skipped if the output channels end before it
+        for (int half = 0; half < 2 && half * 4 < oc - b * 8; half++) {
+            const int o           = b * 8 + half * 4;
+            const float *weight_h = weight + (size_t)index[b] * 8 + half * 4;
+            float *dst_h          = dst + (size_t)o * area;
+            int p                 = chunk * chunk_area;
+            for (; p + 23 < end; p += 24) {
+                X86ConvSparseWeightTile<activation_type, 3, false>(dst_h + p, src + p, area, weight_h, col_b, nnz,
+                                                                   bias + o, oc - o, 24);
+            }
+            for (; p + 7 < end; p += 8) {
+                X86ConvSparseWeightTile<activation_type, 1, false>(dst_h + p, src + p, area, weight_h, col_b, nnz,
+                                                                   bias + o, oc - o, 8);
+            }
+            if (p < end) {
+                X86ConvSparseWeightTile<activation_type, 1, true>(dst_h + p, src + p, area, weight_h, col_b, nnz,
+                                                                  bias + o, oc - o, end - p);
+            }
+        }
+    });
+}
+
+void X86ConvSparseWeightAvx2(float *dst, const float *src, const float *weight, const int *index, const float *bias,
+                             int area, int ic, int oc, int activation_type) {
+    if (activation_type == ActivationType_ReLU) {
+        X86ConvSparseWeight<ActivationType_ReLU>(dst, src, weight, index, bias, area, ic, oc);
+    } else if (activation_type == ActivationType_ReLU6) {
+        X86ConvSparseWeight<ActivationType_ReLU6>(dst, src, weight, index, bias, area, ic, oc);
+    } else {
+        X86ConvSparseWeight<ActivationType_None>(dst, src, weight, index, bias, area, ic, oc);
+    }
+}
+
 template <int activation_type, typename VEC, int pack>
 void X86_Post_Exec(float *dst, const float *bias, long channel, long area) {
     for (long c = 0; c < channel; c++) {
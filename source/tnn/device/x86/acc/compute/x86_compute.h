@@ -30,6 +30,11 @@ namespace TNN_NS {
 Status X86_IM2COL(float *src, int channel, int height, int width, int kernelh, int kernelw, int padl, int padr,
                   int padt, int padb, int strideh, int stridew, int dilationh, int dilationw, float *dst);
 
+// @brief store by row, output spatial size is given by the caller
+Status X86_VOL2COL(float *src, int channel, int depth, int height, int width, int out_depth, int out_height,
+                   int out_width, int kerneld, int kernelh, int kernelw, int padd, int padh, int padw, int strided,
+                   int strideh, int stridew, int dilationd, int dilationh, int dilationw, float *dst);
+
 Status X86_COL2IM(float *src, int channel, int height, int width, int kernelh, int kernelw, int padh, int padw,
                   int strideh, int stridew, int dilationh, int dilationw, int output_height, int output_width,
                   float *dst);
@@ -66,6 +71,45 @@ void DepthwiseConv(float* dst, const float* src, const float* weight, const floa
 template <typename VEC, int pack>
 void X86Sgemv(float* dst, const float* src, const float* weight, float *bias, DimsVector dims_input, DimsVector dims_output);
 
+// @brief bytes of a block of 8 output channels of weight only quantized weights packed by X86PackWeightQuantC8
+size_t X86WeightQuantBlockBytes(int ic, int bits, int group_size);
+
+// @brief pack weight only quantized weights of oc x ic (see WeightQuantUtils) and their float scales in blocks of 8
+// output channels, each group of a block keeps 8 values per input, int4 values of two inputs share the bytes
+void X86PackWeightQuantC8(int8_t *dst_weight, float *dst_scale, const int8_t *src_weight, const float *src_scale,
+                          int oc, int ic, int bits, int group_size);
+
+// @brief dst[rows, oc] = src[rows, ic] * weight^T + bias with weights packed by X86PackWeightQuantC8, the weights are
+// dequantized in registers, bias holds ROUND_UP(oc, 8) values
+void X86GemmWeightQuantAvx2(float *dst, const float *src, const int8_t *weight, const float *scale, const float *bias,
+                            int rows, int ic, int oc, int bits, int group_size);
+
+// @brief number of nonzero blocks of weight[oc, ic] in blocks of 8 output channels x 1 input
+int X86CountSparseBlocksC8(const float *weight, int oc, int ic);
+
+// @brief true if weight[oc, ic] has so few nonzero blocks that the block sparse kernels beat the dense ones
+bool X86PreferSparseWeightC8(const float *weight, int oc, int ic);
+
+// @brief ints of the block sparse index of X86PackSparseIndexC8
+size_t X86SparseIndexC8Size(int oc, int nnz_blocks);
+
+// @brief block sparse row index of weight[oc, ic] in blocks of 8 output channels x 1 input, index[b] to
+// index[b + 1] are the nonzero blocks of block row b, index[UP_DIV(oc, 8) + 1 + i] is the input of block i
+void X86PackSparseIndexC8(int *index, const float *weight, int oc, int ic);
+
+// @brief pack the 8 values of every nonzero block in index order, missing output channels are zero
+void X86PackSparseWeightC8(float *dst, const float *weight, const int *index, int oc, int ic);
+
+// @brief dst[rows, oc] = src[rows, ic] * weight^T + bias with weights packed by X86PackSparseWeightC8, zero blocks
+// are skipped, bias holds ROUND_UP(oc, 8) values
+void X86GemmSparseWeightAvx2(float *dst, const float *src, const float *weight, const int *index, const float *bias,
+                             int rows, int ic, int oc);
+
+// @brief dst[oc, area] = act(weight * src[ic, area] + bias) for 1x1 conv with weights packed by
+// X86PackSparseWeightC8, activation_type is None, ReLU or ReLU6, bias holds ROUND_UP(oc, 8) values
+void X86ConvSparseWeightAvx2(float *dst, const float *src, const float *weight, const int *index, const float *bias,
+                             int area, int ic, int oc, int activation_type);
+
 template <int activation_type, typename VEC, int pack>
 void X86_Post_Exec(float *dst, const float *bias, long channel, long area);
 
@@ -20,7 +20,7 @@
 #include "tnn/interpreter/raw_buffer.h"
 #include "tnn/utils/data_format_converter.h"
 #include "tnn/utils/data_type_utils.h"
-#include "tnn/utils/omp_utils.h"
+#include "tnn/device/x86/x86_thread_pool.h"
 
 namespace TNN_NS {
 bool X86ConvLayer1x1::isPrefered(ConvLayerParam *param, const std::vector<Blob *> &inputs,
@@ -50,6 +50,52 @@ bool X86ConvLayer1x1::isPrefered(ConvLayerParam *param, const std::vector<Blob *
 
 X86ConvLayer1x1::~X86ConvLayer1x1() {}
 
+Status X86ConvLayer1x1::allocateBufferWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    ConvLayerParam *param = dynamic_cast<ConvLayerParam *>(param_);
+    CHECK_PARAM_NULL(param);
+    ConvLayerResource *conv_res = dynamic_cast<ConvLayerResource *>(resource_);
+    CHECK_PARAM_NULL(conv_res);
+
+    if (buffer_weight_.GetBytesSize()) {
+        return TNN_OK;
+    }
+
+    const int oc     = outputs[0]->GetBlobDesc().dims[1];
+    const int ic     = inputs[0]->GetBlobDesc().dims[1];
+    const float *src = conv_res->filter_handle.force_to<float *>();
+    const bool act_supported = param->activation_type == ActivationType_None ||
+                               param->activation_type == ActivationType_ReLU ||
+                               param->activation_type == ActivationType_ReLU6;
+
+    // pruned weights are detected when loaded, the gemm is used if too many blocks are nonzero
+    sparse_weight_ = arch_ == avx2 && act_supported && conv_res->filter_handle.GetDataType() == DATA_TYPE_FLOAT &&
+                     X86PreferSparseWeightC8(src, oc, ic);
+    if (!sparse_weight_) {
+        return X86ConvLayerCommon::allocateBufferWeight(inputs, outputs);
+    }
+
+    auto pack_index = [&](RawBuffer &buffer) -> Status {
+        RawBuffer temp_buffer(X86SparseIndexC8Size(oc, X86CountSparseBlocksC8(src, oc, ic)) * sizeof(int));
+        X86PackSparseIndexC8(temp_buffer.force_to<int *>(), src, oc, ic);
+        temp_buffer.SetDataType(DATA_TYPE_INT32);
+        buffer = temp_buffer;
+        return TNN_OK;
+    };
+    RETURN_ON_NEQ(GetSharedWeights("conv_1x1_sparse_index", buffer_sparse_index_, pack_index), TNN_OK);
+
+    const int *index = buffer_sparse_index_.force_to<int *>();
+    auto pack = [&](RawBuffer &buffer) -> Status {
+        // at least one block, RawBuffer of zero bytes holds no data
+        const int nnz_blocks = std::max(index[UP_DIV(oc, 8)], 1);
+        RawBuffer temp_buffer(nnz_blocks * 8 * sizeof(float));
+        X86PackSparseWeightC8(temp_buffer.force_to<float *>(), src, index, oc, ic);
+        temp_buffer.SetDataType(DATA_TYPE_FLOAT);
+        buffer = temp_buffer;
+        return TNN_OK;
+    };
+    return GetSharedWeights("conv_1x1_sparse_weight", buffer_weight_, pack);
+}
+
 Status X86ConvLayer1x1::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     ConvLayerParam *param = dynamic_cast<ConvLayerParam *>(param_);
 
@@ -74,7 +120,16 @@ Status X86ConvLayer1x1::DoForward(const std::vector<Blob *> &inputs, const std::
     int n = src_z_step;
     int k = dims_input[1];
 
-    int max_num_threads = OMP_MAX_THREADS_NUM_;
+    if (sparse_weight_) {
+        for (int batch_idx = 0; batch_idx < batch; batch_idx++) {
+            X86ConvSparseWeightAvx2(dst_origin + batch_idx * m * n, src_origin + batch_idx * k * n, weights_data,
+                                    buffer_sparse_index_.force_to<int *>(), bias_data, n, k, m,
+                                    param->activation_type);
+        }
+        return TNN_OK;
+    }
+
+    int max_num_threads = X86ThreadPool::GetMaxThreadsNum();
     conv_ajust_m_blk_size(max_num_threads, src_z_step, conv_gemm_conf_.M_c_);
 
     int m_c = conv_gemm_conf_.M_c_;
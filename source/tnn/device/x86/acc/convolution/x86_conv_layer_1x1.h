@@ -25,8 +25,15 @@ public:
 
     virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
 
+    // pack pruned weights for the block sparse kernel, dense weights for the gemm otherwise
+    virtual Status allocateBufferWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+
     static bool isPrefered(ConvLayerParam *param, const std::vector<Blob *> &inputs,
                            const std::vector<Blob *> &outputs);
+
+protected:
+    bool sparse_weight_ = false;
+    RawBuffer buffer_sparse_index_;
 };
 
 }  // namespace TNN_NS
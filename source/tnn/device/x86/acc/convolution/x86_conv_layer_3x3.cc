@@ -16,6 +16,7 @@
 #include "tnn/device/x86/acc/Float4.h"
 #include "tnn/device/x86/acc/Float8.h"
 #include "tnn/device/x86/acc/compute/x86_compute.h"
+#include "tnn/device/x86/acc/compute/jit/utils/cpu_isa.h"
 #include "tnn/device/x86/x86_common.h"
 #include "tnn/device/x86/x86_context.h"
 #include "tnn/device/x86/x86_util.h"
@@ -23,7 +24,7 @@
 #include "tnn/interpreter/raw_buffer.h"
 #include "tnn/utils/data_format_converter.h"
 #include "tnn/utils/data_type_utils.h"
-#include "tnn/utils/omp_utils.h"
+#include "tnn/device/x86/x86_thread_pool.h"
 
 namespace TNN_NS {
 
@@ -566,25 +567,196 @@ template void output_trans_post_2x4<Float8>(const float *src, int src_stride, in
 template void output_trans_post_2x4<Float4>(const float *src, int src_stride, int src_h_stride, float *dest,
                                             int dest_stride, int dest_h_stride, const float *bias_value, int relu_type);
 
+#define TILE_NUM 6
+
+// transform matrices of F(4x4, 3x3) and F(6x6, 3x3), the interpolation points are
+// 0, +-1, +-2 and 0, +-1, +-2, +-1/2 respectively
+struct WinogradF43 {
+    static const int SRC_UNIT = 6;
+    static const int DST_UNIT = 4;
+    static const float BT[6][6];
+    static const float AT[4][6];
+    static const float G[6][3];
+};
+
+const float WinogradF43::BT[6][6] = {{4.0f, 0.0f, -5.0f, 0.0f, 1.0f, 0.0f},  {0.0f, -4.0f, -4.0f, 1.0f, 1.0f, 0.0f},
+                                     {0.0f, 4.0f, -4.0f, -1.0f, 1.0f, 0.0f}, {0.0f, -2.0f, -1.0f, 2.0f, 1.0f, 0.0f},
+                                     {0.0f, 2.0f, -1.0f, -2.0f, 1.0f, 0.0f}, {0.0f, 4.0f, 0.0f, -5.0f, 0.0f, 1.0f}};
+const float WinogradF43::AT[4][6] = {{1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f},
+                                     {0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 0.0f},
+                                     {0.0f, 1.0f, 1.0f, 4.0f, 4.0f, 0.0f},
+                                     {0.0f, 1.0f, -1.0f, 8.0f, -8.0f, 1.0f}};
+const float WinogradF43::G[6][3]  = {{1.0f / 4, 0.0f, 0.0f},
+                                    {-1.0f / 6, -1.0f / 6, -1.0f / 6},
+                                    {-1.0f / 6, 1.0f / 6, -1.0f / 6},
+                                    {1.0f / 24, 1.0f / 12, 1.0f / 6},
+                                    {1.0f / 24, -1.0f / 12, 1.0f / 6},
+                                    {0.0f, 0.0f, 1.0f}};
+
+struct WinogradF63 {
+    static const int SRC_UNIT = 8;
+    static const int DST_UNIT = 6;
+    static const float BT[8][8];
+    static const float AT[6][8];
+    static const float G[8][3];
+};
+
+const float WinogradF63::BT[8][8] = {{1.0f, 0.0f, -5.25f, 0.0f, 5.25f, 0.0f, -1.0f, 0.0f},
+                                     {0.0f, 1.0f, 1.0f, -4.25f, -4.25f, 1.0f, 1.0f, 0.0f},
+                                     {0.0f, -1.0f, 1.0f, 4.25f, -4.25f, -1.0f, 1.0f, 0.0f},
+                                     {0.0f, 0.5f, 0.25f, -2.5f, -1.25f, 2.0f, 1.0f, 0.0f},
+                                     {0.0f, -0.5f, 0.25f, 2.5f, -1.25f, -2.0f, 1.0f, 0.0f},
+                                     {0.0f, 2.0f, 4.0f, -2.5f, -5.0f, 0.5f, 1.0f, 0.0f},
+                                     {0.0f, -2.0f, 4.0f, 2.5f, -5.0f, -0.5f, 1.0f, 0.0f},
+                                     {0.0f, -1.0f, 0.0f, 5.25f, 0.0f, -5.25f, 0.0f, 1.0f}};
+const float WinogradF63::AT[6][8] = {{1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f},
+                                     {0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 0.5f, -0.5f, 0.0f},
+                                     {0.0f, 1.0f, 1.0f, 4.0f, 4.0f, 0.25f, 0.25f, 0.0f},
+                                     {0.0f, 1.0f, -1.0f, 8.0f, -8.0f, 0.125f, -0.125f, 0.0f},
+                                     {0.0f, 1.0f, 1.0f, 16.0f, 16.0f, 0.0625f, 0.0625f, 0.0f},
+                                     {0.0f, 1.0f, -1.0f, 32.0f, -32.0f, 0.03125f, -0.03125f, 1.0f}};
+const float WinogradF63::G[8][3]  = {{1.0f, 0.0f, 0.0f},
+                                    {-2.0f / 9, -2.0f / 9, -2.0f / 9},
+                                    {-2.0f / 9, 2.0f / 9, -2.0f / 9},
+                                    {1.0f / 90, 1.0f / 45, 2.0f / 45},
+                                    {1.0f / 90, -1.0f / 45, 2.0f / 45},
+                                    {32.0f / 45, 16.0f / 45, 8.0f / 45},
+                                    {32.0f / 45, -16.0f / 45, 8.0f / 45},
+                                    {0.0f, 0.0f, 1.0f}};
+
+// same layout as input_trans_4x4, the transform matrices are compile time constants
+// so the zero terms are dropped once the loops are unrolled.
+template <typename VEC, typename WINO>
+static void input_trans_generic(const float *src, int src_stride, int src_h_stride, float *dest, int dest_stride,
+                                int dest_h_stride) {
+    const int ALPHA = WINO::SRC_UNIT;
+    VEC tmp[ALPHA][ALPHA];
+
+    // BT * d along x
+    for (int y = 0; y < ALPHA; y++) {
+        VEC d[ALPHA];
+        for (int x = 0; x < ALPHA; x++) {
+            d[x] = VEC::loadu(src + y * src_h_stride + x * src_stride);
+        }
+        for (int a = 0; a < ALPHA; a++) {
+            VEC sum = VEC(0.f);
+            for (int x = 0; x < ALPHA; x++) {
+                if (WINO::BT[a][x] != 0.f) {
+                    sum = sum + d[x] * WINO::BT[a][x];
+                }
+            }
+            tmp[y][a] = sum;
+        }
+    }
+
+    // BT * d along y
+    for (int a = 0; a < ALPHA; a++) {
+        for (int b = 0; b < ALPHA; b++) {
+            VEC sum = VEC(0.f);
+            for (int y = 0; y < ALPHA; y++) {
+                if (WINO::BT[b][y] != 0.f) {
+                    sum = sum + tmp[y][a] * WINO::BT[b][y];
+                }
+            }
+            VEC::saveu(dest + b * dest_stride + a * dest_h_stride, sum);
+        }
+    }
+}
+
+// same layout as output_trans_post_2x4
+template <typename VEC, typename WINO>
+static void output_trans_post_generic(const float *src, int src_stride, int src_h_stride, float *dest, int dest_stride,
+                                      int dest_h_stride, const float *bias_value, int relu_type) {
+    const int ALPHA = WINO::SRC_UNIT;
+    const int UNIT  = WINO::DST_UNIT;
+    VEC tmp[ALPHA][UNIT];
+
+    // AT * m along y
+    for (int xf = 0; xf < ALPHA; xf++) {
+        VEC m[ALPHA];
+        for (int yf = 0; yf < ALPHA; yf++) {
+            m[yf] = VEC::loadu(src + xf * src_h_stride + yf * src_stride);
+        }
+        for (int oy = 0; oy < UNIT; oy++) {
+            VEC sum = VEC(0.f);
+            for (int yf = 0; yf < ALPHA; yf++) {
+                if (WINO::AT[oy][yf] != 0.f) {
+                    sum = sum + m[yf] * WINO::AT[oy][yf];
+                }
+            }
+            tmp[xf][oy] = sum;
+        }
+    }
+
+    VEC bias  = bias_value ? VEC::loadu(bias_value) : VEC(0.f);
+    VEC zeros = VEC(0.f);
+    VEC sixs  = VEC(6.f);
+    // AT * m along x
+    for (int oy = 0; oy < UNIT; oy++) {
+        for (int ox = 0; ox < UNIT; ox++) {
+            VEC sum = bias;
+            for (int xf = 0; xf < ALPHA; xf++) {
+                if (WINO::AT[ox][xf] != 0.f) {
+                    sum = sum + tmp[xf][oy] * WINO::AT[ox][xf];
+                }
+            }
+            if (relu_type == ActivationType_ReLU || relu_type == ActivationType_ReLU6) {
+                sum = VEC::max(sum, zeros);
+            }
+            if (relu_type == ActivationType_ReLU6) {
+                sum = VEC::min(sum, sixs);
+            }
+            VEC::saveu(dest + oy * dest_h_stride + ox * dest_stride, sum);
+        }
+    }
+}
+
+// a larger tile needs fewer multiplications per output but wastes more on the border and keeps a larger
+// transformed block in cache.
+int X86ConvLayer3x3::SelectDstUnit(int ic_pack, int oc_pack, int ch_pack, int height_out, int width_out) {
+    const int l2_size = cpu_data_cache_size(2);
+    int best_unit     = 2;
+    long best_cost    = -1;
+    for (int dst_unit = 2; dst_unit <= 6; dst_unit += 2) {
+        int src_unit      = dst_unit + 2;
+        long working_size = (long)(ic_pack + oc_pack) * src_unit * src_unit * ch_pack * TILE_NUM * sizeof(float);
+        if (dst_unit > 2 && working_size > l2_size) {
+            continue;
+        }
+        long cost = (long)src_unit * src_unit * UP_DIV(height_out, dst_unit) * UP_DIV(width_out, dst_unit);
+        if (best_cost < 0 || cost < best_cost) {
+            best_cost = cost;
+            best_unit = dst_unit;
+        }
+    }
+    return best_unit;
+}
+
 bool X86ConvLayer3x3::isPrefered(ConvLayerParam *param, const std::vector<Blob *> &inputs,
                                  const std::vector<Blob *> &outputs) {
     if (!param) {
         return false;
     }
 
-    if (param->group != 1) {
+    const int kw    = param->kernels[0];
+    const int kh    = param->kernels[1];
+    const int dw    = param->dialations[0];
+    const int dh    = param->dialations[1];
+    const int sw    = param->strides[0];
+    const int sh    = param->strides[1];
+    const int group = param->group;
+    const int ic    = inputs[0]->GetBlobDesc().dims[1];
+    const int oc    = outputs[0]->GetBlobDesc().dims[1];
+
+    if (kw != 3 || kh != 3 || dw != 1 || dh != 1 || sw != 1 || sh != 1) {
         return false;
     }
 
-    const int kw = param->kernels[0];
-    const int kh = param->kernels[1];
-    const int dw = param->dialations[0];
-    const int dh = param->dialations[1];
-    const int sw = param->strides[0];
-    const int sh = param->strides[1];
-    const int ic = inputs[0]->GetBlobDesc().dims[1];
-
-    return kw == 3 && kh == 3 && dw == 1 && dh == 1 && sw == 1 && sh == 1 && ic >= 16;
+    // grouped conv runs winograd group by group, each group needs enough channels to fill the packs
+    if (group == 1) {
+        return ic >= 16;
+    }
+    return ic / group >= 8 && oc / group >= 8;
 }
 
 X86ConvLayer3x3::~X86ConvLayer3x3() {}
@@ -604,20 +776,43 @@ Status X86ConvLayer3x3::allocateBufferWeight(const std::vector<Blob *> &inputs,
         if (arch_ == avx2)
             CH_PACK = 8;
 
-        const int input_channel  = dims_input[1];
-        const int output_channel = dims_output[1];
-        const int weight_count   = ROUND_UP(input_channel, CH_PACK) * ROUND_UP(output_channel, CH_PACK) * 4 * 4;
+        const int group          = param->group;
+        const int input_channel  = dims_input[1] / group;
+        const int output_channel = dims_output[1] / group;
+
+        dst_unit_ = SelectDstUnit(UP_DIV(input_channel, CH_PACK), UP_DIV(output_channel, CH_PACK), CH_PACK,
+                                  dims_output[2], dims_output[3]);
+        const int src_unit = dst_unit_ + 2;
+
+        const int group_weight_count =
+            ROUND_UP(input_channel, CH_PACK) * ROUND_UP(output_channel, CH_PACK) * src_unit * src_unit;
+        const int weight_count   = group_weight_count * group;
         const int data_byte_size = DataTypeUtils::GetBytesSize(conv_res->filter_handle.GetDataType());
 
         if (conv_res->filter_handle.GetDataType() == DATA_TYPE_FLOAT) {
-            RawBuffer pack_buffer(weight_count * data_byte_size);
-            float *dst = pack_buffer.force_to<float *>();
-
-            const float G[4][3] = {{1.0f, 0.0f, 0.0f}, {0.5f, 0.5f, 0.5f}, {0.5f, -0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}};
-            weight_transform(src, dst, 3, 4, input_channel, output_channel, CH_PACK, G);
+            auto pack = [&](RawBuffer &buffer) -> Status {
+                RawBuffer pack_buffer(weight_count * data_byte_size);
+                float *dst = pack_buffer.force_to<float *>();
+
+                const float G2[4][3] = {{1.0f, 0.0f, 0.0f}, {0.5f, 0.5f, 0.5f}, {0.5f, -0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}};
+                const float(*G)[3]   = G2;
+                if (dst_unit_ == 4) {
+                    G = WinogradF43::G;
+                } else if (dst_unit_ == 6) {
+                    G = WinogradF63::G;
+                }
+                for (int g = 0; g < group; g++) {
+                    weight_transform(src + g * output_channel * input_channel * 3 * 3, dst + g * group_weight_count,
+                                     3, src_unit, input_channel, output_channel, CH_PACK, G);
+                }
 
-            pack_buffer.SetDataType(DATA_TYPE_FLOAT);
-            buffer_weight_ = pack_buffer;
+                pack_buffer.SetDataType(DATA_TYPE_FLOAT);
+                buffer = pack_buffer;
+                return TNN_OK;
+            };
+            // the transformed weights depend on the winograd unit chosen for the output size
+            auto key = "conv3x3_winograd_weight_" + std::to_string(dst_unit_);
+            RETURN_ON_NEQ(GetSharedWeights(key, buffer_weight_, pack), TNN_OK);
         } else {
             LOGE("Error: DataType %d not support\n", conv_res->filter_handle.GetDataType());
             return Status(TNNERR_MODEL_ERR, "conv_res DataType is not supported");
@@ -626,6 +821,30 @@ Status X86ConvLayer3x3::allocateBufferWeight(const std::vector<Blob *> &inputs,
     return TNN_OK;
 }
 
+// bias of each group is padded to ROUND_UP(oc / group, 8)
+Status X86ConvLayer3x3::allocateBufferBias(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    ConvLayerParam *param = dynamic_cast<ConvLayerParam *>(param_);
+    CHECK_PARAM_NULL(param);
+    ConvLayerResource *conv_res = dynamic_cast<ConvLayerResource *>(resource_);
+    CHECK_PARAM_NULL(conv_res);
+
+    if (!buffer_bias_.GetBytesSize()) {
+        const int group          = param->group;
+        const int output_channel = outputs[0]->GetBlobDesc().dims[1] / group;
+        const int group_stride   = ROUND_UP(output_channel, 8);
+        RawBuffer temp_buffer(group * group_stride * sizeof(float));
+        if (param->bias) {
+            const float *src = conv_res->bias_handle.force_to<float *>();
+            float *dst       = temp_buffer.force_to<float *>();
+            for (int g = 0; g < group; g++) {
+                memcpy(dst + g * group_stride, src + g * output_channel, output_channel * sizeof(float));
+            }
+        }
+        buffer_bias_ = temp_buffer;
+    }
+    return TNN_OK;
+}
+
 // pack weight offline
 // pack input c8
 // input trans
@@ -633,9 +852,6 @@ Status X86ConvLayer3x3::allocateBufferWeight(const std::vector<Blob *> &inputs,
 // output trans
 // write c8 to nchw
 
-#define TILE_NUM 6
-// #define CH_PACK 8
-
 Status X86ConvLayer3x3::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     ConvLayerParam *param = dynamic_cast<ConvLayerParam *>(param_);
 
@@ -647,11 +863,12 @@ Status X86ConvLayer3x3::DoForward(const std::vector<Blob *> &inputs, const std::
     auto src_origin = reinterpret_cast<float *>(input->GetHandle().base);
     auto dst_origin = reinterpret_cast<float *>(output->GetHandle().base);
 
+    const int group       = param->group;
     const int batch       = dims_output[0];
-    const int channel_in  = dims_input[1];
+    const int channel_in  = dims_input[1] / group;
     const int height_in   = dims_input[2];
     const int width_in    = dims_input[3];
-    const int channel_out = dims_output[1];
+    const int channel_out = dims_output[1] / group;
     const int height_out  = dims_output[2];
     const int width_out   = dims_output[3];
 
@@ -660,8 +877,8 @@ Status X86ConvLayer3x3::DoForward(const std::vector<Blob *> &inputs, const std::
     const int pad_top    = param->pads[2];
     const int pad_bottom = param->pads[3];
 
-    int in_n_stride  = channel_in * width_in * height_in;
-    int out_n_stride = channel_out * width_out * height_out;
+    int in_n_stride  = channel_in * group * width_in * height_in;
+    int out_n_stride = channel_out * group * width_out * height_out;
     int ic_stride    = width_in * height_in;
     int oc_stride    = width_out * height_out;
 
@@ -671,6 +888,13 @@ Status X86ConvLayer3x3::DoForward(const std::vector<Blob *> &inputs, const std::
     auto unpack_func       = unpack_output_c4;
     auto gemm_func         = gemm_kernel_avx<Float4, 6, 4, 4>;
     auto CH_PACK           = 4;
+    if (dst_unit_ == 4) {
+        input_trans_func  = input_trans_generic<Float4, WinogradF43>;
+        output_trans_func = output_trans_post_generic<Float4, WinogradF43>;
+    } else if (dst_unit_ == 6) {
+        input_trans_func  = input_trans_generic<Float4, WinogradF63>;
+        output_trans_func = output_trans_post_generic<Float4, WinogradF63>;
+    }
     if (arch_ == avx2) {
         input_trans_func  = input_trans_4x4<Float8>;
         output_trans_func = output_trans_post_2x4<Float8>;
@@ -678,13 +902,20 @@ Status X86ConvLayer3x3::DoForward(const std::vector<Blob *> &inputs, const std::
         unpack_func       = unpack_output_c8;
         gemm_func         = gemm_kernel_avx<Float8, 6, 8, 8>;
         CH_PACK           = 8;
+        if (dst_unit_ == 4) {
+            input_trans_func  = input_trans_generic<Float8, WinogradF43>;
+            output_trans_func = output_trans_post_generic<Float8, WinogradF43>;
+        } else if (dst_unit_ == 6) {
+            input_trans_func  = input_trans_generic<Float8, WinogradF63>;
+            output_trans_func = output_trans_post_generic<Float8, WinogradF63>;
+        }
     }
 
     int ic_8 = UP_DIV(channel_in, CH_PACK);
     int oc_8 = UP_DIV(channel_out, CH_PACK);
 
-    const int src_unit = 4;
-    const int dst_unit = 2;
+    const int dst_unit = dst_unit_;
+    const int src_unit = dst_unit + 2;
     int w_unit         = UP_DIV(width_out, dst_unit);
     int h_unit         = UP_DIV(height_out, dst_unit);
     int total_cnt      = UP_DIV(w_unit * h_unit, TILE_NUM);
@@ -697,7 +928,10 @@ Status X86ConvLayer3x3::DoForward(const std::vector<Blob *> &inputs, const std::
     int ic_8_stride  = w_pad * h_pad * CH_PACK;
     int oc_8_stride  = width_out * height_out * CH_PACK;
 
-    int max_num_threads = OMP_MAX_THREADS_NUM_;
+    int group_weight_stride = ic_8 * oc_8 * CH_PACK * CH_PACK * src_unit * src_unit;
+    int group_bias_stride   = ROUND_UP(channel_out, 8);
+
+    int max_num_threads = X86ThreadPool::GetMaxThreadsNum();
     size_t zero_size = ROUND_UP(w_pad * sizeof(float), 32);
     size_t pack_input_size = ROUND_UP(w_pad * h_pad * ROUND_UP(channel_in, CH_PACK) * sizeof(float), 32);
     size_t tmp_size = ROUND_UP((ic_8 + oc_8) * src_unit * src_unit * CH_PACK * TILE_NUM * sizeof(float), 32);
@@ -716,136 +950,133 @@ Status X86ConvLayer3x3::DoForward(const std::vector<Blob *> &inputs, const std::
     float *dst_trans_tmp_data = src_trans_tmp_data + max_num_threads * src_trans_size / sizeof(float);
 
     for (int ni = 0; ni < batch; ni++) {
-        auto input_ptr  = src_origin + ni * in_n_stride;
-        auto output_ptr = dst_origin + ni * out_n_stride;
+        for (int g = 0; g < group; g++) {
+            auto input_ptr  = src_origin + ni * in_n_stride + g * channel_in * ic_stride;
+            auto output_ptr = dst_origin + ni * out_n_stride + g * channel_out * oc_stride;
 
-        for (int i = 0; i < ic_8; ++i) {
-            pack_func(input_ptr, input_c8 + i * new_c_stride, i * CH_PACK, -pad_top, height_in + pad_bottom, -pad_left,
-                      width_in + pad_right, channel_in, width_in, height_in, zero_ptr);
-        }
-        const float *weight_ptr = buffer_weight_.force_to<float *>();
-        const float *bias_ptr   = buffer_bias_.force_to<float *>();
-
-        for (int t_idx = 0; t_idx < total_cnt; t_idx++) {
-            int tile_index  = t_idx * TILE_NUM;
-            int tile_remain = w_unit * h_unit - tile_index;
-            int tile_count  = tile_remain > TILE_NUM ? TILE_NUM : tile_remain;
-
-            // ----------------------------------------- input trans -------------------------------------
-            int c_gi_stride = tile_count * oc_8 * CH_PACK;
-            int b_gi_stride = tile_count * ic_8 * CH_PACK;
-
-            OMP_PARALLEL_FOR_DYNAMIC_
-            for (int x_i = 0; x_i < tile_count; x_i++) {
-                int thread_id = OMP_TID_;
-                auto src_trans_tmp_per_thread = src_trans_tmp_data + thread_id * (src_trans_size / sizeof(float));
-
-                int index = tile_index + x_i;
-                int w_idx = index % w_unit;
-                int h_idx = index / w_unit;
-
-                int src_x = w_idx * dst_unit;
-                int src_y = h_idx * dst_unit;
-                int ex    = src_x + src_unit > w_pad ? w_pad - src_x : src_unit;
-                int ey    = src_y + src_unit > h_pad ? h_pad - src_y : src_unit;
-
-                float *dst_ptr       = tmp_data + x_i * CH_PACK;
-                const float *src_ptr = input_c8 + (src_y * w_pad + src_x) * CH_PACK;
-
-                if (ex == src_unit && ey == src_unit) {
-                    // trans input
-                    for (int ci = 0; ci < ic_8; ++ci) {
-                        const float *src_ci = src_ptr + ci * ic_8_stride;
-                        float *dst_ci       = dst_ptr + ci * tile_count * CH_PACK;
-                        input_trans_func(src_ci, CH_PACK, w_pad * CH_PACK, dst_ci, b_gi_stride, b_gi_stride * src_unit);
-                    }
-                } else {
-                    int x_size = ex;
-                    for (int ci = 0; ci < ic_8; ++ci) {
-                        const float *src_ci = src_ptr + ci * ic_8_stride;
-                        // pad
-                        memset(src_trans_tmp_per_thread, 0, 16 * CH_PACK * sizeof(float));  // src_unit * src_unit * ch_pack
-                        if (x_size > 0) {
-                            for (int yi = 0; yi < ey; ++yi) {
-                                float *dst_yi       = src_trans_tmp_per_thread + yi * src_unit * CH_PACK;
-                                const float *src_yi = src_ci + w_pad * yi * CH_PACK;
-                                memcpy(dst_yi, src_yi, x_size * sizeof(float) * CH_PACK);
-                            }
+            for (int i = 0; i < ic_8; ++i) {
+                pack_func(input_ptr, input_c8 + i * new_c_stride, i * CH_PACK, -pad_top, height_in + pad_bottom,
+                          -pad_left, width_in + pad_right, channel_in, width_in, height_in, zero_ptr);
+            }
+            const float *weight_ptr = buffer_weight_.force_to<float *>() + g * group_weight_stride;
+            const float *bias_ptr   = buffer_bias_.force_to<float *>() + g * group_bias_stride;
+
+            for (int t_idx = 0; t_idx < total_cnt; t_idx++) {
+                int tile_index  = t_idx * TILE_NUM;
+                int tile_remain = w_unit * h_unit - tile_index;
+                int tile_count  = tile_remain > TILE_NUM ? TILE_NUM : tile_remain;
+
+                // ----------------------------------------- input trans -------------------------------------
+                int c_gi_stride = tile_count * oc_8 * CH_PACK;
+                int b_gi_stride = tile_count * ic_8 * CH_PACK;
+
+                X86ParallelFor(0, tile_count, [&](int x_i, int thread_id) {
+                    auto src_trans_tmp_per_thread = src_trans_tmp_data + thread_id * (src_trans_size / sizeof(float));
+
+                    int index = tile_index + x_i;
+                    int w_idx = index % w_unit;
+                    int h_idx = index / w_unit;
+
+                    int src_x = w_idx * dst_unit;
+                    int src_y = h_idx * dst_unit;
+                    int ex    = src_x + src_unit > w_pad ? w_pad - src_x : src_unit;
+                    int ey    = src_y + src_unit > h_pad ? h_pad - src_y : src_unit;
+
+                    float *dst_ptr       = tmp_data + x_i * CH_PACK;
+                    const float *src_ptr = input_c8 + (src_y * w_pad + src_x) * CH_PACK;
+
+                    if (ex == src_unit && ey == src_unit) {
+                        // trans input
+                        for (int ci = 0; ci < ic_8; ++ci) {
+                            const float *src_ci = src_ptr + ci * ic_8_stride;
+                            float *dst_ci       = dst_ptr + ci * tile_count * CH_PACK;
+                            input_trans_func(src_ci, CH_PACK, w_pad * CH_PACK, dst_ci, b_gi_stride,
+                                             b_gi_stride * src_unit);
                         }
+                    } else {
+                        int x_size = ex;
+                        for (int ci = 0; ci < ic_8; ++ci) {
+                            const float *src_ci = src_ptr + ci * ic_8_stride;
+                            // pad
+                            memset(src_trans_tmp_per_thread, 0, src_unit * src_unit * CH_PACK * sizeof(float));
+                            if (x_size > 0) {
+                                for (int yi = 0; yi < ey; ++yi) {
+                                    float *dst_yi       = src_trans_tmp_per_thread + yi * src_unit * CH_PACK;
+                                    const float *src_yi = src_ci + w_pad * yi * CH_PACK;
+                                    memcpy(dst_yi, src_yi, x_size * sizeof(float) * CH_PACK);
+                                }
+                            }
 
-                        // trans
-                        float *dst_ci = dst_ptr + ci * tile_count * CH_PACK;
-                        input_trans_func(src_trans_tmp_per_thread, CH_PACK, src_unit * CH_PACK, dst_ci, b_gi_stride,
-                                         b_gi_stride * src_unit);
+                            // trans
+                            float *dst_ci = dst_ptr + ci * tile_count * CH_PACK;
+                            input_trans_func(src_trans_tmp_per_thread, CH_PACK, src_unit * CH_PACK, dst_ci,
+                                             b_gi_stride, b_gi_stride * src_unit);
+                        }
                     }
-                }
-            }
+                });
 
-            // ---------------------------------------- gemm func ----------------------------------------
-            // gemm
-            float *dst_temp_data = tmp_data + TILE_NUM * ic_8 * 16 * CH_PACK;  // src_unit * src_unit * ch_pack
-            float *b_ptr         = tmp_data;
-            int w_gi_stride      = ic_8 * oc_8 * CH_PACK * CH_PACK;
-            OMP_PARALLEL_FOR_GUIDED_
-            for (int gi = 0; gi < src_unit * src_unit; ++gi) {
-                float *trans_dst          = dst_temp_data + gi * c_gi_stride;
-                float *trans_src          = b_ptr + gi * b_gi_stride;
-                const float *trans_weight = weight_ptr + gi * w_gi_stride;
-
-                gemm_func(trans_dst, trans_src, trans_weight, nullptr, ic_8, oc_8, tile_count);
-            }
+                // ---------------------------------------- gemm func ----------------------------------------
+                // gemm
+                float *dst_temp_data = tmp_data + TILE_NUM * ic_8 * src_unit * src_unit * CH_PACK;
+                float *b_ptr         = tmp_data;
+                int w_gi_stride      = ic_8 * oc_8 * CH_PACK * CH_PACK;
+                X86ParallelFor(0, src_unit * src_unit, [&](int gi, int thread_id) {
+                    float *trans_dst          = dst_temp_data + gi * c_gi_stride;
+                    float *trans_src          = b_ptr + gi * b_gi_stride;
+                    const float *trans_weight = weight_ptr + gi * w_gi_stride;
 
-            // ---------------------------------------- output trans --------------------------------------
+                    gemm_func(trans_dst, trans_src, trans_weight, nullptr, ic_8, oc_8, tile_count);
+                });
 
-            OMP_PARALLEL_FOR_DYNAMIC_
-            for (int ti = 0; ti < tile_count; ++ti) {
-                int thread_id = OMP_TID_;
-                auto src_trans_tmp_per_thread = src_trans_tmp_data + thread_id * (src_trans_size / sizeof(float));
-                auto dst_trans_tmp_per_thread = dst_trans_tmp_data + thread_id * (dst_trans_size / sizeof(float));
+                // ---------------------------------------- output trans --------------------------------------
 
-                int index = tile_index + ti;
+                X86ParallelFor(0, tile_count, [&](int ti, int thread_id) {
+                    auto src_trans_tmp_per_thread = src_trans_tmp_data + thread_id * (src_trans_size / sizeof(float));
+                    auto dst_trans_tmp_per_thread = dst_trans_tmp_data + thread_id * (dst_trans_size / sizeof(float));
 
-                int w_idx = index % w_unit;
-                int h_idx = index / w_unit;
+                    int index = tile_index + ti;
 
-                int dst_x = w_idx * dst_unit;
-                int dst_y = h_idx * dst_unit;
+                    int w_idx = index % w_unit;
+                    int h_idx = index / w_unit;
 
-                int ex = dst_x + dst_unit > width_out ? width_out - dst_x : dst_unit;
-                int ey = dst_y + dst_unit > height_out ? height_out - dst_y : dst_unit;
+                    int dst_x = w_idx * dst_unit;
+                    int dst_y = h_idx * dst_unit;
 
-                float *dst_ptr = output_ptr + (dst_y * width_out + dst_x) * CH_PACK;
-                float *src_ptr = dst_temp_data + ti * CH_PACK;
+                    int ex = dst_x + dst_unit > width_out ? width_out - dst_x : dst_unit;
+                    int ey = dst_y + dst_unit > height_out ? height_out - dst_y : dst_unit;
 
-                if (ex == 2) {
-                    // trans output
-                    for (int ci = 0; ci < oc_8; ++ci) {
-                        const float *bias_ci = bias_ptr + ci * CH_PACK;
-                        float *dst_ci = dst_ptr + ci * oc_8_stride;
-                        float *src_ci = src_ptr + ci * tile_count * CH_PACK;
-                        output_trans_func(src_ci, c_gi_stride, c_gi_stride * src_unit, src_trans_tmp_per_thread, CH_PACK,
-                                          dst_unit * CH_PACK, bias_ci, param->activation_type);
-                        unpack_func(src_trans_tmp_per_thread, output_ptr, ci * CH_PACK, ci * CH_PACK + CH_PACK, dst_y,
-                                    dst_y + ey, dst_x, dst_x + ex, channel_out, height_out, width_out, false, zero_ptr);
-                    }
-                } else {
-                    for (int ci = 0; ci < oc_8; ++ci) {
-                        const float *bias_ci = bias_ptr + ci * CH_PACK;
+                    float *src_ptr = dst_temp_data + ti * CH_PACK;
+
+                    if (ex == dst_unit) {
                         // trans output
-                        float *dst_ci = dst_ptr + ci * oc_8_stride;
-                        float *src_ci = src_ptr + ci * tile_count * CH_PACK;
-                        output_trans_func(src_ci, c_gi_stride, c_gi_stride * src_unit, src_trans_tmp_per_thread, CH_PACK,
-                                          dst_unit * CH_PACK, bias_ci, param->activation_type);
-                        // copy to dest
-                        memset(dst_trans_tmp_per_thread, 0, 4 * CH_PACK * sizeof(float));  // dst_unit * dst_unit * ch_pack
-                        for (int i = 0; i < ey; ++i) {
-                            memcpy(dst_trans_tmp_per_thread + i * ex * CH_PACK, src_trans_tmp_per_thread + i * CH_PACK * dst_unit,
-                                   ex * sizeof(float) * CH_PACK);
+                        for (int ci = 0; ci < oc_8; ++ci) {
+                            const float *bias_ci = bias_ptr + ci * CH_PACK;
+                            float *src_ci        = src_ptr + ci * tile_count * CH_PACK;
+                            output_trans_func(src_ci, c_gi_stride, c_gi_stride * src_unit, src_trans_tmp_per_thread,
+                                              CH_PACK, dst_unit * CH_PACK, bias_ci, param->activation_type);
+                            unpack_func(src_trans_tmp_per_thread, output_ptr, ci * CH_PACK, ci * CH_PACK + CH_PACK,
+                                        dst_y, dst_y + ey, dst_x, dst_x + ex, channel_out, height_out, width_out, false,
+                                        zero_ptr);
+                        }
+                    } else {
+                        for (int ci = 0; ci < oc_8; ++ci) {
+                            const float *bias_ci = bias_ptr + ci * CH_PACK;
+                            // trans output
+                            float *src_ci = src_ptr + ci * tile_count * CH_PACK;
+                            output_trans_func(src_ci, c_gi_stride, c_gi_stride * src_unit, src_trans_tmp_per_thread,
+                                              CH_PACK, dst_unit * CH_PACK, bias_ci, param->activation_type);
+                            // copy to dest
+                            memset(dst_trans_tmp_per_thread, 0, dst_unit * dst_unit * CH_PACK * sizeof(float));
+                            for (int i = 0; i < ey; ++i) {
+                                memcpy(dst_trans_tmp_per_thread + i * ex * CH_PACK,
+                                       src_trans_tmp_per_thread + i * CH_PACK * dst_unit, ex * sizeof(float) * CH_PACK);
+                            }
+                            unpack_func(dst_trans_tmp_per_thread, output_ptr, ci * CH_PACK, ci * CH_PACK + CH_PACK,
+                                        dst_y, dst_y + ey, dst_x, dst_x + ex, channel_out, height_out, width_out, false,
+                                        zero_ptr);
                         }
-                        unpack_func(dst_trans_tmp_per_thread, output_ptr, ci * CH_PACK, ci * CH_PACK + CH_PACK, dst_y,
-                                    dst_y + ey, dst_x, dst_x + ex, channel_out, height_out, width_out, false, zero_ptr);
                     }
-                }
+                });
             }
         }
     }
@@ -29,6 +29,15 @@ public:
                            const std::vector<Blob *> &outputs);
 
     virtual Status allocateBufferWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+
+    virtual Status allocateBufferBias(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+
+    // @brief output tile of winograd F(m x m, 3 x 3) for the channel packs of one group and the output size
+    static int SelectDstUnit(int ic_pack, int oc_pack, int ch_pack, int height_out, int width_out);
+
+protected:
+    // output tile size of winograd F(m x m, 3 x 3), one of 2, 4, 6
+    int dst_unit_ = 2;
 };
 
 }  // namespace TNN_NS
@@ -0,0 +1,275 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "tnn/device/x86/acc/convolution/x86_conv_layer_3x3s2.h"
+#include "tnn/device/x86/acc/Float4.h"
+#include "tnn/device/x86/acc/Float8.h"
+#include "tnn/device/x86/x86_common.h"
+#include "tnn/device/x86/x86_context.h"
+#include "tnn/device/x86/x86_util.h"
+
+#include "tnn/interpreter/raw_buffer.h"
+#include "tnn/utils/data_type_utils.h"
+#include "tnn/device/x86/x86_thread_pool.h"
+
+namespace TNN_NS {
+
+// number of output pixels computed at once, each one takes an accumulator register
+#define OW_TILE 8
+
+// compute up to OW_TILE outputs of one output row for PACK output channels.
+// weight is [ic][3][3][PACK], src points to the first input channel of the group.
+// if CHECK is false all the taps of the tile must be inside the input.
+template <typename VEC, int PACK, bool CHECK>
+static void conv3x3s2_tile(const float *src, const float *weight, const float *bias, float *dst, int count, int ix0,
+                           int iy0, int ic, int height_in, int width_in, int dst_c_stride, int oc_valid,
+                           int relu_type) {
+    VEC acc[OW_TILE];
+    VEC bias_v = VEC::loadu(bias);
+    for (int t = 0; t < OW_TILE; t++) {
+        acc[t] = bias_v;
+    }
+
+    const int ky_s = iy0 < 0 ? -iy0 : 0;
+    const int ky_e = iy0 + 3 > height_in ? height_in - iy0 : 3;
+    const int src_c_stride = height_in * width_in;
+
+    for (int c = 0; c < ic; c++) {
+        const float *src_c = src + c * src_c_stride;
+        const float *w_c   = weight + c * 9 * PACK;
+        for (int ky = ky_s; ky < ky_e; ky++) {
+            const float *row = src_c + (iy0 + ky) * width_in + ix0;
+            for (int kx = 0; kx < 3; kx++) {
+                VEC w = VEC::loadu(w_c + (ky * 3 + kx) * PACK);
+                for (int t = 0; t < OW_TILE; t++) {
+                    int ix = t * 2 + kx;
+                    if (CHECK && (t >= count || ix0 + ix < 0 || ix0 + ix >= width_in)) {
+                        continue;
+                    }
+                    VEC::mla(acc[t], VEC(row + ix), w);
+                }
+            }
+        }
+    }
+
+    float result[OW_TILE * PACK];
+    VEC zeros = VEC(0.f);
+    VEC sixs  = VEC(6.f);
+    for (int t = 0; t < OW_TILE; t++) {
+        if (relu_type == ActivationType_ReLU || relu_type == ActivationType_ReLU6) {
+            acc[t] = VEC::max(acc[t], zeros);
+        }
+        if (relu_type == ActivationType_ReLU6) {
+            acc[t] = VEC::min(acc[t], sixs);
+        }
+        VEC::saveu(result + t * PACK, acc[t]);
+    }
+    for (int o = 0; o < oc_valid; o++) {
+        float *dst_o = dst + o * dst_c_stride;
+        for (int t = 0; t < count; t++) {
+            dst_o[t] = result[t * PACK + o];
+        }
+    }
+}
+
+// one output row of PACK output channels
+template <typename VEC, int PACK>
+static void conv3x3s2_row(const float *src, const float *weight, const float *bias, float *dst, int oy, int ic,
+                          int height_in, int width_in, int width_out, int pad_top, int pad_left, int dst_c_stride,
+                          int oc_valid, int relu_type) {
+    const int iy0 = oy * 2 - pad_top;
+
+    // [ox_l, ox_r) reads no padding on the left or right
+    int ox_l = UP_DIV(pad_left, 2);
+    int ox_r = width_in + pad_left - 3 >= 0 ? (width_in + pad_left - 3) / 2 + 1 : 0;
+    ox_l     = std::min(ox_l, width_out);
+    ox_r     = std::max(std::min(ox_r, width_out), ox_l);
+
+    int ox = 0;
+    while (ox < ox_l) {
+        int count = std::min(OW_TILE, ox_l - ox);
+        conv3x3s2_tile<VEC, PACK, true>(src, weight, bias, dst + ox, count, ox * 2 - pad_left, iy0, ic, height_in,
+                                        width_in, dst_c_stride, oc_valid, relu_type);
+        ox += count;
+    }
+    for (; ox + OW_TILE <= ox_r; ox += OW_TILE) {
+        conv3x3s2_tile<VEC, PACK, false>(src, weight, bias, dst + ox, OW_TILE, ox * 2 - pad_left, iy0, ic, height_in,
+                                         width_in, dst_c_stride, oc_valid, relu_type);
+    }
+    while (ox < width_out) {
+        int count = std::min(OW_TILE, width_out - ox);
+        conv3x3s2_tile<VEC, PACK, true>(src, weight, bias, dst + ox, count, ox * 2 - pad_left, iy0, ic, height_in,
+                                        width_in, dst_c_stride, oc_valid, relu_type);
+        ox += count;
+    }
+}
+
+bool X86ConvLayer3x3s2::isPrefered(ConvLayerParam *param, const std::vector<Blob *> &inputs,
+                                   const std::vector<Blob *> &outputs) {
+    if (!param) {
+        return false;
+    }
+
+    if (inputs[0]->GetBlobDesc().dims.size() != 4 || param->kernels.size() != 2) {
+        return false;
+    }
+
+    const int kw = param->kernels[0];
+    const int kh = param->kernels[1];
+    const int dw = param->dialations[0];
+    const int dh = param->dialations[1];
+    const int sw = param->strides[0];
+    const int sh = param->strides[1];
+    const int act = param->activation_type;
+
+    if (act != ActivationType_None && act != ActivationType_ReLU && act != ActivationType_ReLU6) {
+        return false;
+    }
+
+    return kw == 3 && kh == 3 && dw == 1 && dh == 1 && sw == 2 && sh == 2;
+}
+
+X86ConvLayer3x3s2::~X86ConvLayer3x3s2() {}
+
+// weight is packed to [group][oc / PACK][ic][3][3][PACK]
+Status X86ConvLayer3x3s2::allocateBufferWeight(const std::vector<Blob *> &inputs,
+                                               const std::vector<Blob *> &outputs) {
+    ConvLayerParam *param = dynamic_cast<ConvLayerParam *>(param_);
+    CHECK_PARAM_NULL(param);
+    ConvLayerResource *conv_res = dynamic_cast<ConvLayerResource *>(resource_);
+    CHECK_PARAM_NULL(conv_res);
+
+    if (!buffer_weight_.GetBytesSize()) {
+        const int PACK           = arch_ == avx2 ? 8 : 4;
+        const int group          = param->group;
+        const int input_channel  = inputs[0]->GetBlobDesc().dims[1] / group;
+        const int output_channel = outputs[0]->GetBlobDesc().dims[1] / group;
+        const int oc_blk         = UP_DIV(output_channel, PACK);
+
+        if (conv_res->filter_handle.GetDataType() == DATA_TYPE_FLOAT) {
+            auto pack = [&](RawBuffer &buffer) -> Status {
+                const float *src = conv_res->filter_handle.force_to<float *>();
+                RawBuffer temp_buffer(group * oc_blk * input_channel * 9 * PACK * sizeof(float));
+                float *dst = temp_buffer.force_to<float *>();
+
+                for (int g = 0; g < group; g++) {
+                    for (int oc = 0; oc < output_channel; oc++) {
+                        const float *src_oc = src + (g * output_channel + oc) * input_channel * 9;
+                        float *dst_oc       = dst + (g * oc_blk + oc / PACK) * input_channel * 9 * PACK + oc % PACK;
+                        for (int k = 0; k < input_channel * 9; k++) {
+                            dst_oc[k * PACK] = src_oc[k];
+                        }
+                    }
+                }
+                temp_buffer.SetDataType(DATA_TYPE_FLOAT);
+                buffer = temp_buffer;
+                return TNN_OK;
+            };
+            RETURN_ON_NEQ(GetSharedWeights("conv3x3s2_weight", buffer_weight_, pack), TNN_OK);
+        } else {
+            LOGE("Error: DataType %d not support\n", conv_res->filter_handle.GetDataType());
+            return Status(TNNERR_MODEL_ERR, "conv_res DataType is not supported");
+        }
+    }
+    return TNN_OK;
+}
+
+// bias is padded to [group][ROUND_UP(oc, PACK)]
+Status X86ConvLayer3x3s2::allocateBufferBias(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    ConvLayerParam *param = dynamic_cast<ConvLayerParam *>(param_);
+    CHECK_PARAM_NULL(param);
+    ConvLayerResource *conv_res = dynamic_cast<ConvLayerResource *>(resource_);
+    CHECK_PARAM_NULL(conv_res);
+
+    if (!buffer_bias_.GetBytesSize()) {
+        const int PACK           = arch_ == avx2 ? 8 : 4;
+        const int group          = param->group;
+        const int output_channel = outputs[0]->GetBlobDesc().dims[1] / group;
+        const int group_stride   = ROUND_UP(output_channel, PACK);
+        RawBuffer temp_buffer(group * group_stride * sizeof(float));
+        if (param->bias) {
+            const float *src = conv_res->bias_handle.force_to<float *>();
+            float *dst       = temp_buffer.force_to<float *>();
+            for (int g = 0; g < group; g++) {
+                memcpy(dst + g * group_stride, src + g * output_channel, output_channel * sizeof(float));
+            }
+        }
+        buffer_bias_ = temp_buffer;
+    }
+    return TNN_OK;
+}
+
+Status X86ConvLayer3x3s2::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    ConvLayerParam *param = dynamic_cast<ConvLayerParam *>(param_);
+
+    auto dims_input  = inputs[0]->GetBlobDesc().dims;
+    auto dims_output = outputs[0]->GetBlobDesc().dims;
+
+    auto src_origin = reinterpret_cast<float *>(inputs[0]->GetHandle().base);
+    auto dst_origin = reinterpret_cast<float *>(outputs[0]->GetHandle().base);
+
+    const int group       = param->group;
+    const int batch       = dims_output[0];
+    const int channel_in  = dims_input[1] / group;
+    const int height_in   = dims_input[2];
+    const int width_in    = dims_input[3];
+    const int channel_out = dims_output[1] / group;
+    const int height_out  = dims_output[2];
+    const int width_out   = dims_output[3];
+    const int pad_left    = param->pads[0];
+    const int pad_top     = param->pads[2];
+    const int relu_type   = param->activation_type;
+
+    auto row_func = conv3x3s2_row<Float4, 4>;
+    int PACK      = 4;
+    if (arch_ == avx2) {
+        row_func = conv3x3s2_row<Float8, 8>;
+        PACK     = 8;
+    }
+
+    const int oc_blk       = UP_DIV(channel_out, PACK);
+    const int ic_stride    = height_in * width_in;
+    const int oc_stride    = height_out * width_out;
+    const int w_blk_stride = channel_in * 9 * PACK;
+
+    const float *weight_ptr = buffer_weight_.force_to<float *>();
+    const float *bias_ptr   = buffer_bias_.force_to<float *>();
+
+    for (int ni = 0; ni < batch; ni++) {
+        const float *input_ptr = src_origin + ni * group * channel_in * ic_stride;
+        float *output_ptr      = dst_origin + ni * group * channel_out * oc_stride;
+
+        // neighbouring tasks share the same input rows
+        X86ParallelFor(0, group * height_out * oc_blk, [&](int idx, int thread_id) {
+            int ob = idx % oc_blk;
+            int oy = (idx / oc_blk) % height_out;
+            int g  = idx / oc_blk / height_out;
+
+            int oc_begin = ob * PACK;
+            int oc_valid = std::min(PACK, channel_out - oc_begin);
+
+            const float *src_g = input_ptr + g * channel_in * ic_stride;
+            const float *w_blk = weight_ptr + (g * oc_blk + ob) * w_blk_stride;
+            const float *b_blk = bias_ptr + g * oc_blk * PACK + oc_begin;
+            float *dst_row     = output_ptr + (g * channel_out + oc_begin) * oc_stride + oy * width_out;
+
+            row_func(src_g, w_blk, b_blk, dst_row, oy, channel_in, height_in, width_in, width_out, pad_top, pad_left,
+                     oc_stride, oc_valid, relu_type);
+        });
+    }
+
+    return TNN_OK;
+}
+
+}  // namespace TNN_NS
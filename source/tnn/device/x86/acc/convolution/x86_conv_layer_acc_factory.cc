@@ -17,6 +17,7 @@
 #include "tnn/device/x86/acc/convolution/x86_conv_layer_depthwise.h"
 #include "tnn/device/x86/acc/convolution/x86_conv_layer_1x1.h"
 #include "tnn/device/x86/acc/convolution/x86_conv_layer_3x3.h"
+#include "tnn/device/x86/acc/convolution/x86_conv_layer_3x3s2.h"
 #include "tnn/device/x86/acc/convolution/x86_conv_layer_common.h"
 #include "tnn/device/x86/acc/convolution/x86_conv_int8_layer_common.h"
 #include "tnn/device/x86/acc/convolution/x86_conv_int8_layer_depthwise.h"
@@ -41,11 +42,53 @@ void X86ConvLayerAccFactory::CreateImpFP(const std::vector<Blob *> &inputs, cons
         if (!dynamic_cast<X86ConvLayer3x3*>(conv_acc_impl.get())) {
             conv_acc_impl = std::make_shared<X86ConvLayer3x3>();
         }
+    } else if (X86ConvLayer3x3s2::isPrefered(dynamic_cast<ConvLayerParam *>(param), inputs, outputs)) {
+        if (!dynamic_cast<X86ConvLayer3x3s2 *>(conv_acc_impl.get())) {
+            conv_acc_impl = std::make_shared<X86ConvLayer3x3s2>();
+        }
     } else if (!conv_acc_impl) {
         conv_acc_impl = std::make_shared<X86ConvLayerCommon>();
     }
 }
 
+std::vector<X86ConvImpType> X86ConvLayerAccFactory::GetImpTypesFP(const std::vector<Blob *> &inputs,
+                                                                   const std::vector<Blob *> &outputs,
+                                                                   LayerParam *param) {
+    std::vector<X86ConvImpType> imp_types;
+    auto conv_param = dynamic_cast<ConvLayerParam *>(param);
+    if (X86ConvLayerDepthwise::isPrefered(conv_param, inputs, outputs)) {
+        imp_types.push_back(X86_CONV_IMP_DEPTHWISE);
+    }
+    if (X86ConvLayer1x1::isPrefered(conv_param, inputs, outputs)) {
+        imp_types.push_back(X86_CONV_IMP_1X1);
+    }
+    if (X86ConvLayer3x3::isPrefered(conv_param, inputs, outputs)) {
+        imp_types.push_back(X86_CONV_IMP_3X3);
+    }
+    if (X86ConvLayer3x3s2::isPrefered(conv_param, inputs, outputs)) {
+        imp_types.push_back(X86_CONV_IMP_3X3S2);
+    }
+    imp_types.push_back(X86_CONV_IMP_COMMON);
+    return imp_types;
+}
+
+std::shared_ptr<X86LayerAcc> X86ConvLayerAccFactory::CreateImpFP(X86ConvImpType imp_type) {
+    switch (imp_type) {
+        case X86_CONV_IMP_COMMON:
+            return std::make_shared<X86ConvLayerCommon>();
+        case X86_CONV_IMP_DEPTHWISE:
+            return std::make_shared<X86ConvLayerDepthwise>();
+        case X86_CONV_IMP_1X1:
+            return std::make_shared<X86ConvLayer1x1>();
+        case X86_CONV_IMP_3X3:
+            return std::make_shared<X86ConvLayer3x3>();
+        case X86_CONV_IMP_3X3S2:
+            return std::make_shared<X86ConvLayer3x3s2>();
+        default:
+            return nullptr;
+    }
+}
+
 /*
 get different impl based on conv params
 X86ConvInt8LayerCommon always as the last solution
@@ -21,8 +21,24 @@
 
 namespace TNN_NS {
 
+// fp32 conv impls, the values are stored in the kernel tune cache file
+typedef enum {
+    X86_CONV_IMP_COMMON    = 0,
+    X86_CONV_IMP_DEPTHWISE = 1,
+    X86_CONV_IMP_1X1       = 2,
+    X86_CONV_IMP_3X3       = 3,
+    X86_CONV_IMP_3X3S2     = 4,
+} X86ConvImpType;
+
 class X86ConvLayerAccFactory {
 public:
+    // @brief all fp32 impls able to run the conv, X86_CONV_IMP_COMMON is always the last one
+    static std::vector<X86ConvImpType> GetImpTypesFP(const std::vector<Blob *> &inputs,
+                                                     const std::vector<Blob *> &outputs, LayerParam *param);
+
+    // @brief create a fp32 impl of the given type, nullptr for unknown types
+    static std::shared_ptr<X86LayerAcc> CreateImpFP(X86ConvImpType imp_type);
+
     static void CreateImpFP(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs, LayerParam *param,
                             std::shared_ptr<X86LayerAcc> &conv_acc_impl);
 
@@ -55,17 +55,23 @@ Status X86ConvLayerCommon::allocateBufferWeight(const std::vector<Blob *> &input
         const float *src = conv_res->filter_handle.force_to<float *>();
 
         if (conv_res->filter_handle.GetDataType() == DATA_TYPE_FLOAT) {
-            RawBuffer temp_buffer(weight_pack_per_group * param->group * sizeof(float));
-            float *dst = temp_buffer.force_to<float *>();
-
-            for (int g = 0; g < param->group; g++) {
-                auto src_g = src + K * M * g;
-                auto dst_g = dst + weight_pack_per_group * g;
-                conv_pack_col_b_n(M, K, src_g, K, dst_g, conv_gemm_conf_);
-            }
-
-            temp_buffer.SetDataType(DATA_TYPE_FLOAT);
-            buffer_weight_ = temp_buffer;
+            auto pack = [&](RawBuffer &buffer) -> Status {
+                RawBuffer temp_buffer(weight_pack_per_group * param->group * sizeof(float));
+                float *dst = temp_buffer.force_to<float *>();
+
+                for (int g = 0; g < param->group; g++) {
+                    auto src_g = src + K * M * g;
+                    auto dst_g = dst + weight_pack_per_group * g;
+                    conv_pack_col_b_n(M, K, src_g, K, dst_g, conv_gemm_conf_);
+                }
+
+                temp_buffer.SetDataType(DATA_TYPE_FLOAT);
+                buffer = temp_buffer;
+                return TNN_OK;
+            };
+            // the packed layout depends on the gemm block sizes
+            auto key = "conv_common_weight_" + std::to_string(k_c) + "_" + std::to_string(n_block);
+            RETURN_ON_NEQ(GetSharedWeights(key, buffer_weight_, pack), TNN_OK);
         } else {
             LOGE("Error: DataType %d not support\n", conv_res->filter_handle.GetDataType());
             return Status(TNNERR_MODEL_ERR, "conv_res DataType is not supported");
@@ -94,6 +100,11 @@ Status X86ConvLayerCommon::allocateBufferBias(const std::vector<Blob *> &inputs,
     return TNN_OK;
 }
 
+void X86ConvLayerCommon::SetGemmBlockSize(int m_c, int k_c) {
+    gemm_m_c_ = m_c;
+    gemm_k_c_ = k_c;
+}
+
 Status X86ConvLayerCommon::Init(Context *context, LayerParam *param, LayerResource *resource,
                                 const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     auto status = X86LayerAcc::Init(context, param, resource, inputs, outputs);
@@ -101,6 +112,12 @@ Status X86ConvLayerCommon::Init(Context *context, LayerParam *param, LayerResour
         return status;
     }
     conv_gemm_conf_ = conv_gemm_config<float, float, float>();
+    if (gemm_m_c_ > 0) {
+        conv_gemm_conf_.M_c_ = gemm_m_c_;
+    }
+    if (gemm_k_c_ > 0) {
+        conv_gemm_conf_.K_c_ = gemm_k_c_;
+    }
 
     RETURN_ON_NEQ(allocateBufferWeight(inputs, outputs), TNN_OK);
     RETURN_ON_NEQ(allocateBufferBias(inputs, outputs), TNN_OK);
@@ -127,7 +144,7 @@ Status X86ConvLayerCommon::DoForward(const std::vector<Blob *> &inputs, const st
     int output_offset_ = output_dims[1] * conv_out_spatial_dim_ / param->group;
     size_t col_offset_ = param->kernels[0] * param->kernels[1] * oh * ow * (input_dims[1] / param->group);
 
-    int max_num_threads = OMP_MAX_THREADS_NUM_;
+    int max_num_threads = X86ThreadPool::GetMaxThreadsNum();
     conv_ajust_m_blk_size(max_num_threads, conv_out_spatial_dim_, conv_gemm_conf_.M_c_);
 
     int m_c = conv_gemm_conf_.M_c_;
@@ -44,8 +44,13 @@ public:
 
     virtual Status allocateBufferBias(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
 
+    // set gemm blocking sizes found by kernel tuning, 0 keeps the default. call before Init
+    void SetGemmBlockSize(int m_c, int k_c);
+
 protected:
     bool do_im2col_ = true;
+    int gemm_m_c_   = 0;
+    int gemm_k_c_   = 0;
     RawBuffer buffer_weight_;
     RawBuffer buffer_bias_;
     conv_gemm_config<float, float, float> conv_gemm_conf_;
@@ -20,7 +20,7 @@
 #include "tnn/interpreter/raw_buffer.h"
 #include "tnn/utils/data_format_converter.h"
 #include "tnn/utils/data_type_utils.h"
-#include "tnn/utils/omp_utils.h"
+#include "tnn/device/x86/x86_thread_pool.h"
 
 namespace TNN_NS {
 bool X86ConvLayerDepthwise::isPrefered(ConvLayerParam *param, const std::vector<Blob *> &inputs,
@@ -60,16 +60,20 @@ Status X86ConvLayerDepthwise::allocateBufferWeight(const std::vector<Blob *> &in
         int data_byte_size = DataTypeUtils::GetBytesSize(conv_res->filter_handle.GetDataType());
 
         if (conv_res->filter_handle.GetDataType() == DATA_TYPE_FLOAT) {
-            RawBuffer temp_buffer(weight_count * data_byte_size);
-            float *dst = temp_buffer.force_to<float *>();
-
-            if (arch_ == avx2) {
-                PackC8(dst, src, kh * kw, kh * kw, kh * kw, group);
-            } else if (arch_ == sse42) {
-                PackC4(dst, src, kh * kw, kh * kw, kh * kw, group);
-            }
-            temp_buffer.SetDataType(DATA_TYPE_FLOAT);
-            buffer_weight_ = temp_buffer;
+            auto pack = [&](RawBuffer &buffer) -> Status {
+                RawBuffer temp_buffer(weight_count * data_byte_size);
+                float *dst = temp_buffer.force_to<float *>();
+
+                if (arch_ == avx2) {
+                    PackC8(dst, src, kh * kw, kh * kw, kh * kw, group);
+                } else if (arch_ == sse42) {
+                    PackC4(dst, src, kh * kw, kh * kw, kh * kw, group);
+                }
+                temp_buffer.SetDataType(DATA_TYPE_FLOAT);
+                buffer = temp_buffer;
+                return TNN_OK;
+            };
+            RETURN_ON_NEQ(GetSharedWeights("conv_depthwise_weight", buffer_weight_, pack), TNN_OK);
         } else {
             LOGE("Error: DataType %d not support\n", conv_res->filter_handle.GetDataType());
             return Status(TNNERR_MODEL_ERR, "conv_res DataType is not supported");
@@ -126,7 +130,7 @@ Status X86ConvLayerDepthwise::DoForward(const std::vector<Blob *> &inputs, const
     int dilate_x_step  = c_pack * param->dialations[0];
     int weight_z_step  = param->kernels[0] * param->kernels[1];
 
-    int max_num_threads = OMP_MAX_THREADS_NUM_;
+    int max_num_threads = X86ThreadPool::GetMaxThreadsNum();
     size_t src_pad_size = ROUND_UP(src_pad_w * (dims_input[2] + param->pads[2] + param->pads[3]) * c_pack * sizeof(float), 32);
     size_t dst_tmp_size = ROUND_UP(dst_z_step * c_pack * sizeof(float), 32);
     float *workspace = reinterpret_cast<float *>(context_->GetSharedWorkSpace(
@@ -167,14 +171,12 @@ Status X86ConvLayerDepthwise::DoForward(const std::vector<Blob *> &inputs, const
         auto src_ptr = src_origin + batch_idx * dims_input[1] * src_z_step;
         auto dst_ptr = dst_origin + batch_idx * dims_output[1] * dst_z_step;
 
-        OMP_PARALLEL_FOR_GUIDED_
-        for (int dz = 0; dz < dims_output[1]; dz += c_pack) {
+        X86ParallelFor(0, dims_output[1], c_pack, [&](int dz, int thread_id) {
             int real_dz     = MIN(c_pack, dims_output[1] - dz);
             auto *dst_z     = dst_ptr + dst_z_step * dz;
             auto *src_z     = src_ptr + src_z_step * dz;
             auto *weight_dz = weights_data + dz * weight_z_step;
             auto *bias_z    = bias_data + dz;
-            int thread_id   = OMP_TID_;
             auto *tmp_buf   = workspace + thread_id * ((src_pad_size + dst_tmp_size) / sizeof(float));
             auto *src_buf   = tmp_buf;
             auto *dst_buf   = tmp_buf + src_pad_size / sizeof(float);
@@ -184,7 +186,7 @@ Status X86ConvLayerDepthwise::DoForward(const std::vector<Blob *> &inputs, const
                     param->kernels[0], param->kernels[1], dilate_x_step, dilate_y_step,
                     dims_output[2], src_pad_w * c_pack * param->strides[1], dims_output[3] * c_pack);
             UnpackAcc(dst_z, dst_buf, dst_z_step, dst_z_step, dst_z_step, real_dz);
-        }
+        });
     }
     return TNN_OK;
 }
@@ -150,7 +150,7 @@ Status X86DeconvLayerCommon::DoForward(const std::vector<Blob *> &inputs, const
     size_t col_offset_ =
         param->kernels[0] * param->kernels[1] * input_dims[2] * input_dims[3] * (output_dims[1] / param->group);
 
-    int max_num_threads = OMP_MAX_THREADS_NUM_;
+    int max_num_threads = X86ThreadPool::GetMaxThreadsNum();
     conv_ajust_m_blk_size(max_num_threads, conv_in_spatial_dim_, conv_gemm_conf_.M_c_);
 
     int m_c               = conv_gemm_conf_.M_c_;
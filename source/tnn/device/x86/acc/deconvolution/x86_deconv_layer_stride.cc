@@ -0,0 +1,277 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "tnn/device/x86/acc/deconvolution/x86_deconv_layer_stride.h"
+
+#include <algorithm>
+
+#include "tnn/device/x86/acc/convolution/x86_conv_layer_acc_factory.h"
+#include "tnn/device/x86/x86_context.h"
+#include "tnn/device/x86/x86_thread_pool.h"
+#include "tnn/utils/dims_utils.h"
+
+namespace TNN_NS {
+
+/*
+one axis of a deconv phase. output o = i * stride - pad + k, the outputs with (o + pad) % stride == phase only
+see the kernel taps phase, phase + stride, ..., which makes a stride 1 conv over the input with the flipped taps
+*/
+struct DeconvPhaseAxis {
+    int kernel    = 0;
+    int pad_begin = 0;
+    int pad_end   = 0;
+    // first output written by the phase and the number of outputs
+    int start = 0;
+    int size  = 0;
+};
+
+static DeconvPhaseAxis GetDeconvPhaseAxis(int kernel, int stride, int pad, int phase, int in_size, int out_size) {
+    DeconvPhaseAxis axis;
+    axis.kernel = UP_DIV(kernel - phase, stride);
+    // first input row reaching the output, counted back from the last tap
+    int first      = pad > phase ? UP_DIV(pad - phase, stride) : 0;
+    axis.pad_begin = axis.kernel - 1 - first;
+    axis.start     = first * stride + phase - pad;
+    axis.size      = out_size > axis.start ? UP_DIV(out_size - axis.start, stride) : 0;
+    axis.pad_end   = std::max(axis.size - in_size - axis.pad_begin + axis.kernel - 1, 0);
+    return axis;
+}
+
+bool X86DeconvLayerStride::isPrefered(ConvLayerParam *param, const std::vector<Blob *> &inputs,
+                                      const std::vector<Blob *> &outputs) {
+    if (!param || inputs[0]->GetBlobDesc().data_type != DATA_TYPE_FLOAT) {
+        return false;
+    }
+
+    auto dims_input  = inputs[0]->GetBlobDesc().dims;
+    auto dims_output = outputs[0]->GetBlobDesc().dims;
+    if (dims_input.size() != 4 || dims_output.size() != 4) {
+        return false;
+    }
+
+    if (param->activation_type != ActivationType_None && param->activation_type != ActivationType_ReLU &&
+        param->activation_type != ActivationType_ReLU6) {
+        return false;
+    }
+
+    // axis 0 is w and axis 1 is h, same as kernels and strides
+    for (int axis = 0; axis < 2; ++axis) {
+        const int kernel = param->kernels[axis];
+        const int stride = param->strides[axis];
+        const int pad    = param->pads[axis * 2];
+        if (param->dialations[axis] != 1 || stride < 1 || kernel < stride) {
+            return false;
+        }
+        const int in_size  = dims_input[3 - axis];
+        const int out_size = dims_output[3 - axis];
+        for (int phase = 0; phase < stride; ++phase) {
+            if (GetDeconvPhaseAxis(kernel, stride, pad, phase, in_size, out_size).pad_begin < 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+X86DeconvLayerStride::~X86DeconvLayerStride() {}
+
+Status X86DeconvLayerStride::CreatePhase(int phase_y, int phase_x, const std::vector<Blob *> &inputs,
+                                         const std::vector<Blob *> &outputs) {
+    auto param    = dynamic_cast<ConvLayerParam *>(param_);
+    auto resource = dynamic_cast<ConvLayerResource *>(resource_);
+    CHECK_PARAM_NULL(param);
+    CHECK_PARAM_NULL(resource);
+
+    auto dims_input  = inputs[0]->GetBlobDesc().dims;
+    auto dims_output = outputs[0]->GetBlobDesc().dims;
+    auto axis_y      = GetDeconvPhaseAxis(param->kernels[1], param->strides[1], param->pads[2], phase_y, dims_input[2],
+                                          dims_output[2]);
+    auto axis_x      = GetDeconvPhaseAxis(param->kernels[0], param->strides[0], param->pads[0], phase_x, dims_input[3],
+                                          dims_output[3]);
+    // the output is too small to have any pixel of this phase
+    if (axis_y.size <= 0 || axis_x.size <= 0) {
+        return TNN_OK;
+    }
+
+    const int group  = param->group;
+    const int ic_g   = dims_input[1] / group;
+    const int oc     = dims_output[1];
+    const int oc_g   = oc / group;
+    const int kh     = param->kernels[1];
+    const int kw     = param->kernels[0];
+    const int sub_kh = axis_y.kernel;
+    const int sub_kw = axis_x.kernel;
+
+    DeconvPhase phase;
+    phase.phase_y               = phase_y;
+    phase.phase_x               = phase_x;
+    phase.param                 = std::make_shared<ConvLayerParam>(*param);
+    phase.param->pad_type       = -1;
+    phase.param->kernels        = {sub_kw, sub_kh};
+    phase.param->strides        = {1, 1};
+    phase.param->dialations     = {1, 1};
+    phase.param->pads           = {axis_x.pad_begin, axis_x.pad_end, axis_y.pad_begin, axis_y.pad_end};
+    phase.param->input_channel  = ic_g;
+    phase.param->output_channel = oc;
+    // packed weights are shared by layer name, every phase has its own filter
+    phase.param->name = param->name + "/phase_" + std::to_string(phase_y) + "_" + std::to_string(phase_x);
+
+    if (resource->filter_handle.GetDataType() != DATA_TYPE_FLOAT) {
+        LOGE("Error: DataType %d not support\n", resource->filter_handle.GetDataType());
+        return Status(TNNERR_MODEL_ERR, "conv_res DataType is not supported");
+    }
+
+    // deconv filter is [g][ic/g][oc/g][kh][kw], the phase conv filter is [g][oc/g][ic/g][sub_kh][sub_kw]
+    ConvLayerResource phase_resource;
+    phase_resource.filter_handle = RawBuffer(oc * ic_g * sub_kh * sub_kw * sizeof(float));
+    phase_resource.filter_handle.SetDataType(DATA_TYPE_FLOAT);
+    phase_resource.bias_handle = resource->bias_handle;
+
+    const float *src = resource->filter_handle.force_to<float *>();
+    float *dst       = phase_resource.filter_handle.force_to<float *>();
+    for (int g = 0; g < group; ++g) {
+        for (int o = 0; o < oc_g; ++o) {
+            for (int i = 0; i < ic_g; ++i) {
+                const float *src_io = src + ((g * ic_g + i) * oc_g + o) * kh * kw;
+                float *dst_io       = dst + ((g * oc_g + o) * ic_g + i) * sub_kh * sub_kw;
+                for (int ty = 0; ty < sub_kh; ++ty) {
+                    const int ky = phase_y + (sub_kh - 1 - ty) * param->strides[1];
+                    for (int tx = 0; tx < sub_kw; ++tx) {
+                        const int kx             = phase_x + (sub_kw - 1 - tx) * param->strides[0];
+                        dst_io[ty * sub_kw + tx] = src_io[ky * kw + kx];
+                    }
+                }
+            }
+        }
+    }
+
+    BlobDesc desc = outputs[0]->GetBlobDesc();
+    desc.dims     = {dims_output[0], oc, dims_input[2] + axis_y.pad_begin + axis_y.pad_end - sub_kh + 1,
+                     dims_input[3] + axis_x.pad_begin + axis_x.pad_end - sub_kw + 1};
+    phase.output  = std::make_shared<Blob>(desc);
+
+    std::vector<Blob *> phase_outputs = {phase.output.get()};
+    X86ConvLayerAccFactory::CreateImpFP(inputs, phase_outputs, phase.param.get(), phase.conv_impl);
+    if (!phase.conv_impl) {
+        return Status(TNNERR_NET_ERR, "Could not create deconv phase impl");
+    }
+    // the phase conv packs its weights, the phase filter is released after init
+    RETURN_ON_NEQ(phase.conv_impl->Init(context_, phase.param.get(), &phase_resource, inputs, phase_outputs), TNN_OK);
+
+    phases_.push_back(phase);
+    return TNN_OK;
+}
+
+Status X86DeconvLayerStride::Init(Context *context, LayerParam *param, LayerResource *resource,
+                                  const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    RETURN_ON_NEQ(X86LayerAcc::Init(context, param, resource, inputs, outputs), TNN_OK);
+    auto conv_param = dynamic_cast<ConvLayerParam *>(param_);
+    CHECK_PARAM_NULL(conv_param);
+
+    phases_.clear();
+    for (int phase_y = 0; phase_y < conv_param->strides[1]; ++phase_y) {
+        for (int phase_x = 0; phase_x < conv_param->strides[0]; ++phase_x) {
+            RETURN_ON_NEQ(CreatePhase(phase_y, phase_x, inputs, outputs), TNN_OK);
+        }
+    }
+    return TNN_OK;
+}
+
+Status X86DeconvLayerStride::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    if (outputs[0]->GetBlobDesc().data_type != DATA_TYPE_FLOAT) {
+        return Status(TNNERR_DEVICE_ACC_DATA_FORMAT_NOT_SUPPORT, "Error: x86 device not support this data type");
+    }
+    auto param       = dynamic_cast<ConvLayerParam *>(param_);
+    auto dims_input  = inputs[0]->GetBlobDesc().dims;
+    auto dims_output = outputs[0]->GetBlobDesc().dims;
+    const int batch  = dims_output[0];
+    const int oc     = dims_output[1];
+    const int out_h  = dims_output[2];
+    const int out_w  = dims_output[3];
+    const int sh     = param->strides[1];
+    const int sw     = param->strides[0];
+    float *output    = reinterpret_cast<float *>(outputs[0]->GetHandle().base);
+
+    // every output pixel belongs to exactly one phase, bias and activation are done by the phase convs
+    std::vector<DeconvPhaseAxis> axes_y, axes_x;
+    int covered         = 0;
+    size_t phase_pixels = 0;
+    for (auto &phase : phases_) {
+        auto axis_y = GetDeconvPhaseAxis(param->kernels[1], sh, param->pads[2], phase.phase_y, dims_input[2], out_h);
+        auto axis_x = GetDeconvPhaseAxis(param->kernels[0], sw, param->pads[0], phase.phase_x, dims_input[3], out_w);
+        // pads of the phase conv are fixed at init, they hold as long as the output grows with the input
+        const int rows = dims_input[2] + axis_y.pad_begin + phase.param->pads[3] - axis_y.kernel + 1;
+        const int cols = dims_input[3] + axis_x.pad_begin + phase.param->pads[1] - axis_x.kernel + 1;
+        if (rows < axis_y.size || cols < axis_x.size || rows <= 0 || cols <= 0) {
+            return Status(TNNERR_LAYER_ERR, "deconv phase conv does not cover the output");
+        }
+        phase.output->GetBlobDesc().dims = {batch, oc, rows, cols};
+        axes_y.push_back(axis_y);
+        axes_x.push_back(axis_x);
+        covered += axis_y.size * axis_x.size;
+        phase_pixels += (size_t)rows * cols;
+    }
+    if (covered != out_h * out_w) {
+        return Status(TNNERR_LAYER_ERR, "deconv phases do not cover the output");
+    }
+
+    // stride 1 with a matching output, the only phase writes the output directly
+    const bool direct = phases_.size() == 1 && axes_y[0].start == 0 && axes_x[0].start == 0 &&
+                        phases_[0].output->GetBlobDesc().dims[2] == out_h &&
+                        phases_[0].output->GetBlobDesc().dims[3] == out_w;
+    if (direct) {
+        BlobHandle handle;
+        handle.base = output;
+        phases_[0].output->SetHandle(handle);
+        return phases_[0].conv_impl->DoForward(inputs, {phases_[0].output.get()});
+    }
+
+    const size_t phase_bytes = phase_pixels * batch * oc * sizeof(float);
+    if (buffer_phase_.GetBytesSize() < phase_bytes) {
+        buffer_phase_ = RawBuffer(phase_bytes);
+    }
+
+    float *phase_data = buffer_phase_.force_to<float *>();
+    for (int p = 0; p < phases_.size(); ++p) {
+        auto phase_blob = phases_[p].output.get();
+        const int rows  = phase_blob->GetBlobDesc().dims[2];
+        const int cols  = phase_blob->GetBlobDesc().dims[3];
+        const auto &ay  = axes_y[p];
+        const auto &ax  = axes_x[p];
+
+        BlobHandle handle;
+        handle.base = phase_data;
+        phase_blob->SetHandle(handle);
+        RETURN_ON_NEQ(phases_[p].conv_impl->DoForward(inputs, {phase_blob}), TNN_OK);
+
+        // scatter the phase into every stride-th row and column of the output
+        const float *src = phase_data;
+        X86ParallelFor(0, batch * oc, [&](int nc, int thread_id) {
+            const float *src_nc = src + (size_t)nc * rows * cols;
+            float *dst_nc       = output + (size_t)nc * out_h * out_w;
+            for (int y = 0; y < ay.size; ++y) {
+                const float *src_y = src_nc + y * cols;
+                float *dst_y       = dst_nc + (ay.start + y * sh) * out_w + ax.start;
+                for (int x = 0; x < ax.size; ++x) {
+                    dst_y[x * sw] = src_y[x];
+                }
+            }
+        });
+        phase_data += (size_t)batch * oc * rows * cols;
+    }
+
+    return TNN_OK;
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,59 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef TNN_SOURCE_TNN_DEVICE_X86_X86_DECONV_LAYER_STRIDE_H_
+#define TNN_SOURCE_TNN_DEVICE_X86_X86_DECONV_LAYER_STRIDE_H_
+
+#include <memory>
+#include <vector>
+
+#include "tnn/device/x86/acc/x86_layer_acc.h"
+
+namespace TNN_NS {
+
+// sub-pixel deconv: a deconv with stride s is split into s_h * s_w stride 1 convs,
+// one per output phase, each conv writes every s-th row and column of the output
+class X86DeconvLayerStride : public X86LayerAcc {
+public:
+    virtual ~X86DeconvLayerStride();
+
+    Status Init(Context *context, LayerParam *param, LayerResource *resource, const std::vector<Blob *> &inputs,
+                const std::vector<Blob *> &outputs);
+
+    virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+
+    // fp32 deconv without dilation, the kernel covers the stride and the pads leave every phase a causal kernel
+    static bool isPrefered(ConvLayerParam *param, const std::vector<Blob *> &inputs,
+                           const std::vector<Blob *> &outputs);
+
+protected:
+    struct DeconvPhase {
+        // kernel offset of the phase, the phase conv uses every stride-th kernel tap from it
+        int phase_y                            = 0;
+        int phase_x                            = 0;
+        std::shared_ptr<ConvLayerParam> param  = nullptr;
+        std::shared_ptr<X86LayerAcc> conv_impl = nullptr;
+        std::shared_ptr<Blob> output           = nullptr;
+    };
+
+    Status CreatePhase(int phase_y, int phase_x, const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+
+    std::vector<DeconvPhase> phases_;
+    // outputs of the phase convs, the convs use the shared workspace themselves
+    RawBuffer buffer_phase_;
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_SOURCE_TNN_DEVICE_X86_X86_DECONV_LAYER_STRIDE_H_
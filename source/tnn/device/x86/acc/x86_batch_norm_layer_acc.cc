@@ -42,6 +42,11 @@ Status X86BatchNormLayerAcc::Init(Context *context, LayerParam *param, LayerReso
     return TNN_OK;
 }
 
+// X86_FMA scales every element on its own
+bool X86BatchNormLayerAcc::SupportInPlace(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    return inputs.size() == 1 && IsSameDimsFloat(inputs, outputs);
+}
+
 Status X86BatchNormLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     
     auto resource = dynamic_cast<BatchNormLayerResource *>(resource_);
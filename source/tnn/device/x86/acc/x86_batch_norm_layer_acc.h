@@ -27,6 +27,8 @@ public:
                 const std::vector<Blob *> &outputs) override;
     virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
 
+    virtual bool SupportInPlace(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
+
 protected:
     std::shared_ptr<LayerResource> bn_acc_f32_resource_ = nullptr;
 };
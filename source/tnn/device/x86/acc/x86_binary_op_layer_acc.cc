@@ -712,6 +712,18 @@ Status X86BinaryOpLayerAcc::Reshape(const std::vector<Blob *> &inputs, const std
     return TNN_OK;
 }
 
+/*
+the output may share the memory of inputs[0], DoForward copies the inputs which are read after the output is written
+*/
+bool X86BinaryOpLayerAcc::SupportInPlace(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    for (auto input : inputs) {
+        if (input->GetBlobDesc().data_type != DATA_TYPE_FLOAT) {
+            return false;
+        }
+    }
+    return IsSameDimsFloat(inputs, outputs);
+}
+
 Status X86BinaryOpLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     auto layer_param = dynamic_cast<MultidirBroadcastLayerParam *>(param_);
     if (!layer_param) {
@@ -752,11 +764,35 @@ Status X86BinaryOpLayerAcc::DoForward(const std::vector<Blob *> &inputs, const s
     if (btype_ == BroadcastTypeUnknown) {
         LOGE("Error: unknown broadcast type\n");
         return Status(TNNERR_LAYER_ERR, "Error: Binary layer unknown broadcast type");
-    } else if (btype_ == BroadcastTypeGeneral) {
-        auto output_ptr = reinterpret_cast<float *>(output->GetHandle().base);
+    }
+
+    /*
+    in place the output shares the memory of inputs[0]. The binary func reads both inputs of an element before writing
+    it, while the general func copies the first input to the output and applies the others to the output afterwards,
+    so every aliased input read after the output is written is copied to the workspace first.
+    */
+    auto output_ptr = reinterpret_cast<float *>(output->GetHandle().base);
+    bool general    = btype_ == BroadcastTypeGeneral || (!DimsVectorUtils::Equal(dims, input_shapes_[0]) &&
+                                                      !DimsVectorUtils::Equal(dims, input_shapes_[1]));
+    float *input_copy = nullptr;
+    for (int i = 0; i < input_ptrs.size(); i++) {
+        if (input_ptrs[i] != output_ptr) {
+            continue;
+        }
+        if (DimsVectorUtils::Equal(dims, input_shapes_[i]) && (i == 0 || (i == 1 && !general))) {
+            continue;
+        }
+        if (!input_copy) {
+            size_t bytes = DimsVectorUtils::Count(input_shapes_[i]) * sizeof(float);
+            input_copy   = reinterpret_cast<float *>(context_->GetSharedWorkSpace(bytes));
+            memcpy(input_copy, output_ptr, bytes);
+        }
+        input_ptrs[i] = input_copy;
+    }
+
+    if (btype_ == BroadcastTypeGeneral) {
         binary_general_func_(dims, input_shapes_, output_ptr, input_ptrs);
     } else {
-        auto output_ptr = reinterpret_cast<float *>(output->GetHandle().base);
         auto input0_ptr = reinterpret_cast<float *>(input_ptrs[0]);
         auto input1_ptr = reinterpret_cast<float *>(input_ptrs[1]);
 
@@ -778,7 +814,7 @@ Status X86BinaryOpLayerAcc::DoForward(const std::vector<Blob *> &inputs, const s
         }
 
         for (int i = 2; i < input_ptrs.size(); i++) {
-            DimsVector input0_pad_shape;
+            DimsVector input0_pad_shape(dims.size());
             auto input_ptr = reinterpret_cast<float *>(input_ptrs[i]);
             PadShape(dims.size() - input_shapes_[i].size(), dims.size(), input0_pad_shape, input_shapes_[i]);
             binary_func_(output_ptr, output_ptr, input_ptr, dims, input0_pad_shape, output->GetBlobDesc().dims);
@@ -51,6 +51,8 @@ public:
                 const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
 
     virtual Status Reshape(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
+
+    virtual bool SupportInPlace(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
 protected:
     // Calculate Function
     Status Calculate(const std::vector<Blob *> &input_blobs, const std::vector<void *> &input_ptrs,
@@ -16,6 +16,7 @@
 #include "tnn/device/x86/acc/compute/x86_compute.h"
 #include "tnn/device/x86/acc/convolution/x86_conv_int8_layer_common.h"
 #include "tnn/device/x86/acc/convolution/x86_conv_layer_common.h"
+#include "tnn/device/x86/x86_thread_pool.h"
 #include "tnn/interpreter/layer_resource_generator.h"
 
 namespace TNN_NS {
@@ -59,7 +60,22 @@ Status X86Conv1DLayerAcc::Init(Context *context, LayerParam *param, LayerResourc
     if (!conv_acc_impl_) {
         return Status(TNNERR_NET_ERR, "Could not create conv impl_");
     }
-    ret = conv_acc_impl_->Init(context_, param_, resource_, inputs, outputs);
+
+    // causal conv1d, all pads on the left and stride 1, the left pads are the history in stateful forward
+    const int kernel_extent = conv1d_param->dialations[0] * (conv1d_param->kernels[0] - 1) + 1;
+    if (context->GetEnableStatefulForward() && conv1d_param->pad_type == -1 && conv1d_param->strides[0] == 1 &&
+        conv1d_param->pads[0] > 0 && conv1d_param->pads[0] == kernel_extent - 1 && conv1d_param->pads[1] == 0) {
+        history_size_ = conv1d_param->pads[0];
+        stream_param_ = std::make_shared<ConvLayerParam>(*conv2d_param);
+        stream_param_->pads = {0, 0, 0, 0};
+
+        BlobDesc desc = inputs[0]->GetBlobDesc();
+        desc.dims[2] += history_size_;
+        stream_input_ = std::make_shared<Blob>(desc);
+        ret = conv_acc_impl_->Init(context_, stream_param_.get(), resource_, {stream_input_.get()}, outputs);
+    } else {
+        ret = conv_acc_impl_->Init(context_, param_, resource_, inputs, outputs);
+    }
 
     // converted weights are assumed to be packed, and can be freed now
     if (conv_acc_f32_resource_) {
@@ -71,11 +87,51 @@ Status X86Conv1DLayerAcc::Init(Context *context, LayerParam *param, LayerResourc
 }
 
 Status X86Conv1DLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
-    if (conv_acc_impl_) {
-        return conv_acc_impl_->DoForward(inputs, outputs);
-    } else {
+    if (!conv_acc_impl_) {
         return Status(TNNERR_CONTEXT_ERR, "conv_acc_impl_ is nil");
     }
+    if (!stream_input_) {
+        return conv_acc_impl_->DoForward(inputs, outputs);
+    }
+
+    auto dims         = inputs[0]->GetBlobDesc().dims;
+    const int planes  = dims[0] * dims[1];
+    const int length  = dims[2];
+    const int history = history_size_;
+    const int extent  = history + length;
+
+    // a new stream or a batch change starts from zero history, same as the zero pads
+    const int history_bytes = planes * history * sizeof(float);
+    const int stream_bytes  = planes * extent * sizeof(float);
+    if (buffer_history_.GetBytesSize() != history_bytes) {
+        buffer_history_ = RawBuffer(history_bytes);
+    }
+    if (buffer_stream_.GetBytesSize() < stream_bytes) {
+        buffer_stream_ = RawBuffer(stream_bytes);
+    }
+
+    const float *input_data = reinterpret_cast<float *>(inputs[0]->GetHandle().base);
+    float *history_data     = buffer_history_.force_to<float *>();
+    float *stream_data      = buffer_stream_.force_to<float *>();
+    X86ParallelFor(0, planes, [&](int p, int thread_id) {
+        float *stream_p  = stream_data + p * extent;
+        float *history_p = history_data + p * history;
+        memcpy(stream_p, history_p, history * sizeof(float));
+        memcpy(stream_p + history, input_data + p * length, length * sizeof(float));
+        memcpy(history_p, stream_p + length, history * sizeof(float));
+    });
+
+    dims[2] += history;
+    stream_input_->GetBlobDesc().dims = dims;
+    BlobHandle handle;
+    handle.base = stream_data;
+    stream_input_->SetHandle(handle);
+    return conv_acc_impl_->DoForward({stream_input_.get()}, outputs);
+}
+
+Status X86Conv1DLayerAcc::ResetState() {
+    buffer_history_ = RawBuffer();
+    return TNN_OK;
 }
 
 REGISTER_X86_ACC(Conv1D, LAYER_CONVOLUTION_1D);
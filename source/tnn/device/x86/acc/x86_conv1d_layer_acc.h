@@ -32,9 +32,19 @@ public:
 
     virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
 
+    virtual Status ResetState() override;
+
 protected:
     std::shared_ptr<X86LayerAcc> conv_acc_impl_ = nullptr;
     std::shared_ptr<LayerResource> conv_acc_f32_resource_ = nullptr;
+
+    // stateful forward of a causal conv1d, the impl runs without pads on the last frames of the previous
+    // forward followed by the input, the frames are kept in buffer_history_ as [batch, channel, history_size_]
+    int history_size_ = 0;
+    std::shared_ptr<ConvLayerParam> stream_param_ = nullptr;
+    std::shared_ptr<Blob> stream_input_ = nullptr;
+    RawBuffer buffer_stream_;
+    RawBuffer buffer_history_;
 };
 
 }   // namespace TNN_NS
@@ -0,0 +1,340 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "tnn/device/x86/acc/x86_conv_3d_layer_acc.h"
+#include "tnn/device/x86/acc/Float4.h"
+#include "tnn/device/x86/acc/Float8.h"
+#include "tnn/device/x86/acc/compute/x86_compute.h"
+#include "tnn/device/x86/x86_context.h"
+#include "tnn/device/x86/x86_thread_pool.h"
+#include "tnn/interpreter/layer_resource_generator.h"
+#include "tnn/utils/data_type_utils.h"
+
+namespace TNN_NS {
+
+/*
+accumulate one depthwise channel, output rows are built tap by tap,
+so the inner loop runs over contiguous output pixels and is vectorized when stride_w == 1
+*/
+template <typename VEC, int pack>
+static void X86DepthwiseConv3D(float *dst, const float *src, const float *weight, const DimsVector &dims_input,
+                               const DimsVector &dims_output, ConvLayerParam *param) {
+    const int id = dims_input[2], ih = dims_input[3], iw = dims_input[4];
+    const int od = dims_output[2], oh = dims_output[3], ow = dims_output[4];
+    const int kw = param->kernels[0], kh = param->kernels[1], kd = param->kernels[2];
+    const int sw = param->strides[0], sh = param->strides[1], sd = param->strides[2];
+    const int dw = param->dialations[0], dh = param->dialations[1], dd = param->dialations[2];
+    const int pw = param->pads[0], ph = param->pads[2], pd = param->pads[4];
+
+    for (int d = 0; d < od; d++) {
+        for (int h = 0; h < oh; h++) {
+            float *dst_h = dst + (d * oh + h) * ow;
+            memset(dst_h, 0, ow * sizeof(float));
+            for (int z = 0; z < kd; z++) {
+                int src_d = d * sd - pd + z * dd;
+                if (src_d < 0 || src_d >= id) {
+                    continue;
+                }
+                for (int y = 0; y < kh; y++) {
+                    int src_y = h * sh - ph + y * dh;
+                    if (src_y < 0 || src_y >= ih) {
+                        continue;
+                    }
+                    const float *src_h     = src + (src_d * ih + src_y) * iw;
+                    const float *weight_zy = weight + (z * kh + y) * kw;
+                    for (int x = 0; x < kw; x++) {
+                        int w_base  = x * dw - pw;
+                        int w_start = MIN(ow, MAX(0, UP_DIV(-w_base, sw)));
+                        int w_end   = MAX(w_start, MIN(ow, UP_DIV(iw - w_base, sw)));
+                        float w_val = weight_zy[x];
+                        int w       = w_start;
+                        if (sw == 1) {
+                            VEC w_v(w_val);
+                            const float *src_x = src_h + w_base;
+                            for (; w + pack - 1 < w_end; w += pack) {
+                                VEC acc_v = VEC::loadu(dst_h + w);
+                                VEC::mla(acc_v, VEC::loadu(src_x + w), w_v);
+                                VEC::saveu(dst_h + w, acc_v);
+                            }
+                        }
+                        for (; w < w_end; w++) {
+                            dst_h[w] += src_h[w_base + w * sw] * w_val;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+X86Conv3DLayerAcc::~X86Conv3DLayerAcc() {}
+
+std::vector<DataFormat> X86Conv3DLayerAcc::SupportDataFormat(DataType data_type, int dims_size,
+                                                             BlobType blob_type) {
+    std::vector<DataFormat> support_list;
+    if (dims_size == 5 && data_type == DATA_TYPE_FLOAT) {
+        support_list.push_back(DATA_FORMAT_NCDHW);
+    }
+    return support_list;
+}
+
+Status X86Conv3DLayerAcc::Init(Context *context, LayerParam *param, LayerResource *resource,
+                               const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto conv_param = dynamic_cast<ConvLayerParam *>(param);
+    CHECK_PARAM_NULL(conv_param);
+    auto conv_resource = dynamic_cast<ConvLayerResource *>(resource);
+    CHECK_PARAM_NULL(conv_resource);
+
+    if (inputs[0]->GetBlobDesc().data_type != DATA_TYPE_FLOAT) {
+        return Status(TNNERR_LAYER_ERR, "Conv3D only support float datatype");
+    }
+    // the sgemm kernels only fuse relu and relu6
+    if (conv_param->activation_type != ActivationType_None && conv_param->activation_type != ActivationType_ReLU &&
+        conv_param->activation_type != ActivationType_ReLU6) {
+        return Status(TNNERR_LAYER_ERR, "Conv3D only support activation relu and relu6 on x86");
+    }
+
+    Status ret;
+    if (conv_resource->filter_handle.GetDataType() == DATA_TYPE_HALF) {
+        LayerResource *fp32_res = nullptr;
+        RETURN_ON_NEQ(ConvertHalfResource(LAYER_CONVOLUTION_3D, conv_resource, &fp32_res), TNN_OK);
+        conv_acc_f32_resource_ = std::shared_ptr<LayerResource>(fp32_res);
+        ret = X86LayerAcc::Init(context, param, conv_acc_f32_resource_.get(), inputs, outputs);
+    } else {
+        ret = X86LayerAcc::Init(context, param, resource, inputs, outputs);
+    }
+    if (ret != TNN_OK) {
+        return ret;
+    }
+
+    auto dims_input  = inputs[0]->GetBlobDesc().dims;
+    auto dims_output = outputs[0]->GetBlobDesc().dims;
+    is_depthwise_ = conv_param->group != 1 && conv_param->group == dims_input[1] &&
+                    conv_param->group == dims_output[1];
+
+    if (is_depthwise_) {
+        switch (conv_param->activation_type) {
+            case ActivationType_None:
+                post_func_ = (arch_ == avx2) ? X86_Post_Exec<ActivationType_None, Float8, 8>
+                                             : X86_Post_Exec<ActivationType_None, Float4, 4>;
+                break;
+            case ActivationType_ReLU:
+                post_func_ = (arch_ == avx2) ? X86_Post_Exec<ActivationType_ReLU, Float8, 8>
+                                             : X86_Post_Exec<ActivationType_ReLU, Float4, 4>;
+                break;
+            case ActivationType_ReLU6:
+                post_func_ = (arch_ == avx2) ? X86_Post_Exec<ActivationType_ReLU6, Float8, 8>
+                                             : X86_Post_Exec<ActivationType_ReLU6, Float4, 4>;
+                break;
+            default:
+                break;
+        }
+    }
+
+    conv_gemm_conf_ = conv_gemm_config<float, float, float>();
+    RETURN_ON_NEQ(allocateBufferWeight(inputs, outputs), TNN_OK);
+    RETURN_ON_NEQ(allocateBufferBias(inputs, outputs), TNN_OK);
+
+    // converted weights are packed, and can be freed now
+    if (conv_acc_f32_resource_) {
+        conv_acc_f32_resource_.reset();
+        resource_ = nullptr;
+    }
+
+    return TNN_OK;
+}
+
+Status X86Conv3DLayerAcc::Reshape(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto param = dynamic_cast<ConvLayerParam *>(param_);
+    CHECK_PARAM_NULL(param);
+
+    bool is_1x1x1 = true;
+    for (int i = 0; i < 3; i++) {
+        is_1x1x1 = is_1x1x1 && param->kernels[i] == 1 && param->strides[i] == 1;
+    }
+    for (auto pad : param->pads) {
+        is_1x1x1 = is_1x1x1 && pad == 0;
+    }
+    do_vol2col_ = !is_1x1x1;
+
+    return TNN_OK;
+}
+
+Status X86Conv3DLayerAcc::allocateBufferWeight(const std::vector<Blob *> &inputs,
+                                               const std::vector<Blob *> &outputs) {
+    ConvLayerParam *param = dynamic_cast<ConvLayerParam *>(param_);
+    CHECK_PARAM_NULL(param);
+    ConvLayerResource *conv_res = dynamic_cast<ConvLayerResource *>(resource_);
+    CHECK_PARAM_NULL(conv_res);
+
+    auto dims_input  = inputs[0]->GetBlobDesc().dims;
+    auto dims_output = outputs[0]->GetBlobDesc().dims;
+
+    if (!buffer_weight_.GetBytesSize()) {
+        if (conv_res->filter_handle.GetDataType() != DATA_TYPE_FLOAT) {
+            LOGE("Error: DataType %d not support\n", conv_res->filter_handle.GetDataType());
+            return Status(TNNERR_MODEL_ERR, "conv_res DataType is not supported");
+        }
+        const float *src = conv_res->filter_handle.force_to<float *>();
+        int kernel_size  = param->kernels[0] * param->kernels[1] * param->kernels[2];
+
+        if (is_depthwise_) {
+            // direct kernel reads weights as they are
+            RawBuffer temp_buffer(dims_output[1] * kernel_size * sizeof(float));
+            memcpy(temp_buffer.force_to<float *>(), src, dims_output[1] * kernel_size * sizeof(float));
+            temp_buffer.SetDataType(DATA_TYPE_FLOAT);
+            buffer_weight_ = temp_buffer;
+            return TNN_OK;
+        }
+
+        int k_c     = conv_gemm_conf_.K_c_;
+        int n_block = conv_gemm_conf_.n_block_;
+        int K       = dims_input[1] * kernel_size / param->group;
+        int M       = dims_output[1] / param->group;
+        size_t weight_pack_per_group = ROUND_UP(K, k_c) * ROUND_UP(M, n_block);
+
+        RawBuffer temp_buffer(weight_pack_per_group * param->group * sizeof(float));
+        float *dst = temp_buffer.force_to<float *>();
+        for (int g = 0; g < param->group; g++) {
+            auto src_g = src + K * M * g;
+            auto dst_g = dst + weight_pack_per_group * g;
+            conv_pack_col_b_n(M, K, src_g, K, dst_g, conv_gemm_conf_);
+        }
+        temp_buffer.SetDataType(DATA_TYPE_FLOAT);
+        buffer_weight_ = temp_buffer;
+    }
+    return TNN_OK;
+}
+
+Status X86Conv3DLayerAcc::allocateBufferBias(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    ConvLayerParam *conv_param = dynamic_cast<ConvLayerParam *>(param_);
+    CHECK_PARAM_NULL(conv_param);
+    ConvLayerResource *conv_res = dynamic_cast<ConvLayerResource *>(resource_);
+    CHECK_PARAM_NULL(conv_res);
+
+    if (!buffer_bias_.GetBytesSize()) {
+        auto dims_output    = outputs[0]->GetBlobDesc().dims;
+        int total_byte_size = ROUND_UP(dims_output[1], 8) * sizeof(float);
+        RawBuffer temp_buffer(total_byte_size);
+        if (conv_param->bias) {
+            memcpy(temp_buffer.force_to<float *>(), conv_res->bias_handle.force_to<float *>(),
+                   conv_res->bias_handle.GetBytesSize());
+        }
+        buffer_bias_ = temp_buffer;
+    }
+    return TNN_OK;
+}
+
+Status X86Conv3DLayerAcc::ExecGemm(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto param       = dynamic_cast<ConvLayerParam *>(param_);
+    auto input_dims  = inputs[0]->GetBlobDesc().dims;
+    auto output_dims = outputs[0]->GetBlobDesc().dims;
+
+    const int in_spatial  = DimsVectorUtils::Count(input_dims, 2);
+    const int out_spatial = DimsVectorUtils::Count(output_dims, 2);
+    const int kernel_size = param->kernels[0] * param->kernels[1] * param->kernels[2];
+
+    int K = input_dims[1] * kernel_size / param->group;
+    int M = output_dims[1] / param->group;
+    int N = out_spatial;
+
+    int max_num_threads = X86ThreadPool::GetMaxThreadsNum();
+    conv_ajust_m_blk_size(max_num_threads, N, conv_gemm_conf_.M_c_);
+
+    int m_c     = conv_gemm_conf_.M_c_;
+    int k_c     = conv_gemm_conf_.K_c_;
+    int n_block = conv_gemm_conf_.n_block_;
+    size_t weight_offset_per_group = ROUND_UP(K, k_c) * ROUND_UP(M, n_block);
+
+    size_t col_offset     = (size_t)K * N;
+    size_t vol2col_size   = do_vol2col_ ? ROUND_UP(col_offset * param->group * sizeof(float), 32) : 0;
+    size_t workspace_size = vol2col_size + ROUND_UP(m_c * k_c * max_num_threads * sizeof(float), 32);
+    float *workspace      = reinterpret_cast<float *>(context_->GetSharedWorkSpace(workspace_size));
+    float *col_workspace       = workspace;
+    float *src_trans_workspace = workspace + vol2col_size / sizeof(float);
+
+    auto input_data   = static_cast<float *>(inputs[0]->GetHandle().base);
+    auto output_data  = static_cast<float *>(outputs[0]->GetHandle().base);
+    auto weights_data = buffer_weight_.force_to<float *>();
+    auto bias_data    = buffer_bias_.force_to<float *>();
+
+    for (int b = 0; b < output_dims[0]; b++) {
+        float *input_b = input_data + (size_t)b * input_dims[1] * in_spatial;
+        float *col     = input_b;
+        if (do_vol2col_) {
+            X86_VOL2COL(input_b, input_dims[1], input_dims[2], input_dims[3], input_dims[4], output_dims[2],
+                        output_dims[3], output_dims[4], param->kernels[2], param->kernels[1], param->kernels[0],
+                        param->pads[4], param->pads[2], param->pads[0], param->strides[2], param->strides[1],
+                        param->strides[0], param->dialations[2], param->dialations[1], param->dialations[0],
+                        col_workspace);
+            col = col_workspace;
+        }
+
+        for (int g = 0; g < param->group; g++) {
+            conv_sgemm_nn_col_major_prepack_b(N, M, K, col + col_offset * g, N,
+                                              weights_data + weight_offset_per_group * g, K,
+                                              output_data + ((size_t)b * param->group + g) * M * N, N,
+                                              bias_data + g * M, param->activation_type, src_trans_workspace,
+                                              conv_gemm_conf_);
+        }
+    }
+
+    return TNN_OK;
+}
+
+Status X86Conv3DLayerAcc::ExecDepthwise(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto param       = dynamic_cast<ConvLayerParam *>(param_);
+    auto input_dims  = inputs[0]->GetBlobDesc().dims;
+    auto output_dims = outputs[0]->GetBlobDesc().dims;
+
+    const int channel     = output_dims[1];
+    const int in_spatial  = DimsVectorUtils::Count(input_dims, 2);
+    const int out_spatial = DimsVectorUtils::Count(output_dims, 2);
+    const int kernel_size = param->kernels[0] * param->kernels[1] * param->kernels[2];
+
+    auto input_data   = static_cast<float *>(inputs[0]->GetHandle().base);
+    auto output_data  = static_cast<float *>(outputs[0]->GetHandle().base);
+    auto weights_data = buffer_weight_.force_to<float *>();
+    auto bias_data    = buffer_bias_.force_to<float *>();
+
+    auto dw_func = X86DepthwiseConv3D<Float4, 4>;
+    if (arch_ == avx2) {
+        dw_func = X86DepthwiseConv3D<Float8, 8>;
+    }
+
+    X86ParallelFor(0, output_dims[0] * channel, [&](int nc, int thread_id) {
+        int c          = nc % channel;
+        float *dst_ptr = output_data + (size_t)nc * out_spatial;
+        dw_func(dst_ptr, input_data + (size_t)nc * in_spatial, weights_data + c * kernel_size, input_dims,
+                output_dims, param);
+        post_func_(dst_ptr, bias_data + c, 1, out_spatial);
+    });
+
+    return TNN_OK;
+}
+
+Status X86Conv3DLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    if (outputs[0]->GetBlobDesc().data_type != DATA_TYPE_FLOAT) {
+        return Status(TNNERR_DEVICE_ACC_DATA_FORMAT_NOT_SUPPORT, "Error: x86 device not support this data type");
+    }
+
+    if (is_depthwise_) {
+        return ExecDepthwise(inputs, outputs);
+    }
+    return ExecGemm(inputs, outputs);
+}
+
+REGISTER_X86_ACC(Conv3D, LAYER_CONVOLUTION_3D);
+
+}  // namespace TNN_NS
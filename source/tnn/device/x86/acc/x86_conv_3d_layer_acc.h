@@ -0,0 +1,61 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef TNN_SOURCE_TNN_DEVICE_X86_ACC_X86_CONV_3D_LAYER_ACC_H
+#define TNN_SOURCE_TNN_DEVICE_X86_ACC_X86_CONV_3D_LAYER_ACC_H
+
+#include <vector>
+
+#include "tnn/core/blob.h"
+#include "tnn/device/x86/acc/x86_layer_acc.h"
+#include "tnn/device/x86/acc/compute/jit/conv_sgemm_driver.h"
+#include "tnn/device/x86/x86_device.h"
+
+namespace TNN_NS {
+
+// @brief conv3d x86 acc, float only
+// depthwise conv3d runs a direct kernel, the others run vol2col + conv sgemm.
+// 1x1x1 conv with stride 1 and no pads skips vol2col and feeds the input to sgemm directly.
+class X86Conv3DLayerAcc : public X86LayerAcc {
+public:
+    virtual ~X86Conv3DLayerAcc();
+
+    Status Init(Context *context, LayerParam *param, LayerResource *resource, const std::vector<Blob *> &inputs,
+                const std::vector<Blob *> &outputs) override;
+
+    virtual Status Reshape(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
+
+    virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
+
+    virtual std::vector<DataFormat> SupportDataFormat(DataType data_type, int dims_size, BlobType blob_type) override;
+
+private:
+    Status allocateBufferWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+    Status allocateBufferBias(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+
+    Status ExecGemm(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+    Status ExecDepthwise(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+
+    bool is_depthwise_ = false;
+    bool do_vol2col_   = true;
+    RawBuffer buffer_weight_;
+    RawBuffer buffer_bias_;
+    conv_gemm_config<float, float, float> conv_gemm_conf_;
+    void (*post_func_)(float *, const float *, long, long) = nullptr;
+    std::shared_ptr<LayerResource> conv_acc_f32_resource_ = nullptr;
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_SOURCE_TNN_DEVICE_X86_ACC_X86_CONV_3D_LAYER_ACC_H
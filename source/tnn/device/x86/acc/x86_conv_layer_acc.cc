@@ -13,9 +13,17 @@
 // specific language governing permissions and limitations under the License.
 
 #include "x86_conv_layer_acc.h"
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+
 #include "tnn/device/x86/acc/compute/x86_compute.h"
 #include "tnn/device/x86/acc/convolution/x86_conv_layer_acc_factory.h"
+#include "tnn/device/x86/acc/convolution/x86_conv_layer_common.h"
+#include "tnn/device/x86/x86_context.h"
 #include "tnn/interpreter/layer_resource_generator.h"
+#include "tnn/utils/dims_vector_utils.h"
 
 namespace TNN_NS {
 
@@ -52,8 +60,9 @@ Status X86ConvLayerAcc::Init(Context *context, LayerParam *param, LayerResource
     }
     ret = conv_acc_impl_->Init(context_, param_, resource_, inputs, outputs);
 
-    // converted weights are assumed to be packed, and can be freed now
-    if (conv_acc_f32_resource_) {
+    // converted weights are assumed to be packed, and can be freed now.
+    // kernel tuning packs them again for every candidate, so keep them in that case
+    if (conv_acc_f32_resource_ && !context_->GetEnableTuneKernel()) {
         conv_acc_f32_resource_.reset();
         resource_ = nullptr;
     }
@@ -61,6 +70,150 @@ Status X86ConvLayerAcc::Init(Context *context, LayerParam *param, LayerResource
     return ret;
 }
 
+Status X86ConvLayerAcc::Reshape(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    // X86LayerAcc::Init calls Reshape before the impl is created
+    if (!conv_acc_impl_ || !context_->GetEnableTuneKernel() || !resource_) {
+        return TNN_OK;
+    }
+    if (inputs[0]->GetBlobDesc().data_type != DATA_TYPE_FLOAT) {
+        return TNN_OK;
+    }
+    return TuneImp(inputs, outputs);
+}
+
+static std::string GenerateTuneKey(ConvLayerParam *param, const DimsVector &input_dims, const DimsVector &output_dims,
+                                   int num_threads) {
+    std::ostringstream key;
+    key << "conv";
+    for (auto dim : input_dims) {
+        key << "_" << dim;
+    }
+    for (auto dim : output_dims) {
+        key << "_" << dim;
+    }
+    key << "_k";
+    for (auto value : param->kernels) {
+        key << "_" << value;
+    }
+    key << "_s";
+    for (auto value : param->strides) {
+        key << "_" << value;
+    }
+    key << "_d";
+    for (auto value : param->dialations) {
+        key << "_" << value;
+    }
+    key << "_p";
+    for (auto value : param->pads) {
+        key << "_" << value;
+    }
+    key << "_g_" << param->group << "_a_" << param->activation_type << "_t_" << num_threads;
+    return key.str();
+}
+
+Status X86ConvLayerAcc::TuneImp(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto x86_context = dynamic_cast<X86Context *>(context_);
+    CHECK_PARAM_NULL(x86_context);
+    auto conv_param = dynamic_cast<ConvLayerParam *>(param_);
+    CHECK_PARAM_NULL(conv_param);
+
+    auto input_dims  = inputs[0]->GetBlobDesc().dims;
+    auto output_dims = outputs[0]->GetBlobDesc().dims;
+    auto key         = GenerateTuneKey(conv_param, input_dims, output_dims, x86_context->GetNumThreads());
+    if (key == tune_key_) {
+        return TNN_OK;
+    }
+
+    // each candidate is {imp type, gemm M_c, gemm K_c}
+    auto imp_types = X86ConvLayerAccFactory::GetImpTypesFP(inputs, outputs, param_);
+    std::vector<std::vector<int>> candidates;
+    auto &tune_map = x86_context->GetTuneMap();
+    auto iter      = tune_map.find(key);
+    if (iter != tune_map.end() && iter->second.size() == 3 &&
+        std::find(imp_types.begin(), imp_types.end(), (X86ConvImpType)iter->second[0]) != imp_types.end()) {
+        candidates.push_back(iter->second);
+    } else {
+        for (auto imp_type : imp_types) {
+            if (imp_type == X86_CONV_IMP_COMMON || imp_type == X86_CONV_IMP_1X1) {
+                for (int m_c : {32, 64, 128}) {
+                    for (int k_c : {128, 256, 512}) {
+                        candidates.push_back({imp_type, m_c, k_c});
+                    }
+                }
+            } else {
+                candidates.push_back({imp_type, 0, 0});
+            }
+        }
+    }
+
+    // run on scratch blobs, the network blobs may share memory with others
+    Blob tune_input(inputs[0]->GetBlobDesc(), true);
+    Blob tune_output(outputs[0]->GetBlobDesc(), true);
+    float *input_data = static_cast<float *>(tune_input.GetHandle().base);
+    CHECK_PARAM_NULL(input_data);
+    CHECK_PARAM_NULL(tune_output.GetHandle().base);
+    int input_count = DimsVectorUtils::Count(input_dims);
+    for (int i = 0; i < input_count; ++i) {
+        input_data[i] = (i % 17 - 8) * 0.125f;
+    }
+    std::vector<Blob *> tune_inputs  = {&tune_input};
+    std::vector<Blob *> tune_outputs = {&tune_output};
+
+    std::shared_ptr<X86LayerAcc> best_imp = nullptr;
+    std::vector<int> best_config;
+    double best_time = -1;
+    // weights packed by the candidates, the ones the best candidate does not use are released after tuning
+    std::set<std::string> packed_weight_keys;
+    if (conv_acc_impl_) {
+        packed_weight_keys = conv_acc_impl_->GetPackedWeightKeys();
+    }
+
+    x86_context->OnInstanceForwardBegin();
+    for (const auto &config : candidates) {
+        auto imp = X86ConvLayerAccFactory::CreateImpFP((X86ConvImpType)config[0]);
+        if (!imp) {
+            continue;
+        }
+        auto common_imp = dynamic_cast<X86ConvLayerCommon *>(imp.get());
+        if (common_imp) {
+            common_imp->SetGemmBlockSize(config[1], config[2]);
+        }
+        auto status = imp->Init(context_, param_, resource_, tune_inputs, tune_outputs);
+        auto &keys  = imp->GetPackedWeightKeys();
+        packed_weight_keys.insert(keys.begin(), keys.end());
+        if (status != TNN_OK) {
+            continue;
+        }
+        if (candidates.size() == 1) {
+            best_imp    = imp;
+            best_config = config;
+            break;
+        }
+        double time = imp->MeasureDoForward(tune_inputs, tune_outputs);
+        LOGD("conv %s imp %d m_c %d k_c %d: %.3f ms\n", key.c_str(), config[0], config[1], config[2], time);
+        if (time >= 0 && (best_time < 0 || time < best_time)) {
+            best_imp    = imp;
+            best_config = config;
+            best_time   = time;
+        }
+    }
+    x86_context->OnInstanceForwardEnd();
+
+    if (!best_imp) {
+        return Status(TNNERR_NET_ERR, "conv kernel tune failed");
+    }
+    auto &best_keys = best_imp->GetSharedWeightKeys();
+    for (const auto &packed_key : packed_weight_keys) {
+        if (best_keys.find(packed_key) == best_keys.end()) {
+            context_->ReleaseSharedWeights(packed_key);
+        }
+    }
+    conv_acc_impl_ = best_imp;
+    tune_map[key]  = best_config;
+    tune_key_      = key;
+    return TNN_OK;
+}
+
 Status X86ConvLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     if (conv_acc_impl_) {
         return conv_acc_impl_->DoForward(inputs, outputs);
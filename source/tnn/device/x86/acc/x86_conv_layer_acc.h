@@ -15,6 +15,7 @@
 #ifndef TNN_SOURCE_TNN_DEVICE_X86_ACC_X86_CONV_LAYER_ACC_H
 #define TNN_SOURCE_TNN_DEVICE_X86_ACC_X86_CONV_LAYER_ACC_H
 
+#include <string>
 #include <vector>
 
 #include "tnn/core/blob.h"
@@ -30,11 +31,18 @@ public:
     Status Init(Context *context, LayerParam *param, LayerResource *resource,
                 const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
 
+    virtual Status Reshape(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
+
     virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
 
 protected:
+    // pick the fastest impl and gemm blocking for the current shapes, results are cached in the context
+    Status TuneImp(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+
     std::shared_ptr<X86LayerAcc> conv_acc_impl_ = nullptr;
     std::shared_ptr<LayerResource> conv_acc_f32_resource_ = nullptr;
+    // key of the shapes conv_acc_impl_ was tuned for
+    std::string tune_key_ = "";
 };
 
 }   // namespace TNN_NS
@@ -14,6 +14,7 @@
 
 #include "tnn/device/x86/acc/x86_deconv_layer_acc.h"
 #include "tnn/device/x86/acc/deconvolution/x86_deconv_layer_common.h"
+#include "tnn/device/x86/acc/deconvolution/x86_deconv_layer_stride.h"
 #include "tnn/interpreter/layer_resource_generator.h"
 
 namespace TNN_NS {
@@ -39,7 +40,11 @@ Status X86DeconvLayerAcc::Init(Context *context, LayerParam *param, LayerResourc
     }
 
     if (!conv_acc_impl_) {
-        conv_acc_impl_ = std::make_shared<X86DeconvLayerCommon>();
+        if (X86DeconvLayerStride::isPrefered(conv_param, inputs, outputs)) {
+            conv_acc_impl_ = std::make_shared<X86DeconvLayerStride>();
+        } else {
+            conv_acc_impl_ = std::make_shared<X86DeconvLayerCommon>();
+        }
     }
 
     if (!conv_acc_impl_) {
@@ -13,16 +13,66 @@
 // specific language governing permissions and limitations under the License.
 
 #include "tnn/device/x86/acc/x86_layer_acc.h"
+#include "tnn/device/x86/x86_thread_pool.h"
 #include "tnn/utils/naive_compute.h"
 
+#include <immintrin.h>
+
 namespace TNN_NS {
 
 DECLARE_X86_ACC(DetectionOutput, LAYER_DETECTION_OUTPUT);
 
+/*
+jaccard overlap of bbox against 8 kept boxes at a time, same arithmetic as JaccardOverlap,
+the last boxes are read with a masked load and the lanes past the end are ignored
+*/
+static bool X86AnyJaccardOverlapAVX2(const NormalizedBBox &bbox, const float bbox_size, const BBoxArray &bboxes,
+                                     const float threshold) {
+    const int count       = bboxes.count();
+    const __m256 v_xmin   = _mm256_set1_ps(bbox.xmin());
+    const __m256 v_ymin   = _mm256_set1_ps(bbox.ymin());
+    const __m256 v_xmax   = _mm256_set1_ps(bbox.xmax());
+    const __m256 v_ymax   = _mm256_set1_ps(bbox.ymax());
+    const __m256 v_size   = _mm256_set1_ps(bbox_size);
+    const __m256 v_thresh = _mm256_set1_ps(threshold);
+    const __m256 v_zero   = _mm256_setzero_ps();
+    const __m256i v_lane  = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    for (int i = 0; i < count; i += 8) {
+        const __m256i load_mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(count - i), v_lane);
+        __m256 xmin = _mm256_maskload_ps(bboxes.xmin.data() + i, load_mask);
+        __m256 ymin = _mm256_maskload_ps(bboxes.ymin.data() + i, load_mask);
+        __m256 xmax = _mm256_maskload_ps(bboxes.xmax.data() + i, load_mask);
+        __m256 ymax = _mm256_maskload_ps(bboxes.ymax.data() + i, load_mask);
+        __m256 size = _mm256_maskload_ps(bboxes.size.data() + i, load_mask);
+
+        __m256 width     = _mm256_sub_ps(_mm256_min_ps(v_xmax, xmax), _mm256_max_ps(v_xmin, xmin));
+        __m256 height    = _mm256_sub_ps(_mm256_min_ps(v_ymax, ymax), _mm256_max_ps(v_ymin, ymin));
+        __m256 intersect = _mm256_mul_ps(width, height);
+        __m256 overlap   = _mm256_div_ps(intersect, _mm256_sub_ps(_mm256_add_ps(v_size, size), intersect));
+        __m256 valid =
+            _mm256_and_ps(_mm256_cmp_ps(width, v_zero, _CMP_GT_OQ), _mm256_cmp_ps(height, v_zero, _CMP_GT_OQ));
+        overlap = _mm256_and_ps(overlap, valid);
+
+        __m256 suppress = _mm256_and_ps(_mm256_cmp_ps(overlap, v_thresh, _CMP_NLE_UQ),
+                                        _mm256_castsi256_ps(load_mask));
+        if (_mm256_movemask_ps(suppress)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 Status X86DetectionOutputLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     DetectionOutputLayerParam *param = dynamic_cast<DetectionOutputLayerParam *>(param_);
     CHECK_PARAM_NULL(param);
-    NaiveDetectionOutput(inputs, outputs, param);
+
+    // nms of the classes and images is spread over the threads
+    auto parallel_for = [](int count, const std::function<void(int)> &func) {
+        X86ParallelFor(0, count, [&](int i, int thread_id) { func(i); });
+    };
+    BBoxOverlapFunc overlap_func = (arch_ == avx2) ? X86AnyJaccardOverlapAVX2 : nullptr;
+    NaiveDetectionOutput(inputs, outputs, param, overlap_func, parallel_for);
     return TNN_OK;
 }
 
@@ -0,0 +1,279 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "tnn/device/x86/acc/x86_fused_dw_pw_conv_layer_acc.h"
+#include "tnn/device/x86/acc/Float4.h"
+#include "tnn/device/x86/acc/Float8.h"
+#include "tnn/device/x86/acc/compute/x86_compute.h"
+#include "tnn/device/x86/x86_common.h"
+#include "tnn/device/x86/x86_context.h"
+#include "tnn/device/x86/x86_thread_pool.h"
+#include "tnn/device/x86/x86_util.h"
+#include "tnn/interpreter/layer_resource_generator.h"
+#include "tnn/utils/data_type_utils.h"
+
+namespace TNN_NS {
+
+// bytes of depthwise output kept per thread, sized to stay in L2 together with the gemm panels
+static const int kFusedDwTileBytes = 64 * 1024;
+
+X86FusedDwPwConvLayerAcc::~X86FusedDwPwConvLayerAcc() {}
+
+Status X86FusedDwPwConvLayerAcc::Init(Context *context, LayerParam *param, LayerResource *resource,
+                                      const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto fused_param = dynamic_cast<FusedDwPwConvLayerParam *>(param);
+    CHECK_PARAM_NULL(fused_param);
+    auto fused_res = dynamic_cast<FusedDwPwConvLayerResource *>(resource);
+    CHECK_PARAM_NULL(fused_res);
+    CHECK_PARAM_NULL(fused_res->dw_resource.get());
+    CHECK_PARAM_NULL(fused_res->pw_resource.get());
+
+    Status ret;
+    if (fused_res->dw_resource->filter_handle.GetDataType() == DATA_TYPE_HALF ||
+        fused_res->pw_resource->filter_handle.GetDataType() == DATA_TYPE_HALF) {
+        LayerResource *fp32_res = nullptr;
+        RETURN_ON_NEQ(ConvertHalfResource(LAYER_FUSED_DW_PW_CONVOLUTION, fused_res, &fp32_res), TNN_OK);
+        fp32_resource_ = std::shared_ptr<LayerResource>(fp32_res);
+        ret = X86LayerAcc::Init(context, param, fp32_resource_.get(), inputs, outputs);
+    } else {
+        ret = X86LayerAcc::Init(context, param, resource, inputs, outputs);
+    }
+    if (ret != TNN_OK) {
+        return ret;
+    }
+
+    conv_gemm_conf_ = conv_gemm_config<float, float, float>();
+
+    RETURN_ON_NEQ(allocateBufferWeight(inputs, outputs), TNN_OK);
+    RETURN_ON_NEQ(allocateBufferBias(inputs, outputs), TNN_OK);
+
+    // converted weights are packed now and can be freed
+    if (fp32_resource_) {
+        fp32_resource_.reset();
+        resource_ = nullptr;
+    }
+    return TNN_OK;
+}
+
+Status X86FusedDwPwConvLayerAcc::allocateBufferWeight(const std::vector<Blob *> &inputs,
+                                                      const std::vector<Blob *> &outputs) {
+    auto param = dynamic_cast<FusedDwPwConvLayerParam *>(param_);
+    CHECK_PARAM_NULL(param);
+    auto res = dynamic_cast<FusedDwPwConvLayerResource *>(resource_);
+    CHECK_PARAM_NULL(res);
+
+    auto dw_res = res->dw_resource.get();
+    auto pw_res = res->pw_resource.get();
+    if (dw_res->filter_handle.GetDataType() != DATA_TYPE_FLOAT ||
+        pw_res->filter_handle.GetDataType() != DATA_TYPE_FLOAT) {
+        LOGE("Error: DataType %d not support\n", dw_res->filter_handle.GetDataType());
+        return Status(TNNERR_MODEL_ERR, "conv_res DataType is not supported");
+    }
+
+    const int channel        = inputs[0]->GetBlobDesc().dims[1];
+    const int output_channel = outputs[0]->GetBlobDesc().dims[1];
+
+    if (!dw_buffer_weight_.GetBytesSize()) {
+        const int kernel_size = param->dw_param->kernels[0] * param->dw_param->kernels[1];
+        const float *src      = dw_res->filter_handle.force_to<float *>();
+
+        int channel_rup = ROUND_UP(channel, 8);
+        if (arch_ == sse42) {
+            channel_rup = ROUND_UP(channel, 4);
+        }
+        RawBuffer temp_buffer(channel_rup * kernel_size * sizeof(float));
+        float *dst = temp_buffer.force_to<float *>();
+        if (arch_ == avx2) {
+            PackC8(dst, src, kernel_size, kernel_size, kernel_size, channel);
+        } else if (arch_ == sse42) {
+            PackC4(dst, src, kernel_size, kernel_size, kernel_size, channel);
+        }
+        temp_buffer.SetDataType(DATA_TYPE_FLOAT);
+        dw_buffer_weight_ = temp_buffer;
+    }
+
+    if (!pw_buffer_weight_.GetBytesSize()) {
+        int k_c     = conv_gemm_conf_.K_c_;
+        int n_block = conv_gemm_conf_.n_block_;
+        const float *src = pw_res->filter_handle.force_to<float *>();
+
+        RawBuffer temp_buffer(ROUND_UP(channel, k_c) * ROUND_UP(output_channel, n_block) * sizeof(float));
+        conv_pack_col_b_n(output_channel, channel, src, channel, temp_buffer.force_to<float *>(), conv_gemm_conf_);
+        temp_buffer.SetDataType(DATA_TYPE_FLOAT);
+        pw_buffer_weight_ = temp_buffer;
+    }
+    return TNN_OK;
+}
+
+Status X86FusedDwPwConvLayerAcc::allocateBufferBias(const std::vector<Blob *> &inputs,
+                                                    const std::vector<Blob *> &outputs) {
+    auto param = dynamic_cast<FusedDwPwConvLayerParam *>(param_);
+    CHECK_PARAM_NULL(param);
+    auto res = dynamic_cast<FusedDwPwConvLayerResource *>(resource_);
+    CHECK_PARAM_NULL(res);
+
+    auto alloc_bias = [](RawBuffer &buffer, ConvLayerParam *conv_param, ConvLayerResource *conv_res, int count) {
+        if (!buffer.GetBytesSize()) {
+            RawBuffer temp_buffer(ROUND_UP(count, 8) * sizeof(float));
+            if (conv_param->bias) {
+                memcpy(temp_buffer.force_to<float *>(), conv_res->bias_handle.force_to<float *>(),
+                       conv_res->bias_handle.GetBytesSize());
+            }
+            buffer = temp_buffer;
+        }
+    };
+    alloc_bias(dw_buffer_bias_, param->dw_param.get(), res->dw_resource.get(), inputs[0]->GetBlobDesc().dims[1]);
+    alloc_bias(pw_buffer_bias_, param->pw_param.get(), res->pw_resource.get(), outputs[0]->GetBlobDesc().dims[1]);
+    return TNN_OK;
+}
+
+// pack rows [row_begin, row_begin + rows) of the zero padded plane into c_pack layout
+template <int c_pack>
+static void PackRowsWithPad(const float *src, float *dst, const std::vector<int> &pads, int src_h, int src_w,
+                            int channels, int row_begin, int rows) {
+    auto PackAcc = PackC4;
+    if (c_pack == 8) {
+        PackAcc = PackC8;
+    }
+    int src_pad_w_stride = (src_w + pads[0] + pads[1]) * c_pack;
+    for (int r = 0; r < rows; r++) {
+        auto dst_h_ptr = dst + r * src_pad_w_stride;
+        int src_row    = row_begin + r - pads[2];
+        if (src_row < 0 || src_row >= src_h) {
+            memset(dst_h_ptr, 0, src_pad_w_stride * sizeof(float));
+            continue;
+        }
+        memset(dst_h_ptr, 0, pads[0] * c_pack * sizeof(float));
+        PackAcc(dst_h_ptr + pads[0] * c_pack, src + src_row * src_w, src_w, src_h * src_w, src_w, channels);
+        memset(dst_h_ptr + (pads[0] + src_w) * c_pack, 0, pads[1] * c_pack * sizeof(float));
+    }
+}
+
+Status X86FusedDwPwConvLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    if (outputs[0]->GetBlobDesc().data_type != DATA_TYPE_FLOAT) {
+        return Status(TNNERR_DEVICE_ACC_DATA_FORMAT_NOT_SUPPORT, "Error: x86 device not support this data type");
+    }
+    auto param    = dynamic_cast<FusedDwPwConvLayerParam *>(param_);
+    CHECK_PARAM_NULL(param);
+    auto dw_param = param->dw_param.get();
+    auto pw_param = param->pw_param.get();
+
+    auto dims_input  = inputs[0]->GetBlobDesc().dims;
+    auto dims_output = outputs[0]->GetBlobDesc().dims;
+
+    int c_pack = 8;
+    if (arch_ == sse42) {
+        c_pack = 4;
+    }
+
+    const int batch          = dims_output[0];
+    const int channel        = dims_input[1];
+    const int output_channel = dims_output[1];
+    const int ih             = dims_input[2];
+    const int iw             = dims_input[3];
+    const int oh             = dims_output[2];
+    const int ow             = dims_output[3];
+    const int src_z_step     = ih * iw;
+    const int dst_z_step     = oh * ow;
+    const int src_pad_w      = iw + dw_param->pads[0] + dw_param->pads[1];
+    const int dilate_y_step  = src_pad_w * c_pack * dw_param->dialations[1];
+    const int dilate_x_step  = c_pack * dw_param->dialations[0];
+    const int weight_z_step  = dw_param->kernels[0] * dw_param->kernels[1];
+    const int kernel_extent_h = dw_param->dialations[1] * (dw_param->kernels[1] - 1) + 1;
+
+    // output rows per tile: keep the depthwise tile within budget, but leave every thread some work
+    int max_num_threads = X86ThreadPool::GetMaxThreadsNum();
+    int tile_rows = MAX(1, kFusedDwTileBytes / (int)(channel * ow * sizeof(float)));
+    tile_rows     = MIN(tile_rows, oh);
+    if (batch * UP_DIV(oh, tile_rows) < max_num_threads) {
+        tile_rows = MAX(1, UP_DIV(oh, UP_DIV(max_num_threads, batch)));
+    }
+    const int tiles_per_batch = UP_DIV(oh, tile_rows);
+    const int tile_in_rows    = (tile_rows - 1) * dw_param->strides[1] + kernel_extent_h;
+
+    size_t pack_size   = ROUND_UP(src_pad_w * tile_in_rows * c_pack * sizeof(float), 32);
+    size_t dw_tmp_size = ROUND_UP(tile_rows * ow * c_pack * sizeof(float), 32);
+    size_t tile_size   = ROUND_UP(channel * tile_rows * ow * sizeof(float), 32);
+    size_t thread_size = pack_size + dw_tmp_size + tile_size;
+    size_t gemm_size   = ROUND_UP(conv_gemm_conf_.M_c_ * conv_gemm_conf_.K_c_ * sizeof(float), 32);
+    float *workspace   = reinterpret_cast<float *>(
+        context_->GetSharedWorkSpace((thread_size + gemm_size) * max_num_threads));
+    float *gemm_workspace = workspace + thread_size * max_num_threads / sizeof(float);
+
+    auto dw_full = DepthwiseConv<ActivationType_None, Float8, 8>;
+    if (dw_param->activation_type == ActivationType_ReLU) {
+        dw_full = DepthwiseConv<ActivationType_ReLU, Float8, 8>;
+    } else if (dw_param->activation_type == ActivationType_ReLU6) {
+        dw_full = DepthwiseConv<ActivationType_ReLU6, Float8, 8>;
+    }
+    if (arch_ == sse42) {
+        dw_full = DepthwiseConv<ActivationType_None, Float4, 4>;
+        if (dw_param->activation_type == ActivationType_ReLU) {
+            dw_full = DepthwiseConv<ActivationType_ReLU, Float4, 4>;
+        } else if (dw_param->activation_type == ActivationType_ReLU6) {
+            dw_full = DepthwiseConv<ActivationType_ReLU6, Float4, 4>;
+        }
+    }
+
+    auto PackRowsAcc = PackRowsWithPad<8>;
+    auto UnpackAcc   = UnpackC8;
+    if (arch_ == sse42) {
+        PackRowsAcc = PackRowsWithPad<4>;
+        UnpackAcc   = UnpackC4;
+    }
+
+    const float *src_origin = reinterpret_cast<const float *>(inputs[0]->GetHandle().base);
+    float *dst_origin       = reinterpret_cast<float *>(outputs[0]->GetHandle().base);
+    float *dw_weights       = dw_buffer_weight_.force_to<float *>();
+    float *dw_bias          = dw_buffer_bias_.force_to<float *>();
+    float *pw_weights       = pw_buffer_weight_.force_to<float *>();
+    float *pw_bias          = pw_buffer_bias_.force_to<float *>();
+
+    X86ParallelFor(0, batch * tiles_per_batch, [&](int tile_idx, int thread_id) {
+        const int batch_idx = tile_idx / tiles_per_batch;
+        const int oh_begin  = (tile_idx % tiles_per_batch) * tile_rows;
+        const int rows      = MIN(tile_rows, oh - oh_begin);
+        const int tile_n    = rows * ow;
+        const int in_rows   = (rows - 1) * dw_param->strides[1] + kernel_extent_h;
+
+        auto *thread_buf = workspace + thread_id * (thread_size / sizeof(float));
+        auto *pack_buf   = thread_buf;
+        auto *dw_tmp_buf = thread_buf + pack_size / sizeof(float);
+        auto *tile_buf   = dw_tmp_buf + dw_tmp_size / sizeof(float);
+
+        auto src_ptr = src_origin + batch_idx * channel * src_z_step;
+        auto dst_ptr = dst_origin + batch_idx * output_channel * dst_z_step;
+
+        for (int dz = 0; dz < channel; dz += c_pack) {
+            int real_dz = MIN(c_pack, channel - dz);
+            PackRowsAcc(src_ptr + dz * src_z_step, pack_buf, dw_param->pads, ih, iw, real_dz,
+                        oh_begin * dw_param->strides[1], in_rows);
+            dw_full(dw_tmp_buf, pack_buf, dw_weights + dz * weight_z_step, dw_bias + dz, ow,
+                    dw_param->strides[0] * c_pack, dw_param->kernels[0], dw_param->kernels[1], dilate_x_step,
+                    dilate_y_step, rows, src_pad_w * c_pack * dw_param->strides[1], ow * c_pack);
+            UnpackAcc(tile_buf + dz * tile_n, dw_tmp_buf, tile_n, tile_n, tile_n, real_dz);
+        }
+
+        // tile_buf is [channel][tile_n], exactly the B operand layout of the 1x1 conv gemm
+        conv_sgemm_nn_col_major_prepack_b(tile_n, output_channel, channel, tile_buf, tile_n, pw_weights, channel,
+                                          dst_ptr + oh_begin * ow, dst_z_step, pw_bias, pw_param->activation_type,
+                                          gemm_workspace, conv_gemm_conf_);
+    });
+
+    return TNN_OK;
+}
+
+REGISTER_X86_ACC(FusedDwPwConv, LAYER_FUSED_DW_PW_CONVOLUTION);
+
+}  // namespace TNN_NS
@@ -0,0 +1,338 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "tnn/device/x86/acc/x86_gru_layer_acc.h"
+
+#include "tnn/device/x86/acc/Float4.h"
+#include "tnn/device/x86/x86_thread_pool.h"
+#include "tnn/utils/data_type_utils.h"
+#include "tnn/utils/dims_vector_utils.h"
+
+namespace TNN_NS {
+
+/*
+the step kernels compute 4 hidden units [j, j + 4) of one batch,
+pre (input gemm result), bias and r are offset to unit j and laid out as [z, r, h] with stride hidden_size_4,
+h_prev is the whole hidden state, the padded units of the last block are never read by the recurrence
+*/
+static inline void X86GRUSaveHidden(const Float4 &z, const Float4 &n, const float *h_prev_j, float *h_next_j,
+                                    float *y_j, int valid) {
+    // h = (1 - z) * n + z * h_prev
+    Float4 h = n + z * (Float4::loadu(h_prev_j) - n);
+    Float4::saveu(h_next_j, h);
+    if (valid >= 4) {
+        Float4::saveu(y_j, h);
+    } else {
+        float tmp[4];
+        Float4::saveu(tmp, h);
+        memcpy(y_j, tmp, valid * sizeof(float));
+    }
+}
+
+// linear_before_reset: n = tanh(Wh * x + Wbh + r * (Rh * h_prev + Rbh)), all gates in one pass
+static void X86GRUCell4LinearBeforeReset(const float *pre, const float *bias, const float *r, const float *h_prev,
+                                         int j, float *h_next, float *y, int hidden_size, int hidden_size_4) {
+    const int gate_stride = hidden_size_4;
+    const int r_stride    = 3 * hidden_size_4;
+    Float4 acc_z = Float4::loadu(pre) + Float4::loadu(bias);
+    Float4 acc_r = Float4::loadu(pre + gate_stride) + Float4::loadu(bias + gate_stride);
+    Float4 acc_h = Float4::loadu(bias + 3 * gate_stride);
+    for (int k = 0; k < hidden_size; k++) {
+        Float4 h_k(h_prev + k);
+        auto r_k = r + k * r_stride;
+        Float4::mla(acc_z, h_k, Float4::loadu(r_k));
+        Float4::mla(acc_r, h_k, Float4::loadu(r_k + gate_stride));
+        Float4::mla(acc_h, h_k, Float4::loadu(r_k + 2 * gate_stride));
+    }
+
+    Float4 z = Float4::sigmoid(acc_z);
+    Float4 n = Float4::loadu(pre + 2 * gate_stride) + Float4::loadu(bias + 2 * gate_stride);
+    n        = Float4::tanh(n + Float4::sigmoid(acc_r) * acc_h);
+    X86GRUSaveHidden(z, n, h_prev + j, h_next, y, hidden_size - j);
+}
+
+// first pass without linear_before_reset: z and r * h_prev, which the recurrence of the hidden gate needs for all units
+static void X86GRUCell4Reset(const float *pre, const float *bias, const float *r, const float *h_prev, int j,
+                             float *z_buf, float *rh_buf, int hidden_size, int hidden_size_4) {
+    const int gate_stride = hidden_size_4;
+    const int r_stride    = 3 * hidden_size_4;
+    Float4 acc_z = Float4::loadu(pre) + Float4::loadu(bias);
+    Float4 acc_r = Float4::loadu(pre + gate_stride) + Float4::loadu(bias + gate_stride);
+    for (int k = 0; k < hidden_size; k++) {
+        Float4 h_k(h_prev + k);
+        auto r_k = r + k * r_stride;
+        Float4::mla(acc_z, h_k, Float4::loadu(r_k));
+        Float4::mla(acc_r, h_k, Float4::loadu(r_k + gate_stride));
+    }
+    Float4::saveu(z_buf + j, Float4::sigmoid(acc_z));
+    Float4::saveu(rh_buf + j, Float4::sigmoid(acc_r) * Float4::loadu(h_prev + j));
+}
+
+// second pass without linear_before_reset: n = tanh(Wh * x + Wbh + Rh * (r * h_prev) + Rbh)
+static void X86GRUCell4Hidden(const float *pre, const float *bias, const float *r, const float *h_prev,
+                              const float *z_buf, const float *rh_buf, int j, float *h_next, float *y,
+                              int hidden_size, int hidden_size_4) {
+    const int gate_stride = hidden_size_4;
+    const int r_stride    = 3 * hidden_size_4;
+    Float4 acc_h = Float4::loadu(pre + 2 * gate_stride) + Float4::loadu(bias + 2 * gate_stride) +
+                   Float4::loadu(bias + 3 * gate_stride);
+    for (int k = 0; k < hidden_size; k++) {
+        Float4::mla(acc_h, Float4(rh_buf + k), Float4::loadu(r + k * r_stride + 2 * gate_stride));
+    }
+    X86GRUSaveHidden(Float4::loadu(z_buf + j), Float4::tanh(acc_h), h_prev + j, h_next, y, hidden_size - j);
+}
+
+X86GRUONNXLayerAcc::~X86GRUONNXLayerAcc() {}
+
+Status X86GRUONNXLayerAcc::Init(Context *context, LayerParam *param, LayerResource *resource,
+                                const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto status = X86LayerAcc::Init(context, param, resource, inputs, outputs);
+    RETURN_ON_NEQ(status, TNN_OK);
+
+    if (inputs.size() < 4) {
+        return Status(TNNERR_LAYER_ERR, "GRU has invalid inputs");
+    }
+
+    auto layer_param = dynamic_cast<GRUONNXLayerParam *>(param_);
+    CHECK_PARAM_NULL(layer_param);
+    hidden_size_4_ = ROUND_UP(layer_param->hidden_size, 4);
+
+    RETURN_ON_NEQ(allocateBufferWeight(inputs, outputs), TNN_OK);
+    RETURN_ON_NEQ(allocateBufferBias(inputs, outputs), TNN_OK);
+
+    return TNN_OK;
+}
+
+Status X86GRUONNXLayerAcc::allocateBufferWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    // weights for gates, [num_direction, 3 * hidden_size, input_size]
+    auto w_dims = inputs[1]->GetBlobDesc().dims;
+    int w_direction_size = DimsVectorUtils::Count(w_dims, 1);
+    float *w_ptr = (float *)((char *)(inputs[1]->GetHandle().base) + inputs[1]->GetHandle().bytes_offset);
+
+    // recurrence weights, [num_direction, 3 * hidden_size, hidden_size]
+    auto r_dims = inputs[2]->GetBlobDesc().dims;
+    int r_direction_size = DimsVectorUtils::Count(r_dims, 1);
+    float *r_ptr = (float *)((char *)(inputs[2]->GetHandle().base) + inputs[2]->GetHandle().bytes_offset);
+
+    const int hidden_size   = w_dims[1] / 3;
+    const int hidden_size_4 = hidden_size_4_;
+    int k_c     = conv_gemm_conf_.K_c_;
+    int m_block = conv_gemm_conf_.m_block_;
+
+    // gate weights, pad every gate to hidden_size_4 rows before conv_pack
+    int K = w_dims[2];
+    int M = 3 * hidden_size_4;
+    size_t w_pack_size = ROUND_UP(K, k_c) * ROUND_UP(M, m_block);
+    // align pointer of packed weights, since gemm use aligned load for input A
+    RawBuffer w_temp_buffer(w_dims[0] * w_pack_size * sizeof(float), 32);
+    RawBuffer pad_buf(M * K * sizeof(float));
+    float *pad_ptr = pad_buf.force_to<float *>();
+    for (int d = 0; d < w_dims[0]; d++) {
+        float *w_src = w_ptr + d * w_direction_size;
+        float *w_dst = w_temp_buffer.force_to<float *>() + d * w_pack_size;
+        for (int g = 0; g < 3; g++) {
+            memcpy(pad_ptr + g * hidden_size_4 * K, w_src + g * hidden_size * K, hidden_size * K * sizeof(float));
+        }
+        conv_pack_col_a_t(M, K, pad_ptr, K, w_dst, conv_gemm_conf_);
+    }
+
+    // recurrence weights, transpose to [hidden_size(k), 3 * hidden_size_4], the step kernels read gates of
+    // consecutive hidden units for one k contiguously
+    K = r_dims[2];
+    size_t r_trans_size = K * M;
+    RawBuffer r_temp_buffer(r_dims[0] * r_trans_size * sizeof(float));
+    for (int d = 0; d < r_dims[0]; d++) {
+        float *r_src = r_ptr + d * r_direction_size;
+        float *r_dst = r_temp_buffer.force_to<float *>() + d * r_trans_size;
+        for (int g = 0; g < 3; g++) {
+            for (int j = 0; j < hidden_size; j++) {
+                auto r_src_j = r_src + (g * hidden_size + j) * K;
+                for (int k = 0; k < K; k++) {
+                    r_dst[k * M + g * hidden_size_4 + j] = r_src_j[k];
+                }
+            }
+        }
+    }
+
+    w_temp_buffer.SetDataType(DATA_TYPE_FLOAT);
+    r_temp_buffer.SetDataType(DATA_TYPE_FLOAT);
+    buffer_w_ = w_temp_buffer;
+    buffer_r_ = r_temp_buffer;
+
+    return TNN_OK;
+}
+
+Status X86GRUONNXLayerAcc::allocateBufferBias(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    // bias for gate and recurrence, [num_directions, 6*hidden_size]
+    auto b_dims = inputs[3]->GetBlobDesc().dims;
+    const int hidden_size   = b_dims[1] / 6;
+    const int hidden_size_4 = hidden_size_4_;
+    const int bias_size     = 4 * hidden_size_4;
+    RawBuffer b_temp_buffer(b_dims[0] * bias_size * sizeof(float));
+
+    float *b_ptr = (float *)((char *)(inputs[3]->GetHandle().base) + inputs[3]->GetHandle().bytes_offset);
+
+    for (int d = 0; d < b_dims[0]; d++) {
+        float *wb_d  = b_ptr + d * b_dims[1];
+        float *rb_d  = wb_d + 3 * hidden_size;
+        float *b_dst = b_temp_buffer.force_to<float *>() + d * bias_size;
+
+        // z and r add both bias, h keeps Wbh and Rbh apart for linear_before_reset
+        for (int i = 0; i < hidden_size; i++) {
+            b_dst[i + 0 * hidden_size_4] = wb_d[i + 0 * hidden_size] + rb_d[i + 0 * hidden_size];
+            b_dst[i + 1 * hidden_size_4] = wb_d[i + 1 * hidden_size] + rb_d[i + 1 * hidden_size];
+            b_dst[i + 2 * hidden_size_4] = wb_d[i + 2 * hidden_size];
+            b_dst[i + 3 * hidden_size_4] = rb_d[i + 2 * hidden_size];
+        }
+    }
+    b_temp_buffer.SetDataType(DATA_TYPE_FLOAT);
+    buffer_b_ = b_temp_buffer;
+
+    return TNN_OK;
+}
+
+Status X86GRUONNXLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto layer_param = dynamic_cast<GRUONNXLayerParam *>(param_);
+    CHECK_PARAM_NULL(layer_param);
+    if (layer_param->direction < 0 || layer_param->direction > 2) {
+        return Status(TNNERR_PARAM_ERR, "GRUONNX has invalid direction param");
+    }
+    const int num_directions = layer_param->direction >= 2 ? 2 : 1;
+
+    const auto input_dims  = inputs[0]->GetBlobDesc().dims;
+    const int T            = input_dims[0];                           // length of sequence
+    const int batch        = input_dims[1];                           // batch_size
+    const int input_size   = DimsVectorUtils::Count(input_dims, 2);  // input dimension
+    const int hidden_size  = layer_param->hidden_size;                // output dimension
+    const int hidden_size_4 = hidden_size_4_;
+
+    //X shape [sequence batch_size input_size]
+    float *x = (float *)((char *)(inputs[0]->GetHandle().base) + inputs[0]->GetHandle().bytes_offset);
+    //Y shape [sequence batch_size num_directions *hidden_size]
+    float *y = (float *)((char *)(outputs[0]->GetHandle().base) + outputs[0]->GetHandle().bytes_offset);
+
+    float *w = buffer_w_.force_to<float *>();
+    float *r = buffer_r_.force_to<float *>();
+    float *b = buffer_b_.force_to<float *>();
+
+    // sgemm for weight tensor
+    // weights: [3*hidden_size_4, input_size]
+    // inputs: [seq_len, batch, input_size]
+    const int K = input_size;
+    const int N = T * batch;
+    const int M = 3 * hidden_size_4;
+    size_t w_pack_size = ROUND_UP(K, conv_gemm_conf_.K_c_) * ROUND_UP(M, conv_gemm_conf_.m_block_);
+    const int state_size = num_directions * batch * hidden_size_4;
+
+    // workspace: gemm_buf, gates_buf of all directions, zero bias for gemm,
+    // two hidden state buffers, z and r * h_prev
+    size_t gemm_buf_size  = ROUND_UP(conv_gemm_conf_.K_c_ * ROUND_UP(N, conv_gemm_conf_.n_block_) * sizeof(float), 32);
+    size_t gates_buf_size = ROUND_UP(num_directions * N * M * sizeof(float), 32);
+    size_t zero_buf_size  = ROUND_UP(N * sizeof(float), 32);
+    size_t state_buf_size = ROUND_UP(state_size * sizeof(float), 32);
+    size_t workspace_size = gemm_buf_size + gates_buf_size + zero_buf_size + 4 * state_buf_size;
+    char *workspace  = reinterpret_cast<char *>(context_->GetSharedWorkSpace(workspace_size));
+    float *gemm_buf  = reinterpret_cast<float *>(workspace);
+    float *gates_buf = reinterpret_cast<float *>(workspace + gemm_buf_size);
+    float *zero_bias = reinterpret_cast<float *>(workspace + gemm_buf_size + gates_buf_size);
+    float *h_prev    = reinterpret_cast<float *>(workspace + gemm_buf_size + gates_buf_size + zero_buf_size);
+    float *h_next    = h_prev + state_buf_size / sizeof(float);
+    float *z_buf     = h_next + state_buf_size / sizeof(float);
+    float *rh_buf    = z_buf + state_buf_size / sizeof(float);
+    memset(zero_bias, 0, N * sizeof(float));
+
+    // in stateful forward the state left by the last forward replaces initial_h,
+    // only a forward gru can go on with the next chunk of a stream
+    const int state_bytes = state_size * sizeof(float);
+    const bool stateful   = context_->GetEnableStatefulForward() && layer_param->direction == 0;
+
+    //initial_h, initial value of the hidden, If not specified - assumed to be 0. shape [num_directions, batch_size, hidden_size]
+    memset(h_prev, 0, state_size * sizeof(float));
+    if (stateful && state_h_.GetBytesSize() == state_bytes) {
+        memcpy(h_prev, state_h_.force_to<float *>(), state_bytes);
+    } else if (inputs.size() >= 5) {
+        auto h_0 = (float *)((char *)(inputs[4]->GetHandle().base) + inputs[4]->GetHandle().bytes_offset);
+        for (int i = 0; i < num_directions * batch; i++) {
+            memcpy(h_prev + i * hidden_size_4, h_0 + i * hidden_size, hidden_size * sizeof(float));
+        }
+    }
+
+    for (int d = 0; d < num_directions; d++) {
+        conv_sgemm_tn_col_major_prepack_a(M, N, K, w + d * w_pack_size, K, x, K, gates_buf + d * N * M, M, zero_bias,
+                                          ActivationType_None, gemm_buf, conv_gemm_conf_);
+    }
+
+    // both directions step together, each writes its half of y in place
+    const int y_stride  = num_directions * hidden_size;
+    const int block_num = hidden_size_4 / 4;
+    for (int t = 0; t < T; t++) {
+        // z, r and n of hidden units [j, j + 4) of direction d, for all batches
+        auto cell = [&](int i, int pass) {
+            const int d  = i / block_num;
+            const int j  = i % block_num * 4;
+            const int ti = (layer_param->direction == 1 || d == 1) ? T - 1 - t : t;
+            auto bias    = b + d * 4 * hidden_size_4 + j;
+            auto r_d     = r + d * hidden_size * M + j;
+            for (int bi = 0; bi < batch; bi++) {
+                const int offset = (d * batch + bi) * hidden_size_4;
+                auto pre         = gates_buf + (d * N + ti * batch + bi) * M + j;
+                auto y_t         = y + (ti * batch + bi) * y_stride + d * hidden_size + j;
+                if (pass == 0) {
+                    X86GRUCell4LinearBeforeReset(pre, bias, r_d, h_prev + offset, j, h_next + offset + j, y_t,
+                                                 hidden_size, hidden_size_4);
+                } else if (pass == 1) {
+                    X86GRUCell4Reset(pre, bias, r_d, h_prev + offset, j, z_buf + offset, rh_buf + offset,
+                                     hidden_size, hidden_size_4);
+                } else {
+                    X86GRUCell4Hidden(pre, bias, r_d, h_prev + offset, z_buf + offset, rh_buf + offset, j,
+                                      h_next + offset + j, y_t, hidden_size, hidden_size_4);
+                }
+            }
+        };
+        if (layer_param->linear_before_reset) {
+            X86ParallelFor(0, num_directions * block_num, [&](int i, int thread_id) { cell(i, 0); });
+        } else {
+            // the hidden gate needs r * h_prev of all units
+            X86ParallelFor(0, num_directions * block_num, [&](int i, int thread_id) { cell(i, 1); });
+            X86ParallelFor(0, num_directions * block_num, [&](int i, int thread_id) { cell(i, 2); });
+        }
+        std::swap(h_prev, h_next);
+    }
+
+    // Y_h, [num_directions, batch_size, hidden_size]
+    if (outputs.size() >= 2) {
+        auto h_t = (float *)((char *)(outputs[1]->GetHandle().base) + outputs[1]->GetHandle().bytes_offset);
+        for (int i = 0; i < num_directions * batch; i++) {
+            memcpy(h_t + i * hidden_size, h_prev + i * hidden_size_4, hidden_size * sizeof(float));
+        }
+    }
+
+    if (stateful) {
+        if (state_h_.GetBytesSize() != state_bytes) {
+            state_h_ = RawBuffer(state_bytes);
+        }
+        memcpy(state_h_.force_to<float *>(), h_prev, state_bytes);
+    }
+
+    return TNN_OK;
+}
+
+Status X86GRUONNXLayerAcc::ResetState() {
+    state_h_ = RawBuffer();
+    return TNN_OK;
+}
+
+REGISTER_X86_ACC(GRUONNX, LAYER_GRUONNX);
+}  // namespace TNN_NS
@@ -0,0 +1,51 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#ifndef TNN_SOURCE_TNN_DEVICE_X86_X86_GRU_LAYER_ACC_H_
+#define TNN_SOURCE_TNN_DEVICE_X86_X86_GRU_LAYER_ACC_H_
+
+#include "tnn/device/x86/acc/x86_layer_acc.h"
+#include "tnn/device/x86/acc/compute/jit/conv_sgemm_driver.h"
+
+namespace TNN_NS {
+
+class X86GRUONNXLayerAcc : public X86LayerAcc {
+public:
+    virtual ~X86GRUONNXLayerAcc();
+
+    Status Init(Context *context, LayerParam *param, LayerResource *resource, const std::vector<Blob *> &inputs,
+                const std::vector<Blob *> &outputs) override;
+    virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
+    virtual Status allocateBufferWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+    virtual Status allocateBufferBias(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+    virtual Status ResetState() override;
+
+protected:
+    // hidden_size rounded up to 4, gates of one direction are [3, hidden_size_4] in all buffers
+    int hidden_size_4_ = 0;
+    // packed gate weights, [num_directions, packed 3*hidden_size_4 x input_size]
+    RawBuffer buffer_w_;
+    // recurrence weights transposed to [num_directions, hidden_size, 3 * hidden_size_4]
+    RawBuffer buffer_r_;
+    // bias of z, r, Wbh and Rbh, [num_directions, 4 * hidden_size_4]
+    RawBuffer buffer_b_;
+    conv_gemm_config<float, float, float> conv_gemm_conf_;
+    // hidden state left by the last forward in stateful forward, [batch_size, hidden_size_4]
+    RawBuffer state_h_;
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_SOURCE_TNN_DEVICE_X86_X86_GRU_LAYER_ACC_H_
@@ -21,7 +21,17 @@
 
 namespace TNN_NS {
 
-DECLARE_X86_ACC(HardSwish, X86_HARDSWISH_OP);
+class X86HardSwishLayerAcc : public X86LayerAcc {
+public:
+    virtual ~X86HardSwishLayerAcc(){};
+    virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
+    virtual bool SupportInPlace(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
+};
+
+// with a single input every output element only reads the input element of the same index
+bool X86HardSwishLayerAcc::SupportInPlace(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    return inputs.size() == 1 && IsSameDimsFloat(inputs, outputs);
+}
 
 Status X86HardSwishLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     
@@ -12,6 +12,9 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
+#include <set>
+#include <sstream>
+
 #include "tnn/device/x86/x86_common.h"
 #include "tnn/device/x86/x86_context.h"
 #include "tnn/device/x86/x86_util.h"
@@ -20,6 +23,7 @@
 #include "tnn/device/x86/acc/compute/x86_compute_int8.h"
 #include "tnn/device/x86/acc/x86_inner_product_layer_acc.h"
 #include "tnn/interpreter/layer_resource_generator.h"
+#include "tnn/utils/weight_quant_utils.h"
 
 namespace TNN_NS {
 
@@ -55,9 +59,36 @@ Status X86InnerProductLayerAcc::Init(Context *context, LayerParam *param, LayerR
 
     auto res = dynamic_cast<InnerProductLayerResource *>(resource);
     CHECK_PARAM_NULL(res);
+    auto ip_param = dynamic_cast<InnerProductLayerParam *>(param);
+    CHECK_PARAM_NULL(ip_param);
 
     Status ret;
-    if (res->weight_handle.GetDataType() == DATA_TYPE_HALF) {
+    if (ip_param->weight_quant_bits > 0) {
+        const int oc = DimsVectorUtils::Count(output_dims, 1);
+        const int ic = DimsVectorUtils::Count(input_dims, 1);
+        RETURN_ON_NEQ(WeightQuantUtils::CheckQuantizedBuffer(res->weight_handle, res->scale_handle, oc, ic,
+                                                             ip_param->weight_quant_bits,
+                                                             ip_param->weight_quant_group_size),
+                      TNN_OK);
+        auto fp32_res         = std::make_shared<InnerProductLayerResource>();
+        fp32_res->bias_handle = ConvertHalfHandle(res->bias_handle);
+        if (arch_ == avx2) {
+            // the packed quantized weights are read by the kernel
+            impl_                   = InnerProductWeightQuant;
+            fp32_res->weight_handle = res->weight_handle;
+            fp32_res->scale_handle  = ConvertHalfHandle(res->scale_handle);
+        } else {
+            RawBuffer weight(oc * ic * sizeof(float));
+            RETURN_ON_NEQ(WeightQuantUtils::Dequantize(res->weight_handle, res->scale_handle, oc, ic,
+                                                       ip_param->weight_quant_bits,
+                                                       ip_param->weight_quant_group_size, weight.force_to<float *>()),
+                          TNN_OK);
+            weight.SetDataType(DATA_TYPE_FLOAT);
+            fp32_res->weight_handle = weight;
+        }
+        fc_acc_f32_resource_ = fp32_res;
+        ret = X86LayerAcc::Init(context, param, fc_acc_f32_resource_.get(), inputs, outputs);
+    } else if (res->weight_handle.GetDataType() == DATA_TYPE_HALF) {
         LayerResource *fp32_res = nullptr;
         RETURN_ON_NEQ(ConvertHalfResource(LAYER_INNER_PRODUCT, res, &fp32_res), TNN_OK);
         fc_acc_f32_resource_ = std::shared_ptr<LayerResource>(fp32_res);
@@ -67,12 +98,25 @@ Status X86InnerProductLayerAcc::Init(Context *context, LayerParam *param, LayerR
     }
 
     RETURN_ON_NEQ(ret, TNN_OK);
+
+    // pruned weights, detected when loaded, fall back to the dense kernels if too many blocks are nonzero
+    auto fp32_res = dynamic_cast<InnerProductLayerResource *>(resource_);
+    if (impl_ != InnerProductWeightQuant && arch_ == avx2 && fp32_res &&
+        fp32_res->weight_handle.GetDataType() == DATA_TYPE_FLOAT &&
+        outputs[0]->GetBlobDesc().data_type == DATA_TYPE_FLOAT &&
+        X86PreferSparseWeightC8(fp32_res->weight_handle.force_to<float *>(), DimsVectorUtils::Count(output_dims, 1),
+                                DimsVectorUtils::Count(input_dims, 1))) {
+        impl_ = InnerProductSparse;
+    }
+
     RETURN_ON_NEQ(allocateBufferWeight(inputs, outputs), TNN_OK);
     RETURN_ON_NEQ(allocateBufferBias(inputs, outputs), TNN_OK);
 
-    // converted weights are assumed to be packed, and can be freed now
-    if (fc_acc_f32_resource_) {
+    // converted weights are assumed to be packed, and can be freed now.
+    // kernel tuning packs them again for every candidate, so keep them in that case
+    if (fc_acc_f32_resource_ && !context_->GetEnableTuneKernel()) {
         fc_acc_f32_resource_.reset();
+        resource_ = nullptr;
     }
 
     return TNN_OK;
@@ -92,7 +136,56 @@ Status X86InnerProductLayerAcc::allocateBufferWeight(const std::vector<Blob *> &
     auto output_dims  = outputs[0]->GetBlobDesc().dims;
 
     if (!buffer_weight_.GetBytesSize()) {
-        if (res->weight_handle.GetDataType() == DATA_TYPE_FLOAT) {
+        if (impl_ == InnerProductWeightQuant) {
+            const int oc          = DimsVectorUtils::Count(output_dims, 1);
+            const int ic          = DimsVectorUtils::Count(input_dims, 1);
+            const int bits        = param->weight_quant_bits;
+            const int group_size  = param->weight_quant_group_size;
+            const int group_count = WeightQuantUtils::GetGroupCount(ic, group_size);
+            const int oc_blocks   = UP_DIV(oc, 8);
+
+            auto pack = [&](RawBuffer &weight, RawBuffer &scale) -> Status {
+                RawBuffer temp_weight(oc_blocks * X86WeightQuantBlockBytes(ic, bits, group_size));
+                RawBuffer temp_scale(oc_blocks * group_count * 8 * sizeof(float));
+                X86PackWeightQuantC8(temp_weight.force_to<int8_t *>(), temp_scale.force_to<float *>(),
+                                     res->weight_handle.force_to<int8_t *>(), res->scale_handle.force_to<float *>(),
+                                     oc, ic, bits, group_size);
+                temp_weight.SetDataType(DATA_TYPE_INT8);
+                temp_scale.SetDataType(DATA_TYPE_FLOAT);
+                weight = temp_weight;
+                scale  = temp_scale;
+                return TNN_OK;
+            };
+            const std::string key = "inner_product_weight_quant_b" + std::to_string(bits) + "_g" +
+                                    std::to_string(group_size);
+            RETURN_ON_NEQ(GetSharedWeights(key + "_weight", buffer_weight_, key + "_scale", buffer_scale_, pack),
+                          TNN_OK);
+        } else if (impl_ == InnerProductSparse) {
+            const int oc     = DimsVectorUtils::Count(output_dims, 1);
+            const int ic     = DimsVectorUtils::Count(input_dims, 1);
+            const float *src = res->weight_handle.force_to<float *>();
+
+            auto pack_index = [&](RawBuffer &buffer) -> Status {
+                RawBuffer temp_buffer(X86SparseIndexC8Size(oc, X86CountSparseBlocksC8(src, oc, ic)) * sizeof(int));
+                X86PackSparseIndexC8(temp_buffer.force_to<int *>(), src, oc, ic);
+                temp_buffer.SetDataType(DATA_TYPE_INT32);
+                buffer = temp_buffer;
+                return TNN_OK;
+            };
+            RETURN_ON_NEQ(GetSharedWeights("inner_product_sparse_index", buffer_sparse_index_, pack_index), TNN_OK);
+
+            const int *index = buffer_sparse_index_.force_to<int *>();
+            auto pack = [&](RawBuffer &buffer) -> Status {
+                // at least one block, RawBuffer of zero bytes holds no data
+                const int nnz_blocks = std::max(index[UP_DIV(oc, 8)], 1);
+                RawBuffer temp_buffer(nnz_blocks * 8 * sizeof(float));
+                X86PackSparseWeightC8(temp_buffer.force_to<float *>(), src, index, oc, ic);
+                temp_buffer.SetDataType(DATA_TYPE_FLOAT);
+                buffer = temp_buffer;
+                return TNN_OK;
+            };
+            RETURN_ON_NEQ(GetSharedWeights("inner_product_sparse_weight", buffer_weight_, pack), TNN_OK);
+        } else if (res->weight_handle.GetDataType() == DATA_TYPE_FLOAT) {
             if (impl_ == InnerProductSgemv) {
                 int oc_rup = 8;
                 if (arch_ == sse42) {
@@ -103,17 +196,21 @@ Status X86InnerProductLayerAcc::allocateBufferWeight(const std::vector<Blob *> &
                 size_t weight_count = ROUND_UP(output_dims[1], oc_rup) * input_stride;
                 int data_byte_size = DataTypeUtils::GetBytesSize(res->weight_handle.GetDataType());
 
-                RawBuffer temp_buffer(weight_count * data_byte_size);
-                float *dst = temp_buffer.force_to<float *>();
+                auto pack = [&](RawBuffer &buffer) -> Status {
+                    RawBuffer temp_buffer(weight_count * data_byte_size);
+                    float *dst = temp_buffer.force_to<float *>();
 
-                if (arch_ == avx2) {
-                    PackC8(dst, src, input_stride, input_stride, input_stride, output_dims[1]);
-                } else if (arch_ == sse42) {
-                    PackC4(dst, src, input_stride, input_stride, input_stride, output_dims[1]);
-                }
+                    if (arch_ == avx2) {
+                        PackC8(dst, src, input_stride, input_stride, input_stride, output_dims[1]);
+                    } else if (arch_ == sse42) {
+                        PackC4(dst, src, input_stride, input_stride, input_stride, output_dims[1]);
+                    }
 
-                temp_buffer.SetDataType(DATA_TYPE_FLOAT);
-                buffer_weight_ = temp_buffer;
+                    temp_buffer.SetDataType(DATA_TYPE_FLOAT);
+                    buffer = temp_buffer;
+                    return TNN_OK;
+                };
+                RETURN_ON_NEQ(GetSharedWeights("inner_product_sgemv_weight", buffer_weight_, pack), TNN_OK);
             } else {
                 int k_c = conv_gemm_conf_.K_c_;
                 int m_block = conv_gemm_conf_.m_block_;
@@ -122,14 +219,18 @@ Status X86InnerProductLayerAcc::allocateBufferWeight(const std::vector<Blob *> &
                 size_t weight_pack_size = ROUND_UP(K, k_c) * ROUND_UP(M, m_block);
                 const float *src = res->weight_handle.force_to<float *>();
 
-                // align pointer of packed weights, since gemm use aligned load for input A
-                RawBuffer temp_buffer(weight_pack_size * sizeof(float), 32);
-                float *dst = temp_buffer.force_to<float *>();
+                auto pack = [&](RawBuffer &buffer) -> Status {
+                    // align pointer of packed weights, since gemm use aligned load for input A
+                    RawBuffer temp_buffer(weight_pack_size * sizeof(float), 32);
+                    float *dst = temp_buffer.force_to<float *>();
 
-                conv_pack_col_a_t(M, K, src, K, dst, conv_gemm_conf_);
+                    conv_pack_col_a_t(M, K, src, K, dst, conv_gemm_conf_);
 
-                temp_buffer.SetDataType(DATA_TYPE_FLOAT);
-                buffer_weight_ = temp_buffer;
+                    temp_buffer.SetDataType(DATA_TYPE_FLOAT);
+                    buffer = temp_buffer;
+                    return TNN_OK;
+                };
+                RETURN_ON_NEQ(GetSharedWeights(GetGemmWeightKey(), buffer_weight_, pack), TNN_OK);
             }
         } else if (res->weight_handle.GetDataType() == DATA_TYPE_INT8) {
             // trans nchw to nhwc4
@@ -174,6 +275,116 @@ Status X86InnerProductLayerAcc::allocateBufferWeight(const std::vector<Blob *> &
     return TNN_OK;
 }
 
+std::string X86InnerProductLayerAcc::GetGemmWeightKey() {
+    return "inner_product_gemm_weight_" + std::to_string(conv_gemm_conf_.K_c_) + "_" +
+           std::to_string(conv_gemm_conf_.m_block_);
+}
+
+Status X86InnerProductLayerAcc::Reshape(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    // X86LayerAcc::Init calls Reshape before the weights are packed
+    if (impl_ != InnerProductSgemm || !buffer_weight_.GetBytesSize() || !context_->GetEnableTuneKernel() ||
+        !resource_) {
+        return TNN_OK;
+    }
+    if (inputs[0]->GetBlobDesc().data_type != DATA_TYPE_FLOAT) {
+        return TNN_OK;
+    }
+    return TuneGemmBlockSize(inputs, outputs);
+}
+
+static std::string GenerateTuneKey(const DimsVector &input_dims, const DimsVector &output_dims, int num_threads) {
+    std::ostringstream key;
+    key << "inner_product";
+    for (auto dim : input_dims) {
+        key << "_" << dim;
+    }
+    for (auto dim : output_dims) {
+        key << "_" << dim;
+    }
+    key << "_t_" << num_threads;
+    return key.str();
+}
+
+Status X86InnerProductLayerAcc::TuneGemmBlockSize(const std::vector<Blob *> &inputs,
+                                                  const std::vector<Blob *> &outputs) {
+    auto input_dims  = inputs[0]->GetBlobDesc().dims;
+    auto output_dims = outputs[0]->GetBlobDesc().dims;
+    auto key         = GenerateTuneKey(input_dims, output_dims, context_->GetNumThreads());
+    if (key == tune_key_) {
+        return TNN_OK;
+    }
+
+    // each candidate is {impl, gemm M_c, gemm K_c}, the layout of the conv tune results
+    std::vector<std::vector<int>> candidates;
+    auto &tune_map = context_->GetTuneMap();
+    auto iter      = tune_map.find(key);
+    if (iter != tune_map.end() && iter->second.size() == 3 && iter->second[0] == InnerProductSgemm &&
+        iter->second[1] > 0 && iter->second[2] > 0) {
+        candidates.push_back(iter->second);
+    } else {
+        for (int m_c : {32, 64, 128}) {
+            for (int k_c : {128, 256, 512}) {
+                candidates.push_back({InnerProductSgemm, m_c, k_c});
+            }
+        }
+    }
+
+    // run on scratch blobs, the network blobs may share memory with others
+    Blob tune_input(inputs[0]->GetBlobDesc(), true);
+    Blob tune_output(outputs[0]->GetBlobDesc(), true);
+    float *input_data = static_cast<float *>(tune_input.GetHandle().base);
+    CHECK_PARAM_NULL(input_data);
+    CHECK_PARAM_NULL(tune_output.GetHandle().base);
+    int input_count = DimsVectorUtils::Count(input_dims);
+    for (int i = 0; i < input_count; ++i) {
+        input_data[i] = (i % 17 - 8) * 0.125f;
+    }
+    std::vector<Blob *> tune_inputs  = {&tune_input};
+    std::vector<Blob *> tune_outputs = {&tune_output};
+
+    // the weights are packed per K_c, the ones the best candidate does not use are released after tuning
+    std::set<std::string> weight_keys = {GetGemmWeightKey()};
+    std::vector<int> best_config;
+    double best_time = -1;
+
+    context_->OnInstanceForwardBegin();
+    for (const auto &config : candidates) {
+        conv_gemm_conf_.M_c_ = config[1];
+        conv_gemm_conf_.K_c_ = config[2];
+        weight_keys.insert(GetGemmWeightKey());
+        buffer_weight_ = RawBuffer();
+        if (allocateBufferWeight(tune_inputs, tune_outputs) != TNN_OK) {
+            continue;
+        }
+        if (candidates.size() == 1) {
+            best_config = config;
+            break;
+        }
+        double time = MeasureDoForward(tune_inputs, tune_outputs);
+        LOGD("inner product %s m_c %d k_c %d: %.3f ms\n", key.c_str(), config[1], config[2], time);
+        if (time >= 0 && (best_time < 0 || time < best_time)) {
+            best_config = config;
+            best_time   = time;
+        }
+    }
+    context_->OnInstanceForwardEnd();
+
+    if (best_config.empty()) {
+        return Status(TNNERR_NET_ERR, "inner product kernel tune failed");
+    }
+    conv_gemm_conf_.M_c_ = best_config[1];
+    conv_gemm_conf_.K_c_ = best_config[2];
+    buffer_weight_       = RawBuffer();
+    RETURN_ON_NEQ(allocateBufferWeight(inputs, outputs), TNN_OK);
+    weight_keys.erase(GetGemmWeightKey());
+    for (const auto &weight_key : weight_keys) {
+        ReleasePackedWeights(weight_key);
+    }
+    tune_map[key] = best_config;
+    tune_key_     = key;
+    return TNN_OK;
+}
+
 Status X86InnerProductLayerAcc::allocateBufferBias(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     InnerProductLayerParam *param = dynamic_cast<InnerProductLayerParam *>(param_);
     CHECK_PARAM_NULL(param);
@@ -182,8 +393,10 @@ Status X86InnerProductLayerAcc::allocateBufferBias(const std::vector<Blob *> &in
 
     auto dims_output = outputs[0]->GetBlobDesc().dims;
     if (!buffer_bias_.GetBytesSize()) {
-        // int8 bias needs oc_r4 memory space 
-        int total_byte_size = ROUND_UP(dims_output[1], 4) * DataTypeUtils::GetBytesSize(res->bias_handle.GetDataType());
+        // int8 bias needs oc_r4 memory space, the weight only quantized and the sparse kernels store 8 output
+        // channels at a time
+        int oc_rup          = (impl_ == InnerProductWeightQuant || impl_ == InnerProductSparse) ? 8 : 4;
+        int total_byte_size = ROUND_UP(dims_output[1], oc_rup) * DataTypeUtils::GetBytesSize(res->bias_handle.GetDataType());
         RawBuffer temp_buffer(total_byte_size);
         if (param->has_bias) {
             const int bias_handle_size    = res->bias_handle.GetBytesSize();
@@ -246,7 +459,18 @@ Status X86InnerProductLayerAcc::DoForward(const std::vector<Blob *> &inputs, con
         float *weight_data = buffer_weight_.force_to<float *>();
         float *bias_data   = buffer_bias_.force_to<float *>();
 
-        if (impl_ == InnerProductSgemv) {
+        if (impl_ == InnerProductWeightQuant) {
+            int K = DimsVectorUtils::Count(input_dims, 1);
+            int M = DimsVectorUtils::Count(output_dims, 1);
+            X86GemmWeightQuantAvx2(output_data, input_data, buffer_weight_.force_to<int8_t *>(),
+                                   buffer_scale_.force_to<float *>(), bias_data, input_dims[0], K, M,
+                                   param->weight_quant_bits, param->weight_quant_group_size);
+        } else if (impl_ == InnerProductSparse) {
+            int K = DimsVectorUtils::Count(input_dims, 1);
+            int M = DimsVectorUtils::Count(output_dims, 1);
+            X86GemmSparseWeightAvx2(output_data, input_data, weight_data, buffer_sparse_index_.force_to<int *>(),
+                                    bias_data, input_dims[0], K, M);
+        } else if (impl_ == InnerProductSgemv) {
             X86SgemvFunc(output_data, input_data, weight_data, bias_data, input_dims, output_dims);
         } else {
             int k_c = conv_gemm_conf_.K_c_;
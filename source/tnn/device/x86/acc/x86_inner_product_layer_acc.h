@@ -21,6 +21,10 @@
 enum InnerProductCompute {
     InnerProductSgemv = 0x0000,
     InnerProductSgemm = 0x0001,
+    // weight only quantized weights dequantized in registers
+    InnerProductWeightQuant = 0x0002,
+    // pruned weights in blocks of 8 output channels, zero blocks are skipped
+    InnerProductSparse = 0x0003,
 };
 
 namespace TNN_NS {
@@ -30,17 +34,26 @@ public:
 
     Status Init(Context *context, LayerParam *param, LayerResource *resource, const std::vector<Blob *> &inputs,
                 const std::vector<Blob *> &outputs) override;
+    virtual Status Reshape(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
     virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
     virtual Status allocateBufferWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
     virtual Status allocateBufferBias(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
 
 protected:
+    // pick the fastest gemm blocking for the current shapes, results are cached in the context
+    Status TuneGemmBlockSize(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+    // key of the packed gemm weights, the layout depends on the gemm block sizes
+    std::string GetGemmWeightKey();
+
     RawBuffer buffer_weight_;
     RawBuffer buffer_bias_;
     RawBuffer buffer_scale_;
+    RawBuffer buffer_sparse_index_;
     conv_gemm_config<float, float, float> conv_gemm_conf_;
-    InnerProductCompute impl_;
+    InnerProductCompute impl_ = InnerProductSgemv;
     std::shared_ptr<LayerResource> fc_acc_f32_resource_ = nullptr;
+    // key of the shapes conv_gemm_conf_ was tuned for
+    std::string tune_key_ = "";
 };
 
 }  // namespace TNN_NS
@@ -13,7 +13,11 @@
 // specific language governing permissions and limitations under the License.
 
 #include "tnn/device/x86/acc/x86_layer_acc.h"
+
+#include <chrono>
+
 #include "tnn/utils/blob_transfer_utils.h"
+#include "tnn/utils/dims_utils.h"
 
 namespace TNN_NS {
 
@@ -79,6 +83,99 @@ Status X86LayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vect
     return Status(TNNERR_LAYER_ERR, "DoForward not implement");
 }
 
+bool X86LayerAcc::IsSameDimsFloat(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    if (inputs.empty() || outputs.size() != 1) {
+        return false;
+    }
+    const auto &input_desc  = inputs[0]->GetBlobDesc();
+    const auto &output_desc = outputs[0]->GetBlobDesc();
+    return input_desc.data_type == DATA_TYPE_FLOAT && output_desc.data_type == DATA_TYPE_FLOAT &&
+           DimsVectorUtils::Equal(input_desc.dims, output_desc.dims);
+}
+
+Status X86LayerAcc::GetSharedWeights(const std::string &key, RawBuffer &buffer,
+                                     std::function<Status(RawBuffer &)> pack) {
+    // weights are stored by layer name, layers without a name keep their own
+    if (!context_ || !param_ || param_->name.empty()) {
+        return pack(buffer);
+    }
+    const std::string layer_key = param_->name + "/" + key;
+    bool packed                 = false;
+    auto status                 = context_->GetSharedWeights(layer_key, buffer, [&](RawBuffer &packed_buffer) {
+        packed = true;
+        return pack(packed_buffer);
+    });
+    RETURN_ON_NEQ(status, TNN_OK);
+    shared_weight_keys_.insert(layer_key);
+    if (packed) {
+        packed_weight_keys_.insert(layer_key);
+    }
+    return TNN_OK;
+}
+
+Status X86LayerAcc::GetSharedWeights(const std::string &key, RawBuffer &buffer, const std::string &second_key,
+                                     RawBuffer &second_buffer, std::function<Status(RawBuffer &, RawBuffer &)> pack) {
+    // the second buffer packed with the first one is kept until it is stored
+    RawBuffer packed_second;
+    bool packed = false;
+    RETURN_ON_NEQ(GetSharedWeights(key, buffer,
+                                   [&](RawBuffer &packed_buffer) {
+                                       packed = true;
+                                       return pack(packed_buffer, packed_second);
+                                   }),
+                  TNN_OK);
+    return GetSharedWeights(second_key, second_buffer, [&](RawBuffer &packed_buffer) -> Status {
+        if (!packed) {
+            RawBuffer unused;
+            RETURN_ON_NEQ(pack(unused, packed_second), TNN_OK);
+        }
+        packed_buffer = packed_second;
+        return TNN_OK;
+    });
+}
+
+void X86LayerAcc::ReleasePackedWeights(const std::string &key) {
+    if (!context_ || !param_ || param_->name.empty()) {
+        return;
+    }
+    const std::string layer_key = param_->name + "/" + key;
+    if (packed_weight_keys_.find(layer_key) == packed_weight_keys_.end()) {
+        return;
+    }
+    context_->ReleaseSharedWeights(layer_key);
+    packed_weight_keys_.erase(layer_key);
+    shared_weight_keys_.erase(layer_key);
+}
+
+double X86LayerAcc::MeasureDoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    const int tune_loops = 3;
+    // warm up, workspace is allocated in the first run
+    if (DoForward(inputs, outputs) != TNN_OK) {
+        return -1;
+    }
+    double min_time = -1;
+    for (int i = 0; i < tune_loops; ++i) {
+        auto begin = std::chrono::steady_clock::now();
+        if (DoForward(inputs, outputs) != TNN_OK) {
+            return -1;
+        }
+        auto end     = std::chrono::steady_clock::now();
+        double delta = std::chrono::duration<double, std::milli>(end - begin).count();
+        if (min_time < 0 || delta < min_time) {
+            min_time = delta;
+        }
+    }
+    return min_time;
+}
+
+const std::set<std::string> &X86LayerAcc::GetPackedWeightKeys() {
+    return packed_weight_keys_;
+}
+
+const std::set<std::string> &X86LayerAcc::GetSharedWeightKeys() {
+    return shared_weight_keys_;
+}
+
 Status X86LayerAcc::ReloadConstantBlobs(const std::vector<Blob *> &inputs, bool only_reload_shape_differ_blob) {
     auto const_resource = const_resource_;
     auto const_resource_flag = const_resource_flag_;
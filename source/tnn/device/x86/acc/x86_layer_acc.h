@@ -15,6 +15,8 @@
 #ifndef TNN_SOURCE_TNN_DEVICE_X86_X86_LAYER_ACC_H_
 #define TNN_SOURCE_TNN_DEVICE_X86_X86_LAYER_ACC_H_
 
+#include <set>
+#include <string>
 #include <vector>
 
 #include "tnn/core/abstract_layer_acc.h"
@@ -44,17 +46,43 @@ public:
     // Note: this func may cost much time, call this func only when necessary.
     virtual Status ReloadConstantBlobs(const std::vector<Blob *> &inputs, bool only_reload_shape_differ_blob = false);
 
+    // @brief keys of the shared weights this acc packed itself, see GetSharedWeights
+    const std::set<std::string> &GetPackedWeightKeys();
+
+    // @brief keys of all shared weights this acc uses
+    const std::set<std::string> &GetSharedWeightKeys();
+
+    // @brief min time of a few DoForward runs in ms, negative if one fails. used by kernel tuning
+    double MeasureDoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+
 #if TNN_PROFILE
     Timer timer;
 #endif
 
 protected:
+    // @brief inputs[0] and outputs[0] are float blobs of the same dims, elementwise accs may run in place then
+    bool IsSameDimsFloat(const std::vector<Blob*> &inputs, const std::vector<Blob*> &outputs);
+
+    // @brief get the packed weights of the layer stored with key, they are shared with the instances cloned from
+    // this instance. pack only runs if no weights are stored yet.
+    Status GetSharedWeights(const std::string &key, RawBuffer &buffer, std::function<Status(RawBuffer &)> pack);
+
+    // @brief as above for two buffers packed together, e.g. quantized weights and their scales
+    Status GetSharedWeights(const std::string &key, RawBuffer &buffer, const std::string &second_key,
+                            RawBuffer &second_buffer, std::function<Status(RawBuffer &, RawBuffer &)> pack);
+
+    // @brief release the shared weights stored with key if this acc packed them, e.g. for a kernel tune candidate
+    void ReleasePackedWeights(const std::string &key);
+
     LayerParam* param_          = nullptr;
     LayerResource* resource_    = nullptr;
     X86Context *context_           = nullptr;
     x86_isa_t arch_;
 
 private:
+    std::set<std::string> packed_weight_keys_;
+    std::set<std::string> shared_weight_keys_;
+
     // @brief return device layer acc support data format
     virtual std::vector<DataFormat> SupportDataFormat(DataType data_type, int dims_size, BlobType blob_type);
 };
@@ -17,105 +17,78 @@
 #include "tnn/utils/dims_vector_utils.h"
 #include "tnn/device/x86/acc/x86_lstm_layer_acc.h"
 #include "tnn/device/x86/acc/Float4.h"
-#include "tnn/utils/omp_utils.h"
+#include "tnn/device/x86/x86_thread_pool.h"
 namespace TNN_NS {
 
-static void X86LSTMActivate(const float *gates, float *h_t, float *c_t, float *y, int len) {
-    int len_vec  = len / 4 * 4;
-    OMP_PARALLEL_FOR_GUIDED_
-    for (int i = 0; i < len_vec; i += 4) {
-        Float4x4 vec = Float4x4::ld4u(gates + i * 4);
-        Float4 I, O, F, C;
-        vec.get_lane(I, 0);
-        vec.get_lane(O, 1);
-        vec.get_lane(F, 2);
-        vec.get_lane(C, 3);
-
-        I = Float4::sigmoid(I);
-        O = Float4::sigmoid(O);
-        F = Float4::sigmoid(F);
-        C = Float4::tanh(C);
-
-        Float4 cell2_vec = F * Float4::loadu(c_t + i) + I * C;
-        Float4 h_vec = O * Float4::tanh(cell2_vec);
-        Float4::saveu(c_t + i, cell2_vec);
-        Float4::saveu(h_t + i, h_vec);
-        Float4::saveu(y + i, h_vec);
+/*
+one recurrent step of 4 hidden units for one batch, gates = pre + bias + R * h_prev,
+gates of unit j are at [j * 4, j * 4 + 4) in the order of i, o, f, c
+*/
+static void X86LSTMCell4(const float *pre, const float *bias, const float *r, const float *h_prev, float *h_next,
+                         float *c_t, float *y, int hidden_size) {
+    Float4 acc0 = Float4::loadu(pre) + Float4::loadu(bias);
+    Float4 acc1 = Float4::loadu(pre + 4) + Float4::loadu(bias + 4);
+    Float4 acc2 = Float4::loadu(pre + 8) + Float4::loadu(bias + 8);
+    Float4 acc3 = Float4::loadu(pre + 12) + Float4::loadu(bias + 12);
+    const int r_stride = hidden_size * 4;
+    for (int k = 0; k < hidden_size; k++) {
+        Float4 h_k(h_prev + k);
+        auto r_k = r + k * r_stride;
+        Float4::mla(acc0, h_k, Float4::loadu(r_k));
+        Float4::mla(acc1, h_k, Float4::loadu(r_k + 4));
+        Float4::mla(acc2, h_k, Float4::loadu(r_k + 8));
+        Float4::mla(acc3, h_k, Float4::loadu(r_k + 12));
     }
-    for (int i = len_vec; i < len; i++) {
-        float I = gates[i * 4];
-        float O = gates[i * 4 + 1];
-        float F = gates[i * 4 + 2];
-        float C = gates[i * 4 + 3];
-
-        I = 1.f / (1.f + exp(-I));
-        F = 1.f / (1.f + exp(-F));
-        O = 1.f / (1.f + exp(-O));
-        C = tanh(C);
-
-        float cell2 = F * c_t[i] + I * C;
-        float H = O * tanh(cell2);
-        c_t[i] = cell2;
-        h_t[i] = H;
-        y[i] = H;
-    }
-}
 
-Status X86LSTMONNXLayerAcc::LSTMOneDirection(const float *x, float *y, const float *w, const float *r,
-                              const float *b, float *h_t, float *c_t, int seq_len, int batch_size,
-                              int input_size, int hidden_size, int reverse) {
-    int k_c = conv_gemm_conf_.K_c_;
-    int n_block = conv_gemm_conf_.n_block_;
+    float gates[16];
+    Float4::saveu(gates, acc0);
+    Float4::saveu(gates + 4, acc1);
+    Float4::saveu(gates + 8, acc2);
+    Float4::saveu(gates + 12, acc3);
+    Float4x4 vec = Float4x4::ld4u(gates);
+    Float4 I, O, F, C;
+    vec.get_lane(I, 0);
+    vec.get_lane(O, 1);
+    vec.get_lane(F, 2);
+    vec.get_lane(C, 3);
+
+    I = Float4::sigmoid(I);
+    O = Float4::sigmoid(O);
+    F = Float4::sigmoid(F);
+    C = Float4::tanh(C);
+
+    Float4 cell2_vec = F * Float4::loadu(c_t) + I * C;
+    Float4 h_vec     = O * Float4::tanh(cell2_vec);
+    Float4::saveu(c_t, cell2_vec);
+    Float4::saveu(h_next, h_vec);
+    Float4::saveu(y, h_vec);
+}
 
-    // sgemm for weight tensor
-    // weights: [4*hidden_size, input_size]
-    // inputs: [seq_len, batch, input_size]
-    int K = input_size;
-    int N = seq_len * batch_size;
-    int M = 4 * hidden_size;
-
-    // two temp buf: gemm_buf and gates_buf
-    size_t gemm_buf_size = ROUND_UP(k_c * ROUND_UP(N, n_block) * sizeof(float), 32);
-    size_t gates_buf_size = ROUND_UP(N * M * sizeof(float), 32);
-    size_t workspace_size = gemm_buf_size + gates_buf_size;
-    float *workspace = reinterpret_cast<float *>(context_->GetSharedWorkSpace(workspace_size));
-    float *gemm_buf = workspace;
-    float *gates_buf = workspace + gemm_buf_size / sizeof(float);
-
-    RawBuffer fake_bias(N * sizeof(float));
-    float *fake_bias_ptr = fake_bias.force_to<float *>();
-    conv_sgemm_tn_col_major_prepack_a(M, N, K, w, K, x, K, gates_buf, M,
-            fake_bias_ptr, ActivationType_None, gemm_buf, conv_gemm_conf_);
-    
-    for (int t = 0; t < seq_len; t++) {
-        int ti = reverse ? seq_len - 1 - t : t;
-        auto gates_t = gates_buf +  ti * batch_size * 4 * hidden_size;
-        auto y_t = y + ti * batch_size * hidden_size;
-
-        // add bias
-        OMP_PARALLEL_FOR_GUIDED_
-        for (int i = 0; i < batch_size; i++) {
-            auto gates_b = gates_t + i * 4 * hidden_size;
-            for (int j = 0; j < hidden_size; j++) {
-                auto gates_j = gates_b + j * 4;
-                auto bias_j = b + j * 4;
-                Float4::saveu(gates_j, Float4::loadu(gates_j) + Float4::loadu(bias_j));
-            }
+// one recurrent step of a single hidden unit, for the tail of hidden_size
+static void X86LSTMCell1(const float *pre, const float *bias, const float *r, const float *h_prev, float *h_next,
+                         float *c_t, float *y, int hidden_size) {
+    float gates[4];
+    for (int g = 0; g < 4; g++) {
+        gates[g] = pre[g] + bias[g];
+    }
+    const int r_stride = hidden_size * 4;
+    for (int k = 0; k < hidden_size; k++) {
+        auto r_k = r + k * r_stride;
+        for (int g = 0; g < 4; g++) {
+            gates[g] += h_prev[k] * r_k[g];
         }
-
-        // sgemm for recurrence weight
-        // weights: [4*hidden_size, hidden_size]
-        // inputs: [batch, hidden_size]
-        K = hidden_size;
-        N = batch_size;
-        M = 4 * hidden_size;
-        conv_sgemm_tn_col_major_prepack_a(M, N, K, r, K, h_t, K, gates_t, M,
-                nullptr, ActivationType_None, gemm_buf, conv_gemm_conf_);
-
-        // activation for h_t, c_t, output
-        X86LSTMActivate(gates_t, h_t, c_t, y_t, batch_size * hidden_size);
     }
-    return TNN_OK;
+
+    float I = 1.f / (1.f + exp(-gates[0]));
+    float O = 1.f / (1.f + exp(-gates[1]));
+    float F = 1.f / (1.f + exp(-gates[2]));
+    float C = tanh(gates[3]);
+
+    float cell2 = F * c_t[0] + I * C;
+    float H     = O * tanh(cell2);
+    c_t[0]      = cell2;
+    h_next[0]   = H;
+    y[0]        = H;
 }
 
 X86LSTMONNXLayerAcc::~X86LSTMONNXLayerAcc() {}
@@ -156,8 +129,7 @@ Status X86LSTMONNXLayerAcc::allocateBufferWeight(const std::vector<Blob *> &inpu
     RawBuffer w_temp_buffer(w_dims[0] * w_pack_size * sizeof(float), 32);
     
     // before conv_pack, trans from 4 * hidden_size to hidden_size * 4
-    size_t trans_size = MAX(w_direction_size, r_direction_size);
-    RawBuffer trans_buf(trans_size * sizeof(float));
+    RawBuffer trans_buf(w_direction_size * sizeof(float));
     int hidden_size = w_dims[1] / 4;
     float *trans_ptr = trans_buf.force_to<float *>();
 
@@ -177,25 +149,23 @@ Status X86LSTMONNXLayerAcc::allocateBufferWeight(const std::vector<Blob *> &inpu
         conv_pack_col_a_t(M, K, trans_ptr, K, w_dst, conv_gemm_conf_);
     }
 
-    // recurrence weights
+    // recurrence weights, transpose to [hidden_size(k), hidden_size(j) * 4], the fused step reads gates of
+    // consecutive hidden units for one k contiguously
     K = r_dims[2];
-    M = r_dims[1];
-    size_t r_pack_size = ROUND_UP(K, k_c) * ROUND_UP(M, m_block);
-    RawBuffer r_temp_buffer(r_dims[0] * r_pack_size * sizeof(float), 32);
+    size_t r_trans_size = K * hidden_size * 4;
+    RawBuffer r_temp_buffer(r_dims[0] * r_trans_size * sizeof(float));
     for (int d = 0; d < r_dims[0]; d++) {
         float *r_src = r_ptr + d * r_direction_size;
-        float *r_dst = r_temp_buffer.force_to<float *>() + d * r_pack_size;
+        float *r_dst = r_temp_buffer.force_to<float *>() + d * r_trans_size;
 
-        // transpose
         for (int i = 0; i < 4; i++) {
             for (int j = 0; j < hidden_size; j++) {
-                auto trans_dst = trans_ptr + j * 4 * r_dims[2] + i * r_dims[2];
-                auto trans_src = r_src + i * hidden_size * r_dims[2] + j * r_dims[2];
-                memcpy(trans_dst, trans_src, r_dims[2] * sizeof(float));
+                auto r_src_j = r_src + (i * hidden_size + j) * K;
+                for (int k = 0; k < K; k++) {
+                    r_dst[k * hidden_size * 4 + j * 4 + i] = r_src_j[k];
+                }
             }
         }
-
-        conv_pack_col_a_t(M, K, trans_ptr, K, r_dst, conv_gemm_conf_);
     }
 
     w_temp_buffer.SetDataType(DATA_TYPE_FLOAT);
@@ -239,7 +209,6 @@ Status X86LSTMONNXLayerAcc::DoForward(const std::vector<Blob *> &inputs, const s
     auto layer_param = dynamic_cast<LSTMONNXLayerParam *>(param_);
     int num_directions = layer_param->direction >=2 ? 2 : 1;
     
-    bool reverse = false;
     if (inputs.size() < 4) {
         return Status(TNNERR_LAYER_ERR, "LSTM has invalid inputs");
     }
@@ -274,8 +243,6 @@ Status X86LSTMONNXLayerAcc::DoForward(const std::vector<Blob *> &inputs, const s
 
     //R[iofc], recurrence weight tensor, shape [num_directions, 4*hidden_size, hidden_size]
     float *r = (float *)buffer_r_.force_to<float *>();
-    auto r_dims = inputs[2]->GetBlobDesc().dims;
-    size_t r_pack_size = ROUND_UP(r_dims[2], k_c) * ROUND_UP(r_dims[1], m_block);
     
     //B[iofc] Concatenation of [Wb[iofc], Rb[iofc]], [num_directions, 8*hidden_size]
     float *b = (float *)buffer_b_.force_to<float *>();
@@ -285,47 +252,105 @@ Status X86LSTMONNXLayerAcc::DoForward(const std::vector<Blob *> &inputs, const s
     //initial_c, initial value of the cell, If not specified - assumed to be 0. shape [num_directions, batch_size, hidden_size]
     auto c_t = (float *)((char*)(outputs[2]->GetHandle().base) + outputs[2]->GetHandle().bytes_offset);
 
-    if (inputs.size() >= 6) {
+    if (layer_param->direction < 0 || layer_param->direction > 2) {
+        return Status(TNNERR_PARAM_ERR, "LSTMONNX has invalid direction param");
+    }
+
+    // in stateful forward the state left by the last forward replaces initial_h and initial_c,
+    // only a forward lstm can go on with the next chunk of a stream
+    const int state_bytes    = num_directions * batch * hidden_size * sizeof(float);
+    const bool stateful      = context_->GetEnableStatefulForward() && layer_param->direction == 0;
+    if (stateful && state_h_.GetBytesSize() == state_bytes) {
+        memcpy((void *)h_t, state_h_.force_to<float *>(), state_bytes);
+        memcpy((void *)c_t, state_c_.force_to<float *>(), state_bytes);
+    } else if (inputs.size() >= 6) {
         auto h_0 = (float *)((char*)(blob_h0->GetHandle().base) + blob_h0->GetHandle().bytes_offset);
         auto c_0 = (float *)((char*)(blob_c0->GetHandle().base) + blob_c0->GetHandle().bytes_offset);
-        memcpy((void *)h_t, h_0, num_directions * batch * hidden_size * sizeof(float));
-        memcpy((void *)c_t, c_0, num_directions * batch * hidden_size * sizeof(float));
+        memcpy((void *)h_t, h_0, state_bytes);
+        memcpy((void *)c_t, c_0, state_bytes);
     } else {
-        memset((void *)h_t, 0, num_directions * batch * hidden_size * sizeof(float));
-        memset((void *)c_t, 0, num_directions * batch * hidden_size * sizeof(float));
+        memset((void *)h_t, 0, state_bytes);
+        memset((void *)c_t, 0, state_bytes);
     }
-    
-    if (layer_param->direction == 0 || layer_param->direction == 1) {
-        return LSTMOneDirection(x, y, w, r, b, h_t, c_t, T, batch, input_size, hidden_size, layer_param->direction);
-    } else if (layer_param->direction == 2) {
-        //Y shape [num_directions sequence batch_size hidden_size]
-        auto y_temp = std::shared_ptr<float>(new float[num_directions*T*batch*hidden_size], [](float* p) { delete[] p; });
-        auto y0 = y_temp.get();
-        auto y1 = y0 + T * batch * hidden_size;
-        LSTMOneDirection(x, y0, w, r, b, h_t, c_t, T, batch, input_size, hidden_size, 0);
-        
-        auto w1 = w + w_pack_size;
-        auto r1 = r + r_pack_size;
-        auto b1 = b + 4 * hidden_size;
-        auto h_t1 = h_t + batch * hidden_size;
-        auto c_t1 = c_t + batch * hidden_size;
-        LSTMOneDirection(x, y1, w1, r1, b1, h_t1, c_t1, T, batch, input_size, hidden_size, 1);
-        
-        //transpose [num_directions sequence batch_size hidden_size] to [sequence batch_size num_directions*hidden_size]
-        for (int i = 0; i < T*batch; i++) {
-            auto y0_data = y0 + i * hidden_size;
-            auto y1_data = y1 + i * hidden_size;
-            auto y_data = y + i * num_directions * hidden_size;
-
-            memcpy(y_data, y0_data, hidden_size * sizeof(float));
-            memcpy(y_data + hidden_size, y1_data, hidden_size * sizeof(float));
+
+    // sgemm for weight tensor
+    // weights: [4*hidden_size, input_size]
+    // inputs: [seq_len, batch, input_size]
+    const int K = input_size;
+    const int N = T * batch;
+    const int M = 4 * hidden_size;
+    const int state_size = num_directions * batch * hidden_size;
+
+    // workspace: gemm_buf, gates_buf of all directions, zero bias for gemm and two hidden state buffers
+    size_t gemm_buf_size  = ROUND_UP(k_c * ROUND_UP(N, conv_gemm_conf_.n_block_) * sizeof(float), 32);
+    size_t gates_buf_size = ROUND_UP(num_directions * N * M * sizeof(float), 32);
+    size_t zero_buf_size  = ROUND_UP(N * sizeof(float), 32);
+    size_t state_buf_size = ROUND_UP(state_size * sizeof(float), 32);
+    size_t workspace_size = gemm_buf_size + gates_buf_size + zero_buf_size + 2 * state_buf_size;
+    char *workspace = reinterpret_cast<char *>(context_->GetSharedWorkSpace(workspace_size));
+    float *gemm_buf  = reinterpret_cast<float *>(workspace);
+    float *gates_buf = reinterpret_cast<float *>(workspace + gemm_buf_size);
+    float *zero_bias = reinterpret_cast<float *>(workspace + gemm_buf_size + gates_buf_size);
+    float *h_prev    = reinterpret_cast<float *>(workspace + gemm_buf_size + gates_buf_size + zero_buf_size);
+    float *h_next    = h_prev + state_buf_size / sizeof(float);
+    memset(zero_bias, 0, N * sizeof(float));
+    memcpy(h_prev, h_t, state_size * sizeof(float));
+
+    for (int d = 0; d < num_directions; d++) {
+        conv_sgemm_tn_col_major_prepack_a(M, N, K, w + d * w_pack_size, K, x, K, gates_buf + d * N * M, M, zero_bias,
+                                          ActivationType_None, gemm_buf, conv_gemm_conf_);
+    }
+
+    // both directions step together, each writes its half of y in place
+    const int y_stride  = num_directions * hidden_size;
+    const int block_num = UP_DIV(hidden_size, 4);
+    for (int t = 0; t < T; t++) {
+        X86ParallelFor(0, num_directions * block_num, [&](int i, int thread_id) {
+            const int d       = i / block_num;
+            const int j       = i % block_num * 4;
+            const bool is_rev = layer_param->direction == 1 || d == 1;
+            const int ti      = is_rev ? T - 1 - t : t;
+            const float *r_d  = r + d * hidden_size * M + j * 4;
+            const float *b_d  = b + d * M + j * 4;
+            for (int bi = 0; bi < batch; bi++) {
+                const int state_offset = (d * batch + bi) * hidden_size;
+                const float *pre       = gates_buf + (d * N + ti * batch + bi) * M + j * 4;
+                const float *h_p       = h_prev + state_offset;
+                float *h_n             = h_next + state_offset + j;
+                float *c_n             = c_t + state_offset + j;
+                float *y_n             = y + (ti * batch + bi) * y_stride + d * hidden_size + j;
+                if (j + 4 <= hidden_size) {
+                    X86LSTMCell4(pre, b_d, r_d, h_p, h_n, c_n, y_n, hidden_size);
+                } else {
+                    for (int jj = 0; jj < hidden_size - j; jj++) {
+                        X86LSTMCell1(pre + jj * 4, b_d + jj * 4, r_d + jj * 4, h_p, h_n + jj, c_n + jj, y_n + jj,
+                                     hidden_size);
+                    }
+                }
+            }
+        });
+        std::swap(h_prev, h_next);
+    }
+    memcpy(h_t, h_prev, state_size * sizeof(float));
+
+    // outputs may share memory with other blobs, the state is kept in buffers of the acc
+    if (stateful) {
+        if (state_h_.GetBytesSize() != state_bytes) {
+            state_h_ = RawBuffer(state_bytes);
+            state_c_ = RawBuffer(state_bytes);
         }
-    } else {
-        return Status(TNNERR_PARAM_ERR, "LSTMONNX has invalid direction param");
+        memcpy(state_h_.force_to<float *>(), h_t, state_bytes);
+        memcpy(state_c_.force_to<float *>(), c_t, state_bytes);
     }
 
     return TNN_OK;
 }
 
+Status X86LSTMONNXLayerAcc::ResetState() {
+    state_h_ = RawBuffer();
+    state_c_ = RawBuffer();
+    return TNN_OK;
+}
+
 REGISTER_X86_ACC(LSTMONNX, LAYER_LSTMONNX);
 }  // namespace TNN_NS
@@ -29,15 +29,19 @@ public:
     virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
     virtual Status allocateBufferWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
     virtual Status allocateBufferBias(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
-protected:
-    Status LSTMOneDirection(const float *x, float *y, const float *w, const float *r,
-                           const float *b, float *h_t, float *c_t, int seq_len, int batch_size,
-                           int input_size, int hidden_size, int reverse);
+    virtual Status ResetState() override;
 
+protected:
+    // packed gate weights, [num_directions, packed 4*hidden_size x input_size]
     RawBuffer buffer_w_;
+    // recurrence weights transposed to [num_directions, hidden_size, hidden_size * 4]
     RawBuffer buffer_r_;
+    // summed gate and recurrence bias, [num_directions, hidden_size * 4]
     RawBuffer buffer_b_;
     conv_gemm_config<float, float, float> conv_gemm_conf_;
+    // hidden and cell state left by the last forward in stateful forward, [batch_size, hidden_size]
+    RawBuffer state_h_;
+    RawBuffer state_c_;
 };
 
 }  // namespace TNN_NS
@@ -14,12 +14,76 @@
 
 #include "tnn/device/x86/acc/x86_layer_acc.h"
 #include "tnn/utils/dims_vector_utils.h"
+#include "tnn/utils/weight_quant_utils.h"
+#include "tnn/device/x86/acc/compute/x86_compute.h"
 #include "tnn/device/x86/acc/x86_mat_mul_layer_acc.h"
 
 namespace TNN_NS {
 
 X86MatMulLayerAcc::~X86MatMulLayerAcc() {}
 
+Status X86MatMulLayerAcc::Init(Context *context, LayerParam *param, LayerResource *resource,
+                               const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    RETURN_ON_NEQ(X86LayerAcc::Init(context, param, resource, inputs, outputs), TNN_OK);
+
+    auto layer_param = dynamic_cast<MatMulLayerParam *>(param);
+    CHECK_PARAM_NULL(layer_param);
+    if (layer_param->weight_quant_bits <= 0) {
+        return TNN_OK;
+    }
+
+    auto res = dynamic_cast<MatMulLayerResource *>(resource);
+    CHECK_PARAM_NULL(res);
+    auto weight_dims = res->weight.GetBufferDims();
+    if (layer_param->weight_position != 1 || inputs.size() != 1 || weight_dims.size() != 2) {
+        LOGE("Error: weight only quantized matmul needs a 2d weight at position 1\n");
+        return Status(TNNERR_LAYER_ERR, "weight only quantized matmul needs a 2d weight at position 1");
+    }
+
+    // the quantized weight is stored transposed as [M][K], the dims stay {K, M}
+    const int K          = weight_dims[0];
+    const int M          = weight_dims[1];
+    const int bits       = layer_param->weight_quant_bits;
+    const int group_size = layer_param->weight_quant_group_size;
+    RETURN_ON_NEQ(WeightQuantUtils::CheckQuantizedBuffer(res->weight, res->scale_handle, M, K, bits, group_size),
+                  TNN_OK);
+
+    const std::string key = "mat_mul_weight_quant_b" + std::to_string(bits) + "_g" + std::to_string(group_size);
+    if (arch_ == avx2) {
+        const int group_count = WeightQuantUtils::GetGroupCount(K, group_size);
+        const int oc_blocks   = UP_DIV(M, 8);
+        auto pack             = [&](RawBuffer &weight, RawBuffer &scale) -> Status {
+            RawBuffer float_scale = ConvertHalfHandle(res->scale_handle);
+            weight                = RawBuffer(oc_blocks * X86WeightQuantBlockBytes(K, bits, group_size));
+            scale                 = RawBuffer(oc_blocks * group_count * 8 * sizeof(float));
+            X86PackWeightQuantC8(weight.force_to<int8_t *>(), scale.force_to<float *>(),
+                                 res->weight.force_to<int8_t *>(), float_scale.force_to<float *>(), M, K, bits,
+                                 group_size);
+            return TNN_OK;
+        };
+        RETURN_ON_NEQ(GetSharedWeights(key + "_weight", buffer_weight_, key + "_scale", buffer_scale_, pack), TNN_OK);
+        buffer_bias_ = RawBuffer(oc_blocks * 8 * sizeof(float));
+    } else {
+        auto pack = [&](RawBuffer &buffer) -> Status {
+            RawBuffer weight_t(M * K * sizeof(float));
+            RETURN_ON_NEQ(WeightQuantUtils::Dequantize(res->weight, res->scale_handle, M, K, bits, group_size,
+                                                       weight_t.force_to<float *>()),
+                          TNN_OK);
+            buffer   = RawBuffer(K * M * sizeof(float));
+            auto src = weight_t.force_to<float *>();
+            auto dst = buffer.force_to<float *>();
+            for (int m = 0; m < M; m++) {
+                for (int k = 0; k < K; k++) {
+                    dst[k * M + m] = src[m * K + k];
+                }
+            }
+            return TNN_OK;
+        };
+        RETURN_ON_NEQ(GetSharedWeights(key + "_dequantized", buffer_weight_, pack), TNN_OK);
+    }
+    return TNN_OK;
+}
+
 Status X86MatMulLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     auto param               = dynamic_cast<MatMulLayerParam *>(param_);
     auto resource            = dynamic_cast<MatMulLayerResource *>(resource_);
@@ -41,12 +105,24 @@ Status X86MatMulLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std
             matrix_a = static_cast<float *>(inputs[0]->GetHandle().base);
             matrix_b = static_cast<float *>(inputs[1]->GetHandle().base);
         } else {
-            auto weight = resource->weight.force_to<float *>();
+            auto weight = param->weight_quant_bits > 0 ? buffer_weight_.force_to<float *>()
+                                                       : resource->weight.force_to<float *>();
             matrix_a    = param->weight_position == 0 ? weight : static_cast<float *>(inputs[0]->GetHandle().base);
             matrix_b    = param->weight_position == 1 ? weight : static_cast<float *>(inputs[0]->GetHandle().base);
         }
         auto matrix_c = static_cast<float *>(outputs[0]->GetHandle().base);
 
+        if (param->weight_quant_bits > 0 && arch_ == avx2) {
+            // every row of a is multiplied by the same weight
+            int K    = matrix_b_dims[0];
+            int M    = matrix_b_dims[1];
+            int rows = DimsVectorUtils::Count(inputs[0]->GetBlobDesc().dims) / K;
+            X86GemmWeightQuantAvx2(matrix_c, matrix_a, buffer_weight_.force_to<int8_t *>(),
+                                   buffer_scale_.force_to<float *>(), buffer_bias_.force_to<float *>(), rows, K, M,
+                                   param->weight_quant_bits, param->weight_quant_group_size);
+            return TNN_OK;
+        }
+
         int k_c = conv_gemm_conf_.K_c_;
         int m_c = conv_gemm_conf_.M_c_;
         int n_block = conv_gemm_conf_.n_block_;
@@ -23,10 +23,17 @@ class X86MatMulLayerAcc : public X86LayerAcc {
 public:
     virtual ~X86MatMulLayerAcc();
 
+    Status Init(Context *context, LayerParam *param, LayerResource *resource, const std::vector<Blob *> &inputs,
+                const std::vector<Blob *> &outputs) override;
+
     virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
 
 protected:
     conv_gemm_config<float, float, float> conv_gemm_conf_;
+    // weight only quantized weight, packed for the avx2 kernel or dequantized to float
+    RawBuffer buffer_weight_;
+    RawBuffer buffer_scale_;
+    RawBuffer buffer_bias_;
 };
 
 }  // namespace TNN_NS
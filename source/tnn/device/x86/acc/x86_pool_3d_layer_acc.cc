@@ -0,0 +1,147 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <cfloat>
+
+#include "tnn/device/x86/acc/Float4.h"
+#include "tnn/device/x86/acc/Float8.h"
+#include "tnn/device/x86/acc/x86_layer_acc.h"
+#include "tnn/device/x86/x86_common.h"
+#include "tnn/device/x86/x86_thread_pool.h"
+#include "tnn/utils/dims_utils.h"
+
+namespace TNN_NS {
+
+class X86Pool3DLayerAcc : public X86LayerAcc {
+public:
+    virtual ~X86Pool3DLayerAcc(){};
+    virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
+    virtual std::vector<DataFormat> SupportDataFormat(DataType data_type, int dims_size, BlobType blob_type) override;
+};
+
+/*
+pool one channel, output rows are built tap by tap like the 3d depthwise conv,
+pads are excluded from the average, same as NaivePooling3D
+*/
+template <typename VEC, int pack>
+static void X86Pooling3D(float *dst, const float *src, const DimsVector &dims_input, const DimsVector &dims_output,
+                         PoolingLayerParam *param) {
+    const int id = dims_input[2], ih = dims_input[3], iw = dims_input[4];
+    const int od = dims_output[2], oh = dims_output[3], ow = dims_output[4];
+    const int kw = param->kernels[0], kh = param->kernels[1], kd = param->kernels[2];
+    const int sw = param->strides[0], sh = param->strides[1], sd = param->strides[2];
+    const int pw = param->pads[0], ph = param->pads[2], pd = param->pads[4];
+    const bool is_max = param->pool_type == 0;
+
+    for (int d = 0; d < od; d++) {
+        int d_start = MAX(d * sd - pd, 0);
+        int d_end   = MIN(d * sd - pd + kd, id);
+        for (int h = 0; h < oh; h++) {
+            int h_start  = MAX(h * sh - ph, 0);
+            int h_end    = MIN(h * sh - ph + kh, ih);
+            float *dst_h = dst + (d * oh + h) * ow;
+            for (int w = 0; w < ow; w++) {
+                dst_h[w] = is_max ? -FLT_MAX : 0.f;
+            }
+
+            for (int z = d_start; z < d_end; z++) {
+                for (int y = h_start; y < h_end; y++) {
+                    const float *src_h = src + (z * ih + y) * iw;
+                    for (int x = 0; x < kw; x++) {
+                        int w_base  = x - pw;
+                        int w_start = MIN(ow, MAX(0, UP_DIV(-w_base, sw)));
+                        int w_end   = MAX(w_start, MIN(ow, UP_DIV(iw - w_base, sw)));
+                        int w       = w_start;
+                        if (sw == 1) {
+                            const float *src_x = src_h + w_base;
+                            if (is_max) {
+                                for (; w + pack - 1 < w_end; w += pack) {
+                                    VEC::saveu(dst_h + w, VEC::max(VEC::loadu(dst_h + w), VEC::loadu(src_x + w)));
+                                }
+                            } else {
+                                for (; w + pack - 1 < w_end; w += pack) {
+                                    VEC::saveu(dst_h + w, VEC::add(VEC::loadu(dst_h + w), VEC::loadu(src_x + w)));
+                                }
+                            }
+                        }
+                        if (is_max) {
+                            for (; w < w_end; w++) {
+                                dst_h[w] = std::max(dst_h[w], src_h[w_base + w * sw]);
+                            }
+                        } else {
+                            for (; w < w_end; w++) {
+                                dst_h[w] += src_h[w_base + w * sw];
+                            }
+                        }
+                    }
+                }
+            }
+
+            // a window entirely in the pads gives 0, same as NaivePooling3D
+            int dh_count = MAX(d_end - d_start, 0) * MAX(h_end - h_start, 0);
+            for (int w = 0; w < ow; w++) {
+                int w_count = MIN(w * sw - pw + kw, iw) - MAX(w * sw - pw, 0);
+                int count   = dh_count * MAX(w_count, 0);
+                if (count <= 0) {
+                    dst_h[w] = 0.f;
+                } else if (!is_max) {
+                    dst_h[w] = dst_h[w] / count;
+                }
+            }
+        }
+    }
+}
+
+std::vector<DataFormat> X86Pool3DLayerAcc::SupportDataFormat(DataType data_type, int dims_size,
+                                                             BlobType blob_type) {
+    std::vector<DataFormat> support_list;
+    if (dims_size == 5 && data_type == DATA_TYPE_FLOAT) {
+        support_list.push_back(DATA_FORMAT_NCDHW);
+    }
+    return support_list;
+}
+
+Status X86Pool3DLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto param = dynamic_cast<PoolingLayerParam *>(param_);
+    if (!param) {
+        return Status(TNNERR_MODEL_ERR, "Error: PoolingLayerParam is nil");
+    }
+    if (outputs[0]->GetBlobDesc().data_type != DATA_TYPE_FLOAT) {
+        return Status(TNNERR_DEVICE_ACC_DATA_FORMAT_NOT_SUPPORT, "Error: this data type not supported in pooling 3d layer");
+    }
+
+    auto dims_input  = inputs[0]->GetBlobDesc().dims;
+    auto dims_output = outputs[0]->GetBlobDesc().dims;
+    auto input_ptr   = static_cast<float *>(inputs[0]->GetHandle().base);
+    auto output_ptr  = static_cast<float *>(outputs[0]->GetHandle().base);
+
+    const int in_spatial  = DimsVectorUtils::Count(dims_input, 2);
+    const int out_spatial = DimsVectorUtils::Count(dims_output, 2);
+
+    auto pool_func = X86Pooling3D<Float4, 4>;
+    if (arch_ == avx2) {
+        pool_func = X86Pooling3D<Float8, 8>;
+    }
+
+    X86ParallelFor(0, dims_output[0] * dims_output[1], [&](int nc, int thread_id) {
+        pool_func(output_ptr + (size_t)nc * out_spatial, input_ptr + (size_t)nc * in_spatial, dims_input,
+                  dims_output, param);
+    });
+
+    return TNN_OK;
+}
+
+REGISTER_X86_ACC(Pool3D, LAYER_POOLING_3D);
+
+}  // namespace TNN_NS
@@ -17,7 +17,7 @@
 #include "tnn/device/x86/x86_device.h"
 #include "tnn/device/x86/x86_common.h"
 #include "tnn/device/x86/x86_util.h"
-#include "tnn/utils/omp_utils.h"
+#include "tnn/device/x86/x86_thread_pool.h"
 
 #include "tnn/device/x86/acc/compute/x86_compute.h"
 #include "tnn/device/x86/acc/compute/x86_compute_int8.h"
@@ -85,7 +85,7 @@ Status X86PoolLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::
         c_pack = 8;
     }
 
-    int max_num_threads  = OMP_MAX_THREADS_NUM_;
+    int max_num_threads  = X86ThreadPool::GetMaxThreadsNum();
     size_t src_hw        = dims_input[3] * dims_input[2];
     size_t dst_hw        = dims_output[3] * dims_output[2];
     size_t src_pack_size = ROUND_UP(src_hw * c_pack * sizeof(float), 32);
@@ -97,9 +97,7 @@ Status X86PoolLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::
         for (int b = 0; b < batch; b++) {
             auto input_b  = reinterpret_cast<float *>(input_ptr) + b * dims_input[1] * src_hw;
             auto output_b = reinterpret_cast<float *>(output_ptr) + b * dims_output[1] * dst_hw;
-            OMP_PARALLEL_FOR_GUIDED_
-            for (int c = 0; c < dims_output[1]; c += c_pack) {
-                int thread_id = OMP_TID_;
+            X86ParallelFor(0, dims_output[1], c_pack, [&](int c, int thread_id) {
                 auto workspace_per_t = workspace + thread_id * ((src_pack_size + dst_pack_size) / sizeof(float));
                 auto src_pack_ptr    = workspace_per_t;
                 auto dst_pack_ptr    = workspace_per_t + src_pack_size / sizeof(float);
@@ -116,7 +114,7 @@ Status X86PoolLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::
                             param->strides[1], param->pads[0], param->pads[2]);
                 }
                 UnpackAcc(output_b + c * dst_hw, dst_pack_ptr, dst_hw, dst_hw, dst_hw, left_c);
-            }
+            });
         }
     } else if (input->GetBlobDesc().data_type == DATA_TYPE_INT8) {
         // INT8
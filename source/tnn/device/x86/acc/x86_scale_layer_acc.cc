@@ -20,7 +20,17 @@
 
 namespace TNN_NS {
 
-DECLARE_X86_ACC(Scale, LAYER_SCALE);
+class X86ScaleLayerAcc : public X86LayerAcc {
+public:
+    virtual ~X86ScaleLayerAcc(){};
+    virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
+    virtual bool SupportInPlace(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
+};
+
+// X86_FMA scales every element on its own
+bool X86ScaleLayerAcc::SupportInPlace(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    return inputs.size() == 1 && IsSameDimsFloat(inputs, outputs);
+}
 
 Status X86ScaleLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     
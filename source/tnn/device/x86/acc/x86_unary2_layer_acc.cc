@@ -57,6 +57,11 @@ Status X86_UNARY2_CALCULATE(DimsVector &dims, const float *src, float *dst, Laye
 
 X86Unary2LayerAcc::~X86Unary2LayerAcc() {}
 
+// the unary2 kernels load a vector of the input before the output vector of the same index is stored
+bool X86Unary2LayerAcc::SupportInPlace(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    return inputs.size() == 1 && IsSameDimsFloat(inputs, outputs);
+}
+
 Status X86Unary2LayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     auto input  = inputs[0];
     auto output = outputs[0];
@@ -20,7 +20,7 @@
 #include "tnn/device/x86/acc/Float8.h"
 #include "tnn/device/x86/acc/x86_layer_acc.h"
 #include "tnn/utils/dims_utils.h"
-#include "tnn/utils/omp_utils.h"
+#include "tnn/device/x86/x86_thread_pool.h"
 
 namespace TNN_NS {
 
@@ -55,10 +55,9 @@ void unary2_kernel_avx(std::vector<int> dims, const float *src, float *dst, Laye
     auto count = DimsVectorUtils::Count(dims);
     auto count_vec = count / 8 * 8;
 
-    OMP_PARALLEL_FOR_GUIDED_
-    for (int x = 0; x < count_vec; x += 8) {
+    X86ParallelFor(0, count_vec, 8, [&](int x, int thread_id) {
         Float8::saveu(dst + x, op(Float8::loadu(src + x)));
-    }
+    });
     for (int x = count_vec; x < count; x++) {
         dst[x] = op(src[x]);
     }
@@ -72,10 +71,9 @@ void unary2_kernel_sse(std::vector<int> dims, const float *src, float *dst, Laye
     auto count = DimsVectorUtils::Count(dims);
     auto count_vec = count / 4 * 4;
 
-    OMP_PARALLEL_FOR_GUIDED_
-    for (int x = 0; x < count_vec; x += 4) {
+    X86ParallelFor(0, count_vec, 4, [&](int x, int thread_id) {
         Float4::save(dst + x, op(Float4::load(src + x)));
-    }
+    });
     for (int x = count_vec; x < count; x++) {
         dst[x] = op(src[x]);
     }
@@ -90,6 +88,8 @@ public:
 
     virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
 
+    virtual bool SupportInPlace(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
+
     static Status RegisterUnary2Kernel(LayerType type, x86_isa_t arch, unary2_kernel_avx_func_t kernel);
     static Status GetUnary2Kernel(LayerType type, x86_isa_t arch, unary2_kernel_avx_func_t &kernel);
 
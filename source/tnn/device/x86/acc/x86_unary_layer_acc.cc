@@ -15,7 +15,7 @@
 #include "tnn/device/x86/acc/x86_unary_layer_acc.h"
 #include "tnn/device/x86/x86_context.h"
 #include "tnn/utils/dims_utils.h"
-#include "tnn/utils/omp_utils.h"
+#include "tnn/device/x86/x86_thread_pool.h"
 
 namespace TNN_NS {
 
@@ -27,6 +27,11 @@ Status X86UnaryLayerAcc::Init(Context *context, LayerParam *param, LayerResource
     return op_->Init(param);
 }
 
+// every output element only reads the input element of the same index
+bool X86UnaryLayerAcc::SupportInPlace(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    return inputs.size() == 1 && IsSameDimsFloat(inputs, outputs);
+}
+
 Status X86UnaryLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     auto input  = inputs[0];
     auto output = outputs[0];
@@ -37,10 +42,9 @@ Status X86UnaryLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std:
     auto input_data  = static_cast<float*>(input->GetHandle().base);
     auto output_data = static_cast<float*>(output->GetHandle().base);
 
-    OMP_PARALLEL_FOR_GUIDED_
-    for (int n = 0; n < count; n++) {
+    X86ParallelFor(0, count, [&](int n, int thread_id) {
         output_data[n] = (*op_)(input_data[n]);
-    }
+    });
 
     return TNN_OK;
 }
@@ -42,6 +42,8 @@ public:
                         const std::vector<Blob *> &outputs) override;
 
     virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
+
+    virtual bool SupportInPlace(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
 protected:
     std::shared_ptr<X86_UNARY_OP> op_;
 };
@@ -13,10 +13,25 @@
 // specific language governing permissions and limitations under the License.
 
 #include "tnn/device/x86/x86_context.h"
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "tnn/utils/cpu_utils.h"
 #include "tnn/utils/omp_utils.h"
 
 namespace TNN_NS {
 
+X86Context::X86Context() : init_thread_id_(std::this_thread::get_id()) {}
+
+X86Context::~X86Context() {
+    if (work_space_registered_) {
+        SharedWorkSpaceManager::ReleaseListener(init_thread_id_, DEVICE_X86, 0, this);
+    }
+}
+
 Status X86Context::LoadLibrary(std::vector<std::string> path) {
     return TNN_OK;
 }
@@ -25,34 +40,228 @@ Status X86Context::GetCommandQueue(void** command_queue) {
     return TNN_OK;
 }
 
+// Begin and End may nest, e.g. kernel tuning during a reshape, the outermost End restores the pool the calling
+// thread had before, so no pointer to this context is left on the thread
 Status X86Context::OnInstanceForwardBegin() {
     Context::OnInstanceForwardBegin();
+    if (forward_depth_++ == 0) {
+        outer_thread_pool_ = X86ThreadPool::GetCurrent();
+    }
+    X86ThreadPool::SetCurrent(thread_pool_.get());
     OMP_SET_THREADS_(GetNumThreads());
-    return TNN_OK;
+    return BindNumaNode();
 }
 
 Status X86Context::OnInstanceForwardEnd() {
+    if (forward_depth_ > 0 && --forward_depth_ == 0) {
+        X86ThreadPool::SetCurrent(outer_thread_pool_);
+        outer_thread_pool_ = nullptr;
+    }
+    return UnbindNumaNode();
+}
+
+// the cache file may be shared by instances of the same model
+static std::mutex g_tune_file_mutex;
+
+std::string X86Context::GetTuneFilePath() {
+    if (cache_path_.empty() || cache_file_path_.empty()) {
+        return "";
+    }
+    return cache_path_ + "/" + cache_file_path_ + "_kernel_tune";
+}
+
+Status X86Context::OnInstanceReshapeBegin() {
+    if (!enable_tune_kernel_) {
+        return TNN_OK;
+    }
+
+    auto tune_file_path = GetTuneFilePath();
+    if (!tune_file_path.empty() && tune_map_.empty()) {
+        std::lock_guard<std::mutex> lock(g_tune_file_mutex);
+        std::ifstream cache_stream(tune_file_path);
+        if (cache_stream.is_open() && cache_stream.good()) {
+            uint32_t cache_map_size = 0;
+            cache_stream >> cache_map_size;
+            for (uint32_t i = 0; i < cache_map_size && cache_stream.good(); ++i) {
+                std::string key;
+                uint32_t value_count = 0;
+                cache_stream >> key >> value_count;
+                // a tune result is {imp type, m block, k block}, the count is checked before it is allocated
+                if (!cache_stream.fail() && value_count == 3) {
+                    std::vector<int> values(value_count);
+                    for (uint32_t j = 0; j < value_count; ++j) {
+                        cache_stream >> values[j];
+                    }
+                    if (!cache_stream.fail()) {
+                        tune_map_[key] = values;
+                        continue;
+                    }
+                }
+                LOGE("X86Context: invalid kernel tune cache %s, ignored\n", tune_file_path.c_str());
+                tune_map_.clear();
+                break;
+            }
+            cache_stream.close();
+        }
+    }
+    tune_map_size_ = tune_map_.size();
     return TNN_OK;
 }
 
+Status X86Context::OnInstanceReshapeEnd() {
+    if (!enable_tune_kernel_) {
+        return TNN_OK;
+    }
+
+    auto tune_file_path = GetTuneFilePath();
+    if (!tune_file_path.empty() && tune_map_.size() > tune_map_size_) {
+        std::lock_guard<std::mutex> lock(g_tune_file_mutex);
+        tune_map_size_ = tune_map_.size();
+        std::ofstream cache_stream(tune_file_path);
+        if (!cache_stream.is_open()) {
+            LOGE("X86Context: open kernel tune cache %s failed\n", tune_file_path.c_str());
+            return TNN_OK;
+        }
+        cache_stream << tune_map_.size() << std::endl;
+        for (const auto &element : tune_map_) {
+            cache_stream << element.first << " " << element.second.size();
+            for (auto value : element.second) {
+                cache_stream << " " << value;
+            }
+            cache_stream << std::endl;
+        }
+        cache_stream.close();
+    }
+    return TNN_OK;
+}
+
+std::map<std::string, std::vector<int>>& X86Context::GetTuneMap() {
+    return tune_map_;
+}
+
 Status X86Context::Synchronize() {
     return TNN_OK;
 }
 
 Status X86Context::SetNumThreads(int num_threads) {
-    num_threads_ = MIN(MAX(num_threads, 1), OMP_CORES_);
-    return TNN_OK;
+    int num_cores = MAX((int)std::thread::hardware_concurrency(), OMP_CORES_);
+    num_threads_  = MIN(MAX(num_threads, 1), num_cores);
+    return thread_pool_->SetNumThreads(num_threads_);
+}
+
+Status X86Context::SetCpuAffinity(const std::vector<int>& cpu_list) {
+    std::vector<int> node_cpu_list = cpu_list;
+    if (numa_node_ >= 0) {
+        // only the cpus on the numa node of this context are used
+        node_cpu_list.clear();
+        for (auto cpu : cpu_list) {
+            if (std::find(node_cpu_list_.begin(), node_cpu_list_.end(), cpu) != node_cpu_list_.end()) {
+                node_cpu_list.push_back(cpu);
+            }
+        }
+        if (node_cpu_list.empty() && !cpu_list.empty()) {
+            LOGE("X86Context: no cpu of cpu_list is on numa node %d\n", numa_node_);
+            return Status(TNNERR_SET_CPU_AFFINITY, "no cpu of cpu_list is on the numa node");
+        }
+    }
+    cpu_list_ = node_cpu_list;
+    return thread_pool_->SetCpuAffinity(node_cpu_list);
+}
+
+Status X86Context::SetNumaNode(int numa_node) {
+    if (numa_node < 0) {
+        numa_node_ = -1;
+        node_cpu_list_.clear();
+        return thread_pool_->SetNumaNode(-1, {});
+    }
+
+    std::vector<int> node_cpu_list;
+    auto status = CpuUtils::GetNumaNodeCpus(numa_node, node_cpu_list);
+    if (status != TNN_OK || node_cpu_list.empty()) {
+        LOGE("X86Context: invalid numa node %d, the host has %d numa nodes\n", numa_node,
+             CpuUtils::GetNumaNodeCount());
+        return Status(TNNERR_PARAM_ERR, "invalid numa node");
+    }
+    numa_node_     = numa_node;
+    node_cpu_list_ = node_cpu_list;
+    return thread_pool_->SetNumaNode(numa_node, node_cpu_list);
+}
+
+// binds nest, e.g. kernel tuning runs a forward inside the binding of a reshape, only the outermost pair changes
+// and restores the state of the calling thread
+Status X86Context::BindNumaNode() {
+    if (bind_count_++ > 0 || (numa_node_ < 0 && cpu_list_.empty())) {
+        return TNN_OK;
+    }
+    // the calling thread runs as thread 0 of the pool
+    std::vector<int> bind_cpu_list = cpu_list_.empty() ? node_cpu_list_ : std::vector<int>({cpu_list_[0]});
+    RETURN_ON_NEQ(CpuUtils::GetCpuAffinity(unbound_cpu_list_), TNN_OK);
+    if (numa_node_ >= 0) {
+        RETURN_ON_NEQ(CpuUtils::GetMemoryPolicy(unbound_memory_mode_, unbound_node_mask_), TNN_OK);
+    }
+    thread_bound_        = true;
+    memory_policy_bound_ = numa_node_ >= 0;
+    if (unbound_cpu_list_ != bind_cpu_list) {
+        RETURN_ON_NEQ(CpuUtils::SetCpuAffinity(bind_cpu_list), TNN_OK);
+    }
+    return memory_policy_bound_ ? CpuUtils::SetNumaMemoryPolicy(numa_node_) : TNN_OK;
+}
+
+Status X86Context::UnbindNumaNode() {
+    if (bind_count_ == 0 || --bind_count_ > 0 || !thread_bound_) {
+        return TNN_OK;
+    }
+    thread_bound_ = false;
+    Status status = TNN_OK;
+    if (memory_policy_bound_) {
+        // the policy of the caller, e.g. set by numactl --membind, is kept
+        memory_policy_bound_ = false;
+        status               = CpuUtils::SetMemoryPolicy(unbound_memory_mode_, unbound_node_mask_);
+    }
+    if (!unbound_cpu_list_.empty()) {
+        auto affinity_status = CpuUtils::SetCpuAffinity(unbound_cpu_list_);
+        if (status == TNN_OK) {
+            status = affinity_status;
+        }
+    }
+    return status;
 }
 
 int X86Context::GetNumThreads() {
     return num_threads_;
 }
 
+Status X86Context::ParallelRun(int count, const std::function<void(int)>& task) {
+    if (count > thread_pool_->GetNumThreads()) {
+        return Status(TNNERR_PARAM_ERR, "ParallelRun count exceeds the number of threads");
+    }
+    thread_pool_->Run([&](int thread_id) {
+        if (thread_id < count) {
+            task(thread_id);
+        }
+    });
+    return TNN_OK;
+}
+
 void* X86Context::GetSharedWorkSpace(size_t size) {
     return GetSharedWorkSpace(size, 0);
 }
 
 void* X86Context::GetSharedWorkSpace(size_t size, int index) {
+    if (share_memory_mode_ == SHARE_MEMORY_MODE_SHARE_ONE_THREAD) {
+        if (!work_space_registered_) {
+            SharedWorkSpaceManager::RegisterListener(init_thread_id_, DEVICE_X86, 0, this);
+            work_space_registered_ = true;
+        }
+        if (index < shared_work_space_.size() && shared_work_space_[index].second >= size) {
+            return shared_work_space_[index].first;
+        }
+        // grows the workspace if needed, the cache is refreshed by OnSharedWorkSpaceChanged
+        void* memory = SharedWorkSpaceManager::GetSharedWorkSpace(size, index, init_thread_id_, DEVICE_X86, 0);
+        OnSharedWorkSpaceChanged(index, memory, size);
+        return memory;
+    }
+
     while(work_space_.size() < index + 1) {
         work_space_.push_back(RawBuffer(size, 32));
     }
@@ -62,4 +271,11 @@ void* X86Context::GetSharedWorkSpace(size_t size, int index) {
     return work_space_[index].force_to<void*>();
 }
 
+void X86Context::OnSharedWorkSpaceChanged(int index, void* memory, size_t size) {
+    while (shared_work_space_.size() < index + 1) {
+        shared_work_space_.push_back(std::make_pair(nullptr, 0));
+    }
+    shared_work_space_[index] = std::make_pair(memory, size);
+}
+
 }  // namespace TNN_NS
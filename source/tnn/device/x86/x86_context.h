@@ -15,16 +15,26 @@
 #ifndef TNN_SOURCE_TNN_DEVICE_X86_X86_CONTEXT_H_
 #define TNN_SOURCE_TNN_DEVICE_X86_X86_CONTEXT_H_
 
+#include <map>
+#include <memory>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "tnn/core/context.h"
+#include "tnn/device/x86/x86_thread_pool.h"
 #include "tnn/interpreter/raw_buffer.h"
+#include "tnn/memory_manager/shared_workspace_manager.h"
 
 namespace TNN_NS {
 
-class X86Context : public Context {
+class X86Context : public Context, public ISharedWorkSpaceChangeListener {
 public:
+    X86Context();
+
+    virtual ~X86Context();
+
     // load library
     virtual Status LoadLibrary(std::vector<std::string> path) override;
 
@@ -38,6 +48,12 @@ public:
     // @brief after instance forward
     virtual Status OnInstanceForwardEnd() override;
 
+    // @brief before instance Reshape, load kernel tune results from the cache file
+    virtual Status OnInstanceReshapeBegin() override;
+
+    // @brief after instance Reshape, store kernel tune results if new ones were added
+    virtual Status OnInstanceReshapeEnd() override;
+
     // @brief wait for jobs in the current context to complete
     virtual Status Synchronize() override;
 
@@ -45,14 +61,61 @@ public:
     virtual Status SetNumThreads(int num_threads) override;
 
     // @brief get threads run on device
-    virtual int GetNumThreads();
+    virtual int GetNumThreads() override;
+
+    // @brief run the tasks on the thread pool of this context
+    virtual Status ParallelRun(int count, const std::function<void(int)>& task) override;
+
+    // @brief pin the threads of this context to cpu_list
+    virtual Status SetCpuAffinity(const std::vector<int>& cpu_list) override;
 
+    // @brief run the thread pool of this context on the cpus of numa_node
+    virtual Status SetNumaNode(int numa_node) override;
+
+    // @brief pin the calling thread to the first cpu of SetCpuAffinity, or to the cpus of the numa node, and
+    // allocate its memory on the node. called before init, reshape and forward, the caller runs as thread 0 of
+    // the pool, so it is pinned only while it works for this context.
+    virtual Status BindNumaNode() override;
+
+    virtual Status UnbindNumaNode() override;
+
+    // @brief layer scratch memory, shared with the other x86 instances created in the same thread
+    // if share_memory_mode is SHARE_MEMORY_MODE_SHARE_ONE_THREAD
     void* GetSharedWorkSpace(size_t size);
     void* GetSharedWorkSpace(size_t size, int index);
 
+    // @brief keep the cached pointer valid when another instance grows the shared workspace
+    virtual void OnSharedWorkSpaceChanged(int index, void* memory, size_t size) override;
+
+    // @brief kernel tune results, the key is generated by the layer acc from its params and shapes
+    std::map<std::string, std::vector<int>>& GetTuneMap();
+
 private:
+    std::string GetTuneFilePath();
+
     int num_threads_ = 1;
     std::vector<RawBuffer> work_space_;
+    // SHARE_MEMORY_MODE_SHARE_ONE_THREAD, workspaces are owned by SharedWorkSpaceManager
+    std::thread::id init_thread_id_;
+    bool work_space_registered_ = false;
+    std::vector<std::pair<void*, size_t>> shared_work_space_;
+    // persistent workers used by X86ParallelFor during forward of this context
+    std::shared_ptr<X86ThreadPool> thread_pool_ = std::make_shared<X86ThreadPool>();
+    // nesting of OnInstanceForwardBegin and the pool bound to the calling thread before the outermost one
+    int forward_depth_                = 0;
+    X86ThreadPool* outer_thread_pool_ = nullptr;
+    std::map<std::string, std::vector<int>> tune_map_;
+    size_t tune_map_size_ = 0;
+    // cpus of numa_node_, cpu_list_ is the pinning of SetCpuAffinity on that node
+    std::vector<int> node_cpu_list_;
+    std::vector<int> cpu_list_;
+    // nesting of BindNumaNode, affinity and memory policy of the calling thread before the outermost one
+    int bind_count_           = 0;
+    bool thread_bound_        = false;
+    bool memory_policy_bound_ = false;
+    std::vector<int> unbound_cpu_list_;
+    int unbound_memory_mode_ = 0;
+    std::vector<unsigned long> unbound_node_mask_;
 };
 
 }  // namespace TNN_NS
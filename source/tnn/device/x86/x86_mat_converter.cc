@@ -14,6 +14,8 @@
 
 #include "tnn/device/x86/x86_mat_converter.h"
 
+#include <algorithm>
+
 #include "tnn/device/x86/x86_mat_util.h"
 
 #include "tnn/utils/dims_utils.h"
@@ -283,6 +285,46 @@ Status X86MatConverterAcc::CopyMakeBorder(Mat& src, Mat& dst, CopyMakeBorderPara
     return ret;
 }
 
+Status X86MatConverterAcc::CropResize(Mat& src, Mat& dst, CropResizeParam param, void* command_queue) {
+    Status ret = TNN_OK;
+
+    ret = CheckMatConverterParams(src, dst, true);
+    if (ret != TNN_OK)
+        return ret;
+
+    auto mat_type = src.GetMatType();
+    if (mat_type != NGRAY && mat_type != N8UC3 && mat_type != N8UC4) {
+        return Status(TNNERR_PARAM_ERR, "X86MatConverterAcc::CropResize, convert type not support yet");
+    }
+    int channel     = mat_type == NGRAY ? 1 : (mat_type == N8UC3 ? 3 : 4);
+    int num_boxes   = param.boxes.size();
+    int dst_w       = dst.GetWidth();
+    int dst_h       = dst.GetHeight();
+    int dst_channel = dst.GetChannel();
+    auto src_ptr    = (uint8_t*)src.GetData();
+
+    // boxes are independent, each thread writes whole dst images. the thread count only applies to this loop,
+    // the omp setting of the process is left as it is
+    int thread_count = std::max(param.num_threads, 1);
+    OMP_PARALLEL_FOR_DYNAMIC_THREADS_(thread_count)
+    for (int b = 0; b < num_boxes; ++b) {
+        float* dst_ptr = (float*)dst.GetData() + b * dst_channel * dst_h * dst_w;
+        if (!param.transforms.empty() && param.transforms[b].size() == 6) {
+            const float* t        = param.transforms[b].data();
+            float transform[2][3] = {{t[0], t[1], t[2]}, {t[3], t[4], t[5]}};
+            CropResizeWarpAffineToNCHW(src_ptr, src.GetWidth(), src.GetHeight(), channel, transform,
+                                       param.border_val, dst_ptr, dst_w, dst_h, dst_channel, param.scale.data(),
+                                       param.bias.data(), param.reverse_channel);
+        } else {
+            CropResizeBilinearToNCHW(src_ptr, src.GetWidth(), src.GetHeight(), channel, param.boxes[b], dst_ptr,
+                                     dst_w, dst_h, dst_channel, param.scale.data(), param.bias.data(),
+                                     param.reverse_channel);
+        }
+    }
+
+    return ret;
+}
+
 DECLARE_MAT_CONVERTER_CREATER(X86);
 REGISTER_MAT_CONVERTER(X86, DEVICE_X86);
 
@@ -29,6 +29,7 @@ public:
     virtual Status WarpAffine(Mat& src, Mat& dst, WarpAffineParam param, void* command_queue = NULL);
     virtual Status CvtColor(Mat& src, Mat& dst, ColorConversionType type, void* command_queue = NULL);
     virtual Status CopyMakeBorder(Mat& src, Mat& dst, CopyMakeBorderParam param, void* command_queue = NULL);
+    virtual Status CropResize(Mat& src, Mat& dst, CropResizeParam param, void* command_queue = NULL);
 };
 
 }  // namespace TNN_NS
@@ -15,7 +15,9 @@
 #include "tnn/device/x86/x86_mat_util.h"
 
 #include <algorithm>
+#include <cmath>
 #include <type_traits>
+#include <vector>
 
 #include "tnn/core/macro.h"
 #include "tnn/device/x86/x86_common.h"
@@ -1869,4 +1871,149 @@ void WarpAffineNearestYUV420sp(const uint8_t* src, int batch, int src_w, int src
     }
 }
 
+/*
+crop resize
+*/
+
+// horizontal pass of one src row into channel planes of w floats
+template <int channel>
+static void CropResizeHorizontalRow(const uint8_t* src_row, const int* xofs, const float* xalpha, int w,
+                                    float* rows) {
+    for (int dx = 0; dx < w; ++dx) {
+        const uint8_t* S0 = src_row + xofs[dx * 2];
+        const uint8_t* S1 = src_row + xofs[dx * 2 + 1];
+        float a           = xalpha[dx];
+        for (int c = 0; c < channel; ++c) {
+            rows[c * w + dx] = S0[c] + (S1[c] - S0[c]) * a;
+        }
+    }
+}
+
+// vertical pass fused with scale and bias, dst = (rows0 * b0 + rows1 * b1) * scale + bias
+static void CropResizeVerticalRow(const float* rows0, const float* rows1, float b0, float b1, float scale,
+                                  float bias, int w, float* dst) {
+    float c0 = b0 * scale;
+    float c1 = b1 * scale;
+    int x    = 0;
+#ifdef __AVX2__
+    __m256 v_c0   = _mm256_set1_ps(c0);
+    __m256 v_c1   = _mm256_set1_ps(c1);
+    __m256 v_bias = _mm256_set1_ps(bias);
+    for (; x + 7 < w; x += 8) {
+        __m256 acc = _mm256_fmadd_ps(_mm256_loadu_ps(rows0 + x), v_c0, v_bias);
+        acc        = _mm256_fmadd_ps(_mm256_loadu_ps(rows1 + x), v_c1, acc);
+        _mm256_storeu_ps(dst + x, acc);
+    }
+#endif
+    for (; x < w; ++x) {
+        dst[x] = rows0[x] * c0 + rows1[x] * c1 + bias;
+    }
+}
+
+template <int channel>
+static void CropResizeBilinearImpl(const uint8_t* src, int src_w, int src_h, const CropParam& box, float* dst,
+                                   int dst_w, int dst_h, int dst_channel, const float* scale, const float* bias,
+                                   bool reverse_channel) {
+    float scale_x = (float)box.width / dst_w;
+    float scale_y = (float)box.height / dst_h;
+
+    std::vector<int> xofs(dst_w * 2);
+    std::vector<float> xalpha(dst_w);
+    for (int dx = 0; dx < dst_w; ++dx) {
+        int x0, x1;
+        CropResizePosition(dx, box.top_left_x, scale_x, src_w, &x0, &x1, &xalpha[dx]);
+        xofs[dx * 2]     = x0 * channel;
+        xofs[dx * 2 + 1] = x1 * channel;
+    }
+
+    std::vector<float> rows_buf(channel * dst_w * 2);
+    float* rows0   = rows_buf.data();
+    float* rows1   = rows0 + channel * dst_w;
+    int prev_y0    = -1;
+    int prev_y1    = -1;
+    int src_stride = src_w * channel;
+    int dst_plane  = dst_h * dst_w;
+
+    for (int dy = 0; dy < dst_h; ++dy) {
+        int y0, y1;
+        float by;
+        CropResizePosition(dy, box.top_left_y, scale_y, src_h, &y0, &y1, &by);
+        // adjacent dst rows mostly share src rows, only resize the new ones
+        if (y0 == prev_y1 && y0 != prev_y0) {
+            std::swap(rows0, rows1);
+            CropResizeHorizontalRow<channel>(src + y1 * src_stride, xofs.data(), xalpha.data(), dst_w, rows1);
+        } else if (y0 != prev_y0 || y1 != prev_y1) {
+            CropResizeHorizontalRow<channel>(src + y0 * src_stride, xofs.data(), xalpha.data(), dst_w, rows0);
+            CropResizeHorizontalRow<channel>(src + y1 * src_stride, xofs.data(), xalpha.data(), dst_w, rows1);
+        }
+        prev_y0 = y0;
+        prev_y1 = y1;
+
+        for (int c = 0; c < dst_channel; ++c) {
+            int sc = CropResizeSrcChannel(c, channel, reverse_channel);
+            CropResizeVerticalRow(rows0 + sc * dst_w, rows1 + sc * dst_w, 1.f - by, by, scale[c], bias[c], dst_w,
+                                  dst + c * dst_plane + dy * dst_w);
+        }
+    }
+}
+
+void CropResizeBilinearToNCHW(const uint8_t* src, int src_w, int src_h, int channel, const CropParam& box,
+                              float* dst, int dst_w, int dst_h, int dst_channel, const float* scale, const float* bias,
+                              bool reverse_channel) {
+    if (channel == 1) {
+        CropResizeBilinearImpl<1>(src, src_w, src_h, box, dst, dst_w, dst_h, dst_channel, scale, bias,
+                                  reverse_channel);
+    } else if (channel == 3) {
+        CropResizeBilinearImpl<3>(src, src_w, src_h, box, dst, dst_w, dst_h, dst_channel, scale, bias,
+                                  reverse_channel);
+    } else if (channel == 4) {
+        CropResizeBilinearImpl<4>(src, src_w, src_h, box, dst, dst_w, dst_h, dst_channel, scale, bias,
+                                  reverse_channel);
+    }
+}
+
+void CropResizeWarpAffineToNCHW(const uint8_t* src, int src_w, int src_h, int channel, const float (*transform)[3],
+                                float border_val, float* dst, int dst_w, int dst_h, int dst_channel,
+                                const float* scale, const float* bias, bool reverse_channel) {
+    double m[6];
+    WarpAffineMatrixInverse(transform, m);
+
+    int src_ch[4];
+    for (int c = 0; c < dst_channel; ++c) {
+        src_ch[c] = CropResizeSrcChannel(c, channel, reverse_channel);
+    }
+    int dst_plane = dst_h * dst_w;
+
+    for (int dy = 0; dy < dst_h; ++dy) {
+        float* dst_y = dst + dy * dst_w;
+        for (int dx = 0; dx < dst_w; ++dx) {
+            float fx = (float)(m[0] * dx + m[1] * dy + m[2]);
+            float fy = (float)(m[3] * dx + m[4] * dy + m[5]);
+            int x0   = (int)std::floor(fx);
+            int y0   = (int)std::floor(fy);
+            float ax = fx - x0;
+            float by = fy - y0;
+
+            // taps out of src take the border value
+            bool in_x0 = x0 >= 0 && x0 < src_w;
+            bool in_x1 = x0 + 1 >= 0 && x0 + 1 < src_w;
+            bool in_y0 = y0 >= 0 && y0 < src_h;
+            bool in_y1 = y0 + 1 >= 0 && y0 + 1 < src_h;
+            const uint8_t* S0 = src + (y0 * src_w + x0) * channel;
+            const uint8_t* S1 = S0 + src_w * channel;
+
+            for (int c = 0; c < dst_channel; ++c) {
+                int sc    = src_ch[c];
+                float v00 = (in_y0 && in_x0) ? S0[sc] : border_val;
+                float v01 = (in_y0 && in_x1) ? S0[sc + channel] : border_val;
+                float v10 = (in_y1 && in_x0) ? S1[sc] : border_val;
+                float v11 = (in_y1 && in_x1) ? S1[sc + channel] : border_val;
+                float v0  = v00 + (v01 - v00) * ax;
+                float v1  = v10 + (v11 - v10) * ax;
+                dst_y[c * dst_plane + dx] = (v0 + (v1 - v0) * by) * scale[c] + bias[c];
+            }
+        }
+    }
+}
+
 }  // namespace TNN_NS
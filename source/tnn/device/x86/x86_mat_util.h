@@ -21,6 +21,7 @@
 #include "tnn/core/blob.h"
 #include "tnn/core/macro.h"
 #include "tnn/utils/bfp16.h"
+#include "tnn/utils/mat_utils.h"
 
 namespace TNN_NS {
 
@@ -77,6 +78,14 @@ void WarpAffineNearestC4(const uint8_t* src, int batch, int src_w, int src_h, ui
 void WarpAffineNearestYUV420sp(const uint8_t* src, int batch, int src_w, int src_h, uint8_t* dst, int w, int h,
                                const float (*transform)[3], const float border_val = 0.0);
 
+// crop resize, dst is dst_channel float planes of dst_h x dst_w, dst = value * scale + bias
+void CropResizeBilinearToNCHW(const uint8_t* src, int src_w, int src_h, int channel, const CropParam& box,
+                              float* dst, int dst_w, int dst_h, int dst_channel, const float* scale, const float* bias,
+                              bool reverse_channel);
+void CropResizeWarpAffineToNCHW(const uint8_t* src, int src_w, int src_h, int channel, const float (*transform)[3],
+                                float border_val, float* dst, int dst_w, int dst_h, int dst_channel,
+                                const float* scale, const float* bias, bool reverse_channel);
+
 }  // namespace TNN_NS
 
 #endif  // TNN_SOURCE_TNN_DEVICE_X86_X86_MAT_UTIL_H_
@@ -0,0 +1,184 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "tnn/device/x86/x86_thread_pool.h"
+
+#include <immintrin.h>
+
+#include "tnn/utils/cpu_utils.h"
+
+namespace TNN_NS {
+
+// spin iterations before a worker parks, roughly 10~100us depending on the pause latency
+static const int kSpinCount = 2000;
+
+static thread_local X86ThreadPool *g_current_pool = nullptr;
+static thread_local int g_thread_id               = 0;
+static thread_local bool g_in_parallel_region     = false;
+
+X86ThreadPool::X86ThreadPool() : generation_(0), pending_(0) {}
+
+X86ThreadPool::~X86ThreadPool() {
+    StopWorkers();
+}
+
+Status X86ThreadPool::SetNumThreads(int num_threads) {
+    num_threads = MAX(num_threads, 1);
+    std::unique_lock<std::mutex> run_lock(run_mutex_);
+    if (num_threads == num_threads_) {
+        return TNN_OK;
+    }
+    StopWorkers();
+    num_threads_ = num_threads;
+    StartWorkers();
+    return TNN_OK;
+}
+
+int X86ThreadPool::GetNumThreads() {
+    return num_threads_;
+}
+
+Status X86ThreadPool::SetCpuAffinity(const std::vector<int> &cpu_list) {
+    std::unique_lock<std::mutex> run_lock(run_mutex_);
+    StopWorkers();
+    cpu_list_ = cpu_list;
+    StartWorkers();
+    return TNN_OK;
+}
+
+Status X86ThreadPool::SetNumaNode(int numa_node, const std::vector<int> &node_cpu_list) {
+    std::unique_lock<std::mutex> run_lock(run_mutex_);
+    StopWorkers();
+    numa_node_     = numa_node;
+    node_cpu_list_ = numa_node < 0 ? std::vector<int>() : node_cpu_list;
+    StartWorkers();
+    return TNN_OK;
+}
+
+void X86ThreadPool::StartWorkers() {
+    stop_ = false;
+    for (int i = 1; i < num_threads_; ++i) {
+        // pass the current generation, a worker starting late must not skip the first task
+        workers_.emplace_back(&X86ThreadPool::WorkerLoop, this, i, generation_.load(std::memory_order_relaxed));
+    }
+}
+
+void X86ThreadPool::StopWorkers() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+void X86ThreadPool::WorkerLoop(int thread_id, uint64_t seen) {
+    if (!cpu_list_.empty()) {
+        CpuUtils::SetCpuAffinity({cpu_list_[thread_id % cpu_list_.size()]});
+    } else if (!node_cpu_list_.empty()) {
+        CpuUtils::SetCpuAffinity(node_cpu_list_);
+    }
+    if (numa_node_ >= 0) {
+        CpuUtils::SetNumaMemoryPolicy(numa_node_);
+    }
+    g_thread_id = thread_id;
+    while (true) {
+        uint64_t current = generation_.load(std::memory_order_acquire);
+        for (int spin = 0; current == seen && spin < kSpinCount; ++spin) {
+            _mm_pause();
+            current = generation_.load(std::memory_order_acquire);
+        }
+        if (current == seen) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [&] { return stop_ || generation_.load(std::memory_order_acquire) != seen; });
+            if (stop_) {
+                return;
+            }
+            current = generation_.load(std::memory_order_acquire);
+        }
+        seen = current;
+
+        g_in_parallel_region = true;
+        (*task_)(thread_id);
+        g_in_parallel_region = false;
+        if (pending_.fetch_sub(1, std::memory_order_release) == 1) {
+            // the caller checks pending_ under the lock before it parks, so the notify is not lost
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+            }
+            done_cond_.notify_one();
+        }
+    }
+}
+
+void X86ThreadPool::Run(const std::function<void(int)> &task) {
+    std::unique_lock<std::mutex> run_lock(run_mutex_);
+    if (workers_.empty()) {
+        g_in_parallel_region = true;
+        task(0);
+        g_in_parallel_region = false;
+        return;
+    }
+
+    task_ = &task;
+    pending_.store((int)workers_.size(), std::memory_order_relaxed);
+    generation_.fetch_add(1, std::memory_order_release);
+    {
+        // parked workers check generation_ under the lock, so no wakeup is lost
+        std::unique_lock<std::mutex> lock(mutex_);
+    }
+    cond_.notify_all();
+
+    g_in_parallel_region = true;
+    task(0);
+    g_in_parallel_region = false;
+
+    for (int spin = 0; pending_.load(std::memory_order_acquire) > 0 && spin < kSpinCount; ++spin) {
+        _mm_pause();
+    }
+    if (pending_.load(std::memory_order_acquire) > 0) {
+        // a slow worker, park like the workers do
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cond_.wait(lock, [&] { return pending_.load(std::memory_order_acquire) == 0; });
+    }
+    task_ = nullptr;
+}
+
+void X86ThreadPool::SetCurrent(X86ThreadPool *pool) {
+    g_current_pool = pool;
+}
+
+X86ThreadPool *X86ThreadPool::GetCurrent() {
+    return g_current_pool;
+}
+
+int X86ThreadPool::GetMaxThreadsNum() {
+    if (g_current_pool == nullptr || g_in_parallel_region) {
+        return g_in_parallel_region ? g_thread_id + 1 : 1;
+    }
+    return g_current_pool->GetNumThreads();
+}
+
+int X86ThreadPool::GetThreadId() {
+    return g_thread_id;
+}
+
+bool X86ThreadPool::InParallelRegion() {
+    return g_in_parallel_region;
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,136 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef TNN_SOURCE_TNN_DEVICE_X86_X86_THREAD_POOL_H_
+#define TNN_SOURCE_TNN_DEVICE_X86_X86_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "tnn/core/macro.h"
+#include "tnn/core/status.h"
+
+namespace TNN_NS {
+
+// @brief X86ThreadPool keeps its worker threads alive across parallel regions.
+// Workers spin for a short while after a region ends and then park on a
+// condition variable, so back-to-back layers do not pay a fork/join each.
+// The caller of Run waits for the workers the same way.
+// The thread calling Run always takes part as thread 0.
+class X86ThreadPool {
+public:
+    X86ThreadPool();
+    ~X86ThreadPool();
+
+    // @brief set number of threads including the calling thread, workers are recreated if changed
+    Status SetNumThreads(int num_threads);
+
+    int GetNumThreads();
+
+    // @brief pin worker i to cpu_list[i % cpu_list.size()], empty list removes pinning. thread 0 is the thread
+    // calling Run, its owner pins it to cpu_list[0] while it runs tasks on the pool.
+    Status SetCpuAffinity(const std::vector<int> &cpu_list);
+
+    // @brief run the workers on node_cpu_list and allocate their memory on numa_node, -1 removes the binding.
+    // pinning by SetCpuAffinity takes precedence over node_cpu_list.
+    Status SetNumaNode(int numa_node, const std::vector<int> &node_cpu_list);
+
+    // @brief run task(thread_id) on every thread of the pool and wait for all of them
+    void Run(const std::function<void(int)> &task);
+
+    // @brief bind the pool to the calling thread, X86ParallelFor uses the bound pool
+    static void SetCurrent(X86ThreadPool *pool);
+
+    static X86ThreadPool *GetCurrent();
+
+    // @brief max number of threads a parallel region on the calling thread may use
+    static int GetMaxThreadsNum();
+
+    // @brief thread id inside the current parallel region, 0 outside of it
+    static int GetThreadId();
+
+    // @brief true while the calling thread executes a parallel region
+    static bool InParallelRegion();
+
+private:
+    void StartWorkers();
+    void StopWorkers();
+    void WorkerLoop(int thread_id, uint64_t seen);
+
+    int num_threads_ = 1;
+    std::vector<int> cpu_list_;
+    int numa_node_ = -1;
+    std::vector<int> node_cpu_list_;
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    // the last worker finishing a task wakes Run
+    std::condition_variable done_cond_;
+    bool stop_ = false;
+
+    // bumped by Run to publish a new task to the workers
+    std::atomic<uint64_t> generation_;
+    std::atomic<int> pending_;
+    const std::function<void(int)> *task_ = nullptr;
+
+    // serialize Run calls from different threads sharing one pool
+    std::mutex run_mutex_;
+};
+
+// @brief parallel for over [begin, end) with step on the pool bound to the calling thread.
+// func is called as func(index, thread_id), thread_id is below X86ThreadPool::GetMaxThreadsNum().
+// Iterations are handed out in chunks from a shared counter, so uneven work is balanced.
+template <typename Func>
+void X86ParallelFor(int begin, int end, int step, const Func &func) {
+    if (end <= begin) {
+        return;
+    }
+    const int count = (end - begin + step - 1) / step;
+    auto pool       = X86ThreadPool::GetCurrent();
+    if (pool == nullptr || pool->GetNumThreads() <= 1 || count <= 1 || X86ThreadPool::InParallelRegion()) {
+        const int thread_id = X86ThreadPool::GetThreadId();
+        for (int i = begin; i < end; i += step) {
+            func(i, thread_id);
+        }
+        return;
+    }
+
+    const int num_threads = pool->GetNumThreads();
+    const int chunk       = MAX(1, count / (num_threads * 4));
+    const int num_chunks  = (count + chunk - 1) / chunk;
+    std::atomic<int> next_chunk(0);
+    pool->Run([&](int thread_id) {
+        int c;
+        while ((c = next_chunk.fetch_add(1, std::memory_order_relaxed)) < num_chunks) {
+            const int chunk_end = MIN(count, (c + 1) * chunk);
+            for (int idx = c * chunk; idx < chunk_end; ++idx) {
+                func(begin + idx * step, thread_id);
+            }
+        }
+    });
+}
+
+template <typename Func>
+void X86ParallelFor(int begin, int end, const Func &func) {
+    X86ParallelFor(begin, end, 1, func);
+}
+
+}  // namespace TNN_NS
+
+#endif  // TNN_SOURCE_TNN_DEVICE_X86_X86_THREAD_POOL_H_
@@ -132,6 +132,14 @@ struct ConvLayerParam : public LayerParam {
     PARAM_COPY(ConvLayerParam)
 };
 
+// @brief depthwise conv followed by a 1x1 conv, created by the dw pw fusion optimizer
+struct FusedDwPwConvLayerParam : public LayerParam {
+    std::shared_ptr<ConvLayerParam> dw_param = nullptr;
+    std::shared_ptr<ConvLayerParam> pw_param = nullptr;
+
+    PARAM_COPY(FusedDwPwConvLayerParam)
+};
+
 struct PadLayerParam : public LayerParam {
     // for old Pad the order is  [w_begin, w_end, h_begin, h_end, c_begin, c_end]
     // for PadV2 the order correspand to input dims, same as ONNX, like [x1_begin, x2_begin,...,x1_end, x2_end,...]
@@ -321,6 +329,10 @@ struct InnerProductLayerParam : public LayerParam {
     int has_bias   = 0;
     int transpose  = 0;
     int axis       = 0;
+    // weight only quantization: 8 or 4 bits int weights with float scales, 0 for float weights
+    int weight_quant_bits = 0;
+    // input channels sharing a scale, 0 for one scale per output channel
+    int weight_quant_group_size = 0;
 
     PARAM_COPY(InnerProductLayerParam)
 };
@@ -607,6 +619,16 @@ struct LSTMONNXLayerParam : public LayerParam {
     PARAM_COPY(LSTMONNXLayerParam)
 };
 
+struct GRUONNXLayerParam : public LayerParam {
+    int hidden_size = 0;
+    // 0: forward 1:reverse 2:bidirection
+    int direction = 0;
+    // 1: apply the reset gate after the recurrence of the hidden gate
+    int linear_before_reset = 0;
+
+    PARAM_COPY(GRUONNXLayerParam)
+};
+
 struct ExpandLayerParam : public LayerParam {
     std::vector<int> shape;
 
@@ -618,6 +640,9 @@ struct MatMulLayerParam : public LayerParam {
     DimsVector matrix_a_dims;
     DimsVector matrix_b_dims;
     int axis = 0;
+    // weight only quantization of the 2d weight at position 1, see InnerProductLayerParam
+    int weight_quant_bits       = 0;
+    int weight_quant_group_size = 0;
 
     PARAM_COPY(MatMulLayerParam)
 };
@@ -53,6 +53,13 @@ struct ConvLayerResource : public LayerResource {
     RawBuffer scale_handle;
 };
 
+struct FusedDwPwConvLayerResource : public LayerResource {
+    // resource of the depthwise conv
+    std::shared_ptr<ConvLayerResource> dw_resource = nullptr;
+    // resource of the 1x1 conv
+    std::shared_ptr<ConvLayerResource> pw_resource = nullptr;
+};
+
 struct BatchNormLayerResource : public LayerResource {
     // bn k buffer
     RawBuffer scale_handle;
@@ -148,6 +155,8 @@ struct UnsqueezeLayerResource : public SqueezeLayerResource {};
 
 struct MatMulLayerResource : public LayerResource {
     RawBuffer weight;
+    // scales of weight only quantized weight
+    RawBuffer scale_handle;
 };
 
 struct BiasAddLayerResource : public LayerResource {
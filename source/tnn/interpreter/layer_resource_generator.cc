@@ -179,6 +179,70 @@ class Convolution1DLayerResourceGenerator : public LayerResourceGenerator {
     }
 };
 
+/*
+ * Generate fused depthwise + 1x1 conv resource
+ */
+class FusedDwPwConvolutionLayerResourceGenerator : public LayerResourceGenerator {
+    virtual Status GenLayerResource(LayerParam* param, LayerResource** resource, std::vector<Blob*>& inputs) {
+        LOGD("FusedDwPwConvolutionLayerResourceGenerator\n");
+        auto layer_param = dynamic_cast<FusedDwPwConvLayerParam*>(param);
+        CHECK_PARAM_NULL(layer_param);
+        auto dw_param = layer_param->dw_param;
+        auto pw_param = layer_param->pw_param;
+        CHECK_PARAM_NULL(dw_param.get());
+        CHECK_PARAM_NULL(pw_param.get());
+
+        auto channel   = inputs[0]->GetBlobDesc().dims[1];
+        auto layer_res = new FusedDwPwConvLayerResource();
+        auto dw_res    = std::make_shared<ConvLayerResource>();
+        auto pw_res    = std::make_shared<ConvLayerResource>();
+
+        int dw_filter_size = channel * dw_param->kernels[0] * dw_param->kernels[1];
+        dw_res->filter_handle = RawBuffer(dw_filter_size * sizeof(float));
+        InitRandom(dw_res->filter_handle.force_to<float*>(), dw_filter_size, 1.0f);
+        if (dw_param->bias) {
+            dw_res->bias_handle = RawBuffer(channel * sizeof(float));
+            InitRandom(dw_res->bias_handle.force_to<float*>(), channel, 1.0f);
+        }
+
+        int pw_filter_size = channel * pw_param->output_channel;
+        pw_res->filter_handle = RawBuffer(pw_filter_size * sizeof(float));
+        InitRandom(pw_res->filter_handle.force_to<float*>(), pw_filter_size, 1.0f);
+        if (pw_param->bias) {
+            pw_res->bias_handle = RawBuffer(pw_param->output_channel * sizeof(float));
+            InitRandom(pw_res->bias_handle.force_to<float*>(), pw_param->output_channel, 1.0f);
+        }
+
+        layer_res->dw_resource = dw_res;
+        layer_res->pw_resource = pw_res;
+
+        *resource = layer_res;
+        return TNN_OK;
+    }
+
+    virtual Status ConvertHalfLayerResource(LayerResource* fp16_res, LayerResource** fp32_res) {
+        auto src_res = dynamic_cast<FusedDwPwConvLayerResource*>(fp16_res);
+        CHECK_PARAM_NULL(src_res);
+        CHECK_PARAM_NULL(src_res->dw_resource.get());
+        CHECK_PARAM_NULL(src_res->pw_resource.get());
+
+        auto dst_res = new FusedDwPwConvLayerResource();
+        std::shared_ptr<ConvLayerResource> sub_res[2] = {src_res->dw_resource, src_res->pw_resource};
+        for (int i = 0; i < 2; ++i) {
+            auto res           = std::make_shared<ConvLayerResource>();
+            res->filter_handle = ConvertHalfHandle(sub_res[i]->filter_handle);
+            res->scale_handle  = ConvertHalfHandle(sub_res[i]->scale_handle);
+            res->bias_handle   = ConvertHalfHandle(sub_res[i]->bias_handle);
+            sub_res[i]         = res;
+        }
+        dst_res->dw_resource = sub_res[0];
+        dst_res->pw_resource = sub_res[1];
+
+        *fp32_res = dst_res;
+        return TNN_OK;
+    }
+};
+
 /*
  * Generate weights for innerproduct layer
  */
@@ -510,10 +574,49 @@ class LSTMONNXLayerResourceGenerator : public LayerResourceGenerator {
     }
 };
 
+class GRUONNXLayerResourceGenerator : public LayerResourceGenerator {
+    virtual Status GenLayerConstantResource(LayerParam* param, LayerResource** resource,
+                                            std::vector<Blob*>& inputs, ConstantResource* consts) {
+        LOGD("GRUONNXLayerResourceGenerator\n");
+        auto layer_param = dynamic_cast<GRUONNXLayerParam*>(param);
+        CHECK_PARAM_NULL(layer_param);
+
+        // W, R and B are random constants, initial_h stays a network input
+        for (int i = 1; i < 4 && i < inputs.size(); i++) {
+            auto blob_name = inputs[i]->GetBlobDesc().name;
+            auto data_type = inputs[i]->GetBlobDesc().data_type;
+            auto count     = DimsVectorUtils::Count(inputs[i]->GetBlobDesc().dims);
+            if (consts->count(blob_name) > 0) {
+                continue;
+            }
+            if (data_type == DATA_TYPE_FLOAT) {
+                auto buffer = std::make_shared<RawBuffer>(count * sizeof(float));
+                buffer->SetBufferDims(inputs[i]->GetBlobDesc().dims);
+                buffer->SetDataType(DATA_TYPE_FLOAT);
+                InitRandom(buffer->force_to<float *>(), count, 1.0f);
+                (*consts)[blob_name] = buffer;
+            } else if (data_type == DATA_TYPE_HALF) {
+                auto buffer = std::make_shared<RawBuffer>(count * sizeof(fp16_t));
+                buffer->SetBufferDims(inputs[i]->GetBlobDesc().dims);
+                buffer->SetDataType(DATA_TYPE_HALF);
+                InitRandom(buffer->force_to<fp16_t *>(), count, fp16_t(1));
+                (*consts)[blob_name] = buffer;
+            }
+        }
+
+        return TNN_OK;
+    }
+
+    virtual Status ConvertHalfLayerResource(LayerResource* fp16_res, LayerResource** fp32_res) {
+        return TNN_OK;
+    }
+};
+
 REGISTER_LAYER_RESOURCE(Convolution, LAYER_CONVOLUTION);
 REGISTER_LAYER_RESOURCE(Deconvolution, LAYER_DECONVOLUTION);
 REGISTER_LAYER_RESOURCE(Convolution1D, LAYER_CONVOLUTION_1D);
 REGISTER_LAYER_RESOURCE(Convolution3D, LAYER_CONVOLUTION_3D);
+REGISTER_LAYER_RESOURCE(FusedDwPwConvolution, LAYER_FUSED_DW_PW_CONVOLUTION);
 REGISTER_LAYER_RESOURCE(InnerProduct, LAYER_INNER_PRODUCT);
 REGISTER_LAYER_RESOURCE(Batchnorm, LAYER_BATCH_NORM);
 REGISTER_LAYER_RESOURCE(Scale, LAYER_SCALE);
@@ -530,5 +633,6 @@ REGISTER_LAYER_RESOURCE(SquaredDifference, LAYER_SQUARED_DIFFERENCE);
 REGISTER_LAYER_RESOURCE(HdrGuide, LAYER_HDRGUIDE);
 
 REGISTER_LAYER_CONSTANT_RESOURCE(LSTMONNX, LAYER_LSTMONNX);
+REGISTER_LAYER_CONSTANT_RESOURCE(GRUONNX, LAYER_GRUONNX);
 
 }  // namespace TNN_NS
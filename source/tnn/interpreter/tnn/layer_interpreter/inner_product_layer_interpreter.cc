@@ -30,6 +30,12 @@ Status InnerProductLayerInterpreter::InterpretProto(str_arr layer_cfg_arr, int s
     layer_param->transpose  = atoi(layer_cfg_arr[index++].c_str());
     layer_param->axis       = atoi(layer_cfg_arr[index++].c_str());
 
+    // weight only quantization, absent in float models
+    if (index + 1 < layer_cfg_arr.size()) {
+        layer_param->weight_quant_bits       = atoi(layer_cfg_arr[index++].c_str());
+        layer_param->weight_quant_group_size = atoi(layer_cfg_arr[index++].c_str());
+    }
+
     return TNN_OK;
 }
 
@@ -68,6 +74,10 @@ Status InnerProductLayerInterpreter::SaveProto(std::ofstream& output_stream, Lay
     output_stream << layer_param->has_bias << " ";
     output_stream << layer_param->transpose << " ";
     output_stream << layer_param->axis << " ";
+    if (layer_param->weight_quant_bits > 0) {
+        output_stream << layer_param->weight_quant_bits << " ";
+        output_stream << layer_param->weight_quant_group_size << " ";
+    }
 
     return TNN_OK;
 }
@@ -88,7 +98,7 @@ Status InnerProductLayerInterpreter::SaveResource(Serializer& serializer, LayerP
     serializer.PutRaw(layer_res->weight_handle);
     serializer.PutRaw(layer_res->bias_handle);
 
-    if (layer_param->quantized) {
+    if (layer_param->quantized || layer_param->weight_quant_bits > 0) {
         serializer.PutRaw(layer_res->scale_handle);
     }
 
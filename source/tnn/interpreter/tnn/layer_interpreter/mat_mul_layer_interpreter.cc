@@ -26,6 +26,11 @@ Status MatMulLayerInterpreter::InterpretProto(str_arr layer_cfg_arr, int index,
     if (index < layer_cfg_arr.size()) {
        layer_param->weight_position = atoi(layer_cfg_arr[index++].c_str());
     }
+    // weight only quantization, absent in float models
+    if (index + 1 < layer_cfg_arr.size()) {
+        layer_param->weight_quant_bits       = atoi(layer_cfg_arr[index++].c_str());
+        layer_param->weight_quant_group_size = atoi(layer_cfg_arr[index++].c_str());
+    }
     return TNN_OK;
 }
 
@@ -34,6 +39,11 @@ Status MatMulLayerInterpreter::InterpretResource(Deserializer& deserializer, Lay
     RawBuffer buf;
     deserializer.GetRaw(buf);
     layer_res->weight = buf;
+    if (buf.GetDataType() == DATA_TYPE_INT8) {
+        RawBuffer scale;
+        deserializer.GetRaw(scale);
+        layer_res->scale_handle = scale;
+    }
     return TNN_OK;
 }
 
@@ -43,12 +53,19 @@ Status MatMulLayerInterpreter::SaveProto(std::ofstream& output_stream, LayerPara
         return Status(TNNERR_NULL_PARAM, "invalid layer param to save");
     }
     output_stream << layer_param->weight_position << " ";
+    if (layer_param->weight_quant_bits > 0) {
+        output_stream << layer_param->weight_quant_bits << " ";
+        output_stream << layer_param->weight_quant_group_size << " ";
+    }
     return TNN_OK;
 }
 
 Status MatMulLayerInterpreter::SaveResource(Serializer& serializer, LayerParam* param, LayerResource* resource) {
     CAST_OR_RET_ERROR(layer_res, MatMulLayerResource, "invalid layer res to save", resource);
     serializer.PutRaw(layer_res->weight);
+    if (layer_res->weight.GetDataType() == DATA_TYPE_INT8) {
+        serializer.PutRaw(layer_res->scale_handle);
+    }
     return TNN_OK;
 }
 
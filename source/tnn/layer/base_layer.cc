@@ -14,6 +14,7 @@
 
 #include "tnn/layer/base_layer.h"
 #include "tnn/utils/data_flag_utils.h"
+#include "tnn/utils/dims_utils.h"
 #include "tnn/utils/string_utils_inner.h"
 
 #include <mutex>
@@ -34,6 +35,10 @@ BaseLayer::~BaseLayer() {
         delete layer_acc_;
         layer_acc_ = NULL;
     }
+    if (fold_acc_ != NULL) {
+        delete fold_acc_;
+        fold_acc_ = NULL;
+    }
 }
 
 Status BaseLayer::Init(Context* context, LayerParam* param, LayerResource* resource, std::vector<Blob*>& input_blobs,
@@ -72,9 +77,25 @@ Status BaseLayer::Init(Context* context, LayerParam* param, LayerResource* resou
         }
     }
 
-    if (device->GetDeviceType() == DEVICE_NAIVE || !IsOutputConstant() ||
+    if (device->GetDeviceType() == DEVICE_NAIVE || !IsOutputConstant() || runtime_model_ == RUNTIME_MODE_CONST_FOLD ||
             (device->GetDeviceType() == DEVICE_CUDA && !enable_const_folder)) {
         layer_acc_ = device->CreateLayerAcc(type_);
+        /*
+         * x86 blobs are host memory in the same NCHW float layout as naive blobs. In constant folding the output
+         * shapes are only known in forward, so the naive acc is used to fold, also for layer types x86 has no acc
+         * for, and the x86 acc is created in GetFoldLayerAcc once the shapes are known.
+         */
+        if (device->GetDeviceType() == DEVICE_X86 && runtime_model_ == RUNTIME_MODE_CONST_FOLD) {
+            auto naive_device = GetDevice(DEVICE_NAIVE);
+            if (naive_device != NULL) {
+                if (layer_acc_ != NULL) {
+                    fold_device_  = device;
+                    fold_context_ = context;
+                    delete layer_acc_;
+                }
+                layer_acc_ = naive_device->CreateLayerAcc(type_);
+            }
+        }
         if (layer_acc_ != NULL) {
             layer_acc_->SetRuntimeMode(runtime_model_);
             layer_acc_->SetConstantResource(const_resource_);
@@ -209,7 +230,7 @@ Status BaseLayer::Forward() {
             if (IsOutputConstant()) {
                 status = layer_acc_->AllocateRuntimeOutputBlob(input_blobs_, output_blobs_);
                 RETURN_ON_NEQ(status, TNN_OK);
-                status = layer_acc_->Forward(input_blobs_, output_blobs_);
+                status = GetFoldLayerAcc()->Forward(input_blobs_, output_blobs_);
                 RETURN_ON_NEQ(status, TNN_OK);
             } else {
                 status = InferOutputShape(false);
@@ -224,6 +245,44 @@ Status BaseLayer::Forward() {
     }
 }
 
+AbstractLayerAcc* BaseLayer::GetFoldLayerAcc() {
+    if (fold_device_ == NULL) {
+        return layer_acc_;
+    }
+
+    // device accs are written for float 4d blobs
+    std::vector<Blob*> blobs = input_blobs_;
+    blobs.insert(blobs.end(), output_blobs_.begin(), output_blobs_.end());
+    for (auto blob : blobs) {
+        auto& desc = blob->GetBlobDesc();
+        if (desc.data_type != DATA_TYPE_FLOAT || desc.dims.size() != 4 || DimsVectorUtils::Count(desc.dims) <= 0) {
+            return layer_acc_;
+        }
+    }
+
+    Status status = TNN_OK;
+    if (fold_acc_ == NULL) {
+        fold_acc_ = fold_device_->CreateLayerAcc(type_);
+        fold_acc_->SetRuntimeMode(runtime_model_);
+        fold_acc_->SetConstantResource(const_resource_);
+        fold_acc_->SetConstantResourceFlag(const_resource_flag_);
+        status = fold_acc_->Init(fold_context_, param_, resource_, input_blobs_, output_blobs_);
+    } else {
+        status = fold_acc_->Reshape(input_blobs_, output_blobs_);
+    }
+
+    if (status != TNN_OK) {
+        // keep folding with the naive acc, constant inputs may point to blobs of the failed acc
+        LOGD("layer(%s) folds with naive acc: %s\n", layer_name_.c_str(), status.description().c_str());
+        delete fold_acc_;
+        fold_acc_    = NULL;
+        fold_device_ = NULL;
+        layer_acc_->ReloadConstantBlobs(input_blobs_, false);
+        return layer_acc_;
+    }
+    return fold_acc_;
+}
+
 void BaseLayer::SetLayerName(std::string layer_name) {
     layer_name_ = layer_name;
 }
@@ -280,6 +339,20 @@ int BaseLayer::GetLayerChangeFlag() {
     return flag;
 }
 
+bool BaseLayer::IsSupportInPlace() {
+    if (!layer_acc_ || input_blobs_.empty() || output_blobs_.empty()) {
+        return false;
+    }
+    return layer_acc_->SupportInPlace(input_blobs_, output_blobs_);
+}
+
+Status BaseLayer::ResetState() {
+    if (!layer_acc_) {
+        return TNN_OK;
+    }
+    return layer_acc_->ResetState();
+}
+
 void BaseLayer::SetConstantResource(ConstantResource* consts) {
     const_resource_ = consts;
 }
@@ -73,6 +73,12 @@ public:
     
     // @brief check if the layer's output is const with flag DATA_FLAG_CHANGE_IF_SHAPE_DIFFER
     int GetLayerChangeFlag();
+
+    // @brief check if the layer acc can write its first output into the memory of its first input
+    bool IsSupportInPlace();
+
+    // @brief clear the state the layer acc keeps between forwards
+    Status ResetState();
     
     // @brief set constant resource
     void SetConstantResource(ConstantResource* consts);
@@ -104,6 +110,15 @@ protected:
     virtual Status InferOutputDataType();
     //@brief fill layer param with constant resource
     virtual Status FillLayerParamWithConstantResource();
+
+private:
+    //@brief get the acc to fold constant layer, the device acc if it supports the runtime shapes, otherwise layer_acc_
+    AbstractLayerAcc* GetFoldLayerAcc();
+
+    // device and acc to fold constant layers on the device while layer_acc_ is the naive acc
+    AbstractDevice* fold_device_ = nullptr;
+    Context* fold_context_       = nullptr;
+    AbstractLayerAcc* fold_acc_  = nullptr;
 };
 
 //@brief LayerCreator define the create layer interface
@@ -0,0 +1,85 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the 
+// specific language governing permissions and limitations under the License.
+
+
+#include "tnn/memory_manager/shared_workspace_manager.h"
+
+#include <algorithm>
+
+namespace TNN_NS {
+
+std::mutex SharedWorkSpaceManager::s_mutex;
+std::map<SharedMemoryId, std::vector<RawBuffer>> SharedWorkSpaceManager::s_shared_work_space;
+std::map<SharedMemoryId, std::vector<ISharedWorkSpaceChangeListener *>>
+    SharedWorkSpaceManager::s_shared_work_space_listeners;
+
+static SharedMemoryId GetWorkSpaceId(std::thread::id thread_id, DeviceType device_type, int device_id) {
+    SharedMemoryId work_space_id;
+    work_space_id.thread_id   = thread_id;
+    work_space_id.device_type = device_type;
+    work_space_id.device_id   = device_id;
+    return work_space_id;
+}
+
+void SharedWorkSpaceManager::RegisterListener(std::thread::id thread_id, DeviceType device_type, int device_id,
+                                              ISharedWorkSpaceChangeListener *listener) {
+    std::lock_guard<std::mutex> guard(s_mutex);
+    auto &listeners = s_shared_work_space_listeners[GetWorkSpaceId(thread_id, device_type, device_id)];
+    if (std::find(listeners.begin(), listeners.end(), listener) == listeners.end()) {
+        listeners.push_back(listener);
+    }
+}
+
+void SharedWorkSpaceManager::ReleaseListener(std::thread::id thread_id, DeviceType device_type, int device_id,
+                                             ISharedWorkSpaceChangeListener *listener) {
+    std::lock_guard<std::mutex> guard(s_mutex);
+    auto work_space_id = GetWorkSpaceId(thread_id, device_type, device_id);
+    auto &listeners    = s_shared_work_space_listeners[work_space_id];
+    auto it            = std::find(listeners.begin(), listeners.end(), listener);
+    if (it != listeners.end()) {
+        listeners.erase(it);
+    }
+    if (listeners.empty()) {
+        s_shared_work_space_listeners.erase(work_space_id);
+        s_shared_work_space.erase(work_space_id);
+    }
+}
+
+size_t SharedWorkSpaceManager::GetListenerCount(std::thread::id thread_id, DeviceType device_type, int device_id) {
+    std::lock_guard<std::mutex> guard(s_mutex);
+    auto iter = s_shared_work_space_listeners.find(GetWorkSpaceId(thread_id, device_type, device_id));
+    return iter == s_shared_work_space_listeners.end() ? 0 : iter->second.size();
+}
+
+void *SharedWorkSpaceManager::GetSharedWorkSpace(size_t size, int index, std::thread::id thread_id,
+                                                 DeviceType device_type, int device_id) {
+    std::lock_guard<std::mutex> guard(s_mutex);
+    auto work_space_id = GetWorkSpaceId(thread_id, device_type, device_id);
+    auto &work_space   = s_shared_work_space[work_space_id];
+    while (work_space.size() < index + 1) {
+        work_space.push_back(RawBuffer());
+    }
+    if (work_space[index].GetBytesSize() < size) {
+        // release the old buffer first, so the peak is not old + new
+        work_space[index] = RawBuffer();
+        work_space[index] = RawBuffer(size, 32);
+        void *memory      = work_space[index].force_to<void *>();
+        for (auto listener : s_shared_work_space_listeners[work_space_id]) {
+            listener->OnSharedWorkSpaceChanged(index, memory, size);
+        }
+    }
+    return work_space[index].force_to<void *>();
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,65 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the 
+// specific language governing permissions and limitations under the License.
+
+
+#ifndef TNN_SOURCE_TNN_MEMORY_MANAGER_SHARED_WORKSPACE_MANAGER_H_
+#define TNN_SOURCE_TNN_MEMORY_MANAGER_SHARED_WORKSPACE_MANAGER_H_
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "tnn/core/common.h"
+#include "tnn/interpreter/raw_buffer.h"
+#include "tnn/memory_manager/shared_memory_manager.h"
+
+namespace TNN_NS {
+
+class ISharedWorkSpaceChangeListener {
+public:
+    virtual ~ISharedWorkSpaceChangeListener() = default;
+
+    // @brief called when the workspace at index is reallocated, the old memory is already freed
+    virtual void OnSharedWorkSpaceChanged(int index, void *memory, size_t size) = 0;
+};
+
+// @brief layer scratch workspace shared by the contexts of one thread,
+// used by host devices in SHARE_MEMORY_MODE_SHARE_ONE_THREAD.
+// a workspace only grows, every registered listener is notified on growth.
+class SharedWorkSpaceManager {
+public:
+    static void RegisterListener(std::thread::id thread_id, DeviceType device_type, int device_id,
+                                 ISharedWorkSpaceChangeListener *listener);
+
+    // @brief unregister the listener, the workspaces are freed with the last listener
+    static void ReleaseListener(std::thread::id thread_id, DeviceType device_type, int device_id,
+                                ISharedWorkSpaceChangeListener *listener);
+
+    // @brief number of listeners registered for the workspaces of thread_id
+    static size_t GetListenerCount(std::thread::id thread_id, DeviceType device_type, int device_id);
+
+    // @brief get workspace at index with at least size bytes, 32 bytes aligned
+    static void *GetSharedWorkSpace(size_t size, int index, std::thread::id thread_id, DeviceType device_type,
+                                    int device_id);
+
+private:
+    static std::mutex s_mutex;
+    static std::map<SharedMemoryId, std::vector<RawBuffer>> s_shared_work_space;
+    static std::map<SharedMemoryId, std::vector<ISharedWorkSpaceChangeListener *>> s_shared_work_space_listeners;
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_SOURCE_TNN_MEMORY_MANAGER_SHARED_WORKSPACE_MANAGER_H_
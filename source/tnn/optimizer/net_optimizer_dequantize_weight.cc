@@ -0,0 +1,139 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "tnn/optimizer/net_optimizer_dequantize_weight.h"
+
+#include <memory>
+#include <vector>
+
+#include "tnn/core/layer_type.h"
+#include "tnn/interpreter/layer_param.h"
+#include "tnn/interpreter/layer_resource.h"
+#include "tnn/optimizer/net_optimizer_manager.h"
+#include "tnn/optimizer/optimizer_const.h"
+#include "tnn/utils/weight_quant_utils.h"
+
+namespace TNN_NS {
+
+namespace optimizer {
+
+    // P0 priority: runs before fuse conv bn of the same priority, which may fold the float weights then
+    NetOptimizerRegister<NetOptimizerDequantizeWeight> g_net_optimizer_dequantize_weight(OptPriority::P0);
+
+    std::string NetOptimizerDequantizeWeight::Strategy() {
+        return kNetOptimizerDequantizeWeight;
+    }
+
+    // the x86 innerproduct and matmul run the quantized weights, the naive ones dequantize them on init
+    bool NetOptimizerDequantizeWeight::IsSupported(const NetworkConfig &net_config) {
+        auto device = net_config.device_type;
+        if (device == DEVICE_NAIVE) {
+            return false;
+        }
+        return !(device == DEVICE_X86 && net_config.network_type != NETWORK_TYPE_OPENVINO);
+    }
+
+    static RawBuffer CreateFloatBuffer(std::vector<float> &data, DimsVector dims) {
+        RawBuffer buffer(data.size() * sizeof(float), reinterpret_cast<char *>(data.data()), dims);
+        buffer.SetDataType(DATA_TYPE_FLOAT);
+        return buffer;
+    }
+
+    static Status DequantizeInnerProduct(std::shared_ptr<LayerInfo> layer, NetResource *resource) {
+        auto param = dynamic_cast<InnerProductLayerParam *>(layer->param.get());
+        auto res   = dynamic_cast<InnerProductLayerResource *>(resource->resource_map[layer->name].get());
+        if (!param || !res) {
+            return Status(TNNERR_MODEL_ERR, "invalid weight only quantized innerproduct");
+        }
+        auto dims      = res->weight_handle.GetBufferDims();
+        const int rows = param->num_output;
+        const int cols = dims.size() == 2 ? dims[1] : (rows > 0 ? res->weight_handle.GetBytesSize() / rows : 0);
+
+        std::vector<float> weight(rows * cols);
+        RETURN_ON_NEQ(WeightQuantUtils::Dequantize(res->weight_handle, res->scale_handle, rows, cols,
+                                                   param->weight_quant_bits, param->weight_quant_group_size,
+                                                   weight.data()),
+                      TNN_OK);
+
+        // new resource instead of writing in place, the resources are shared with other instances
+        auto new_res           = std::make_shared<InnerProductLayerResource>();
+        new_res->name          = res->name;
+        new_res->weight_handle = CreateFloatBuffer(weight, {rows, cols});
+        new_res->bias_handle   = res->bias_handle;
+        resource->resource_map[layer->name] = new_res;
+        param->weight_quant_bits            = 0;
+        param->weight_quant_group_size      = 0;
+        return TNN_OK;
+    }
+
+    static Status DequantizeMatMul(std::shared_ptr<LayerInfo> layer, NetResource *resource) {
+        auto param = dynamic_cast<MatMulLayerParam *>(layer->param.get());
+        auto res   = dynamic_cast<MatMulLayerResource *>(resource->resource_map[layer->name].get());
+        if (!param || !res || res->weight.GetBufferDims().size() != 2) {
+            return Status(TNNERR_MODEL_ERR, "invalid weight only quantized matmul");
+        }
+        // the quantized weight is stored transposed as [N][K], the dims stay {K, N}
+        auto dims = res->weight.GetBufferDims();
+        const int k = dims[0];
+        const int n = dims[1];
+
+        std::vector<float> weight_t(n * k);
+        RETURN_ON_NEQ(WeightQuantUtils::Dequantize(res->weight, res->scale_handle, n, k, param->weight_quant_bits,
+                                                   param->weight_quant_group_size, weight_t.data()),
+                      TNN_OK);
+        std::vector<float> weight(k * n);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < k; j++) {
+                weight[j * n + i] = weight_t[i * k + j];
+            }
+        }
+
+        auto new_res    = std::make_shared<MatMulLayerResource>();
+        new_res->name   = res->name;
+        new_res->weight = CreateFloatBuffer(weight, dims);
+        resource->resource_map[layer->name] = new_res;
+        param->weight_quant_bits            = 0;
+        param->weight_quant_group_size      = 0;
+        return TNN_OK;
+    }
+
+    Status NetOptimizerDequantizeWeight::Optimize(NetStructure *structure, NetResource *resource) {
+        if (!structure || !resource) {
+            LOGE("Error: empty NetStructure or NetResource\n");
+            return Status(TNNERR_NET_ERR, "Error: empty NetStructure or NetResource");
+        }
+
+        for (auto layer : structure->layers) {
+            if (resource->resource_map.count(layer->name) == 0) {
+                continue;
+            }
+            if (layer->type == LAYER_INNER_PRODUCT) {
+                auto param = dynamic_cast<InnerProductLayerParam *>(layer->param.get());
+                if (param && param->weight_quant_bits > 0) {
+                    RETURN_ON_NEQ(DequantizeInnerProduct(layer, resource), TNN_OK);
+                }
+            } else if (layer->type == LAYER_MATMUL) {
+                auto param = dynamic_cast<MatMulLayerParam *>(layer->param.get());
+                if (param && param->weight_quant_bits > 0) {
+                    RETURN_ON_NEQ(DequantizeMatMul(layer, resource), TNN_OK);
+                }
+            }
+        }
+
+        return TNN_OK;
+    }
+
+}  // namespace optimizer
+
+}  // namespace TNN_NS
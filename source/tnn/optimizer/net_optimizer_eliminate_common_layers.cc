@@ -0,0 +1,165 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "tnn/optimizer/net_optimizer_eliminate_common_layers.h"
+
+#include <map>
+#include <memory>
+#include <typeinfo>
+#include <vector>
+
+#include "tnn/core/layer_type.h"
+#include "tnn/interpreter/layer_param.h"
+#include "tnn/optimizer/net_optimizer_manager.h"
+#include "tnn/optimizer/optimizer_const.h"
+
+namespace TNN_NS {
+
+namespace optimizer {
+
+    // P1 priority: should be run after the layout chains are removed, so duplicated chains look the same
+    NetOptimizerRegister<NetOptimizerEliminateCommonLayers> g_net_optimizer_eliminate_common_layers(OptPriority::P1);
+
+    std::string NetOptimizerEliminateCommonLayers::Strategy() {
+        return kNetOptimizerEliminateCommonLayers;
+    }
+
+    bool NetOptimizerEliminateCommonLayers::IsSupported(const NetworkConfig &net_config) {
+        auto device = net_config.device_type;
+        if (net_config.network_type == NETWORK_TYPE_OPENVINO) {
+            return false;
+        }
+        return device == DEVICE_X86 || device == DEVICE_ARM || device == DEVICE_NAIVE || device == DEVICE_OPENCL ||
+               device == DEVICE_METAL;
+    }
+
+    /*
+     * params are compared field by field, only the param types listed here are merged,
+     * layers with any other param type are always kept
+     */
+    static bool IsSameParam(LayerParam *param0, LayerParam *param1) {
+        if (!param0 || !param1 || typeid(*param0) != typeid(*param1) || param0->quantized || param1->quantized) {
+            return false;
+        }
+        auto &param_type = typeid(*param0);
+        if (param_type == typeid(LayerParam) || param_type == typeid(ElementWiseLayerParam)) {
+            return true;
+        } else if (param_type == typeid(MultidirBroadcastLayerParam)) {
+            auto p0 = dynamic_cast<MultidirBroadcastLayerParam *>(param0);
+            auto p1 = dynamic_cast<MultidirBroadcastLayerParam *>(param1);
+            return p0->input0_broadcast_type == p1->input0_broadcast_type &&
+                   p0->input1_broadcast_type == p1->input1_broadcast_type &&
+                   p0->weight_input_index == p1->weight_input_index;
+        } else if (param_type == typeid(ReshapeLayerParam)) {
+            auto p0 = dynamic_cast<ReshapeLayerParam *>(param0);
+            auto p1 = dynamic_cast<ReshapeLayerParam *>(param1);
+            return p0->reshape_type == p1->reshape_type && p0->axis == p1->axis && p0->num_axes == p1->num_axes &&
+                   p0->shape == p1->shape;
+        } else if (param_type == typeid(PermuteLayerParam)) {
+            auto p0 = dynamic_cast<PermuteLayerParam *>(param0);
+            auto p1 = dynamic_cast<PermuteLayerParam *>(param1);
+            return p0->orders == p1->orders;
+        } else if (param_type == typeid(SqueezeLayerParam) || param_type == typeid(UnsqueezeLayerParam)) {
+            auto p0 = dynamic_cast<SqueezeLayerParam *>(param0);
+            auto p1 = dynamic_cast<SqueezeLayerParam *>(param1);
+            return !p0->data_in_resource && !p1->data_in_resource && p0->axes == p1->axes;
+        } else if (param_type == typeid(ConcatLayerParam)) {
+            auto p0 = dynamic_cast<ConcatLayerParam *>(param0);
+            auto p1 = dynamic_cast<ConcatLayerParam *>(param1);
+            return p0->axis == p1->axis;
+        } else if (param_type == typeid(FlattenLayerParam)) {
+            auto p0 = dynamic_cast<FlattenLayerParam *>(param0);
+            auto p1 = dynamic_cast<FlattenLayerParam *>(param1);
+            return p0->axis == p1->axis;
+        }
+        return false;
+    }
+
+    Status NetOptimizerEliminateCommonLayers::Optimize(NetStructure *structure, NetResource *resource) {
+        if (!structure) {
+            LOGE("Error: empty NetStructure\n");
+            return Status(TNNERR_NET_ERR, "Error: empty NetStructure");
+        }
+        if (!resource) {
+            LOGE("Error: empty NetResource\n");
+            return Status(TNNERR_NET_ERR, "Error: empty NetResource");
+        }
+
+        std::vector<std::shared_ptr<LayerInfo>> layers_orig = structure->layers;
+        const int count                                     = (const int)layers_orig.size();
+        if (count <= 1) {
+            return TNN_OK;
+        }
+
+        std::vector<std::shared_ptr<LayerInfo>> layers_fused;
+
+        // layers kept so far, keyed by the first input
+        std::map<std::string, std::vector<std::shared_ptr<LayerInfo>>> candidates;
+        std::map<std::string, std::string> rename_map;
+        for (int index = 0; index < count; index++) {
+            auto layer = layers_orig[index];
+            for (auto &in_name : layer->inputs) {
+                while (rename_map.find(in_name) != rename_map.end()) {
+                    in_name = rename_map[in_name];
+                }
+            }
+
+            // layers with weights or constant outputs are never merged
+            bool mergeable = !layer->inputs.empty() && !layer->outputs.empty() &&
+                             resource->resource_map.count(layer->name) == 0 &&
+                             resource->constant_layers.count(layer->name) == 0;
+            for (auto output : layer->outputs) {
+                if (structure->outputs.count(output) != 0 || resource->constant_map.count(output) != 0) {
+                    mergeable = false;
+                }
+            }
+            if (!mergeable) {
+                layers_fused.push_back(layer);
+                continue;
+            }
+
+            std::shared_ptr<LayerInfo> layer_same = nullptr;
+            auto &layers_same_input               = candidates[layer->inputs[0]];
+            for (auto candidate : layers_same_input) {
+                if (candidate->type == layer->type && candidate->inputs == layer->inputs &&
+                    candidate->outputs.size() == layer->outputs.size() &&
+                    IsSameParam(candidate->param.get(), layer->param.get())) {
+                    layer_same = candidate;
+                    break;
+                }
+            }
+            if (!layer_same) {
+                layers_same_input.push_back(layer);
+                layers_fused.push_back(layer);
+                continue;
+            }
+
+            // later layers read the outputs of the layer kept
+            for (int i = 0; i < layer->outputs.size(); i++) {
+                rename_map[layer->outputs[i]] = layer_same->outputs[i];
+            }
+        }
+        structure->layers = layers_fused;
+        // the outputs of the layers removed are read by no layer any more
+        for (const auto &iter : rename_map) {
+            structure->blobs.erase(iter.first);
+        }
+
+        LOGD("NetOptimizerEliminateCommonLayers: %d layers removed\n", count - (int)layers_fused.size());
+        return TNN_OK;
+    }
+
+}  // namespace optimizer
+
+}  // namespace TNN_NS
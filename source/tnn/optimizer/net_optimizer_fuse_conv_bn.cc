@@ -0,0 +1,287 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "tnn/optimizer/net_optimizer_fuse_conv_bn.h"
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tnn/core/layer_type.h"
+#include "tnn/interpreter/layer_param.h"
+#include "tnn/interpreter/layer_resource.h"
+#include "tnn/optimizer/net_optimizer_manager.h"
+#include "tnn/optimizer/optimizer_const.h"
+#include "tnn/utils/half_utils.h"
+
+namespace TNN_NS {
+
+namespace optimizer {
+
+    // P0 priority: bn and scale must be folded before conv post fuse picks up the activations
+    NetOptimizerRegister<NetOptimizerFuseConvBN> g_net_optimizer_fuse_conv_bn(OptPriority::P0);
+
+    std::string NetOptimizerFuseConvBN::Strategy() {
+        return kNetOptimizerFuseConvBN;
+    }
+
+    bool NetOptimizerFuseConvBN::IsSupported(const NetworkConfig &net_config) {
+        auto device = net_config.device_type;
+        if (net_config.network_type == NETWORK_TYPE_OPENVINO) {
+            return false;
+        }
+        return device == DEVICE_X86 || device == DEVICE_ARM || device == DEVICE_NAIVE || device == DEVICE_OPENCL ||
+               device == DEVICE_METAL;
+    }
+
+    // weights of a conv or innerproduct with the output channel as the outermost dim
+    struct FoldTarget {
+        int channels  = 0;
+        bool has_bias = false;
+        RawBuffer weight;
+        RawBuffer bias;
+    };
+
+    static bool IsFloatBuffer(RawBuffer &buffer) {
+        auto data_type = buffer.GetDataType();
+        return data_type == DATA_TYPE_FLOAT || data_type == DATA_TYPE_HALF;
+    }
+
+    static std::vector<float> GetFloatData(RawBuffer &buffer) {
+        RawBuffer buffer_fp32 = ConvertHalfHandle(buffer);
+        auto data             = buffer_fp32.force_to<float *>();
+        return std::vector<float>(data, data + buffer_fp32.GetDataCount());
+    }
+
+    // new buffer instead of writing in place, the raw buffers are shared with other instances
+    static RawBuffer CreateBuffer(std::vector<float> &data, DataType data_type, DimsVector dims) {
+        const int count = (int)data.size();
+        if (data_type == DATA_TYPE_HALF) {
+            RawBuffer buffer(count * 2);
+            ConvertFromFloatToHalf(data.data(), buffer.force_to<void *>(), count);
+            buffer.SetDataType(DATA_TYPE_HALF);
+            buffer.SetBufferDims(dims);
+            return buffer;
+        }
+        RawBuffer buffer(count * sizeof(float));
+        memcpy(buffer.force_to<float *>(), data.data(), count * sizeof(float));
+        buffer.SetDataType(DATA_TYPE_FLOAT);
+        buffer.SetBufferDims(dims);
+        return buffer;
+    }
+
+    static bool GetFoldTarget(std::shared_ptr<LayerInfo> layer, NetResource *resource, FoldTarget &target) {
+        if (layer->inputs.size() != 1 || layer->outputs.size() != 1 ||
+            resource->resource_map.count(layer->name) == 0) {
+            return false;
+        }
+        auto layer_resource = resource->resource_map[layer->name].get();
+        if (layer->type == LAYER_CONVOLUTION) {
+            auto param    = dynamic_cast<ConvLayerParam *>(layer->param.get());
+            auto conv_res = dynamic_cast<ConvLayerResource *>(layer_resource);
+            if (!param || !conv_res || param->quantized || param->activation_type != ActivationType_None ||
+                param->fusion_type != FusionType_None || conv_res->filter_format != OIHW ||
+                conv_res->scale_handle.GetBytesSize() != 0) {
+                return false;
+            }
+            target.channels = param->output_channel;
+            target.weight   = conv_res->filter_handle;
+            target.bias     = conv_res->bias_handle;
+            target.has_bias = param->bias != 0;
+        } else if (layer->type == LAYER_INNER_PRODUCT) {
+            // output is [batch, num_output], the channel of the bn
+            auto param  = dynamic_cast<InnerProductLayerParam *>(layer->param.get());
+            auto ip_res = dynamic_cast<InnerProductLayerResource *>(layer_resource);
+            if (!param || !ip_res || param->quantized || param->axis != 1 || param->transpose != 0 ||
+                ip_res->scale_handle.GetBytesSize() != 0) {
+                return false;
+            }
+            target.channels = param->num_output;
+            target.weight   = ip_res->weight_handle;
+            target.bias     = ip_res->bias_handle;
+            target.has_bias = param->has_bias != 0;
+        } else {
+            return false;
+        }
+
+        if (target.channels <= 0 || !IsFloatBuffer(target.weight) || target.weight.GetDataCount() <= 0 ||
+            target.weight.GetDataCount() % target.channels != 0) {
+            return false;
+        }
+        if (target.has_bias && (!IsFloatBuffer(target.bias) || target.bias.GetDataCount() != target.channels)) {
+            return false;
+        }
+        return true;
+    }
+
+    // y = k * x + b per channel, k and b hold one value or one per channel
+    static bool GetScaleBias(std::shared_ptr<LayerInfo> layer, NetResource *resource, int channels,
+                             std::vector<float> &k, std::vector<float> &b) {
+        if ((layer->type != LAYER_BATCH_NORM && layer->type != LAYER_SCALE) || layer->inputs.size() != 1 ||
+            layer->outputs.size() != 1 || resource->resource_map.count(layer->name) == 0) {
+            return false;
+        }
+        if (layer->type == LAYER_SCALE) {
+            auto param = dynamic_cast<ScaleLayerParam *>(layer->param.get());
+            if (!param || param->axis != 1 || param->num_axes != 1) {
+                return false;
+            }
+        }
+        auto bn_res = dynamic_cast<BatchNormLayerResource *>(resource->resource_map[layer->name].get());
+        if (!bn_res || !IsFloatBuffer(bn_res->scale_handle)) {
+            return false;
+        }
+        int k_count = bn_res->scale_handle.GetDataCount();
+        int b_count = bn_res->bias_handle.GetBytesSize() > 0 ? bn_res->bias_handle.GetDataCount() : 0;
+        if ((k_count != 1 && k_count != channels) || (b_count != 0 && b_count != k_count)) {
+            return false;
+        }
+        if (b_count != 0 && !IsFloatBuffer(bn_res->bias_handle)) {
+            return false;
+        }
+
+        auto k_data = GetFloatData(bn_res->scale_handle);
+        k           = std::vector<float>(channels, k_data[0]);
+        if (k_count == channels) {
+            k = k_data;
+        }
+        b = std::vector<float>(channels, 0.0f);
+        if (b_count != 0) {
+            auto b_data = GetFloatData(bn_res->bias_handle);
+            for (int c = 0; c < channels; c++) {
+                b[c] = b_data[b_count == 1 ? 0 : c];
+            }
+        }
+        return true;
+    }
+
+    static std::shared_ptr<LayerResource> CreateFoldedResource(std::shared_ptr<LayerInfo> layer,
+                                                               LayerResource *layer_resource, FoldTarget &target,
+                                                               std::vector<float> &k, std::vector<float> &b) {
+        const int channels = target.channels;
+        auto weight        = GetFloatData(target.weight);
+        const int inner    = (int)weight.size() / channels;
+        for (int c = 0; c < channels; c++) {
+            for (int i = 0; i < inner; i++) {
+                weight[c * inner + i] *= k[c];
+            }
+        }
+        std::vector<float> bias(channels, 0.0f);
+        if (target.has_bias) {
+            bias = GetFloatData(target.bias);
+        }
+        for (int c = 0; c < channels; c++) {
+            bias[c] = bias[c] * k[c] + b[c];
+        }
+
+        auto data_type     = target.weight.GetDataType();
+        auto weight_folded = CreateBuffer(weight, data_type, target.weight.GetBufferDims());
+        auto bias_folded   = CreateBuffer(bias, data_type, {channels});
+
+        if (layer->type == LAYER_CONVOLUTION) {
+            auto conv_res           = std::make_shared<ConvLayerResource>(*(ConvLayerResource *)layer_resource);
+            conv_res->filter_handle = weight_folded;
+            conv_res->bias_handle   = bias_folded;
+            return conv_res;
+        }
+        auto ip_res           = std::make_shared<InnerProductLayerResource>(*(InnerProductLayerResource *)layer_resource);
+        ip_res->weight_handle = weight_folded;
+        ip_res->bias_handle   = bias_folded;
+        return ip_res;
+    }
+
+    Status NetOptimizerFuseConvBN::Optimize(NetStructure *structure, NetResource *resource) {
+        if (!structure) {
+            LOGE("Error: empty NetStructure\n");
+            return Status(TNNERR_NET_ERR, "Error: empty NetStructure");
+        }
+        if (!resource) {
+            LOGE("Error: empty NetResource\n");
+            return Status(TNNERR_NET_ERR, "Error: empty NetResource");
+        }
+
+        std::vector<std::shared_ptr<LayerInfo>> layers_orig = structure->layers;
+        const int count                                     = (const int)layers_orig.size();
+        if (count <= 1) {
+            return TNN_OK;
+        }
+
+        // number of layers consuming each blob
+        std::map<std::string, int> blob_consumers;
+        for (auto layer : layers_orig) {
+            for (auto input : layer->inputs) {
+                blob_consumers[input]++;
+            }
+        }
+
+        std::vector<bool> removed(count, false);
+        for (int index = 0; index < count; index++) {
+            auto layer = layers_orig[index];
+            FoldTarget target;
+            if (!GetFoldTarget(layer, resource, target)) {
+                continue;
+            }
+            // conv output must be consumed by the bn only
+            auto output = layer->outputs[0];
+            if (structure->outputs.count(output) != 0 || blob_consumers[output] != 1 ||
+                resource->constant_map.count(output) != 0) {
+                continue;
+            }
+
+            int next = index + 1;
+            for (; next < count; next++) {
+                if (layers_orig[next]->inputs.size() > 0 && layers_orig[next]->inputs[0] == output) {
+                    break;
+                }
+            }
+            if (next >= count) {
+                continue;
+            }
+
+            auto layer_bn = layers_orig[next];
+            std::vector<float> k, b;
+            if (!GetScaleBias(layer_bn, resource, target.channels, k, b)) {
+                continue;
+            }
+
+            // NetResource is owned per instance, the layer resource itself may be shared
+            resource->resource_map[layer->name] =
+                CreateFoldedResource(layer, resource->resource_map[layer->name].get(), target, k, b);
+            if (layer->type == LAYER_CONVOLUTION) {
+                dynamic_cast<ConvLayerParam *>(layer->param.get())->bias = 1;
+            } else {
+                dynamic_cast<InnerProductLayerParam *>(layer->param.get())->has_bias = 1;
+            }
+            layer->outputs = layer_bn->outputs;
+            removed[next]  = true;
+            // bn followed by scale, fold the scale into the same layer again
+            index--;
+        }
+
+        std::vector<std::shared_ptr<LayerInfo>> layers_fused;
+        for (int index = 0; index < count; index++) {
+            if (!removed[index]) {
+                layers_fused.push_back(layers_orig[index]);
+            }
+        }
+        structure->layers = layers_fused;
+
+        LOGD("NetOptimizerFuseConvBN: %d layers removed\n", count - (int)layers_fused.size());
+        return TNN_OK;
+    }
+
+}  // namespace optimizer
+
+}  // namespace TNN_NS
@@ -0,0 +1,208 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "tnn/optimizer/net_optimizer_fuse_dw_pw.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tnn/core/layer_type.h"
+#include "tnn/interpreter/layer_param.h"
+#include "tnn/interpreter/layer_resource.h"
+#include "tnn/optimizer/net_optimizer_manager.h"
+#include "tnn/optimizer/optimizer_const.h"
+
+namespace TNN_NS {
+
+namespace optimizer {
+
+    // P2 priority: should be fused after conv post fuse, so both convs already carry their activations
+    NetOptimizerRegister<NetOptimizerFuseDwPw> g_net_optimizer_fuse_dw_pw(OptPriority::P2);
+
+    std::string NetOptimizerFuseDwPw::Strategy() {
+        return kNetOptimizerFuseDwPw;
+    }
+
+    bool NetOptimizerFuseDwPw::IsSupported(const NetworkConfig &net_config) {
+        auto device = net_config.device_type;
+        return device == DEVICE_X86 && net_config.network_type != NETWORK_TYPE_OPENVINO;
+    }
+
+    static bool IsFloatConvResource(ConvLayerResource *conv_res, int filter_count) {
+        if (!conv_res) {
+            return false;
+        }
+        auto data_type = conv_res->filter_handle.GetDataType();
+        if (data_type != DATA_TYPE_FLOAT && data_type != DATA_TYPE_HALF) {
+            return false;
+        }
+        return conv_res->filter_handle.GetDataCount() == filter_count;
+    }
+
+    static bool IsDepthwiseConv(std::shared_ptr<LayerInfo> layer, NetResource *resource) {
+        if (layer->type != LAYER_CONVOLUTION || layer->inputs.size() != 1 || layer->outputs.size() != 1) {
+            return false;
+        }
+        auto param = dynamic_cast<ConvLayerParam *>(layer->param.get());
+        if (!param || param->quantized || param->fusion_type != FusionType_None || param->pad_type != -1 ||
+            param->kernels.size() != 2 || param->group <= 1 || param->group != param->output_channel) {
+            return false;
+        }
+        if (param->activation_type != ActivationType_None && param->activation_type != ActivationType_ReLU &&
+            param->activation_type != ActivationType_ReLU6) {
+            return false;
+        }
+        if (resource->resource_map.count(layer->name) == 0) {
+            return false;
+        }
+        // one filter per channel, i.e. input channels equal to group
+        auto conv_res = dynamic_cast<ConvLayerResource *>(resource->resource_map[layer->name].get());
+        return IsFloatConvResource(conv_res, param->output_channel * param->kernels[0] * param->kernels[1]);
+    }
+
+    static bool IsPointwiseConv(std::shared_ptr<LayerInfo> layer, NetResource *resource, int input_channel) {
+        if (layer->type != LAYER_CONVOLUTION || layer->inputs.size() != 1 || layer->outputs.size() != 1) {
+            return false;
+        }
+        auto param = dynamic_cast<ConvLayerParam *>(layer->param.get());
+        if (!param || param->quantized || param->fusion_type != FusionType_None || param->group != 1 ||
+            param->kernels.size() != 2) {
+            return false;
+        }
+        // the fused acc applies the activation in the sgemm of the 1x1 conv
+        if (param->activation_type != ActivationType_None && param->activation_type != ActivationType_ReLU &&
+            param->activation_type != ActivationType_ReLU6) {
+            return false;
+        }
+        for (auto pad : param->pads) {
+            if (pad != 0) {
+                return false;
+            }
+        }
+        if (param->kernels[0] != 1 || param->kernels[1] != 1 || param->strides[0] != 1 || param->strides[1] != 1 ||
+            param->dialations[0] != 1 || param->dialations[1] != 1) {
+            return false;
+        }
+        if (resource->resource_map.count(layer->name) == 0) {
+            return false;
+        }
+        auto conv_res = dynamic_cast<ConvLayerResource *>(resource->resource_map[layer->name].get());
+        return IsFloatConvResource(conv_res, param->output_channel * input_channel);
+    }
+
+    Status NetOptimizerFuseDwPw::Optimize(NetStructure *structure, NetResource *resource) {
+        if (!structure) {
+            LOGE("Error: empty NetStructure\n");
+            return Status(TNNERR_NET_ERR, "Error: empty NetStructure");
+        }
+        if (!resource) {
+            LOGE("Error: empty NetResource\n");
+            return Status(TNNERR_NET_ERR, "Error: empty NetResource");
+        }
+
+        std::vector<std::shared_ptr<LayerInfo>> layers_orig = structure->layers;
+        const int count                                     = (const int)layers_orig.size();
+        if (count <= 1) {
+            return TNN_OK;
+        }
+
+        // number of layers consuming each blob
+        std::map<std::string, int> blob_consumers;
+        for (auto layer : layers_orig) {
+            for (auto input : layer->inputs) {
+                blob_consumers[input]++;
+            }
+        }
+
+        // index of pw conv -> fused layer replacing it
+        std::map<int, std::shared_ptr<LayerInfo>> fused_layers;
+        std::vector<bool> removed(count, false);
+        for (int index = 0; index < count; index++) {
+            auto layer_dw = layers_orig[index];
+            if (!IsDepthwiseConv(layer_dw, resource)) {
+                continue;
+            }
+            // depthwise output must be consumed by the 1x1 conv only
+            auto dw_output = layer_dw->outputs[0];
+            if (structure->outputs.count(dw_output) != 0 || blob_consumers[dw_output] != 1) {
+                continue;
+            }
+
+            int next = index + 1;
+            for (; next < count; next++) {
+                if (layers_orig[next]->inputs.size() > 0 && layers_orig[next]->inputs[0] == dw_output) {
+                    break;
+                }
+            }
+            if (next >= count || fused_layers.count(next) != 0) {
+                continue;
+            }
+
+            auto layer_pw = layers_orig[next];
+            auto dw_param = std::dynamic_pointer_cast<ConvLayerParam>(layer_dw->param);
+            if (!IsPointwiseConv(layer_pw, resource, dw_param->output_channel)) {
+                continue;
+            }
+            auto pw_param = std::dynamic_pointer_cast<ConvLayerParam>(layer_pw->param);
+
+            auto fused_param      = std::make_shared<FusedDwPwConvLayerParam>();
+            fused_param->type     = "FusedDwPwConvolution";
+            fused_param->name     = layer_pw->name;
+            fused_param->dw_param = dw_param;
+            fused_param->pw_param = pw_param;
+
+            auto fused_resource = std::make_shared<FusedDwPwConvLayerResource>();
+            fused_resource->name        = layer_pw->name;
+            fused_resource->dw_resource = std::dynamic_pointer_cast<ConvLayerResource>(resource->resource_map[layer_dw->name]);
+            fused_resource->pw_resource = std::dynamic_pointer_cast<ConvLayerResource>(resource->resource_map[layer_pw->name]);
+
+            auto layer_fused      = std::make_shared<LayerInfo>();
+            layer_fused->type     = LAYER_FUSED_DW_PW_CONVOLUTION;
+            layer_fused->type_str = "FusedDwPwConvolution";
+            layer_fused->name     = layer_pw->name;
+            layer_fused->inputs   = layer_dw->inputs;
+            layer_fused->outputs  = layer_pw->outputs;
+            layer_fused->param    = fused_param;
+
+            // the fused layer takes over the name of the 1x1 conv, NetResource is owned per instance
+            resource->resource_map[layer_fused->name] = fused_resource;
+
+            fused_layers[next] = layer_fused;
+            removed[index]     = true;
+        }
+
+        if (fused_layers.empty()) {
+            return TNN_OK;
+        }
+
+        std::vector<std::shared_ptr<LayerInfo>> layers_fused;
+        for (int index = 0; index < count; index++) {
+            if (removed[index]) {
+                continue;
+            }
+            if (fused_layers.count(index) != 0) {
+                layers_fused.push_back(fused_layers[index]);
+            } else {
+                layers_fused.push_back(layers_orig[index]);
+            }
+        }
+        structure->layers = layers_fused;
+
+        return TNN_OK;
+    }
+
+}  // namespace optimizer
+
+}  // namespace TNN_NS
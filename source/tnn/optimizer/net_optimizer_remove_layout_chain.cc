@@ -0,0 +1,225 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "tnn/optimizer/net_optimizer_remove_layout_chain.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tnn/core/layer_type.h"
+#include "tnn/interpreter/layer_param.h"
+#include "tnn/optimizer/net_optimizer_manager.h"
+#include "tnn/optimizer/optimizer_const.h"
+
+namespace TNN_NS {
+
+namespace optimizer {
+
+    NetOptimizerRegister<NetOptimizerRemoveLayoutChain> g_net_optimizer_remove_layout_chain(OptPriority::P0);
+
+    std::string NetOptimizerRemoveLayoutChain::Strategy() {
+        return kNetOptimizerRemoveLayoutChain;
+    }
+
+    bool NetOptimizerRemoveLayoutChain::IsSupported(const NetworkConfig &net_config) {
+        auto device = net_config.device_type;
+        if (net_config.network_type == NETWORK_TYPE_OPENVINO) {
+            return false;
+        }
+        return device == DEVICE_X86 || device == DEVICE_ARM || device == DEVICE_NAIVE || device == DEVICE_OPENCL ||
+               device == DEVICE_METAL;
+    }
+
+    // orders holding each of 0 ~ n-1 once
+    static bool IsFullPermute(std::shared_ptr<LayerInfo> layer) {
+        auto param = dynamic_cast<PermuteLayerParam *>(layer->param.get());
+        if (layer->type != LAYER_PERMUTE || !param || param->orders.empty()) {
+            return false;
+        }
+        const int size = (int)param->orders.size();
+        std::vector<bool> used(size, false);
+        for (auto order : param->orders) {
+            if (order < 0 || order >= size || used[order]) {
+                return false;
+            }
+            used[order] = true;
+        }
+        return true;
+    }
+
+    static bool IsIdentityPermute(const std::vector<int> &orders) {
+        for (int i = 0; i < orders.size(); i++) {
+            if (orders[i] != i) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // ascending non-negative axes, squeeze then unsqueeze on them gives back the input and vice versa
+    static bool GetSqueezeAxes(std::shared_ptr<LayerInfo> layer, std::vector<int> &axes) {
+        auto param = dynamic_cast<SqueezeLayerParam *>(layer->param.get());
+        if ((layer->type != LAYER_SQUEEZE && layer->type != LAYER_UNSQUEEZE) || !param ||
+            param->data_in_resource || param->axes.empty()) {
+            return false;
+        }
+        for (int i = 0; i < param->axes.size(); i++) {
+            if (param->axes[i] < 0 || (i > 0 && param->axes[i] <= param->axes[i - 1])) {
+                return false;
+            }
+        }
+        axes = param->axes;
+        return true;
+    }
+
+    // reshape, squeeze, unsqueeze and flatten only change the dims, the data keeps the nchw order
+    static bool IsViewLayer(std::shared_ptr<LayerInfo> layer) {
+        if (layer->type == LAYER_RESHAPE) {
+            auto param = dynamic_cast<ReshapeLayerParam *>(layer->param.get());
+            return param && param->reshape_type == 0;
+        }
+        if (layer->type == LAYER_SQUEEZE || layer->type == LAYER_UNSQUEEZE) {
+            auto param = dynamic_cast<SqueezeLayerParam *>(layer->param.get());
+            return param && !param->data_in_resource;
+        }
+        return layer->type == LAYER_FLATTEN;
+    }
+
+    // the output dims of the reshape only depend on the element count of its input
+    static bool IsFullReshape(std::shared_ptr<LayerInfo> layer) {
+        auto param = dynamic_cast<ReshapeLayerParam *>(layer->param.get());
+        if (layer->type != LAYER_RESHAPE || !param || param->reshape_type != 0 || param->shape.empty() ||
+            param->axis != 0 || param->num_axes != param->shape.size()) {
+            return false;
+        }
+        for (auto dim : param->shape) {
+            if (dim == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Status NetOptimizerRemoveLayoutChain::Optimize(NetStructure *structure, NetResource *resource) {
+        if (!structure) {
+            LOGE("Error: empty NetStructure\n");
+            return Status(TNNERR_NET_ERR, "Error: empty NetStructure");
+        }
+        if (!resource) {
+            LOGE("Error: empty NetResource\n");
+            return Status(TNNERR_NET_ERR, "Error: empty NetResource");
+        }
+
+        std::vector<std::shared_ptr<LayerInfo>> layers_orig = structure->layers;
+        const int count                                     = (const int)layers_orig.size();
+        if (count <= 1) {
+            return TNN_OK;
+        }
+
+        // number of layers consuming each blob, and the index of the layer producing it
+        std::map<std::string, int> blob_consumers;
+        std::map<std::string, int> blob_producer;
+        for (int index = 0; index < count; index++) {
+            for (auto input : layers_orig[index]->inputs) {
+                blob_consumers[input]++;
+            }
+            for (auto output : layers_orig[index]->outputs) {
+                blob_producer[output] = index;
+            }
+        }
+
+        std::vector<bool> removed(count, false);
+        std::map<std::string, std::string> rename_map;
+        for (int index = 0; index < count; index++) {
+            auto layer = layers_orig[index];
+            for (auto &in_name : layer->inputs) {
+                while (rename_map.find(in_name) != rename_map.end()) {
+                    in_name = rename_map[in_name];
+                }
+            }
+            if (layer->inputs.size() != 1 || layer->outputs.size() != 1) {
+                continue;
+            }
+
+            // the layer is folded into its producer as long as the pair can be merged
+            while (true) {
+                auto input = layer->inputs[0];
+                if (blob_producer.count(input) == 0 || blob_consumers[input] != 1 ||
+                    structure->outputs.count(input) != 0 || resource->constant_map.count(input) != 0) {
+                    break;
+                }
+                auto prev = layers_orig[blob_producer[input]];
+                if (prev->inputs.size() != 1 || prev->outputs.size() != 1) {
+                    break;
+                }
+                auto prev_input = prev->inputs[0];
+                auto output     = layer->outputs[0];
+                bool can_rename = structure->outputs.count(output) == 0 && resource->constant_map.count(output) == 0;
+
+                bool cancelled = false;
+                std::vector<int> axes, prev_axes;
+                if (IsFullPermute(layer) && IsFullPermute(prev)) {
+                    auto orders      = dynamic_cast<PermuteLayerParam *>(layer->param.get())->orders;
+                    auto prev_orders = dynamic_cast<PermuteLayerParam *>(prev->param.get())->orders;
+                    if (orders.size() != prev_orders.size()) {
+                        break;
+                    }
+                    // out[i] = in[prev_orders[orders[i]]]
+                    std::vector<int> fused_orders(orders.size());
+                    for (int i = 0; i < orders.size(); i++) {
+                        fused_orders[i] = prev_orders[orders[i]];
+                    }
+                    dynamic_cast<PermuteLayerParam *>(layer->param.get())->orders = fused_orders;
+                    cancelled = IsIdentityPermute(fused_orders);
+                } else if (GetSqueezeAxes(layer, axes) && GetSqueezeAxes(prev, prev_axes)) {
+                    // only a squeeze and unsqueeze on the same axes, both layers go away together
+                    if (layer->type == prev->type || axes != prev_axes || !can_rename) {
+                        break;
+                    }
+                    cancelled = true;
+                } else if (!IsFullReshape(layer) || !IsViewLayer(prev)) {
+                    // a reshape with full shape does not depend on the dims the view layer before it produced
+                    break;
+                }
+
+                // the layer now reads the input of the previous one
+                removed[blob_producer[input]] = true;
+                blob_consumers[input]--;
+                layer->inputs[0] = prev_input;
+
+                if (cancelled && can_rename) {
+                    rename_map[output] = prev_input;
+                    blob_consumers[prev_input] += blob_consumers[output] - 1;
+                    removed[index] = true;
+                    break;
+                }
+            }
+        }
+
+        std::vector<std::shared_ptr<LayerInfo>> layers_fused;
+        for (int index = 0; index < count; index++) {
+            if (!removed[index]) {
+                layers_fused.push_back(layers_orig[index]);
+            }
+        }
+        structure->layers = layers_fused;
+
+        LOGD("NetOptimizerRemoveLayoutChain: %d layers removed\n", count - (int)layers_fused.size());
+        return TNN_OK;
+    }
+
+}  // namespace optimizer
+
+}  // namespace TNN_NS
@@ -25,6 +25,21 @@ static const std::string kNetOptimizerFuseConvPost =
 static const std::string kNetOptimizerFuseConvAdd =
     "net_optimizer_fuse_conv_add";
 
+static const std::string kNetOptimizerFuseDwPw =
+    "net_optimizer_fuse_dw_pw";
+
+static const std::string kNetOptimizerFuseConvBN =
+    "net_optimizer_fuse_conv_bn";
+
+static const std::string kNetOptimizerRemoveLayoutChain =
+    "net_optimizer_remove_layout_chain";
+
+static const std::string kNetOptimizerEliminateCommonLayers =
+    "net_optimizer_eliminate_common_layers";
+
+static const std::string kNetOptimizerDequantizeWeight =
+    "net_optimizer_dequantize_weight";
+
 static const std::string kNetOptimizerCbamFusedReduce =
     "net_optimizer_cbam_fused_reduce";
 
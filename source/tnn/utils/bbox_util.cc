@@ -18,6 +18,7 @@
 #include <cassert>
 #include <cfloat>
 #include <cmath>
+#include <numeric>
 #include <string>
 
 namespace TNN_NS {
@@ -48,6 +49,32 @@ bool SortScorePairDescend(const pair<float, T>& pair1, const pair<float, T>& pai
 template bool SortScorePairDescend(const pair<float, int>& pair1, const pair<float, int>& pair2);
 template bool SortScorePairDescend(const pair<float, pair<int, int>>& pair1, const pair<float, pair<int, int>>& pair2);
 
+// Sort the score pairs in descend order, equal scores keep their order in
+// score_index_vec as with a stable sort. Only the first top_k pairs are
+// sorted and kept if top_k is not -1.
+static void SortTopKScoreIndex(const int top_k, vector<pair<float, int>>* score_index_vec) {
+    const vector<pair<float, int>>& pairs = *score_index_vec;
+    // the positions of the pairs are sorted, they break the ties
+    vector<int> order(pairs.size());
+    std::iota(order.begin(), order.end(), 0);
+    auto compare = [&pairs](const int a, const int b) {
+        return pairs[a].first > pairs[b].first || (pairs[a].first == pairs[b].first && a < b);
+    };
+    size_t count = order.size();
+    if (top_k > -1 && top_k < count) {
+        count = top_k;
+        std::partial_sort(order.begin(), order.begin() + count, order.end(), compare);
+    } else {
+        std::sort(order.begin(), order.end(), compare);
+    }
+
+    vector<pair<float, int>> sorted_pairs(count);
+    for (size_t i = 0; i < count; ++i) {
+        sorted_pairs[i] = pairs[order[i]];
+    }
+    score_index_vec->swap(sorted_pairs);
+}
+
 NormalizedBBox UnitBBox() {
     NormalizedBBox unit_bbox;
     unit_bbox.set_xmin(0.);
@@ -165,6 +192,23 @@ float JaccardOverlap(const NormalizedBBox& bbox1, const NormalizedBBox& bbox2, c
     }
 }
 
+bool AnyJaccardOverlap(const NormalizedBBox& bbox, const float bbox_size, const BBoxArray& bboxes,
+                       const float threshold) {
+    for (int i = 0; i < bboxes.count(); ++i) {
+        float intersect_width  = std::min(bbox.xmax(), bboxes.xmax[i]) - std::max(bbox.xmin(), bboxes.xmin[i]);
+        float intersect_height = std::min(bbox.ymax(), bboxes.ymax[i]) - std::max(bbox.ymin(), bboxes.ymin[i]);
+        float overlap          = 0.;
+        if (intersect_width > 0 && intersect_height > 0) {
+            float intersect_size = intersect_width * intersect_height;
+            overlap              = intersect_size / (bbox_size + bboxes.size[i] - intersect_size);
+        }
+        if (!(overlap <= threshold)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 float BBoxCoverage(const NormalizedBBox& bbox1, const NormalizedBBox& bbox2) {
     NormalizedBBox intersect_bbox;
     IntersectBBox(bbox1, bbox2, &intersect_bbox);
@@ -867,17 +911,14 @@ void GetTopKScoreIndex(const vector<float>& scores, const vector<int>& indices,
     CHECK_EQ(scores.size(), indices.size());
 
     // Generate index score pairs.
+    score_index_vec->reserve(score_index_vec->size() + scores.size());
     for (size_t i = 0; i < scores.size(); ++i) {
         score_index_vec->push_back(std::make_pair(scores[i], indices[i]));
     }
 
-    // Sort the score pair according to the scores in descending order
-    std::stable_sort(score_index_vec->begin(), score_index_vec->end(), SortScorePairDescend<int>);
-
-    // Keep top_k scores if needed.
-    if (top_k > -1 && top_k < score_index_vec->size()) {
-        score_index_vec->resize(top_k);
-    }
+    // Sort the score pair according to the scores in descending order,
+    // keep top_k scores if needed.
+    SortTopKScoreIndex(top_k, score_index_vec);
 }
 
 void ApplyNMS(const vector<NormalizedBBox>& bboxes, const vector<float>& scores, const float threshold, const int top_k,
@@ -896,20 +937,19 @@ void ApplyNMS(const vector<NormalizedBBox>& bboxes, const vector<float>& scores,
     vector<pair<float, int>> score_index_vec;
     GetTopKScoreIndex(scores, idx, top_k, &score_index_vec);
 
-    // Do nms.
+    // Do nms. The remaining boxes are score_index_vec[begin, end), they are
+    // compacted in place instead of erased one by one.
     indices->clear();
-    while (score_index_vec.size() != 0) {
-        // Get the current highest score box.
-        int best_idx                    = score_index_vec.front().second;
+    size_t begin = 0;
+    while (begin < score_index_vec.size()) {
+        // Get the current highest score box and erase it.
+        int best_idx                    = score_index_vec[begin++].second;
         const NormalizedBBox& best_bbox = bboxes[best_idx];
         if (BBoxSize(best_bbox) < 1e-5) {
             // Erase small box.
-            score_index_vec.erase(score_index_vec.begin());
             continue;
         }
         indices->push_back(best_idx);
-        // Erase the best box.
-        score_index_vec.erase(score_index_vec.begin());
 
         if (top_k > -1 && indices->size() >= top_k) {
             // Stop if finding enough bboxes for nms.
@@ -919,12 +959,12 @@ void ApplyNMS(const vector<NormalizedBBox>& bboxes, const vector<float>& scores,
         // Compute overlap between best_bbox and other remaining bboxes.
         // Remove a bbox if the overlap with best_bbox is larger than
         // nms_threshold.
-        for (vector<pair<float, int>>::iterator it = score_index_vec.begin(); it != score_index_vec.end();) {
-            int cur_idx                    = it->second;
+        size_t end = begin;
+        for (size_t i = begin; i < score_index_vec.size(); ++i) {
+            int cur_idx                    = score_index_vec[i].second;
             const NormalizedBBox& cur_bbox = bboxes[cur_idx];
             if (BBoxSize(cur_bbox) < 1e-5) {
                 // Erase small box.
-                it = score_index_vec.erase(it);
                 continue;
             }
             float cur_overlap = 0.;
@@ -947,12 +987,11 @@ void ApplyNMS(const vector<NormalizedBBox>& bboxes, const vector<float>& scores,
             }
 
             // Remove it if necessary
-            if (cur_overlap > threshold) {
-                it = score_index_vec.erase(it);
-            } else {
-                ++it;
+            if (!(cur_overlap > threshold)) {
+                score_index_vec[end++] = score_index_vec[i];
             }
         }
+        score_index_vec.resize(end);
     }
 }
 
@@ -964,48 +1003,45 @@ void ApplyNMS(const bool* overlapped, const int num, vector<int>* indices) {
     for (int i = 0; i < num; ++i) {
         index_vec.push_back(i);
     }
-    // Do nms.
+    // Do nms, the remaining boxes are index_vec[begin, end).
     indices->clear();
-    while (index_vec.size() != 0) {
-        // Get the current highest score box.
-        int best_idx = index_vec.front();
+    size_t begin = 0;
+    while (begin < index_vec.size()) {
+        // Get the current highest score box and erase it.
+        int best_idx = index_vec[begin++];
         indices->push_back(best_idx);
-        // Erase the best box.
-        index_vec.erase(index_vec.begin());
 
-        for (vector<int>::iterator it = index_vec.begin(); it != index_vec.end();) {
-            int cur_idx = *it;
+        size_t end = begin;
+        for (size_t i = begin; i < index_vec.size(); ++i) {
+            int cur_idx = index_vec[i];
 
             // Remove it if necessary
-            if (overlapped[best_idx * num + cur_idx]) {
-                it = index_vec.erase(it);
-            } else {
-                ++it;
+            if (!overlapped[best_idx * num + cur_idx]) {
+                index_vec[end++] = cur_idx;
             }
         }
+        index_vec.resize(end);
     }
 }
 
 void GetMaxScoreIndex(const vector<float>& scores, const float threshold, const int top_k,
                       vector<pair<float, int>>* score_index_vec) {
-    // Generate index score pairs.
+    // Generate index score pairs, most scores are below the threshold and
+    // never reach the sort.
     for (size_t i = 0; i < scores.size(); ++i) {
         if (scores[i] > threshold) {
             score_index_vec->push_back(std::make_pair(scores[i], i));
         }
     }
 
-    // Sort the score pair according to the scores in descending order
-    std::stable_sort(score_index_vec->begin(), score_index_vec->end(), SortScorePairDescend<int>);
-
-    // Keep top_k scores if needed.
-    if (top_k > -1 && top_k < score_index_vec->size()) {
-        score_index_vec->resize(top_k);
-    }
+    // Sort the score pair according to the scores in descending order,
+    // keep top_k scores if needed.
+    SortTopKScoreIndex(top_k, score_index_vec);
 }
 
 void ApplyNMSFast(const vector<NormalizedBBox>& bboxes, const vector<float>& scores, const float score_threshold,
-                  const float nms_threshold, const float eta, const int top_k, vector<int>* indices) {
+                  const float nms_threshold, const float eta, const int top_k, vector<int>* indices,
+                  BBoxOverlapFunc overlap_func) {
     // Sanity check.
     assert(bboxes.size() == scores.size());  //"bboxes and scores have different size."
 
@@ -1013,26 +1049,21 @@ void ApplyNMSFast(const vector<NormalizedBBox>& bboxes, const vector<float>& sco
     vector<pair<float, int>> score_index_vec;
     GetMaxScoreIndex(scores, score_threshold, top_k, &score_index_vec);
 
-    // Do nms.
+    // Do nms, the kept boxes are also stored as struct of arrays for overlap_func.
     float adaptive_threshold = nms_threshold;
+    BBoxArray kept_bboxes;
+    kept_bboxes.reserve(score_index_vec.size());
     indices->clear();
-    while (score_index_vec.size() != 0) {
-        const int idx = score_index_vec.front().second;
-        bool keep     = true;
-        for (int k = 0; k < indices->size(); ++k) {
-            if (keep) {
-                const int kept_idx = (*indices)[k];
-                float overlap      = JaccardOverlap(bboxes[idx], bboxes[kept_idx]);
-                keep               = overlap <= adaptive_threshold;
-            } else {
-                break;
-            }
-        }
-        if (keep) {
-            indices->push_back(idx);
+    for (size_t i = 0; i < score_index_vec.size(); ++i) {
+        const int idx              = score_index_vec[i].second;
+        const NormalizedBBox& bbox = bboxes[idx];
+        const float bbox_size      = BBoxSize(bbox);
+        if (overlap_func(bbox, bbox_size, kept_bboxes, adaptive_threshold)) {
+            continue;
         }
-        score_index_vec.erase(score_index_vec.begin());
-        if (keep && eta < 1 && adaptive_threshold > 0.5) {
+        indices->push_back(idx);
+        kept_bboxes.push_back(bbox, bbox_size);
+        if (eta < 1 && adaptive_threshold > 0.5) {
             adaptive_threshold *= eta;
         }
     }
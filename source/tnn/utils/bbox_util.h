@@ -105,6 +105,12 @@ bool ProjectBBox(const NormalizedBBox& src_bbox, const NormalizedBBox& bbox, Nor
 // Compute the jaccard (intersection over union IoU) overlap between two bboxes.
 float JaccardOverlap(const NormalizedBBox& bbox1, const NormalizedBBox& bbox2, const bool normalized = true);
 
+// Check if the jaccard overlap between bbox and any of bboxes is larger than
+// threshold, the scalar BBoxOverlapFunc.
+//    bbox_size: the size of bbox.
+bool AnyJaccardOverlap(const NormalizedBBox& bbox, const float bbox_size, const BBoxArray& bboxes,
+                       const float threshold);
+
 // Compute the coverage of bbox1 by bbox2.
 float BBoxCoverage(const NormalizedBBox& bbox1, const NormalizedBBox& bbox2);
 
@@ -272,8 +278,11 @@ void ApplyNMS(const bool* overlapped, const int num, vector<int>* indices);
 //    nms_threshold: a threshold used in non maximum suppression.
 //    top_k: if not -1, keep at most top_k picked indices.
 //    indices: the kept indices of bboxes after nms.
+//    overlap_func: checks a box against the kept boxes, device accs may pass
+//      a vectorized one.
 void ApplyNMSFast(const vector<NormalizedBBox>& bboxes, const vector<float>& scores, const float score_threshold,
-                  const float nms_threshold, const float eta, const int top_k, vector<int>* indices);
+                  const float nms_threshold, const float eta, const int top_k, vector<int>* indices,
+                  BBoxOverlapFunc overlap_func = AnyJaccardOverlap);
 
 // Compute cumsum of a set of pairs.
 void CumSum(const vector<pair<float, int>>& pairs, vector<int>* cumsum);
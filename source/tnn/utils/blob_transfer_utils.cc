@@ -76,7 +76,10 @@ Status Blob2RawBuffer(Blob *blob, std::shared_ptr<RawBuffer> &buffer) {
     if (!blob) {
         return Status(TNNERR_PARAM_ERR, "blob is null");
     }
-    if (blob->GetBlobDesc().device_type != DEVICE_NAIVE) {
+    // float blobs of x86 are host memory in NCHW, the same as naive
+    const auto device_type = blob->GetBlobDesc().device_type;
+    if (device_type != DEVICE_NAIVE &&
+        !(device_type == DEVICE_X86 && blob->GetBlobDesc().data_format != DATA_FORMAT_NHWC4)) {
         LOGE("Blob2RawBuffer dont support device type: %d", blob->GetBlobDesc().device_type);
         return Status(TNNERR_PARAM_ERR, "Blob2RawBuffer dont support device type");
     }
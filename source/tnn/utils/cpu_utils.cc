@@ -14,6 +14,7 @@
 
 #include "tnn/utils/cpu_utils.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <vector>
 #include "tnn/utils/cpu_info.h"
@@ -267,6 +268,79 @@ static int SetSchedAffinity(const std::vector<int>& cpuids) {
     return 0;
 }
 
+static int GetSchedAffinity(std::vector<int>& cpuids) {
+#if defined(__ANDROID__) || defined(__linux__)
+    typedef struct {
+        unsigned long __bits[TNN_CPU_SETSIZE / TNN_NCPUBITS];
+    } cpu_set_t;
+
+#ifdef __GLIBC__
+    pid_t pid = syscall(SYS_gettid);
+#else
+#ifdef PI3
+    pid_t pid  = getpid();
+#else
+    pid_t pid = gettid();
+#endif
+#endif
+    cpu_set_t mask;
+    memset(&mask, 0, sizeof(cpu_set_t));
+    // returns the size of the kernel cpu mask on success
+    int syscallret = syscall(__NR_sched_getaffinity, pid, sizeof(mask), &mask);
+    if (syscallret < 0) {
+        fprintf(stderr, "syscall error %d\n", syscallret);
+        return -1;
+    }
+    cpuids.clear();
+    for (int i = 0; i < TNN_CPU_SETSIZE; i++) {
+        if (mask.__bits[i / TNN_NCPUBITS] & (1UL << (i % TNN_NCPUBITS))) {
+            cpuids.push_back(i);
+        }
+    }
+#endif
+    return 0;
+}
+
+#if defined(__ANDROID__) || defined(__linux__)
+// parse a sysfs list like "0-3,8-11"
+static bool ReadSysfsList(const char* path, std::vector<int>& values) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        return false;
+    }
+    char buffer[1024] = {0};
+    size_t size       = fread(buffer, 1, sizeof(buffer) - 1, fp);
+    fclose(fp);
+    buffer[size] = 0;
+
+    values.clear();
+    char* cursor = buffer;
+    while (*cursor != 0 && *cursor != '\n') {
+        char* end  = cursor;
+        long first = strtol(cursor, &end, 10);
+        if (end == cursor) {
+            return false;
+        }
+        long last = first;
+        cursor    = end;
+        if (*cursor == '-') {
+            last = strtol(cursor + 1, &end, 10);
+            if (end == cursor + 1) {
+                return false;
+            }
+            cursor = end;
+        }
+        for (long i = first; i <= last; i++) {
+            values.push_back((int)i);
+        }
+        if (*cursor == ',') {
+            cursor++;
+        }
+    }
+    return true;
+}
+#endif
+
 Status CpuUtils::SetCpuPowersave(int powersave) {
 #ifdef __ANDROID__
     static std::vector<int> sorted_cpuids;
@@ -343,6 +417,94 @@ Status CpuUtils::SetCpuAffinity(const std::vector<int>& cpu_list) {
 #endif
 }
 
+Status CpuUtils::GetCpuAffinity(std::vector<int>& cpu_list) {
+#if defined(__ANDROID__) || defined(__linux__)
+    if (0 != GetSchedAffinity(cpu_list)) {
+        return TNNERR_SET_CPU_AFFINITY;
+    }
+    return TNN_OK;
+#else
+    return TNNERR_SET_CPU_AFFINITY;
+#endif
+}
+
+int CpuUtils::GetNumaNodeCount() {
+#if defined(__linux__)
+    std::vector<int> nodes;
+    if (ReadSysfsList("/sys/devices/system/node/online", nodes) && !nodes.empty()) {
+        return nodes.back() + 1;
+    }
+#endif
+    return 1;
+}
+
+Status CpuUtils::GetNumaNodeCpus(int numa_node, std::vector<int>& cpu_list) {
+    if (numa_node < 0 || numa_node >= GetNumaNodeCount()) {
+        return Status(TNNERR_PARAM_ERR, "invalid numa node");
+    }
+#if defined(__linux__)
+    char path[256];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", numa_node);
+    if (ReadSysfsList(path, cpu_list)) {
+        return TNN_OK;
+    }
+#endif
+    // unknown topology, all cpus belong to node 0
+    return GetCpuAffinity(cpu_list);
+}
+
+Status CpuUtils::SetNumaMemoryPolicy(int numa_node) {
+#if defined(__linux__) && defined(__NR_set_mempolicy)
+    // from include/uapi/linux/mempolicy.h
+    const int mpol_default   = 0;
+    const int mpol_preferred = 1;
+    if (numa_node < 0) {
+        if (0 != syscall(__NR_set_mempolicy, mpol_default, NULL, 0)) {
+            return Status(TNNERR_SET_CPU_AFFINITY, "set_mempolicy failed");
+        }
+        return TNN_OK;
+    }
+    if (numa_node >= GetNumaNodeCount() || numa_node >= TNN_CPU_SETSIZE) {
+        return Status(TNNERR_PARAM_ERR, "invalid numa node");
+    }
+    unsigned long mask[TNN_CPU_SETSIZE / TNN_NCPUBITS] = {0};
+    mask[numa_node / TNN_NCPUBITS] |= 1UL << (numa_node % TNN_NCPUBITS);
+    if (0 != syscall(__NR_set_mempolicy, mpol_preferred, mask, TNN_CPU_SETSIZE)) {
+        return Status(TNNERR_SET_CPU_AFFINITY, "set_mempolicy failed");
+    }
+    return TNN_OK;
+#else
+    return numa_node < 0 ? TNN_OK : Status(TNNERR_SET_CPU_AFFINITY, "numa memory policy is not supported");
+#endif
+}
+
+Status CpuUtils::GetMemoryPolicy(int& mode, std::vector<unsigned long>& node_mask) {
+#if defined(__linux__) && defined(__NR_get_mempolicy)
+    // the mask must hold at least as many bits as the kernel has numa nodes
+    node_mask.assign(TNN_CPU_SETSIZE / TNN_NCPUBITS, 0);
+    if (0 != syscall(__NR_get_mempolicy, &mode, node_mask.data(), TNN_CPU_SETSIZE, NULL, 0)) {
+        return Status(TNNERR_SET_CPU_AFFINITY, "get_mempolicy failed");
+    }
+    return TNN_OK;
+#else
+    mode = 0;
+    node_mask.clear();
+    return TNN_OK;
+#endif
+}
+
+Status CpuUtils::SetMemoryPolicy(int mode, const std::vector<unsigned long>& node_mask) {
+#if defined(__linux__) && defined(__NR_set_mempolicy)
+    const unsigned long *mask = node_mask.empty() ? NULL : node_mask.data();
+    if (0 != syscall(__NR_set_mempolicy, mode, mask, node_mask.size() * TNN_NCPUBITS)) {
+        return Status(TNNERR_SET_CPU_AFFINITY, "set_mempolicy failed");
+    }
+    return TNN_OK;
+#else
+    return mode == 0 ? TNN_OK : Status(TNNERR_SET_CPU_AFFINITY, "numa memory policy is not supported");
+#endif
+}
+
 bool CpuUtils::CpuSupportFp16() {
     bool fp16arith = false;
 
@@ -115,8 +115,6 @@ void NonMaxSuppressionSingleClasssImpl(Blob* decoded_boxes, const float* scores,
     ASSERT(decoded_boxes->GetBlobDesc().dims[1] == 4);
 
     const int output_num = std::min(max_detections, num_boxes);
-    std::vector<float> scores_data(num_boxes);
-    std::copy_n(scores, num_boxes, scores_data.begin());
 
     struct Candidate {
         int box_index;
@@ -125,64 +123,61 @@ void NonMaxSuppressionSingleClasssImpl(Blob* decoded_boxes, const float* scores,
 
     auto cmp = [](const Candidate bs_i, const Candidate bs_j) { return bs_i.score < bs_j.score; };
 
-    std::priority_queue<Candidate, std::deque<Candidate>, decltype(cmp)> candidate_priority_queue(cmp);
-
-    for (int i = 0; i < scores_data.size(); ++i) {
-        if (scores_data[i] > score_threshold) {
-            candidate_priority_queue.emplace(Candidate({i, scores_data[i]}));
+    // only the candidates above the threshold go into the heap, the heap is built at once
+    std::vector<Candidate> candidates;
+    for (int i = 0; i < num_boxes; ++i) {
+        if (scores[i] > score_threshold) {
+            candidates.push_back(Candidate({i, scores[i]}));
         }
     }
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(cmp)> candidate_priority_queue(
+        cmp, std::move(candidates));
 
-    // std::vector<float> selectedScores;
-    Candidate next_candidate;
-    float iou, original_score;
+    // corners and area of the selected boxes, stored as struct of arrays
+    std::vector<float> selected_ymin, selected_xmin, selected_ymax, selected_xmax, selected_area;
 
     const auto boxes_ptr = static_cast<float*>(decoded_boxes->GetHandle().base);
     while (selected->size() < output_num && !candidate_priority_queue.empty()) {
-        next_candidate = candidate_priority_queue.top();
-        original_score = next_candidate.score;
+        const Candidate next_candidate = candidate_priority_queue.top();
         candidate_priority_queue.pop();
 
+        const float* box  = boxes_ptr + next_candidate.box_index * 4;
+        const float y_min = std::min<float>(box[0], box[2]);
+        const float x_min = std::min<float>(box[1], box[3]);
+        const float y_max = std::max<float>(box[0], box[2]);
+        const float x_max = std::max<float>(box[1], box[3]);
+        const float area  = (y_max - y_min) * (x_max - x_min);
+
         // Overlapping boxes are likely to have similar scores,
         // therefore we iterate through the previously selected boxes backwards
         // in order to see if `next_candidate` should be suppressed.
+        // A box without area never overlaps.
         bool should_select = true;
-        for (int j = (int)selected->size() - 1; j >= 0; --j) {
-            iou = IOU(boxes_ptr, next_candidate.box_index, selected->at(j));
-            if (iou == 0.0) {
+        for (int j = (int)selected->size() - 1; j >= 0 && area > 0; --j) {
+            if (selected_area[j] <= 0) {
                 continue;
             }
+            const float intersection_area =
+                std::max<float>(std::min<float>(y_max, selected_ymax[j]) - std::max<float>(y_min, selected_ymin[j]),
+                                0.0) *
+                std::max<float>(std::min<float>(x_max, selected_xmax[j]) - std::max<float>(x_min, selected_xmin[j]),
+                                0.0);
+            const float iou = intersection_area / (area + selected_area[j] - intersection_area);
             if (iou > iou_threshold) {
                 should_select = false;
+                break;
             }
         }
 
         if (should_select) {
             selected->push_back(next_candidate.box_index);
-            // selectedScores.push_back(next_candidate.score);
+            selected_ymin.push_back(y_min);
+            selected_xmin.push_back(x_min);
+            selected_ymax.push_back(y_max);
+            selected_xmax.push_back(x_max);
+            selected_area.push_back(area);
         }
     }
 }
-static inline float IOU(const float* boxes, int i, int j) {
-    const float y_min_i = std::min<float>(boxes[i * 4 + 0], boxes[i * 4 + 2]);
-    const float x_min_i = std::min<float>(boxes[i * 4 + 1], boxes[i * 4 + 3]);
-    const float y_max_i = std::max<float>(boxes[i * 4 + 0], boxes[i * 4 + 2]);
-    const float x_max_i = std::max<float>(boxes[i * 4 + 1], boxes[i * 4 + 3]);
-    const float y_min_j = std::min<float>(boxes[j * 4 + 0], boxes[j * 4 + 2]);
-    const float x_min_j = std::min<float>(boxes[j * 4 + 1], boxes[j * 4 + 3]);
-    const float y_max_j = std::max<float>(boxes[j * 4 + 0], boxes[j * 4 + 2]);
-    const float x_max_j = std::max<float>(boxes[j * 4 + 1], boxes[j * 4 + 3]);
-    const float area_i  = (y_max_i - y_min_i) * (x_max_i - x_min_i);
-    const float area_j  = (y_max_j - y_min_j) * (x_max_j - x_min_j);
-    if (area_i <= 0 || area_j <= 0)
-        return 0.0;
-    const float intersection_y_min = std::max<float>(y_min_i, y_min_j);
-    const float intersection_x_min = std::max<float>(x_min_i, x_min_j);
-    const float intersection_y_max = std::min<float>(y_max_i, y_max_j);
-    const float intersection_x_max = std::min<float>(x_max_i, x_max_j);
-    const float intersection_area  = std::max<float>(intersection_y_max - intersection_y_min, 0.0) *
-                                    std::max<float>(intersection_x_max - intersection_x_min, 0.0);
-    return intersection_area / (area_i + area_j - intersection_area);
-}
 
 }  // namespace TNN_NS
\ No newline at end of file
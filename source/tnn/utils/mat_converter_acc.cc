@@ -20,6 +20,10 @@
 
 namespace TNN_NS {
 
+Status MatConverterAcc::CropResize(Mat& src, Mat& dst, CropResizeParam param, void* command_queue) {
+    return Status(TNNERR_PARAM_ERR, "crop resize is not supported on this device");
+}
+
 std::shared_ptr<MatConverterManager>& MatConverterManager::Shared() {
     static std::once_flag once;
     static std::shared_ptr<MatConverterManager> g_global_blob_converter_manager;
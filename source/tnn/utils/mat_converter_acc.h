@@ -38,6 +38,8 @@ public:
     virtual Status WarpAffine(Mat& src, Mat& dst, WarpAffineParam param, void* command_queue = NULL)         = 0;
     virtual Status CvtColor(Mat& src, Mat& dst, ColorConversionType type, void* command_queue = NULL)        = 0;
     virtual Status CopyMakeBorder(Mat& src, Mat& dst, CopyMakeBorderParam param, void* command_queue = NULL) = 0;
+    // not all devices implement it, the default returns an error
+    virtual Status CropResize(Mat& src, Mat& dst, CropResizeParam param, void* command_queue = NULL);
 };
 
 class MatConverterAccCreater {
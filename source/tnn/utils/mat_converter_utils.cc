@@ -165,4 +165,16 @@ int GetMatElementSize(Mat* mat) {
     }
 }
 
+int CropResizeSrcChannel(int c, int channel, bool reverse_channel) {
+    return (reverse_channel && channel >= 3 && c < 3) ? 2 - c : c;
+}
+
+void CropResizePosition(int i, float start, float scale, int length, int* pos0, int* pos1, float* ratio) {
+    float pos = start + (i + 0.5f) * scale - 0.5f;
+    pos       = std::min(std::max(pos, 0.f), (float)(length - 1));
+    *pos0     = (int)pos;
+    *pos1     = std::min(*pos0 + 1, length - 1);
+    *ratio    = pos - *pos0;
+}
+
 }  // namespace TNN_NS
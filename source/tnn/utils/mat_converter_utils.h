@@ -56,6 +56,13 @@ void WarpAffineMatrixInverse(const float (*transform)[3], double* inverse);
 
 int GetMatElementSize(Mat* mat);
 
+// @brief src channel of dst channel c for CropResize, reverse_channel swaps the first three channels
+int CropResizeSrcChannel(int c, int channel, bool reverse_channel);
+
+// @brief sample position of dst pixel i in src for CropResize, clamped to the src image, pos0 and pos1 are the
+// neighbouring src pixels and ratio the weight of pos1
+void CropResizePosition(int i, float start, float scale, int length, int* pos0, int* pos1, float* ratio);
+
 }  // namespace TNN_NS
 
 #endif
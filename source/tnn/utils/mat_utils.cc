@@ -213,6 +213,71 @@ Status MatUtils::CopyMakeBorder(Mat& src, Mat& dst, CopyMakeBorderParam param, v
     return converter->CopyMakeBorder(src, dst, param, command_queue);
 }
 
+static int GetCropResizeSrcChannel(MatType mat_type) {
+    switch (mat_type) {
+        case NGRAY:
+            return 1;
+        case N8UC3:
+            return 3;
+        case N8UC4:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+Status MatUtils::CropResize(Mat& src, Mat& dst, CropResizeParam param, void* command_queue) {
+    auto ret = CheckSrcAndDstMat(src, dst, true, false, true);
+    if (ret != TNN_OK) {
+        return ret;
+    }
+
+    int src_channel = GetCropResizeSrcChannel(src.GetMatType());
+    if (src_channel == 0 || src.GetBatch() != 1) {
+        return Status(TNNERR_PARAM_ERR, "crop resize src must be a single NGRAY, N8UC3 or N8UC4 image");
+    }
+    if (dst.GetMatType() != NCHW_FLOAT) {
+        return Status(TNNERR_PARAM_ERR, "crop resize dst must be NCHW_FLOAT");
+    }
+
+    int num_boxes = static_cast<int>(param.boxes.size());
+    if (num_boxes <= 0) {
+        return Status(TNNERR_PARAM_ERR, "crop resize boxes is empty");
+    }
+    if (!param.transforms.empty() && param.transforms.size() != param.boxes.size()) {
+        return Status(TNNERR_PARAM_ERR, "crop resize transforms and boxes size not equal");
+    }
+    for (int i = 0; i < num_boxes; ++i) {
+        bool has_transform = !param.transforms.empty() && !param.transforms[i].empty();
+        if (has_transform && param.transforms[i].size() != 6) {
+            return Status(TNNERR_PARAM_ERR, "crop resize transform must have 6 values");
+        }
+        if (!has_transform && (param.boxes[i].width <= 0 || param.boxes[i].height <= 0)) {
+            return Status(TNNERR_PARAM_ERR, "crop resize box size is zero or negnative");
+        }
+    }
+
+    if (dst.GetWidth() <= 0 || dst.GetHeight() <= 0) {
+        return Status(TNNERR_PARAM_ERR, "crop resize dst size is zero or negnative");
+    }
+    int dst_channel = dst.GetChannel() > 0 ? dst.GetChannel() : src_channel;
+    if (dst_channel > src_channel) {
+        return Status(TNNERR_PARAM_ERR, "crop resize dst channel is larger than src channel");
+    }
+    if (param.scale.size() < dst_channel || param.bias.size() < dst_channel) {
+        return Status(TNNERR_PARAM_ERR, "crop resize scale or bias size is smaller than dst channel");
+    }
+    if (dst.GetBatch() != num_boxes || dst.GetChannel() != dst_channel) {
+        CHECK_DST_DATA_NULL;
+        // one dst image per box
+        DimsVector dims = {num_boxes, dst_channel, dst.GetHeight(), dst.GetWidth()};
+        dst = Mat(dst.GetDeviceType(), dst.GetMatType(), dims);
+    }
+
+    MAT_CONVERTER_PREPARATION(src.GetDeviceType());
+    return converter->CropResize(src, dst, param, command_queue);
+}
+
 #undef CHECK_DST_DATA_NULL
 #undef MAT_CONVERTER_PREPARATION
 
@@ -233,8 +233,8 @@ void NaivePooling3D(T *input_ptr, T *output_ptr, DimsVector dims_input, DimsVect
                         if (pool_type == 0) {  // max pooling
                             calc_val = std::max((Tacc)cur_val, calc_val);
                         } else {
-                            // average pooling
-                            calc_val = calc_val / kernel_count;
+                            // average pooling, a window entirely in the pads gives 0
+                            calc_val = kernel_count > 0 ? calc_val / kernel_count : 0;
                         }
 
                         ou_current_batch[c * output_height * output_width * output_depth
@@ -909,7 +909,8 @@ void DealOutput(Blob *output_blob, const int num_kept, const int num,
 }
 
 void NaiveDetectionOutput(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs,
-                          DetectionOutputLayerParam *param) {
+                          DetectionOutputLayerParam *param, BBoxOverlapFunc overlap_func,
+                          const ParallelForFunc &parallel_for) {
     ASSERT(inputs.size() >= 3);
     Blob *loc_blob   = inputs[0];
     Blob *conf_blob  = inputs[1];
@@ -982,36 +983,60 @@ void NaiveDetectionOutput(const std::vector<Blob *> &inputs, const std::vector<B
                         &all_decode_bboxes);
     }
 
+    // The nms of every (image, class) pair is independent, the results are
+    // collected per image afterwards.
+    const int num_classes = param->num_classes;
+    if (overlap_func == nullptr) {
+        overlap_func = AnyJaccardOverlap;
+    }
+    std::vector<std::vector<int>> class_indices(num * num_classes);
+    std::vector<char> class_done(num * num_classes, 0);
+    auto class_nms = [&](int task) {
+        const int i = task / num_classes;
+        const int c = task % num_classes;
+        if (c == param->background_label_id) {
+            // Ignore background class.
+            return;
+        }
+        const LabelBBox &decode_bboxes                       = all_decode_bboxes[i];
+        const std::map<int, std::vector<float>> &conf_scores = all_conf_scores[i];
+        if (conf_scores.find(c) == conf_scores.end()) {
+            // Something bad happened if there are no predictions for
+            // current label.
+            LOGE("Could not find confidence predictions for label ");
+            return;
+        }
+        const std::vector<float> &scores = conf_scores.find(c)->second;
+        int label                        = param->share_location ? -1 : c;
+        if (decode_bboxes.find(label) == decode_bboxes.end()) {
+            // Something bad happened if there are no predictions for
+            LOGE("Could not find location predictions for label");
+            return;
+        }
+        const std::vector<NormalizedBBox> &bboxes = decode_bboxes.find(label)->second;
+        ApplyNMSFast(bboxes, scores, param->confidence_threshold, param->nms_param.nms_threshold, param->eta,
+                     param->nms_param.top_k, &class_indices[task], overlap_func);
+        class_done[task] = 1;
+    };
+    if (parallel_for) {
+        parallel_for(num * num_classes, class_nms);
+    } else {
+        for (int task = 0; task < num * num_classes; ++task) {
+            class_nms(task);
+        }
+    }
+
     int num_kept = 0;
     std::vector<std::map<int, std::vector<int>>> all_indices;
     for (int i = 0; i < num; ++i) {
-        const LabelBBox &decode_bboxes                       = all_decode_bboxes[i];
         const std::map<int, std::vector<float>> &conf_scores = all_conf_scores[i];
         std::map<int, std::vector<int>> indices;
         int num_det = 0;
-        for (int c = 0; c < param->num_classes; ++c) {
-            if (c == param->background_label_id) {
-                // Ignore background class.
-                continue;
-            }
-            if (conf_scores.find(c) == conf_scores.end()) {
-                // Something bad happened if there are no predictions for
-                // current label.
-                LOGE("Could not find confidence predictions for label ");
-                // assert(false); // "Could not find confidence predictions for
-                // label
-            }
-            const std::vector<float> &scores = conf_scores.find(c)->second;
-            int label                        = param->share_location ? -1 : c;
-            if (decode_bboxes.find(label) == decode_bboxes.end()) {
-                // Something bad happened if there are no predictions for
-                LOGE("Could not find location predictions for label");
-                continue;
+        for (int c = 0; c < num_classes; ++c) {
+            if (class_done[i * num_classes + c]) {
+                indices[c] = std::move(class_indices[i * num_classes + c]);
+                num_det += static_cast<int>(indices[c].size());
             }
-            const std::vector<NormalizedBBox> &bboxes = decode_bboxes.find(label)->second;
-            ApplyNMSFast(bboxes, scores, param->confidence_threshold, param->nms_param.nms_threshold, param->eta,
-                         param->nms_param.top_k, &(indices[c]));
-            num_det += static_cast<int>(indices[c].size());
         }
         if (param->keep_top_k > -1 && num_det > param->keep_top_k) {
             std::vector<std::pair<float, std::pair<int, int>>> score_index_pairs;
@@ -1031,7 +1056,8 @@ void NaiveDetectionOutput(const std::vector<Blob *> &inputs, const std::vector<B
                 }
             }
             // Keep top k results per image.
-            std::sort(score_index_pairs.begin(), score_index_pairs.end(), SortScorePairDescend<std::pair<int, int>>);
+            std::partial_sort(score_index_pairs.begin(), score_index_pairs.begin() + param->keep_top_k,
+                              score_index_pairs.end(), SortScorePairDescend<std::pair<int, int>>);
             score_index_pairs.resize(param->keep_top_k);
             // Store the new indices.
             std::map<int, std::vector<int>> new_indices;
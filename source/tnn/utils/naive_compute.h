@@ -21,9 +21,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <functional>
 
 #include "tnn/core/blob.h"
 #include "tnn/core/common.h"
+#include "tnn/device/cpu/acc/compute/normalized_bbox.h"
 #include "tnn/interpreter/layer_param.h"
 #include "tnn/utils/half_utils_inner.h"
 
@@ -91,8 +93,14 @@ void NaivePriorbox(PriorBoxLayerParam *param, int output_h, int output_w, float
 
 void priorbox_set_value(const int N, const float alpha, float *Y);
 
+// runs func(0), ..., func(count - 1), the calls may run in parallel
+typedef std::function<void(int count, const std::function<void(int)> &func)> ParallelForFunc;
+
+// overlap_func checks a box against the kept boxes in nms, AnyJaccardOverlap if nullptr.
+// parallel_for runs the nms of the (image, class) pairs, in order if nullptr.
 void NaiveDetectionOutput(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs,
-                          DetectionOutputLayerParam *param);
+                          DetectionOutputLayerParam *param, BBoxOverlapFunc overlap_func = nullptr,
+                          const ParallelForFunc &parallel_for = nullptr);
 
 void NaiveColorToGray(const uint8_t *src, uint8_t *dst, int h, int w, int channel, bool bgr_order);
 
@@ -33,6 +33,7 @@
 #define OMP_PARALLEL_FOR_ PRAGMA_(omp parallel for)
 #define OMP_PARALLEL_FOR_GUIDED_ PRAGMA_(omp parallel for)
 #define OMP_PARALLEL_FOR_DYNAMIC_ PRAGMA_(omp parallel for schedule(dynamic))
+#define OMP_PARALLEL_FOR_DYNAMIC_THREADS_(t) PRAGMA_(omp parallel for schedule(dynamic) num_threads(t))
 #define OMP_SECTION_ PRAGMA_(omp section)
 #define OMP_PARALLEL_SECTIONS_ PRAGMA_(omp parallel sections)
 #define OMP_CORES_ (omp_get_num_procs())
@@ -45,6 +46,7 @@
 #define OMP_PARALLEL_FOR_
 #define OMP_PARALLEL_FOR_GUIDED_
 #define OMP_PARALLEL_FOR_DYNAMIC_
+#define OMP_PARALLEL_FOR_DYNAMIC_THREADS_(t)
 #define OMP_PARALLEL_FOR_COLLAPSE_(t)
 #define OMP_SECTION_
 #define OMP_PARALLEL_SECTIONS_
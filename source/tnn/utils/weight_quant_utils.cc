@@ -0,0 +1,123 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "tnn/utils/weight_quant_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace TNN_NS {
+
+int WeightQuantUtils::GetGroupCount(int cols, int group_size) {
+    if (group_size <= 0 || group_size >= cols) {
+        return 1;
+    }
+    return UP_DIV(cols, group_size);
+}
+
+int WeightQuantUtils::GetRowBytes(int cols, int bits) {
+    return bits == 4 ? UP_DIV(cols, 2) : cols;
+}
+
+Status WeightQuantUtils::CheckQuantizedBuffer(RawBuffer &weight, RawBuffer &scale, int rows, int cols, int bits,
+                                              int group_size) {
+    if (bits != 8 && bits != 4) {
+        LOGE("WeightQuantUtils: unsupported weight bits %d\n", bits);
+        return Status(TNNERR_PARAM_ERR, "weight only quantization supports 8 and 4 bits");
+    }
+    if (group_size < 0) {
+        LOGE("WeightQuantUtils: invalid group size %d\n", group_size);
+        return Status(TNNERR_PARAM_ERR, "invalid weight quantization group size");
+    }
+    if (weight.GetDataType() != DATA_TYPE_INT8 || weight.GetBytesSize() < rows * GetRowBytes(cols, bits)) {
+        return Status(TNNERR_MODEL_ERR, "invalid weight only quantized weights");
+    }
+    if ((scale.GetDataType() != DATA_TYPE_FLOAT && scale.GetDataType() != DATA_TYPE_HALF) ||
+        scale.GetDataCount() != rows * GetGroupCount(cols, group_size)) {
+        return Status(TNNERR_MODEL_ERR, "invalid weight only quantized scales");
+    }
+    return TNN_OK;
+}
+
+Status WeightQuantUtils::Quantize(const float *src, int rows, int cols, int bits, int group_size, RawBuffer &weight,
+                                  RawBuffer &scale) {
+    if (bits != 8 && bits != 4) {
+        return Status(TNNERR_PARAM_ERR, "weight only quantization supports 8 and 4 bits");
+    }
+    const int row_bytes   = GetRowBytes(cols, bits);
+    const int group_count = GetGroupCount(cols, group_size);
+    const int group_cols  = group_count == 1 ? cols : group_size;
+    const int max_value   = bits == 8 ? 127 : 7;
+
+    weight = RawBuffer(rows * row_bytes, {rows, cols});
+    weight.SetDataType(DATA_TYPE_INT8);
+    scale = RawBuffer(rows * group_count * sizeof(float));
+    scale.SetDataType(DATA_TYPE_FLOAT);
+    auto weight_ptr = weight.force_to<int8_t *>();
+    auto scale_ptr  = scale.force_to<float *>();
+    memset(weight_ptr, 0, rows * row_bytes);
+
+    for (int r = 0; r < rows; r++) {
+        const float *src_row = src + r * cols;
+        int8_t *dst_row      = weight_ptr + r * row_bytes;
+        for (int g = 0; g < group_count; g++) {
+            const int col_begin = g * group_cols;
+            const int col_end   = std::min(cols, col_begin + group_cols);
+            float max_abs       = 0.f;
+            for (int c = col_begin; c < col_end; c++) {
+                max_abs = std::max(max_abs, std::fabs(src_row[c]));
+            }
+            const float group_scale        = max_abs / max_value;
+            scale_ptr[r * group_count + g] = group_scale;
+
+            for (int c = col_begin; c < col_end; c++) {
+                int value = 0;
+                if (group_scale > 0.f) {
+                    value = static_cast<int>(std::round(src_row[c] / group_scale));
+                    value = std::min(max_value, std::max(-max_value, value));
+                }
+                if (bits == 8) {
+                    dst_row[c] = static_cast<int8_t>(value);
+                } else {
+                    dst_row[c >> 1] |= static_cast<int8_t>((value & 0xF) << ((c & 1) * 4));
+                }
+            }
+        }
+    }
+    return TNN_OK;
+}
+
+Status WeightQuantUtils::Dequantize(RawBuffer &weight, RawBuffer &scale, int rows, int cols, int bits,
+                                    int group_size, float *dst) {
+    RETURN_ON_NEQ(CheckQuantizedBuffer(weight, scale, rows, cols, bits, group_size), TNN_OK);
+
+    RawBuffer scale_f32   = scale.GetDataType() == DATA_TYPE_HALF ? ConvertHalfHandle(scale) : scale;
+    const int row_bytes   = GetRowBytes(cols, bits);
+    const int group_count = GetGroupCount(cols, group_size);
+    const int group_cols  = group_count == 1 ? cols : group_size;
+    auto weight_ptr       = weight.force_to<int8_t *>();
+    auto scale_ptr        = scale_f32.force_to<float *>();
+
+    for (int r = 0; r < rows; r++) {
+        const int8_t *src_row = weight_ptr + r * row_bytes;
+        float *dst_row        = dst + r * cols;
+        for (int c = 0; c < cols; c++) {
+            dst_row[c] = GetValue(src_row, c, bits) * scale_ptr[r * group_count + c / group_cols];
+        }
+    }
+    return TNN_OK;
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,65 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef TNN_SOURCE_TNN_UTILS_WEIGHT_QUANT_UTILS_H_
+#define TNN_SOURCE_TNN_UTILS_WEIGHT_QUANT_UTILS_H_
+
+#include <cstdint>
+
+#include "tnn/core/macro.h"
+#include "tnn/core/status.h"
+#include "tnn/interpreter/raw_buffer.h"
+
+namespace TNN_NS {
+
+/*
+weight only quantization keeps rows x cols weights as int8 values or as int4 values packed two per byte, the low nibble
+holds the even col and every row starts at a new byte. Each row has one float scale per group of group_size cols,
+group_size 0 means one group per row, the scales are stored row by row. The weight is value * scale.
+Quantize sets the dims of the weights to {rows, cols}.
+*/
+class WeightQuantUtils {
+public:
+    // @brief number of scale groups of a row
+    static int GetGroupCount(int cols, int group_size);
+
+    // @brief bytes of a quantized row
+    static int GetRowBytes(int cols, int bits);
+
+    // @brief check bits and group size, and the sizes of the weight and scale buffers
+    static Status CheckQuantizedBuffer(RawBuffer &weight, RawBuffer &scale, int rows, int cols, int bits,
+                                       int group_size);
+
+    // @brief symmetric quantization of float weights to int8 or int4 weights with float scales
+    static Status Quantize(const float *src, int rows, int cols, int bits, int group_size, RawBuffer &weight,
+                           RawBuffer &scale);
+
+    // @brief dequantize the weights to rows x cols float weights, half scales are supported
+    static Status Dequantize(RawBuffer &weight, RawBuffer &scale, int rows, int cols, int bits, int group_size,
+                             float *dst);
+
+    // @brief quantized value of col in a row
+    static inline int GetValue(const int8_t *row, int col, int bits) {
+        if (bits == 8) {
+            return row[col];
+        }
+        // arithmetic shifts sign extend the nibble
+        int8_t packed = row[col >> 1];
+        return (col & 1) ? (packed >> 4) : (static_cast<int8_t>(packed << 4) >> 4);
+    }
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_SOURCE_TNN_UTILS_WEIGHT_QUANT_UTILS_H_
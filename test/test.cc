@@ -21,6 +21,7 @@
 #include <cfloat>
 #include <cstdlib>
 #include <fstream>
+#include <future>
 #include <iomanip>
 #include <sstream>
 #include <string>
@@ -98,13 +99,20 @@ namespace test {
             auto output_converters_map = CreateBlobConverterMap(output_blob_map);
             auto output_params_map = CreateConvertParamMap(output_mat_map, false);
 
+            // cpu devices run ForwardAsync on the worker thread of the instance, the converters read
+            // the output blobs directly, so the forward is waited for before converting
+            std::future<Status> forward_status;
+
             for (int i = 0; i < FLAGS_wc; ++i) {
                 for(auto element : input_converters_map) {
                     auto name = element.first;
                     auto blob_converter = element.second;
                     blob_converter->ConvertFromMatAsync(*input_mat_map[name], input_params_map[name], command_queue);
                 }
-                ret = instance->ForwardAsync(nullptr);
+                ret = instance->ForwardAsync(forward_status);
+                if (ret == TNN_OK) {
+                    ret = forward_status.get();
+                }
                 for(auto element : output_converters_map) {
                     auto name = element.first;
                     auto blob_converter = element.second;
@@ -135,7 +143,10 @@ namespace test {
 #if (DUMP_INPUT_BLOB || DUMP_OUTPUT_BLOB)
                 ret = instance->Forward();
 #else
-                ret = instance->ForwardAsync(nullptr);
+                ret = instance->ForwardAsync(forward_status);
+                if (ret == TNN_OK) {
+                    ret = forward_status.get();
+                }
 #endif
                 if (!CheckResult("Forward", ret)) {
                     return ret;
@@ -0,0 +1,122 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "test/unit_test/instance_test.h"
+#include "test/unit_test/unit_test_common.h"
+#include "tnn/core/default_network.h"
+#include "tnn/utils/blob_converter.h"
+
+namespace TNN_NS {
+
+// batch split runs on the network directly, the instance does not expose how the batch was split
+class BatchSplitTest : public InstanceTest {
+protected:
+    // the threads are capped by the cores of the machine, the batch is split once per thread
+    class SplitNetwork : public DefaultNetwork {
+    public:
+        int GetExpectedSplitCount(int batch) {
+            int split_count = MIN(GetContext()->GetNumThreads(), batch);
+            return split_count > 1 ? split_count : 0;
+        }
+    };
+
+
+    static Status InitNetwork(DefaultNetwork& network, AbstractModelInterpreter* interpreter, bool enable_batch_split,
+                              DimsVector max_dims) {
+        auto config               = GetDeviceConfig();
+        config.enable_batch_split = enable_batch_split;
+        ModelConfig model_config;
+        InputShapesMap inputs_shape = {{"input0", max_dims}};
+        return network.Init(config, model_config, interpreter, inputs_shape, inputs_shape);
+    }
+
+    static Status ForwardNetwork(DefaultNetwork& network, std::shared_ptr<Mat> input, std::shared_ptr<Mat>& output) {
+        RETURN_ON_NEQ(network.Reshape({{"input0", input->GetDims()}}), TNN_OK);
+        BlobMap input_blobs, output_blobs;
+        RETURN_ON_NEQ(network.GetAllInputBlobs(input_blobs), TNN_OK);
+        RETURN_ON_NEQ(network.GetAllOutputBlobs(output_blobs), TNN_OK);
+
+        void* command_queue = nullptr;
+        RETURN_ON_NEQ(network.GetCommandQueue(&command_queue), TNN_OK);
+        BlobConverter input_converter(input_blobs.begin()->second);
+        RETURN_ON_NEQ(input_converter.ConvertFromMat(*input, MatConvertParam(), command_queue), TNN_OK);
+        RETURN_ON_NEQ(network.Forward(), TNN_OK);
+
+        Blob* output_blob = output_blobs.begin()->second;
+        output            = std::make_shared<Mat>(DEVICE_NAIVE, NCHW_FLOAT, output_blob->GetBlobDesc().dims);
+        BlobConverter output_converter(output_blob);
+        return output_converter.ConvertToMat(*output, MatConvertParam(), command_queue);
+    }
+};
+
+TEST_F(BatchSplitTest, SplitMatchesUnsplit) {
+    if (GetDeviceConfig().device_type != DEVICE_X86) {
+        GTEST_SKIP();
+    }
+
+    DimsVector dims        = {10, 4, 8, 8};
+    auto param             = CreateConvParam(4, 8, 3, 1);
+    auto interpreter       = GenerateInterpreter("Convolution", {dims}, param, CreateConvResource(param));
+    auto split_interpreter = interpreter->Copy();
+    DefaultNetwork network;
+    SplitNetwork split_network;
+    ASSERT_EQ((int)InitNetwork(network, interpreter.get(), false, dims), TNN_OK);
+    ASSERT_EQ((int)InitNetwork(split_network, split_interpreter.get(), true, dims), TNN_OK);
+    ASSERT_EQ((int)split_network.SetCpuNumThreads(4), TNN_OK);
+
+    // 10 over 4 threads splits unevenly, 8 evenly
+    for (int batch : {10, 8}) {
+        dims[0]    = batch;
+        auto input = CreateRandomMat(dims);
+        std::shared_ptr<Mat> expected, output;
+        ASSERT_EQ((int)ForwardNetwork(network, input, expected), TNN_OK);
+        ASSERT_EQ((int)ForwardNetwork(split_network, input, output), TNN_OK);
+        EXPECT_EQ(split_network.GetBatchSplitCount(), split_network.GetExpectedSplitCount(batch));
+        EXPECT_EQ(0, CompareMat(expected, output));
+    }
+}
+
+TEST_F(BatchSplitTest, FallBackIfShapesDoNotScale) {
+    if (GetDeviceConfig().device_type != DEVICE_X86) {
+        GTEST_SKIP();
+    }
+
+    // the reshape merges the batch into the channels
+    DimsVector dims         = {10, 4, 8, 8};
+    auto conv_param         = CreateConvParam(4, 4, 3, 1);
+    auto reshape_param      = std::make_shared<ReshapeLayerParam>();
+    reshape_param->shape    = {1, -1, 8, 8};
+    reshape_param->num_axes = 4;
+    auto interpreter = GenerateInterpreter(
+        {dims},
+        {CreateLayerInfo("Convolution", "conv", {"input0"}, {"conv_output"}, conv_param),
+         CreateLayerInfo("Reshape", "reshape", {"conv_output"}, {"output"}, reshape_param)},
+        {{"conv", CreateConvResource(conv_param)}});
+    auto split_interpreter = interpreter->Copy();
+    DefaultNetwork network;
+    SplitNetwork split_network;
+    ASSERT_EQ((int)InitNetwork(network, interpreter.get(), false, dims), TNN_OK);
+    ASSERT_EQ((int)InitNetwork(split_network, split_interpreter.get(), true, dims), TNN_OK);
+    ASSERT_EQ((int)split_network.SetCpuNumThreads(4), TNN_OK);
+
+    auto input = CreateRandomMat(dims);
+    std::shared_ptr<Mat> expected, output;
+    ASSERT_EQ((int)ForwardNetwork(network, input, expected), TNN_OK);
+    ASSERT_EQ((int)ForwardNetwork(split_network, input, output), TNN_OK);
+    EXPECT_EQ(split_network.GetBatchSplitCount(), 0);
+    EXPECT_EQ(output->GetDims()[1], 40);
+    EXPECT_EQ(0, CompareMat(expected, output));
+}
+
+}  // namespace TNN_NS
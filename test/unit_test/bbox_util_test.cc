@@ -0,0 +1,182 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include "tnn/utils/bbox_util.h"
+
+namespace TNN_NS {
+
+/*
+reference nms, the caffe implementation the bbox utils were taken from: all score pairs are stable sorted and the
+candidates are erased from the front of a vector
+*/
+static void RefGetMaxScoreIndex(const vector<float>& scores, const float threshold, const int top_k,
+                                vector<pair<float, int>>* score_index_vec) {
+    for (size_t i = 0; i < scores.size(); ++i) {
+        if (scores[i] > threshold) {
+            score_index_vec->push_back(std::make_pair(scores[i], i));
+        }
+    }
+    std::stable_sort(score_index_vec->begin(), score_index_vec->end(), SortScorePairDescend<int>);
+    if (top_k > -1 && top_k < score_index_vec->size()) {
+        score_index_vec->resize(top_k);
+    }
+}
+
+static void RefApplyNMSFast(const vector<NormalizedBBox>& bboxes, const vector<float>& scores,
+                            const float score_threshold, const float nms_threshold, const float eta, const int top_k,
+                            vector<int>* indices) {
+    vector<pair<float, int>> score_index_vec;
+    RefGetMaxScoreIndex(scores, score_threshold, top_k, &score_index_vec);
+
+    float adaptive_threshold = nms_threshold;
+    indices->clear();
+    while (score_index_vec.size() != 0) {
+        const int idx = score_index_vec.front().second;
+        bool keep     = true;
+        for (int k = 0; k < indices->size() && keep; ++k) {
+            keep = JaccardOverlap(bboxes[idx], bboxes[(*indices)[k]]) <= adaptive_threshold;
+        }
+        if (keep) {
+            indices->push_back(idx);
+        }
+        score_index_vec.erase(score_index_vec.begin());
+        if (keep && eta < 1 && adaptive_threshold > 0.5) {
+            adaptive_threshold *= eta;
+        }
+    }
+}
+
+static void RefApplyNMS(const vector<NormalizedBBox>& bboxes, const vector<float>& scores, const float threshold,
+                        const int top_k, vector<int>* indices) {
+    vector<pair<float, int>> score_index_vec;
+    for (size_t i = 0; i < scores.size(); ++i) {
+        score_index_vec.push_back(std::make_pair(scores[i], i));
+    }
+    std::stable_sort(score_index_vec.begin(), score_index_vec.end(), SortScorePairDescend<int>);
+    if (top_k > -1 && top_k < score_index_vec.size()) {
+        score_index_vec.resize(top_k);
+    }
+
+    indices->clear();
+    while (score_index_vec.size() != 0) {
+        int best_idx                    = score_index_vec.front().second;
+        const NormalizedBBox& best_bbox = bboxes[best_idx];
+        score_index_vec.erase(score_index_vec.begin());
+        if (BBoxSize(best_bbox) < 1e-5) {
+            continue;
+        }
+        indices->push_back(best_idx);
+        if (top_k > -1 && indices->size() >= top_k) {
+            break;
+        }
+        for (auto it = score_index_vec.begin(); it != score_index_vec.end();) {
+            const NormalizedBBox& cur_bbox = bboxes[it->second];
+            if (BBoxSize(cur_bbox) < 1e-5 || JaccardOverlap(best_bbox, cur_bbox) > threshold) {
+                it = score_index_vec.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+class BBoxUtilTest : public ::testing::TestWithParam<std::tuple<int, float>> {
+protected:
+    // clustered boxes with few distinct scores, so that many candidates overlap and tie
+    static void CreateBoxes(int count, unsigned int seed, vector<NormalizedBBox>& bboxes, vector<float>& scores) {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<float> center(0.3f, 0.7f);
+        std::uniform_real_distribution<float> extent(0.f, 0.2f);
+        std::uniform_int_distribution<int> level(0, 7);
+        bboxes.resize(count);
+        scores.resize(count);
+        for (int i = 0; i < count; ++i) {
+            float x = center(generator), y = center(generator);
+            // a few boxes are empty
+            float w = i % 13 == 0 ? 0.f : extent(generator);
+            float h = extent(generator);
+            bboxes[i].set_xmin(x - w);
+            bboxes[i].set_ymin(y - h);
+            bboxes[i].set_xmax(x + w);
+            bboxes[i].set_ymax(y + h);
+            scores[i] = level(generator) * 0.125f;
+        }
+    }
+};
+
+INSTANTIATE_TEST_SUITE_P(BBoxUtilTest, BBoxUtilTest,
+                         ::testing::Combine(
+                             // top_k
+                             testing::Values(-1, 0, 1, 7, 64, 1000),
+                             // eta
+                             testing::Values(1.0f, 0.9f, 0.5f)));
+
+TEST_P(BBoxUtilTest, ApplyNMSFastMatchesReference) {
+    const int top_k = std::get<0>(GetParam());
+    const float eta = std::get<1>(GetParam());
+    for (unsigned int seed = 0; seed < 8; ++seed) {
+        vector<NormalizedBBox> bboxes;
+        vector<float> scores;
+        CreateBoxes(300, seed, bboxes, scores);
+        for (float nms_threshold : {0.3f, 0.45f, 0.7f}) {
+            vector<int> expected, result;
+            RefApplyNMSFast(bboxes, scores, 0.1f, nms_threshold, eta, top_k, &expected);
+            ApplyNMSFast(bboxes, scores, 0.1f, nms_threshold, eta, top_k, &result);
+            EXPECT_EQ(expected, result) << "seed " << seed << " nms_threshold " << nms_threshold;
+        }
+    }
+}
+
+TEST_P(BBoxUtilTest, ApplyNMSMatchesReference) {
+    const int top_k = std::get<0>(GetParam());
+    // eta only applies to ApplyNMSFast
+    if (std::get<1>(GetParam()) != 1.0f) {
+        GTEST_SKIP();
+    }
+    for (unsigned int seed = 0; seed < 8; ++seed) {
+        vector<NormalizedBBox> bboxes;
+        vector<float> scores;
+        CreateBoxes(300, seed, bboxes, scores);
+        for (float nms_threshold : {0.3f, 0.45f, 0.7f}) {
+            vector<int> expected, result;
+            RefApplyNMS(bboxes, scores, nms_threshold, top_k, &expected);
+            map<int, map<int, float>> overlaps;
+            ApplyNMS(bboxes, scores, nms_threshold, top_k, false, &overlaps, &result);
+            EXPECT_EQ(expected, result) << "seed " << seed << " nms_threshold " << nms_threshold;
+        }
+    }
+}
+
+TEST_P(BBoxUtilTest, GetMaxScoreIndexKeepsOrderOfTies) {
+    const int top_k = std::get<0>(GetParam());
+    if (std::get<1>(GetParam()) != 1.0f) {
+        GTEST_SKIP();
+    }
+    vector<NormalizedBBox> bboxes;
+    vector<float> scores;
+    CreateBoxes(300, 0, bboxes, scores);
+    // pairs already in the vector take part in the sort, they are not in index order
+    vector<pair<float, int>> expected = {{0.5f, 1000}, {0.5f, 999}, {0.25f, 1001}};
+    vector<pair<float, int>> result   = expected;
+    RefGetMaxScoreIndex(scores, 0.1f, top_k, &expected);
+    GetMaxScoreIndex(scores, 0.1f, top_k, &result);
+    EXPECT_EQ(expected, result);
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,142 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <thread>
+
+#include "test/unit_test/instance_test.h"
+#include "test/unit_test/unit_test_common.h"
+#include "tnn/utils/dims_utils.h"
+
+namespace TNN_NS {
+
+// the forward of a cpu instance is queued to its worker thread, a deadlocked one would never complete
+static const auto ASYNC_TIMEOUT = std::chrono::seconds(60);
+
+static std::shared_ptr<Mat> CopyOutputMat(Instance* instance) {
+    std::shared_ptr<Mat> instance_output;
+    if (instance->GetOutputMat(instance_output, MatConvertParam(), "", DEVICE_NAIVE, NCHW_FLOAT) != TNN_OK) {
+        return nullptr;
+    }
+    auto output = std::make_shared<Mat>(DEVICE_NAIVE, NCHW_FLOAT, instance_output->GetDims());
+    memcpy(output->GetData(), instance_output->GetData(),
+           DimsVectorUtils::Count(instance_output->GetDims()) * sizeof(float));
+    return output;
+}
+
+TEST_F(InstanceTest, ForwardAsyncRunsCallback) {
+    DimsVector dims  = {1, 8, 16, 16};
+    auto param       = CreateConvParam(8, 8, 3, 1);
+    auto interpreter = GenerateInterpreter(
+        {dims}, {CreateLayerInfo("Convolution", "conv", {"input0"}, {"output"}, param)},
+        {{"conv", CreateConvResource(param)}});
+    std::shared_ptr<Instance> instance;
+    ASSERT_EQ((int)CreateInstance(interpreter, GetDeviceConfig(), {}, instance), TNN_OK);
+    auto input = CreateRandomMat(dims);
+    std::shared_ptr<Mat> expected;
+    ASSERT_EQ((int)ForwardMat(instance.get(), input, expected), TNN_OK);
+    // clear the output of the sync forward
+    ASSERT_EQ((int)instance->SetInputMat(CreateRandomMat(dims), MatConvertParam()), TNN_OK);
+    ASSERT_EQ((int)instance->Forward(), TNN_OK);
+
+    std::promise<void> called;
+    ASSERT_EQ((int)instance->SetInputMat(input, MatConvertParam()), TNN_OK);
+    ASSERT_EQ((int)instance->ForwardAsync([&called]() { called.set_value(); }), TNN_OK);
+    ASSERT_EQ(called.get_future().wait_for(ASYNC_TIMEOUT), std::future_status::ready);
+    EXPECT_EQ(0, CompareMat(expected, CopyOutputMat(instance.get())));
+}
+
+TEST_F(InstanceTest, ForwardAsyncFutureCompletes) {
+    DimsVector dims  = {1, 8, 16, 16};
+    auto param       = CreateConvParam(8, 8, 3, 1);
+    auto interpreter = GenerateInterpreter(
+        {dims}, {CreateLayerInfo("Convolution", "conv", {"input0"}, {"output"}, param)},
+        {{"conv", CreateConvResource(param)}});
+    std::shared_ptr<Instance> instance;
+    ASSERT_EQ((int)CreateInstance(interpreter, GetDeviceConfig(), {}, instance), TNN_OK);
+    auto input = CreateRandomMat(dims);
+    std::shared_ptr<Mat> expected;
+    ASSERT_EQ((int)ForwardMat(instance.get(), input, expected), TNN_OK);
+
+    std::future<Status> future;
+    ASSERT_EQ((int)instance->SetInputMat(input, MatConvertParam()), TNN_OK);
+    ASSERT_EQ((int)instance->ForwardAsync(future), TNN_OK);
+    ASSERT_TRUE(future.valid());
+    ASSERT_EQ(future.wait_for(ASYNC_TIMEOUT), std::future_status::ready);
+    EXPECT_EQ((int)future.get(), TNN_OK);
+    EXPECT_EQ(0, CompareMat(expected, CopyOutputMat(instance.get())));
+}
+
+TEST_F(InstanceTest, ForwardWaitsForForwardAsync) {
+    if (!IsCpuDevice(ConvertDeviceType(FLAGS_dt))) {
+        GTEST_SKIP();
+    }
+    DimsVector dims  = {1, 8, 16, 16};
+    auto param       = CreateConvParam(8, 8, 3, 1);
+    auto interpreter = GenerateInterpreter(
+        {dims}, {CreateLayerInfo("Convolution", "conv", {"input0"}, {"output"}, param)},
+        {{"conv", CreateConvResource(param)}});
+    std::shared_ptr<Instance> instance;
+    ASSERT_EQ((int)CreateInstance(interpreter, GetDeviceConfig(), {}, instance), TNN_OK);
+    auto input = CreateRandomMat(dims);
+    ASSERT_EQ((int)instance->SetInputMat(input, MatConvertParam()), TNN_OK);
+
+    // the callback of the queued forward is still running when Forward is called
+    std::atomic<bool> done(false);
+    ASSERT_EQ((int)instance->ForwardAsync([&done]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        done = true;
+    }),
+              TNN_OK);
+    ASSERT_EQ((int)instance->Forward(), TNN_OK);
+    EXPECT_TRUE(done);
+}
+
+TEST_F(InstanceTest, WaitFromForwardAsyncCallback) {
+    if (!IsCpuDevice(ConvertDeviceType(FLAGS_dt))) {
+        GTEST_SKIP();
+    }
+    DimsVector dims  = {1, 8, 16, 16};
+    auto param       = CreateConvParam(8, 8, 3, 1);
+    auto interpreter = GenerateInterpreter(
+        {dims}, {CreateLayerInfo("Convolution", "conv", {"input0"}, {"output"}, param)},
+        {{"conv", CreateConvResource(param)}});
+    std::shared_ptr<Instance> instance;
+    ASSERT_EQ((int)CreateInstance(interpreter, GetDeviceConfig(), {}, instance), TNN_OK);
+    auto input = CreateRandomMat(dims);
+    std::shared_ptr<Mat> expected;
+    ASSERT_EQ((int)ForwardMat(instance.get(), input, expected), TNN_OK);
+
+    // GetOutputMat waits for the queued forwards, called on the worker thread it must return at once
+    std::shared_ptr<Mat> output;
+    std::promise<void> called;
+    Instance* raw_instance = instance.get();
+    ASSERT_EQ((int)instance->SetInputMat(input, MatConvertParam()), TNN_OK);
+    ASSERT_EQ((int)instance->ForwardAsync([&output, &called, raw_instance]() {
+        output = CopyOutputMat(raw_instance);
+        called.set_value();
+    }),
+              TNN_OK);
+    if (called.get_future().wait_for(ASYNC_TIMEOUT) != std::future_status::ready) {
+        // the deadlocked worker is never joined
+        new std::shared_ptr<Instance>(instance);
+        FAIL() << "ForwardAsync deadlocked";
+    }
+    EXPECT_EQ(0, CompareMat(expected, output));
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,179 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <cstring>
+
+#include "test/unit_test/instance_test.h"
+#include "test/unit_test/unit_test_common.h"
+#include "tnn/core/blob.h"
+#include "tnn/utils/dims_utils.h"
+
+namespace TNN_NS {
+
+static const float BLOB_SENTINEL = 1000.f;
+
+static float* GetBlobData(Blob* blob) {
+    auto handle = blob->GetHandle();
+    return reinterpret_cast<float*>(static_cast<char*>(handle.base) + handle.bytes_offset);
+}
+
+static void FillBlob(Blob* blob, float value) {
+    float* data = GetBlobData(blob);
+    int count   = DimsVectorUtils::Count(blob->GetBlobDesc().dims);
+    for (int i = 0; i < count; ++i) {
+        data[i] = value;
+    }
+}
+
+static bool BlobFilledWith(Blob* blob, float value) {
+    float* data = GetBlobData(blob);
+    int count   = DimsVectorUtils::Count(blob->GetBlobDesc().dims);
+    for (int i = 0; i < count; ++i) {
+        if (data[i] != value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::shared_ptr<Mat> CopyMat(std::shared_ptr<Mat> src, std::shared_ptr<Mat> dst) {
+    memcpy(dst->GetData(), src->GetData(), DimsVectorUtils::Count(src->GetDims()) * sizeof(float));
+    return dst;
+}
+
+TEST_F(InstanceTest, BindAlignedMatWithoutCopy) {
+    auto config = GetDeviceConfig();
+    if (!IsCpuDevice(config.device_type)) {
+        GTEST_SKIP();
+    }
+
+    DimsVector dims  = {1, 4, 8, 8};
+    auto param       = CreateConvParam(4, 4, 3, 1);
+    auto interpreter = GenerateInterpreter("Convolution", {dims}, param, CreateConvResource(param));
+    std::shared_ptr<Instance> instance;
+    ASSERT_EQ((int)CreateInstance(interpreter, config, {}, instance), TNN_OK);
+
+    auto input = CreateRandomMat(dims);
+    std::shared_ptr<Mat> expected;
+    ASSERT_EQ((int)ForwardMat(instance.get(), input, expected), TNN_OK);
+
+    BlobMap input_blobs, output_blobs;
+    instance->GetAllInputBlobs(input_blobs);
+    instance->GetAllOutputBlobs(output_blobs);
+    Blob* input_blob  = input_blobs.begin()->second;
+    Blob* output_blob = output_blobs.begin()->second;
+    if (input_blob->GetBlobDesc().data_format != DATA_FORMAT_NCHW ||
+        output_blob->GetBlobDesc().data_format != DATA_FORMAT_NCHW) {
+        // packed layouts are always converted
+        GTEST_SKIP();
+    }
+    void* input_base  = input_blob->GetHandle().base;
+    void* output_base = output_blob->GetHandle().base;
+    FillBlob(input_blob, BLOB_SENTINEL);
+    FillBlob(output_blob, BLOB_SENTINEL);
+
+    auto bound_input  = CopyMat(input, CreateRandomMat(dims));
+    auto bound_output = CreateRandomMat(expected->GetDims());
+    ASSERT_EQ((int)instance->BindInputMat(bound_input), TNN_OK);
+    ASSERT_EQ((int)instance->BindOutputMat(bound_output), TNN_OK);
+    ASSERT_EQ((int)instance->Forward(), TNN_OK);
+
+    EXPECT_EQ(0, CompareMat(expected, bound_output));
+    // the layer read and wrote the mats, the blob memory is untouched and the handles are restored
+    EXPECT_EQ(input_blob->GetHandle().base, input_base);
+    EXPECT_EQ(output_blob->GetHandle().base, output_base);
+    EXPECT_TRUE(BlobFilledWith(input_blob, BLOB_SENTINEL));
+    EXPECT_TRUE(BlobFilledWith(output_blob, BLOB_SENTINEL));
+}
+
+TEST_F(InstanceTest, BindMisalignedMatConverts) {
+    auto config = GetDeviceConfig();
+
+    DimsVector dims  = {1, 4, 8, 8};
+    auto param       = CreateConvParam(4, 4, 3, 1);
+    auto interpreter = GenerateInterpreter("Convolution", {dims}, param, CreateConvResource(param));
+    std::shared_ptr<Instance> instance;
+    ASSERT_EQ((int)CreateInstance(interpreter, config, {}, instance), TNN_OK);
+
+    auto input = CreateRandomMat(dims);
+    std::shared_ptr<Mat> expected;
+    ASSERT_EQ((int)ForwardMat(instance.get(), input, expected), TNN_OK);
+
+    BlobMap input_blobs;
+    instance->GetAllInputBlobs(input_blobs);
+    Blob* input_blob = input_blobs.begin()->second;
+    void* input_base = input_blob->GetHandle().base;
+    bool cpu_nchw    = IsCpuDevice(config.device_type) && input_blob->GetBlobDesc().data_format == DATA_FORMAT_NCHW;
+    if (cpu_nchw) {
+        FillBlob(input_blob, BLOB_SENTINEL);
+    }
+
+    // one float past the alignment
+    auto bound_input  = CopyMat(input, CreateRandomMat(dims, 1));
+    auto bound_output = CreateRandomMat(expected->GetDims(), 1);
+    ASSERT_EQ((int)instance->BindInputMat(bound_input), TNN_OK);
+    ASSERT_EQ((int)instance->BindOutputMat(bound_output), TNN_OK);
+    ASSERT_EQ((int)instance->Forward(), TNN_OK);
+
+    EXPECT_EQ(0, CompareMat(expected, bound_output));
+    EXPECT_EQ(input_blob->GetHandle().base, input_base);
+    if (cpu_nchw) {
+        // the input was converted into the blob memory
+        EXPECT_EQ(0, CompareData(static_cast<float*>(input->GetData()), GetBlobData(input_blob),
+                                 DimsVectorUtils::Count(dims), 1e-6));
+    }
+}
+
+TEST_F(InstanceTest, BindMatOnlyForNextForward) {
+    auto config = GetDeviceConfig();
+
+    DimsVector dims  = {1, 4, 8, 8};
+    auto param       = CreateConvParam(4, 4, 3, 1);
+    auto interpreter = GenerateInterpreter("Convolution", {dims}, param, CreateConvResource(param));
+    std::shared_ptr<Instance> instance;
+    ASSERT_EQ((int)CreateInstance(interpreter, config, {}, instance), TNN_OK);
+
+    auto input_a = CreateRandomMat(dims);
+    auto input_b = CreateRandomMat(dims);
+    std::shared_ptr<Mat> expected_a, expected_b;
+    ASSERT_EQ((int)ForwardMat(instance.get(), input_a, expected_a), TNN_OK);
+    ASSERT_EQ((int)ForwardMat(instance.get(), input_b, expected_b), TNN_OK);
+
+    auto bound_output = CreateRandomMat(expected_a->GetDims());
+    ASSERT_EQ((int)instance->BindInputMat(CopyMat(input_a, CreateRandomMat(dims))), TNN_OK);
+    ASSERT_EQ((int)instance->BindOutputMat(bound_output), TNN_OK);
+    ASSERT_EQ((int)instance->Forward(), TNN_OK);
+    EXPECT_EQ(0, CompareMat(expected_a, bound_output));
+
+    // the next forward reads and writes the blobs again
+    std::shared_ptr<Mat> output;
+    ASSERT_EQ((int)ForwardMat(instance.get(), input_b, output), TNN_OK);
+    EXPECT_EQ(0, CompareMat(expected_b, output));
+    EXPECT_EQ(0, CompareMat(expected_a, bound_output));
+
+    // the output can not be converted to an int32 mat, the bindings are dropped with the failed forward
+    BlobMap input_blobs;
+    instance->GetAllInputBlobs(input_blobs);
+    void* input_base = input_blobs.begin()->second->GetHandle().base;
+    auto int_output  = std::make_shared<Mat>(DEVICE_NAIVE, NC_INT32, expected_a->GetDims());
+    ASSERT_EQ((int)instance->BindInputMat(CopyMat(input_a, CreateRandomMat(dims))), TNN_OK);
+    ASSERT_EQ((int)instance->BindOutputMat(int_output), TNN_OK);
+    EXPECT_NE((int)instance->Forward(), TNN_OK);
+    EXPECT_EQ(input_blobs.begin()->second->GetHandle().base, input_base);
+
+    ASSERT_EQ((int)ForwardMat(instance.get(), input_b, output), TNN_OK);
+    EXPECT_EQ(0, CompareMat(expected_b, output));
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,109 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <cstring>
+
+#include "test/unit_test/instance_test.h"
+#include "test/unit_test/unit_test_common.h"
+#include "tnn/utils/weight_quant_utils.h"
+
+namespace TNN_NS {
+
+class InstanceCloneTest : public InstanceTest {
+protected:
+    /*
+    the clone must compute the output of the source. on x86 the weights are packed at init, so once the weights
+    of the model are zeroed a clone still gives the output of the source only if it reuses the packed weights, while
+    an instance initialized anew packs the zeroed weights.
+    */
+    static void ExpectCloneMatchesSource(std::shared_ptr<AbstractModelInterpreter> interpreter, RawBuffer& weight,
+                                         DimsVector dims) {
+        auto config = GetDeviceConfig();
+        std::shared_ptr<Instance> instance, clone;
+        ASSERT_EQ((int)CreateInstance(interpreter, config, {}, instance), TNN_OK);
+        auto input = CreateRandomMat(dims);
+        std::shared_ptr<Mat> expected, output;
+        ASSERT_EQ((int)ForwardMat(instance.get(), input, expected), TNN_OK);
+
+        ASSERT_EQ((int)instance->Clone(clone), TNN_OK);
+        ASSERT_EQ((int)ForwardMat(clone.get(), input, output), TNN_OK);
+        EXPECT_EQ(0, CompareMat(expected, output));
+        if (config.device_type != DEVICE_X86) {
+            return;
+        }
+
+        memset(weight.force_to<void*>(), 0, weight.GetBytesSize());
+        ASSERT_EQ((int)instance->Clone(clone), TNN_OK);
+        ASSERT_EQ((int)ForwardMat(clone.get(), input, output), TNN_OK);
+        EXPECT_EQ(0, CompareMat(expected, output));
+
+        std::shared_ptr<Instance> new_instance;
+        ASSERT_EQ((int)CreateInstance(interpreter, config, {}, new_instance), TNN_OK);
+        ASSERT_EQ((int)ForwardMat(new_instance.get(), input, output), TNN_OK);
+        EXPECT_NE(0, CompareMat(expected, output));
+    }
+};
+
+TEST_F(InstanceCloneTest, CloneSharesPackedWeights) {
+    DimsVector dims  = {1, 8, 16, 16};
+    auto param       = CreateConvParam(8, 8, 3, 1);
+    auto resource    = CreateConvResource(param);
+    auto interpreter = GenerateInterpreter(
+        {dims}, {CreateLayerInfo("Convolution", "conv", {"input0"}, {"output"}, param)}, {{"conv", resource}});
+
+    ExpectCloneMatchesSource(interpreter, resource->filter_handle, dims);
+}
+
+TEST_F(InstanceCloneTest, CloneFoldsOwnConstants) {
+    // the reshape target is the folded shape of the conv output
+    DimsVector dims  = {1, 8, 16, 16};
+    auto param       = CreateConvParam(8, 8, 3, 1);
+    auto resource    = CreateConvResource(param);
+    auto interpreter = GenerateInterpreter(
+        {dims},
+        {CreateLayerInfo("Convolution", "conv", {"input0"}, {"conv"}, param),
+         CreateLayerInfo("Shape", "shape", {"conv"}, {"shape"}, std::make_shared<LayerParam>()),
+         CreateLayerInfo("Reshape", "reshape", {"conv", "shape"}, {"output"}, std::make_shared<ReshapeLayerParam>())},
+        {{"conv", resource}});
+
+    ExpectCloneMatchesSource(interpreter, resource->filter_handle, dims);
+}
+
+TEST_F(InstanceCloneTest, CloneSharesWeightQuantWeights) {
+    // int4 weights in groups of 16
+    const int input_channel = 32, output_channel = 24;
+
+    auto param                     = std::make_shared<InnerProductLayerParam>();
+    param->num_output              = output_channel;
+    param->has_bias                = 1;
+    param->axis                    = 1;
+    param->weight_quant_bits       = 4;
+    param->weight_quant_group_size = 16;
+    auto resource                  = std::make_shared<InnerProductLayerResource>();
+    std::vector<float> weight(output_channel * input_channel);
+    InitRandom(weight.data(), weight.size(), 1.0f);
+    ASSERT_EQ((int)WeightQuantUtils::Quantize(weight.data(), output_channel, input_channel, 4, 16,
+                                              resource->weight_handle, resource->scale_handle),
+              TNN_OK);
+    resource->bias_handle = RawBuffer(output_channel * sizeof(float));
+    InitRandom(resource->bias_handle.force_to<float*>(), output_channel, 1.0f);
+    DimsVector dims  = {2, input_channel, 1, 1};
+    auto interpreter = GenerateInterpreter(
+        {dims}, {CreateLayerInfo("InnerProduct", "inner_product", {"input0"}, {"output"}, param)},
+        {{"inner_product", resource}});
+
+    ExpectCloneMatchesSource(interpreter, resource->weight_handle, dims);
+}
+
+}  // namespace TNN_NS
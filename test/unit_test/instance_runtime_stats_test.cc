@@ -0,0 +1,126 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <numeric>
+
+#include "test/unit_test/instance_test.h"
+#include "test/unit_test/unit_test_common.h"
+
+namespace TNN_NS {
+
+class InstanceRuntimeStatsTest : public InstanceTest {
+protected:
+    void SetUp() override {
+        if (!IsCpuDevice(ConvertDeviceType(FLAGS_dt))) {
+            GTEST_SKIP();
+        }
+        dims_            = {2, 8, 16, 16};
+        auto param       = CreateConvParam(8, 8, 3, 1);
+        auto interpreter = GenerateInterpreter(
+            {dims_},
+            {CreateLayerInfo("Convolution", "conv", {"input0"}, {"conv"}, param),
+             CreateLayerInfo("Abs", "abs", {"conv"}, {"output"}, std::make_shared<LayerParam>())},
+            {{"conv", CreateConvResource(param)}});
+        auto config                 = GetDeviceConfig();
+        config.enable_runtime_stats = true;
+        // the batch is not split while stats are collected, every layer runs once per forward
+        config.enable_batch_split = true;
+        ASSERT_EQ((int)CreateInstance(interpreter, config, {}, instance_), TNN_OK);
+        ASSERT_EQ((int)instance_->SetCpuNumThreads(2), TNN_OK);
+        ASSERT_EQ((int)instance_->SetInputMat(CreateRandomMat(dims_), MatConvertParam()), TNN_OK);
+    }
+
+    static uint64_t SumHistogram(const std::vector<uint64_t>& histogram) {
+        return std::accumulate(histogram.begin(), histogram.end(), (uint64_t)0);
+    }
+
+    // the counters of the network and of every layer saw count forwards
+    static void ExpectCount(const RuntimeStats& stats, uint64_t count) {
+        EXPECT_EQ(stats.forward_count, count);
+        EXPECT_EQ(SumHistogram(stats.forward_histogram), count);
+        double layers_time_ms = 0;
+        for (const auto& layer : stats.layers) {
+            EXPECT_EQ(layer.count, count) << layer.layer_name;
+            EXPECT_EQ(SumHistogram(layer.histogram), count) << layer.layer_name;
+            EXPECT_LE(layer.max_time_ms, layer.total_time_ms) << layer.layer_name;
+            if (count > 0) {
+                EXPECT_GT(layer.total_time_ms, 0) << layer.layer_name;
+            } else {
+                EXPECT_EQ(layer.total_time_ms, 0) << layer.layer_name;
+                EXPECT_EQ(layer.max_time_ms, 0) << layer.layer_name;
+            }
+            layers_time_ms += layer.total_time_ms;
+        }
+        EXPECT_LE(stats.max_forward_time_ms, stats.total_forward_time_ms);
+        // the forward timer encloses the layer timers
+        EXPECT_GE(stats.total_forward_time_ms, layers_time_ms);
+    }
+
+    DimsVector dims_;
+    std::shared_ptr<Instance> instance_;
+};
+
+TEST_F(InstanceRuntimeStatsTest, CountForwards) {
+    RuntimeStats stats;
+    ASSERT_EQ((int)instance_->GetRuntimeStats(stats), TNN_OK);
+    ASSERT_EQ(stats.layers.size(), 2);
+    EXPECT_EQ(stats.layers[0].layer_name, "conv");
+    EXPECT_EQ(stats.layers[0].type_name, "Convolution");
+    EXPECT_EQ(stats.layers[1].layer_name, "abs");
+    EXPECT_EQ(stats.layers[1].type_name, "Abs");
+    ExpectCount(stats, 0);
+
+    const int forward_count = 5;
+    for (int i = 0; i < forward_count; ++i) {
+        ASSERT_EQ((int)instance_->Forward(), TNN_OK);
+    }
+    ASSERT_EQ((int)instance_->GetRuntimeStats(stats), TNN_OK);
+    ASSERT_EQ(stats.layers.size(), 2);
+    ExpectCount(stats, forward_count);
+}
+
+TEST_F(InstanceRuntimeStatsTest, Reset) {
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQ((int)instance_->Forward(), TNN_OK);
+    }
+    RuntimeStats stats;
+    ASSERT_EQ((int)instance_->ResetRuntimeStats(), TNN_OK);
+    ASSERT_EQ((int)instance_->GetRuntimeStats(stats), TNN_OK);
+    ASSERT_EQ(stats.layers.size(), 2);
+    ExpectCount(stats, 0);
+    EXPECT_EQ(stats.total_forward_time_ms, 0);
+    EXPECT_EQ(stats.max_forward_time_ms, 0);
+
+    ASSERT_EQ((int)instance_->Forward(), TNN_OK);
+    ASSERT_EQ((int)instance_->GetRuntimeStats(stats), TNN_OK);
+    ExpectCount(stats, 1);
+}
+
+TEST_F(InstanceTest, RuntimeStatsNotEnabled) {
+    if (!IsCpuDevice(ConvertDeviceType(FLAGS_dt))) {
+        GTEST_SKIP();
+    }
+    DimsVector dims  = {1, 8, 16, 16};
+    auto param       = CreateConvParam(8, 8, 3, 1);
+    auto interpreter = GenerateInterpreter(
+        {dims}, {CreateLayerInfo("Convolution", "conv", {"input0"}, {"output"}, param)},
+        {{"conv", CreateConvResource(param)}});
+    std::shared_ptr<Instance> instance;
+    ASSERT_EQ((int)CreateInstance(interpreter, GetDeviceConfig(), {}, instance), TNN_OK);
+    RuntimeStats stats;
+    EXPECT_NE((int)instance->GetRuntimeStats(stats), TNN_OK);
+    EXPECT_NE((int)instance->ResetRuntimeStats(), TNN_OK);
+}
+
+}  // namespace TNN_NS
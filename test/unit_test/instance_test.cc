@@ -0,0 +1,126 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "test/unit_test/instance_test.h"
+
+#include <cstring>
+
+#include "tnn/interpreter/raw_buffer.h"
+#include "tnn/utils/dims_utils.h"
+#include "tnn/utils/random_data_utils.h"
+
+namespace TNN_NS {
+
+// blob memory alignment, mats aligned like it can be bound to blobs
+static const int MAT_ALIGNMENT = 32;
+
+NetworkConfig InstanceTest::GetDeviceConfig() {
+    NetworkConfig config;
+    config.device_type        = ConvertDeviceType(FLAGS_dt);
+    config.enable_tune_kernel = FLAGS_et;
+    config.precision          = PRECISION_HIGH;
+    if (FLAGS_lp.length() > 0) {
+        config.library_path = {FLAGS_lp};
+    }
+    return config;
+}
+
+bool InstanceTest::IsCpuDevice(DeviceType device_type) {
+    return device_type == DEVICE_NAIVE || device_type == DEVICE_X86 || device_type == DEVICE_ARM;
+}
+
+Status InstanceTest::CreateInstance(std::shared_ptr<AbstractModelInterpreter> interpreter, NetworkConfig config,
+                                    InputShapesMap inputs_shape, std::shared_ptr<Instance>& instance) {
+    ModelConfig model_config;
+    model_config.params = {"", ""};
+    instance            = std::make_shared<Instance>(config, model_config);
+    return instance->Init(interpreter, inputs_shape);
+}
+
+std::shared_ptr<Mat> InstanceTest::CreateRandomMat(DimsVector dims, int offset) {
+    int count   = DimsVectorUtils::Count(dims);
+    auto buffer = std::make_shared<RawBuffer>((count + offset) * sizeof(float), MAT_ALIGNMENT);
+    float* data = buffer->force_to<float*>() + offset;
+    InitRandom(data, count, 1.0f);
+    // the mat keeps the buffer alive
+    return std::shared_ptr<Mat>(new Mat(DEVICE_NAIVE, NCHW_FLOAT, dims, data), [buffer](Mat* mat) { delete mat; });
+}
+
+std::shared_ptr<Mat> InstanceTest::SliceMat(std::shared_ptr<Mat> mat, int axis, int begin, int end) {
+    auto dims  = mat->GetDims();
+    int outer  = DimsVectorUtils::Count(dims, 0, axis);
+    int inner  = DimsVectorUtils::Count(dims, axis + 1);
+    dims[axis] = end - begin;
+    auto slice = std::make_shared<Mat>(DEVICE_NAIVE, NCHW_FLOAT, dims);
+
+    auto src = static_cast<float*>(mat->GetData());
+    auto dst = static_cast<float*>(slice->GetData());
+    for (int o = 0; o < outer; ++o) {
+        memcpy(dst + o * (end - begin) * inner, src + (o * mat->GetDims()[axis] + begin) * inner,
+               (end - begin) * inner * sizeof(float));
+    }
+    return slice;
+}
+
+Status InstanceTest::ForwardMat(Instance* instance, std::shared_ptr<Mat> input, std::shared_ptr<Mat>& output,
+                                std::string input_name, std::string output_name) {
+    RETURN_ON_NEQ(instance->SetInputMat(input, MatConvertParam(), input_name), TNN_OK);
+    RETURN_ON_NEQ(instance->Forward(), TNN_OK);
+    // the instance reuses its output mat in the next forward, the caller gets a copy
+    std::shared_ptr<Mat> instance_output;
+    RETURN_ON_NEQ(instance->GetOutputMat(instance_output, MatConvertParam(), output_name, DEVICE_NAIVE, NCHW_FLOAT),
+                  TNN_OK);
+    output = std::make_shared<Mat>(DEVICE_NAIVE, NCHW_FLOAT, instance_output->GetDims());
+    memcpy(output->GetData(), instance_output->GetData(),
+           DimsVectorUtils::Count(instance_output->GetDims()) * sizeof(float));
+    return TNN_OK;
+}
+
+int InstanceTest::CompareMat(std::shared_ptr<Mat> ref, std::shared_ptr<Mat> result, float ep) {
+    if (!ref || !result || !DimsVectorUtils::Equal(ref->GetDims(), result->GetDims())) {
+        LOGE("mat dims not equal\n");
+        return -1;
+    }
+    return CompareData(static_cast<float*>(ref->GetData()), static_cast<float*>(result->GetData()),
+                       DimsVectorUtils::Count(ref->GetDims()), ep);
+}
+
+std::shared_ptr<ConvLayerParam> InstanceTest::CreateConvParam(int input_channel, int output_channel, int kernel,
+                                                              int pad) {
+    auto param            = std::make_shared<ConvLayerParam>();
+    param->input_channel  = input_channel;
+    param->output_channel = output_channel;
+    param->group          = 1;
+    param->kernels        = {kernel, kernel};
+    param->strides        = {1, 1};
+    param->dialations     = {1, 1};
+    param->pads           = {pad, pad, pad, pad};
+    param->bias           = 1;
+    return param;
+}
+
+std::shared_ptr<ConvLayerResource> InstanceTest::CreateConvResource(std::shared_ptr<ConvLayerParam> param) {
+    auto resource      = std::make_shared<ConvLayerResource>();
+    int weight_count   = param->output_channel * param->input_channel / param->group *
+                       DimsVectorUtils::Count(param->kernels);
+    RawBuffer filter(weight_count * sizeof(float));
+    InitRandom(filter.force_to<float*>(), weight_count, 1.0f);
+    RawBuffer bias(param->output_channel * sizeof(float));
+    InitRandom(bias.force_to<float*>(), param->output_channel, 1.0f);
+    resource->filter_handle = filter;
+    resource->bias_handle   = bias;
+    return resource;
+}
+
+}  // namespace TNN_NS
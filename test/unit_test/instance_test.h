@@ -0,0 +1,66 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef TNN_TEST_UNIT_TEST_INSTANCE_TEST_H_
+#define TNN_TEST_UNIT_TEST_INSTANCE_TEST_H_
+
+#include <gtest/gtest.h>
+
+#include "test/flags.h"
+#include "test/test_utils.h"
+#include "tnn/core/common.h"
+#include "tnn/core/instance.h"
+#include "tnn/core/macro.h"
+#include "tnn/core/mat.h"
+#include "tnn/core/status.h"
+#include "tnn/interpreter/abstract_model_interpreter.h"
+#include "tnn/interpreter/layer_param.h"
+#include "tnn/interpreter/layer_resource.h"
+
+namespace TNN_NS {
+
+// @brief tests of the instance features running whole models, the instances run on the device of FLAGS_dt
+class InstanceTest : public ::testing::Test {
+protected:
+    // network config of the device under test
+    static NetworkConfig GetDeviceConfig();
+
+    static bool IsCpuDevice(DeviceType device_type);
+
+    static Status CreateInstance(std::shared_ptr<AbstractModelInterpreter> interpreter, NetworkConfig config,
+                                 InputShapesMap inputs_shape, std::shared_ptr<Instance>& instance);
+
+    // NCHW_FLOAT mat of random values, its data starts offset floats after a 32 bytes aligned address
+    static std::shared_ptr<Mat> CreateRandomMat(DimsVector dims, int offset = 0);
+
+    // NCHW_FLOAT mat holding the batch items [begin, end) of mat
+    static std::shared_ptr<Mat> SliceMat(std::shared_ptr<Mat> mat, int axis, int begin, int end);
+
+    // set input to the input blob, forward and get the output blob as NCHW_FLOAT mat
+    static Status ForwardMat(Instance* instance, std::shared_ptr<Mat> input, std::shared_ptr<Mat>& output,
+                             std::string input_name = "", std::string output_name = "");
+
+    // 0 if the mats have the same dims and values
+    static int CompareMat(std::shared_ptr<Mat> ref, std::shared_ptr<Mat> result, float ep = 1e-4);
+
+    static std::shared_ptr<ConvLayerParam> CreateConvParam(int input_channel, int output_channel, int kernel,
+                                                           int pad);
+
+    // random weights and bias of a conv created by CreateConvParam
+    static std::shared_ptr<ConvLayerResource> CreateConvResource(std::shared_ptr<ConvLayerParam> param);
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_TEST_UNIT_TEST_INSTANCE_TEST_H_
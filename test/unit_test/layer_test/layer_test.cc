@@ -20,6 +20,7 @@
 #include "test/unit_test/unit_test_common.h"
 #include "test/unit_test/utils/network_helpers.h"
 #include "tnn/core/blob_int8.h"
+#include "tnn/core/default_network.h"
 #include "tnn/utils/bfp16.h"
 #include "tnn/utils/blob_converter.h"
 #include "tnn/utils/blob_memory_size_utils.h"
@@ -153,6 +154,19 @@ Status LayerTest::Init(std::shared_ptr<AbstractModelInterpreter> interp, Precisi
         return ret;
     }
 
+    if (compare_unoptimized_) {
+        // a network sharing no weights with the model marked as optimized skips the net optimizers
+        interpreter_unoptimized_ = interp->Copy();
+        network_unoptimized_     = std::make_shared<DefaultNetwork>();
+        network_unoptimized_->ShareWeights(nullptr, true);
+        ret = network_unoptimized_->Init(config_cpu, model_config, interpreter_unoptimized_.get(), input_shape,
+                                         input_shape, true);
+        if (ret != TNN_OK) {
+            LOGE("tnn init unoptimized network failed (%s)\n", ret.description().c_str());
+            return ret;
+        }
+    }
+
     if (nullptr == instance_ocl_cache_ && DEVICE_OPENCL == config_device.device_type) {
         instance_ocl_cache_ = std::make_shared<Instance>(config_device, model_config);
         if (nullptr == instance_ocl_cache_) {
@@ -176,6 +190,10 @@ Status LayerTest::Forward() {
 #ifndef TNN_UNIT_TEST_BENCHMARK
     ret = instance_cpu_->Forward();
     EXPECT_EQ_OR_RETURN(ret, TNN_OK);
+    if (network_unoptimized_) {
+        ret = network_unoptimized_->Forward();
+        EXPECT_EQ_OR_RETURN(ret, TNN_OK);
+    }
 #endif
 
 #if TNN_PROFILE && defined(TNN_UNIT_TEST_BENCHMARK)
@@ -235,12 +253,33 @@ Status LayerTest::Compare() {
     }
 
     EXPECT_EQ(0, cmp_result);
+
+    if (network_unoptimized_) {
+        BlobMap output_blobs_unoptimized;
+        ret = network_unoptimized_->GetAllOutputBlobs(output_blobs_unoptimized);
+        if (ret != TNN_OK)
+            return ret;
+        for (auto blob_item : output_blobs_cpu) {
+            if (output_blobs_unoptimized.count(blob_item.first) == 0) {
+                LOGE("output %s is missing in the unoptimized network\n", blob_item.first.c_str());
+                cmp_result = -1;
+                break;
+            }
+            cmp_result = CompareBlob(output_blobs_unoptimized[blob_item.first], blob_item.second, nullptr);
+            if (cmp_result != 0) {
+                break;
+            }
+        }
+        EXPECT_EQ(0, cmp_result);
+    }
     return TNN_OK;
 }
 
 Status LayerTest::DeInit() {
     instance_cpu_.reset();
     instance_device_.reset();
+    network_unoptimized_.reset();
+    interpreter_unoptimized_.reset();
 
     return TNN_OK;
 }
@@ -446,6 +485,12 @@ Status LayerTest::InitInputBlobsDataRandom() {
         if (ret != TNN_OK) {
             return ret;
         }
+        if (network_unoptimized_) {
+            ret = CopyToUnoptimizedInput(blob_item.first, blob_item.second);
+            if (ret != TNN_OK) {
+                return ret;
+            }
+        }
 
         index++;
     }
@@ -453,6 +498,31 @@ Status LayerTest::InitInputBlobsDataRandom() {
     return TNN_OK;
 }
 
+Status LayerTest::CopyToUnoptimizedInput(const std::string& name, Blob* cpu_blob) {
+    BlobMap input_blobs;
+    Status ret = network_unoptimized_->GetAllInputBlobs(input_blobs);
+    if (ret != TNN_OK)
+        return ret;
+    if (input_blobs.count(name) == 0) {
+        return Status(TNNERR_NET_ERR, "input is missing in the unoptimized network");
+    }
+
+    TNN_NS::Mat mat(DEVICE_NAIVE, NCHW_FLOAT, cpu_blob->GetBlobDesc().dims);
+    BlobConverter blob_converter_cpu(cpu_blob);
+    ret = blob_converter_cpu.ConvertToMat(mat, MatConvertParam(), nullptr);
+    if (ret != TNN_OK) {
+        LOGE("input blob_converter failed (%s)\n", ret.description().c_str());
+        return ret;
+    }
+    BlobConverter blob_converter(input_blobs[name]);
+    ret = blob_converter.ConvertFromMat(mat, MatConvertParam(), nullptr);
+    if (ret != TNN_OK) {
+        LOGE("input blob_converter failed (%s)\n", ret.description().c_str());
+        return ret;
+    }
+    return ret;
+}
+
 int LayerTest::CompareDims(DimsVector dims_a, DimsVector dims_b) {
     return dims_a == dims_b ? 0 : 1;
 }
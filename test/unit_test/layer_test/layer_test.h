@@ -36,6 +36,8 @@
 
 namespace TNN_NS {
 
+class DefaultNetwork;
+
 class LayerTest : public ::testing::Test {
 protected:
     static void SetUpTestCase();
@@ -54,6 +56,8 @@ private:
 
 protected:
     int ensure_input_positive_ = 0;
+    // also run the model on naive without the net optimizers, the outputs of the cpu instance must match it
+    int compare_unoptimized_ = 0;
 
     static std::shared_ptr<Instance> instance_cpu_;
     static std::shared_ptr<Instance> instance_device_;
@@ -65,6 +69,11 @@ private:
     int CompareDims(DimsVector dims_a, DimsVector dims_b);
 
     Status InitInputBlobsDataRandom();
+    // copy the input of the cpu instance to the network without optimizers
+    Status CopyToUnoptimizedInput(const std::string& name, Blob* cpu_blob);
+
+    std::shared_ptr<AbstractModelInterpreter> interpreter_unoptimized_ = nullptr;
+    std::shared_ptr<DefaultNetwork> network_unoptimized_               = nullptr;
 };
 
 }  // namespace TNN_NS
@@ -65,7 +65,10 @@ TEST_P(Conv3DLayerTest, Conv3DLayer) {
     int activation_type   = std::get<10>(GetParam());
     DeviceType dev        = ConvertDeviceType(FLAGS_dt);
 
-    if (DEVICE_NAIVE != dev) {
+    if (DEVICE_NAIVE != dev && DEVICE_X86 != dev) {
+        GTEST_SKIP();
+    }
+    if (DEVICE_X86 == dev && (dtype != DATA_TYPE_FLOAT || activation_type == ActivationType_SIGMOID_MUL)) {
         GTEST_SKIP();
     }
 
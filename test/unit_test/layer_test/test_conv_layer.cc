@@ -101,4 +101,58 @@ TEST_P(ConvLayerTest, ConvLayer) {
     Run(interpreter, precision);
 }
 
+/*
+3x3 convs of the x86 winograd and stride 2 kernels. the output size picks the winograd output tile, F(4, 3) for 8x8
+and 16x16, F(6, 3) for 12x12 and 24x24, see X86ConvLayer3x3::SelectDstUnit
+*/
+class Conv3x3LayerTest : public LayerTest,
+                         public ::testing::WithParamInterface<std::tuple<int, int, int, int, int, int, ActivationType>> {
+};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, Conv3x3LayerTest,
+                         ::testing::Combine(  // batch
+                             testing::Values(1, 2),
+                             // channel per group
+                             testing::Values(8, 16),
+                             // group
+                             testing::Values(1, 2, 4),
+                             // output size
+                             testing::Values(8, 12, 16, 24),
+                             // stride
+                             testing::Values(1, 2),
+                             // pads
+                             testing::Values(0, 1),
+                             // activation_type
+                             testing::Values(ActivationType_None, ActivationType_ReLU)));
+
+TEST_P(Conv3x3LayerTest, ConvLayer) {
+    int batch             = std::get<0>(GetParam());
+    int channel_per_group = std::get<1>(GetParam());
+    int group             = std::get<2>(GetParam());
+    int channel           = group * channel_per_group;
+    int output_size       = std::get<3>(GetParam());
+    int stride            = std::get<4>(GetParam());
+    int pad               = std::get<5>(GetParam());
+    int activation_type   = std::get<6>(GetParam());
+    DeviceType dev        = ConvertDeviceType(FLAGS_dt);
+
+    std::shared_ptr<ConvLayerParam> param(new ConvLayerParam());
+    param->name            = "Conv";
+    param->input_channel   = channel;
+    param->output_channel  = channel;
+    param->group           = group;
+    param->kernels         = {3, 3};
+    param->dialations      = {1, 1};
+    param->strides         = {stride, stride};
+    param->pads            = {pad, pad, pad, pad};
+    param->bias            = 1;
+    param->activation_type = activation_type;
+
+    int input_size              = (output_size - 1) * stride + 3 - 2 * pad;
+    Precision precision         = SetPrecision(dev, DATA_TYPE_FLOAT);
+    std::vector<int> input_dims = {batch, channel, input_size, input_size};
+    auto interpreter            = GenerateInterpreter("Convolution", {input_dims}, param);
+    Run(interpreter, precision);
+}
+
 }  // namespace TNN_NS
@@ -0,0 +1,82 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "test/unit_test/layer_test/layer_test.h"
+#include "test/unit_test/unit_test_common.h"
+#include "test/unit_test/utils/network_helpers.h"
+#include "tnn/utils/dims_utils.h"
+
+namespace TNN_NS {
+
+class ConvSparseLayerTest : public LayerTest,
+                            public ::testing::WithParamInterface<std::tuple<int, int, int, int, int, ActivationType>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, ConvSparseLayerTest,
+                         ::testing::Combine(  // batch
+                             testing::Values(1, 2),
+                             // input channel
+                             testing::Values(8, 32),
+                             // output channel
+                             testing::Values(5, 16, 40),
+                             // hw
+                             testing::Values(3, 10, 16),
+                             // percent of nonzero blocks of 8 output channels
+                             testing::Values(0, 10, 30),
+                             // activation_type
+                             testing::Values(ActivationType_None, ActivationType_ReLU, ActivationType_ReLU6)));
+
+TEST_P(ConvSparseLayerTest, ConvLayer) {
+    // get param
+    int batch           = std::get<0>(GetParam());
+    int input_channel   = std::get<1>(GetParam());
+    int output_channel  = std::get<2>(GetParam());
+    int input_size      = std::get<3>(GetParam());
+    int density         = std::get<4>(GetParam());
+    int activation_type = std::get<5>(GetParam());
+
+    // param
+    std::shared_ptr<ConvLayerParam> param(new ConvLayerParam());
+    param->name            = "Conv";
+    param->input_channel   = input_channel;
+    param->output_channel  = output_channel;
+    param->group           = 1;
+    param->kernels         = {1, 1};
+    param->dialations      = {1, 1};
+    param->strides         = {1, 1};
+    param->pads            = {0, 0, 0, 0};
+    param->bias            = 1;
+    param->activation_type = activation_type;
+
+    // resource, pruned weights keep a few blocks of 8 output channels x 1 input
+    std::shared_ptr<ConvLayerResource> resource(new ConvLayerResource());
+    resource->filter_handle = RawBuffer(output_channel * input_channel * sizeof(float));
+    float *weight           = resource->filter_handle.force_to<float *>();
+    InitRandom(weight, output_channel * input_channel, 1.0f);
+    for (int o = 0; o < output_channel; o++) {
+        for (int c = 0; c < input_channel; c++) {
+            if ((o / 8 * 31 + c * 17) % 100 >= density) {
+                weight[o * input_channel + c] = 0.f;
+            }
+        }
+    }
+    resource->bias_handle = RawBuffer(output_channel * sizeof(float));
+    InitRandom(resource->bias_handle.force_to<float *>(), output_channel, 1.0f);
+
+    // generate interpreter
+    std::vector<int> input_dims = {batch, input_channel, input_size, input_size};
+    auto interpreter            = GenerateInterpreter("Convolution", {input_dims}, param, resource);
+    Run(interpreter);
+}
+
+}  // namespace TNN_NS
@@ -52,6 +52,31 @@ INSTANTIATE_TEST_SUITE_P(LayerTest, DeconvLayerTest,
                                             testing::Values(ActivationType_None, ActivationType_ReLU,
                                                             ActivationType_ReLU6, ActivationType_SIGMOID_MUL)));
 
+// strides other than 2, depthwise and larger kernels split into stride 1 convs per output phase
+INSTANTIATE_TEST_SUITE_P(LayerTestStride, DeconvLayerTest,
+                         ::testing::Combine(testing::Values(1), testing::Values(1, 3),
+                                            testing::Values(1, 4),
+                                            // input_size
+                                            testing::Values(3, 8),
+                                            // group
+                                            testing::Values(1, 4),
+                                            // kernel
+                                            testing::Values(1, 2, 3, 4, 6),
+                                            // dilation
+                                            testing::Values(1),
+                                            // stride
+                                            testing::Values(1, 3),
+                                            // pads
+                                            testing::Values(0, 1, 2),
+                                            // output_pads
+                                            testing::Values(0),
+                                            // pad type
+                                            testing::Values(-1),
+                                            // data_type
+                                            testing::Values(DATA_TYPE_FLOAT),
+                                            // activation_type
+                                            testing::Values(ActivationType_None, ActivationType_ReLU)));
+
 TEST_P(DeconvLayerTest, DeconvLayer) {
     // get param
     int batch                    = std::get<0>(GetParam());
@@ -0,0 +1,164 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "test/unit_test/layer_test/layer_test.h"
+#include "test/unit_test/unit_test_common.h"
+#include "test/unit_test/utils/network_helpers.h"
+#include "tnn/interpreter/default_model_interpreter.h"
+#include "tnn/optimizer/net_optimizer_manager.h"
+#include "tnn/utils/cpu_utils.h"
+#include "tnn/utils/dims_utils.h"
+
+namespace TNN_NS {
+
+class FusedDwPwConvLayerTest
+    : public LayerTest,
+      public ::testing::WithParamInterface<std::tuple<int, int, int, int, int, int, int, int, ActivationType>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, FusedDwPwConvLayerTest,
+                         ::testing::Combine(  // batch
+                             testing::Values(1, 2),
+                             // channel
+                             testing::Values(3, 8, 20),
+                             // output channel
+                             testing::Values(8, 17),
+                             // hw
+                             testing::Values(9, 16),
+                             // kernel
+                             testing::Values(3, 5),
+                             // dilation
+                             testing::Values(1, 2),
+                             // stride
+                             testing::Values(1, 2),
+                             // pads
+                             testing::Values(0, 1),
+                             // activation_type
+                             testing::Values(ActivationType_None, ActivationType_ReLU, ActivationType_ReLU6)));
+
+TEST_P(FusedDwPwConvLayerTest, FusedDwPwConvLayer) {
+    // get param
+    int batch           = std::get<0>(GetParam());
+    int channel         = std::get<1>(GetParam());
+    int output_channel  = std::get<2>(GetParam());
+    int input_size      = std::get<3>(GetParam());
+    int kernel          = std::get<4>(GetParam());
+    int dilation        = std::get<5>(GetParam());
+    int stride          = std::get<6>(GetParam());
+    int pad             = std::get<7>(GetParam());
+    int activation_type = std::get<8>(GetParam());
+    DeviceType dev      = ConvertDeviceType(FLAGS_dt);
+
+    // only the x86 device implements the fused layer
+    if (DEVICE_X86 != dev) {
+        GTEST_SKIP();
+    }
+
+    if ((kernel - 1) * dilation + 1 > input_size + 2 * pad) {
+        GTEST_SKIP();
+    }
+
+    // param
+    std::shared_ptr<ConvLayerParam> dw_param(new ConvLayerParam());
+    dw_param->name            = "DwConv";
+    dw_param->input_channel   = 1;
+    dw_param->output_channel  = channel;
+    dw_param->group           = channel;
+    dw_param->kernels         = {kernel, kernel};
+    dw_param->dialations      = {dilation, dilation};
+    dw_param->strides         = {stride, stride};
+    dw_param->pads            = {pad, pad, pad, pad};
+    dw_param->bias            = 1;
+    dw_param->activation_type = activation_type;
+
+    std::shared_ptr<ConvLayerParam> pw_param(new ConvLayerParam());
+    pw_param->name            = "PwConv";
+    pw_param->input_channel   = channel;
+    pw_param->output_channel  = output_channel;
+    pw_param->group           = 1;
+    pw_param->kernels         = {1, 1};
+    pw_param->dialations      = {1, 1};
+    pw_param->strides         = {1, 1};
+    pw_param->pads            = {0, 0, 0, 0};
+    pw_param->bias            = 1;
+    pw_param->activation_type = activation_type;
+
+    std::shared_ptr<FusedDwPwConvLayerParam> param(new FusedDwPwConvLayerParam());
+    param->name     = "FusedDwPwConv";
+    param->dw_param = dw_param;
+    param->pw_param = pw_param;
+
+    // generate interpreter
+    std::vector<int> input_dims = {batch, channel, input_size, input_size};
+    auto interpreter            = GenerateInterpreter("FusedDwPwConvolution", {input_dims}, param);
+    Run(interpreter);
+}
+
+static std::shared_ptr<ConvLayerParam> CreateFuseConvParam(int input_channel, int output_channel, int group,
+                                                          int kernel, int activation_type) {
+    auto param             = std::make_shared<ConvLayerParam>();
+    param->input_channel   = input_channel;
+    param->output_channel  = output_channel;
+    param->group           = group;
+    param->kernels         = {kernel, kernel};
+    param->dialations      = {1, 1};
+    param->strides         = {1, 1};
+    param->pads            = {kernel / 2, kernel / 2, kernel / 2, kernel / 2};
+    param->bias            = 1;
+    param->activation_type = activation_type;
+    return param;
+}
+
+static std::shared_ptr<ConvLayerResource> CreateFuseConvResource(int filter_count, int output_channel) {
+    auto resource = std::make_shared<ConvLayerResource>();
+    RawBuffer filter(filter_count * sizeof(float));
+    InitRandom(filter.force_to<float*>(), filter_count, 1.0f);
+    RawBuffer bias(output_channel * sizeof(float));
+    InitRandom(bias.force_to<float*>(), output_channel, 1.0f);
+    resource->filter_handle = filter;
+    resource->bias_handle   = bias;
+    return resource;
+}
+
+// number of fused layers after the x86 net optimizers run on a dw conv followed by a pw conv
+static int CountFusedDwPwLayers(int pw_activation_type) {
+    const int channel = 8, output_channel = 16;
+    auto dw_param     = CreateFuseConvParam(1, channel, channel, 3, ActivationType_ReLU);
+    auto pw_param     = CreateFuseConvParam(channel, output_channel, 1, 1, pw_activation_type);
+    auto interpreter  = GenerateInterpreter(
+        {{1, channel, 16, 16}},
+        {CreateLayerInfo("Convolution", "dw", {"input0"}, {"dw"}, dw_param),
+         CreateLayerInfo("Convolution", "pw", {"dw"}, {"output"}, pw_param)},
+        {{"dw", CreateFuseConvResource(channel * 9, channel)},
+         {"pw", CreateFuseConvResource(output_channel * channel, output_channel)}});
+
+    auto default_interpreter = dynamic_cast<DefaultModelInterpreter*>(interpreter.get());
+    auto structure           = default_interpreter->GetNetStructure();
+    NetworkConfig config;
+    config.device_type = DEVICE_X86;
+    EXPECT_EQ((int)optimizer::NetOptimizerManager::Optimize(structure, default_interpreter->GetNetResource(), config),
+              TNN_OK);
+    int count = 0;
+    for (auto layer : structure->layers) {
+        count += layer->type == LAYER_FUSED_DW_PW_CONVOLUTION ? 1 : 0;
+    }
+    return count;
+}
+
+TEST(FuseDwPwOptimizerTest, PwActivation) {
+    EXPECT_EQ(CountFusedDwPwLayers(ActivationType_ReLU6), 1);
+    // the activation of the 1x1 conv would be dropped by the fused acc
+    EXPECT_EQ(CountFusedDwPwLayers(ActivationType_SIGMOID_MUL), 0);
+}
+
+}  // namespace TNN_NS
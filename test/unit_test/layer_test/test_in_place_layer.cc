@@ -0,0 +1,98 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "test/unit_test/layer_test/layer_test.h"
+#include "test/unit_test/unit_test_common.h"
+
+namespace TNN_NS {
+
+static bool TestFilter(DeviceType device_type) {
+    return device_type == DEVICE_NAIVE || device_type == DEVICE_X86;
+}
+
+/*
+models whose layers write the output into the memory of their first input, the blob manager only does so when the
+layer is the last user of the input, which is never a model input, so every model starts with an abs layer
+*/
+class InPlaceLayerTest : public LayerTest,
+                         public ::testing::WithParamInterface<std::tuple<int, int, int, std::string>> {
+protected:
+    static std::shared_ptr<LayerInfo> CreateUnary(std::string type, std::string input, std::string output) {
+        return CreateLayerInfo(type, output, {input}, {output}, std::make_shared<LayerParam>());
+    }
+
+    static std::shared_ptr<LayerInfo> CreateBinary(std::string type, std::vector<std::string> inputs,
+                                                   std::string output) {
+        return CreateLayerInfo(type, output, inputs, {output}, std::make_shared<MultidirBroadcastLayerParam>());
+    }
+};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, InPlaceLayerTest,
+                         ::testing::Combine(testing::Values(1, 2),    // batch
+                                            testing::Values(4, 9),    // channel
+                                            testing::Values(6, 13),   // input size
+                                            testing::Values("Add", "Mul")));
+
+TEST_P(InPlaceLayerTest, SharedInputNotOverwritten) {
+    int batch        = std::get<0>(GetParam());
+    int channel      = std::get<1>(GetParam());
+    int input_size   = std::get<2>(GetParam());
+    std::string type = std::get<3>(GetParam());
+    if (!TestFilter(ConvertDeviceType(FLAGS_dt))) {
+        GTEST_SKIP();
+    }
+
+    // relu is not the last user of abs, only sigmoid and the binary op run in place
+    auto interpreter = GenerateInterpreter({{batch, channel, input_size, input_size}},
+                                           {CreateUnary("Abs", "input0", "abs"), CreateUnary("ReLU", "abs", "relu"),
+                                            CreateUnary("Sigmoid", "abs", "sigmoid"),
+                                            CreateBinary(type, {"relu", "sigmoid"}, "output")});
+    Run(interpreter);
+}
+
+TEST_P(InPlaceLayerTest, ThreeInputs) {
+    int batch        = std::get<0>(GetParam());
+    int channel      = std::get<1>(GetParam());
+    int input_size   = std::get<2>(GetParam());
+    std::string type = std::get<3>(GetParam());
+    if (!TestFilter(ConvertDeviceType(FLAGS_dt))) {
+        GTEST_SKIP();
+    }
+
+    // the third input is the memory of the output, it is read after the first two are applied
+    auto interpreter = GenerateInterpreter(
+        {{batch, channel, input_size, input_size}, {1, channel, 1, 1}},
+        {CreateUnary("Abs", "input0", "abs"), CreateBinary(type, {"abs", "input1", "abs"}, "output")});
+    Run(interpreter);
+}
+
+TEST_P(InPlaceLayerTest, GeneralBroadcast) {
+    int batch        = std::get<0>(GetParam());
+    int channel      = std::get<1>(GetParam());
+    int input_size   = std::get<2>(GetParam());
+    std::string type = std::get<3>(GetParam());
+    if (!TestFilter(ConvertDeviceType(FLAGS_dt))) {
+        GTEST_SKIP();
+    }
+
+    // a [1, 1, h, 1] input takes the general broadcast, which writes the first input to the output before it reads
+    // the others, the second input of the first op and the third input of the second op alias the output
+    auto interpreter =
+        GenerateInterpreter({{batch, channel, input_size, input_size}, {1, 1, input_size, 1}},
+                            {CreateUnary("Abs", "input0", "abs"), CreateBinary(type, {"abs", "abs", "input1"}, "op0"),
+                             CreateBinary(type, {"op0", "input1", "op0"}, "output")});
+    Run(interpreter);
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,71 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "test/unit_test/layer_test/layer_test.h"
+#include "test/unit_test/unit_test_common.h"
+#include "test/unit_test/utils/network_helpers.h"
+#include "tnn/utils/dims_utils.h"
+#include "tnn/utils/weight_quant_utils.h"
+
+namespace TNN_NS {
+
+class InnerProductWeightQuantLayerTest : public LayerTest,
+                                         public ::testing::WithParamInterface<std::tuple<int, int, int, int, int, int>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, InnerProductWeightQuantLayerTest,
+                         ::testing::Combine(testing::Values(1, 2, 5), testing::Values(3, 16),
+                                            testing::Values(1, 5),
+                                            // output channel
+                                            testing::Values(4, 21, 50),
+                                            // weight bits
+                                            testing::Values(8, 4),
+                                            // group size
+                                            testing::Values(0, 7, 16)));
+
+TEST_P(InnerProductWeightQuantLayerTest, InnerProductLayer) {
+    // get param
+    int batch          = std::get<0>(GetParam());
+    int input_channel  = std::get<1>(GetParam());
+    int input_size     = std::get<2>(GetParam());
+    int output_channel = std::get<3>(GetParam());
+    int bits           = std::get<4>(GetParam());
+    int group_size     = std::get<5>(GetParam());
+
+    // param
+    std::shared_ptr<InnerProductLayerParam> param(new InnerProductLayerParam());
+    param->name                    = "InnerProduct";
+    param->num_output              = output_channel;
+    param->has_bias                = 1;
+    param->axis                    = 1;
+    param->weight_quant_bits       = bits;
+    param->weight_quant_group_size = group_size;
+
+    // resource
+    int input_count = input_channel * input_size * input_size;
+    std::shared_ptr<InnerProductLayerResource> resource(new InnerProductLayerResource());
+    std::vector<float> weight(output_channel * input_count);
+    InitRandom(weight.data(), weight.size(), 1.0f);
+    Status ret = WeightQuantUtils::Quantize(weight.data(), output_channel, input_count, bits, group_size,
+                                            resource->weight_handle, resource->scale_handle);
+    ASSERT_EQ((int)ret, TNN_OK);
+    resource->bias_handle = RawBuffer(output_channel * sizeof(float));
+    InitRandom(resource->bias_handle.force_to<float *>(), output_channel, 1.0f);
+
+    // generate interpreter
+    std::vector<int> input_dims = {batch, input_channel, input_size, input_size};
+    auto interpreter            = GenerateInterpreter("InnerProduct", {input_dims}, param, resource);
+    Run(interpreter);
+}
+
+}  // namespace TNN_NS
@@ -16,6 +16,7 @@
 #include "test/unit_test/unit_test_common.h"
 #include "test/unit_test/utils/network_helpers.h"
 #include "tnn/utils/dims_utils.h"
+#include "tnn/utils/weight_quant_utils.h"
 
 namespace TNN_NS {
 
@@ -118,4 +119,50 @@ TEST_P(MatMulLayerTest, MatMulLayer) {
     Run(interpreter);
 }
 
+class MatMulWeightQuantLayerTest : public LayerTest,
+                                   public ::testing::WithParamInterface<std::tuple<std::vector<int>, int, int, int>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, MatMulWeightQuantLayerTest,
+                         ::testing::Combine(::testing::Values(std::vector<int>({8, 16}), std::vector<int>({1, 3, 16}),
+                                                              std::vector<int>({2, 3, 5, 16})),
+                                            // output cols
+                                            ::testing::Values(9, 32),
+                                            // weight bits
+                                            ::testing::Values(8, 4),
+                                            // group size
+                                            ::testing::Values(0, 5)));
+
+TEST_P(MatMulWeightQuantLayerTest, MatMulLayer) {
+    // get param
+    std::vector<int> input_dim = std::get<0>(GetParam());
+    int output_cols            = std::get<1>(GetParam());
+    int bits                   = std::get<2>(GetParam());
+    int group_size             = std::get<3>(GetParam());
+
+    DeviceType dev = ConvertDeviceType(FLAGS_dt);
+
+    if (DEVICE_HUAWEI_NPU == dev) {
+        GTEST_SKIP();
+    }
+
+    std::shared_ptr<MatMulLayerParam> param(new MatMulLayerParam());
+    param->name                    = "MatMul";
+    param->weight_position         = 1;
+    param->weight_quant_bits       = bits;
+    param->weight_quant_group_size = group_size;
+
+    // the quantized weight is stored transposed, one row per output col
+    int k = input_dim.back();
+    std::vector<float> weight(output_cols * k);
+    InitRandom(weight.data(), weight.size(), 1.0f);
+    auto resource = std::shared_ptr<MatMulLayerResource>(new MatMulLayerResource());
+    Status ret = WeightQuantUtils::Quantize(weight.data(), output_cols, k, bits, group_size, resource->weight,
+                                            resource->scale_handle);
+    ASSERT_EQ((int)ret, TNN_OK);
+    resource->weight.SetBufferDims({k, output_cols});
+
+    auto interpreter = GenerateInterpreter("MatMul", {input_dim}, param, resource);
+    Run(interpreter);
+}
+
 }  // namespace TNN_NS
@@ -0,0 +1,214 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "test/unit_test/layer_test/layer_test.h"
+#include "test/unit_test/unit_test_common.h"
+#include "tnn/interpreter/default_model_interpreter.h"
+#include "tnn/optimizer/net_optimizer_manager.h"
+#include "tnn/utils/dims_utils.h"
+#include "tnn/utils/half_utils.h"
+
+namespace TNN_NS {
+
+static bool TestFilter(DeviceType device_type) {
+    return device_type == DEVICE_NAIVE || device_type == DEVICE_X86;
+}
+
+// a copy of the model after the net optimizers of naive
+static std::shared_ptr<AbstractModelInterpreter> OptimizeCopy(std::shared_ptr<AbstractModelInterpreter> interpreter) {
+    auto copy                = interpreter->Copy();
+    auto default_interpreter = dynamic_cast<DefaultModelInterpreter*>(copy.get());
+    NetworkConfig config;
+    config.device_type = DEVICE_NAIVE;
+    EXPECT_EQ((int)optimizer::NetOptimizerManager::Optimize(default_interpreter->GetNetStructure(),
+                                                            default_interpreter->GetNetResource(), config),
+              TNN_OK);
+    return copy;
+}
+
+// layers of type left in a copy of the model after the net optimizers of naive
+static int CountOptimizedLayers(std::shared_ptr<AbstractModelInterpreter> interpreter, LayerType type) {
+    auto copy      = OptimizeCopy(interpreter);
+    auto structure = dynamic_cast<DefaultModelInterpreter*>(copy.get())->GetNetStructure();
+    int count      = 0;
+    for (auto layer : structure->layers) {
+        count += layer->type == type ? 1 : 0;
+    }
+    return count;
+}
+
+static RawBuffer CreateRandomBuffer(int count, DataType data_type) {
+    RawBuffer buffer(count * sizeof(float));
+    InitRandom(buffer.force_to<float*>(), count, 1.0f);
+    if (data_type != DATA_TYPE_HALF) {
+        return buffer;
+    }
+    RawBuffer half_buffer(count * sizeof(uint16_t));
+    ConvertFromFloatToHalf(buffer.force_to<float*>(), half_buffer.force_to<void*>(), count);
+    half_buffer.SetDataType(DATA_TYPE_HALF);
+    return half_buffer;
+}
+
+/*
+the optimized model runs on the cpu instance, its outputs are compared with the model run without the optimizers
+*/
+class NetOptimizerLayerTest : public LayerTest,
+                              public ::testing::WithParamInterface<std::tuple<int, int, DataType>> {
+public:
+    NetOptimizerLayerTest() {
+        compare_unoptimized_ = 1;
+    }
+};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, NetOptimizerLayerTest,
+                         ::testing::Combine(testing::Values(1, 2),   // batch
+                                            testing::Values(3, 8),   // channel
+                                            // data type of the conv weights
+                                            testing::Values(DATA_TYPE_FLOAT, DATA_TYPE_HALF)));
+
+TEST_P(NetOptimizerLayerTest, FuseConvBatchNormScale) {
+    int batch          = std::get<0>(GetParam());
+    int channel        = std::get<1>(GetParam());
+    DataType data_type = std::get<2>(GetParam());
+    if (!TestFilter(ConvertDeviceType(FLAGS_dt))) {
+        GTEST_SKIP();
+    }
+
+    const int output_channel     = channel * 2;
+    auto conv_param              = std::make_shared<ConvLayerParam>();
+    conv_param->input_channel    = channel;
+    conv_param->output_channel   = output_channel;
+    conv_param->group            = 1;
+    conv_param->kernels          = {3, 3};
+    conv_param->strides          = {1, 1};
+    conv_param->dialations       = {1, 1};
+    conv_param->pads             = {1, 1, 1, 1};
+    conv_param->bias             = 1;
+    auto conv_resource           = std::make_shared<ConvLayerResource>();
+    conv_resource->filter_handle = CreateRandomBuffer(output_channel * channel * 9, data_type);
+    conv_resource->bias_handle   = CreateRandomBuffer(output_channel, data_type);
+
+    auto bn_param                = std::make_shared<BatchNormLayerParam>();
+    bn_param->channels           = output_channel;
+    auto bn_resource             = std::make_shared<BatchNormLayerResource>();
+    bn_resource->scale_handle    = CreateRandomBuffer(output_channel, DATA_TYPE_FLOAT);
+    bn_resource->bias_handle     = CreateRandomBuffer(output_channel, DATA_TYPE_FLOAT);
+    auto scale_param             = std::make_shared<ScaleLayerParam>();
+    scale_param->bias_term       = 1;
+    auto scale_resource          = std::make_shared<BatchNormLayerResource>();
+    scale_resource->scale_handle = CreateRandomBuffer(output_channel, DATA_TYPE_FLOAT);
+    scale_resource->bias_handle  = CreateRandomBuffer(output_channel, DATA_TYPE_FLOAT);
+
+    // the scale after the bn is folded into the conv the bn was folded into
+    auto interpreter = GenerateInterpreter(
+        {{batch, channel, 9, 9}},
+        {CreateLayerInfo("Convolution", "conv", {"input0"}, {"conv"}, conv_param),
+         CreateLayerInfo("BatchNormCxx", "bn", {"conv"}, {"bn"}, bn_param),
+         CreateLayerInfo("Scale", "scale", {"bn"}, {"output"}, scale_param)},
+        {{"conv", conv_resource}, {"bn", bn_resource}, {"scale", scale_resource}});
+    EXPECT_EQ(CountOptimizedLayers(interpreter, LAYER_BATCH_NORM), 0);
+    EXPECT_EQ(CountOptimizedLayers(interpreter, LAYER_SCALE), 0);
+
+    Run(interpreter);
+}
+
+TEST_P(NetOptimizerLayerTest, ComposePermutes) {
+    int batch          = std::get<0>(GetParam());
+    int channel        = std::get<1>(GetParam());
+    DataType data_type = std::get<2>(GetParam());
+    if (!TestFilter(ConvertDeviceType(FLAGS_dt)) || data_type != DATA_TYPE_FLOAT) {
+        GTEST_SKIP();
+    }
+
+    auto CreatePermute = [](std::string name, std::string input, std::vector<int> orders) {
+        auto param    = std::make_shared<PermuteLayerParam>();
+        param->orders = orders;
+        return CreateLayerInfo("Permute", name, {input}, {name}, param);
+    };
+    auto CreateAbs = [](std::string name, std::string input) {
+        return CreateLayerInfo("Abs", name, {input}, {name}, std::make_shared<LayerParam>());
+    };
+
+    // three permutes compose into one
+    DimsVector dims  = {batch, channel, 5, 7};
+    auto interpreter = GenerateInterpreter(
+        {dims}, {CreateAbs("abs", "input0"), CreatePermute("permute0", "abs", {0, 2, 3, 1}),
+                 CreatePermute("permute1", "permute0", {0, 2, 1, 3}), CreatePermute("output", "permute1", {1, 0, 3, 2})});
+    EXPECT_EQ(CountOptimizedLayers(interpreter, LAYER_PERMUTE), 1);
+    Run(interpreter);
+
+    // a permute and its inverse cancel, the abs after them reads the input of the first
+    interpreter = GenerateInterpreter(
+        {dims}, {CreateAbs("abs", "input0"), CreatePermute("permute0", "abs", {0, 2, 3, 1}),
+                 CreatePermute("permute1", "permute0", {0, 3, 1, 2}), CreateAbs("output", "permute1")});
+    EXPECT_EQ(CountOptimizedLayers(interpreter, LAYER_PERMUTE), 0);
+    Run(interpreter);
+}
+
+TEST_P(NetOptimizerLayerTest, CancelSqueezeUnsqueeze) {
+    int batch          = std::get<0>(GetParam());
+    int channel        = std::get<1>(GetParam());
+    DataType data_type = std::get<2>(GetParam());
+    if (!TestFilter(ConvertDeviceType(FLAGS_dt)) || data_type != DATA_TYPE_FLOAT) {
+        GTEST_SKIP();
+    }
+
+    auto unsqueeze_param  = std::make_shared<UnsqueezeLayerParam>();
+    unsqueeze_param->axes = {2};
+    auto squeeze_param    = std::make_shared<SqueezeLayerParam>();
+    squeeze_param->axes   = {2};
+    auto interpreter      = GenerateInterpreter(
+        {{batch, channel, 5, 7}},
+        {CreateLayerInfo("Abs", "abs", {"input0"}, {"abs"}, std::make_shared<LayerParam>()),
+         CreateLayerInfo("Unsqueeze", "unsqueeze", {"abs"}, {"unsqueeze"}, unsqueeze_param),
+         CreateLayerInfo("Squeeze", "squeeze", {"unsqueeze"}, {"squeeze"}, squeeze_param),
+         CreateLayerInfo("ReLU", "output", {"squeeze"}, {"output"}, std::make_shared<LayerParam>())});
+    EXPECT_EQ(CountOptimizedLayers(interpreter, LAYER_SQUEEZE), 0);
+    EXPECT_EQ(CountOptimizedLayers(interpreter, LAYER_UNSQUEEZE), 0);
+
+    Run(interpreter);
+}
+
+TEST_P(NetOptimizerLayerTest, EliminateCommonLayers) {
+    int batch          = std::get<0>(GetParam());
+    int channel        = std::get<1>(GetParam());
+    DataType data_type = std::get<2>(GetParam());
+    if (!TestFilter(ConvertDeviceType(FLAGS_dt)) || data_type != DATA_TYPE_FLOAT) {
+        GTEST_SKIP();
+    }
+
+    // the second abs and the second relu are duplicates, the add reads the outputs of the first ones twice
+    auto interpreter = GenerateInterpreter(
+        {{batch, channel, 5, 7}},
+        {CreateLayerInfo("Abs", "abs0", {"input0"}, {"abs0"}, std::make_shared<LayerParam>()),
+         CreateLayerInfo("Abs", "abs1", {"input0"}, {"abs1"}, std::make_shared<LayerParam>()),
+         CreateLayerInfo("ReLU", "relu0", {"abs0"}, {"relu0"}, std::make_shared<LayerParam>()),
+         CreateLayerInfo("ReLU", "relu1", {"abs1"}, {"relu1"}, std::make_shared<LayerParam>()),
+         CreateLayerInfo("Add", "output", {"relu0", "relu1"}, {"output"},
+                         std::make_shared<MultidirBroadcastLayerParam>())});
+    EXPECT_EQ(CountOptimizedLayers(interpreter, LAYER_ABS), 1);
+    EXPECT_EQ(CountOptimizedLayers(interpreter, LAYER_RELU), 1);
+
+    auto copy      = OptimizeCopy(interpreter);
+    auto structure = dynamic_cast<DefaultModelInterpreter*>(copy.get())->GetNetStructure();
+    EXPECT_EQ(structure->blobs.count("abs1"), 0);
+    EXPECT_EQ(structure->blobs.count("relu1"), 0);
+    for (auto name : {"input0", "abs0", "relu0", "output"}) {
+        EXPECT_EQ(structure->blobs.count(name), 1) << name;
+    }
+
+    Run(interpreter);
+}
+
+}  // namespace TNN_NS
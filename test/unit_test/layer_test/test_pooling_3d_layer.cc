@@ -45,7 +45,10 @@ TEST_P(Pooling3DLayerTest, Pooling3DLayer) {
     int pool_type      = std::get<6>(GetParam());
     DataType data_type = std::get<7>(GetParam());
     DeviceType dev     = ConvertDeviceType(FLAGS_dt);
-    if (dev != DEVICE_NAIVE) {
+    if (dev != DEVICE_NAIVE && dev != DEVICE_X86) {
+        GTEST_SKIP();
+    }
+    if (dev == DEVICE_X86 && data_type != DATA_TYPE_FLOAT) {
         GTEST_SKIP();
     }
 
@@ -70,4 +73,50 @@ TEST_P(Pooling3DLayerTest, Pooling3DLayer) {
     Run(interpreter, precision);
 }
 
+// pads not smaller than the kernel, the windows at the borders lie entirely in the pads
+class Pooling3DLargePadLayerTest : public LayerTest,
+                                   public ::testing::WithParamInterface<std::tuple<int, int, int, int, int, int>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, Pooling3DLargePadLayerTest,
+                         ::testing::Combine(  // batch
+                             testing::Values(1, 2),
+                             // channel
+                             testing::Values(1, 4),
+                             // kernel
+                             testing::Values(1, 2),
+                             // pad added to the kernel
+                             testing::Values(0, 1),
+                             // stride
+                             testing::Values(1, 2),
+                             // pool type
+                             testing::Values(0, 1)));
+
+TEST_P(Pooling3DLargePadLayerTest, Pooling3DLayer) {
+    int batch      = std::get<0>(GetParam());
+    int channel    = std::get<1>(GetParam());
+    int kernel     = std::get<2>(GetParam());
+    int pad        = kernel + std::get<3>(GetParam());
+    int stride     = std::get<4>(GetParam());
+    int pool_type  = std::get<5>(GetParam());
+    DeviceType dev = ConvertDeviceType(FLAGS_dt);
+    if (dev != DEVICE_NAIVE && dev != DEVICE_X86) {
+        GTEST_SKIP();
+    }
+
+    std::shared_ptr<PoolingLayerParam> param(new PoolingLayerParam());
+    param->name           = "Pooling3D";
+    param->kernels_params = {kernel, kernel, kernel};
+    param->kernels        = {kernel, kernel, kernel};
+    param->strides        = {stride, stride, stride};
+    param->pads           = {pad, pad, pad, pad, pad, pad};
+    param->pad_type       = -1;
+    param->pool_type      = pool_type;
+    param->kernel_indexs  = {-1, -1, -1};
+
+    std::vector<int> input_dims = {batch, channel, 5, 6, 7};
+    auto interpreter            = GenerateInterpreter("Pooling3D", {input_dims}, param);
+    Precision precision         = SetPrecision(dev, DATA_TYPE_FLOAT);
+    Run(interpreter, precision);
+}
+
 }  // namespace TNN_NS
@@ -440,6 +440,80 @@ TEST_P(MatConverterTest, MatConverterTest) {
     EXPECT_EQ(rtn, 0);
 }
 
+INSTANTIATE_TEST_SUITE_P(MatConverterTest, MatConverterCropResizeTest,
+                         ::testing::Combine(
+                            // inputsize
+                            testing::Values(23, 150),
+                            // mat type
+                            testing::Values(N8UC4, N8UC3, NGRAY),
+                            // use transform
+                            testing::Values(false, true),
+                            // reverse channel
+                            testing::Values(false, true)));
+
+TEST_P(MatConverterCropResizeTest, MatConverterCropResizeTest) {
+    int input_size       = std::get<0>(GetParam());
+    MatType mat_type     = std::get<1>(GetParam());
+    bool use_transform   = std::get<2>(GetParam());
+    bool reverse_channel = std::get<3>(GetParam());
+
+    DeviceType device_type = ConvertDeviceType(FLAGS_dt);
+    if (device_type != DEVICE_X86 && device_type != DEVICE_NAIVE) {
+        GTEST_SKIP();
+    }
+
+    int channel     = mat_type == NGRAY ? 1 : (mat_type == N8UC3 ? 3 : 4);
+    int dst_channel = std::min(channel, 3);
+    int dst_size    = 17;
+
+    DimsVector dims = {1, channel, input_size, input_size};
+    int in_size     = DimsVectorUtils::Count(dims);
+    std::vector<uint8_t> in_data(in_size);
+    InitRandom(in_data.data(), in_size, static_cast<uint8_t>(0), static_cast<uint8_t>(255));
+
+    auto make_box = [](int x, int y, int width, int height) {
+        CropParam box;
+        box.top_left_x = x;
+        box.top_left_y = y;
+        box.width      = width;
+        box.height     = height;
+        return box;
+    };
+    CropResizeParam param;
+    // inside, partly outside and upscaled boxes
+    param.boxes = {make_box(0, 0, input_size, input_size), make_box(3, 5, 10, 12),
+                   make_box(input_size / 2, input_size / 3, input_size, 7), make_box(-4, -2, 9, 9),
+                   make_box(1, 2, 4, 3)};
+    if (use_transform) {
+        param.transforms = {{}, {1.5f, 0.1f, -3.f, -0.2f, 1.2f, 2.f}, {}, {0.5f, 0, 0, 0, 0.5f, 0}, {}};
+    }
+    param.border_val      = 114.f;
+    param.scale           = {0.017f, 0.018f, 0.019f, 1.f};
+    param.bias            = {-1.f, -2.f, -3.f, 0.f};
+    param.reverse_channel = reverse_channel;
+    param.num_threads     = 4;
+
+    DimsVector dims_out = {(int)param.boxes.size(), dst_channel, dst_size, dst_size};
+    Mat cpu_in_mat      = Mat(DEVICE_NAIVE, mat_type, dims, in_data.data());
+    Mat cpu_ref_mat     = Mat(DEVICE_NAIVE, NCHW_FLOAT, dims_out);
+    Mat device_in_mat   = Mat(device_type, mat_type, dims);
+    Mat device_mat      = Mat(device_type, NCHW_FLOAT, dims_out);
+    Mat cpu_out_mat     = Mat(DEVICE_NAIVE, NCHW_FLOAT, dims_out);
+
+    TNN_NS::Status status = MatUtils::CropResize(cpu_in_mat, cpu_ref_mat, param, NULL);
+    CHECK_STATUS;
+    status = MatUtils::Copy(cpu_in_mat, device_in_mat, NULL);
+    CHECK_STATUS;
+    status = MatUtils::CropResize(device_in_mat, device_mat, param, NULL);
+    CHECK_STATUS;
+    status = MatUtils::Copy(device_mat, cpu_out_mat, NULL);
+    CHECK_STATUS;
+
+    int cmp_result = CompareData(static_cast<float*>(cpu_ref_mat.GetData()), static_cast<float*>(cpu_out_mat.GetData()),
+                                 DimsVectorUtils::Count(dims_out), 0.001f);
+    EXPECT_EQ(0, cmp_result);
+}
+
 #undef CHECK_STATUS
 
 }  // namespace TNN_NS
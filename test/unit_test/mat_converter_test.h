@@ -156,6 +156,9 @@ protected:
     static Context* device_context_;
 };
 
+// input size, mat type, use transform, reverse channel
+class MatConverterCropResizeTest : public ::testing::TestWithParam<std::tuple<int, MatType, bool, bool>> {};
+
 }  // namespace TNN_NS
 
 #endif  // TNN_TEST_UNIT_TEST_BLOB_CONVERTER_TEST_H_
@@ -0,0 +1,211 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "test/unit_test/pipeline_test.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+namespace TNN_NS {
+
+std::shared_ptr<Mat> PipelineTest::CreateValueMat(float value) {
+    auto mat = std::make_shared<Mat>(DEVICE_NAIVE, NCHW_FLOAT, DimsVector({1, 1, 1, 1}));
+    static_cast<float*>(mat->GetData())[0] = value;
+    return mat;
+}
+
+float PipelineTest::GetValue(std::shared_ptr<Mat> mat) {
+    return static_cast<float*>(mat->GetData())[0];
+}
+
+Pipeline::OpFunc PipelineTest::ScaleOp(const std::string& input, const std::string& output, float scale,
+                                       float delay_value, int delay_ms) {
+    return [=](MatMap& inputs, MatMap& outputs) {
+        float value = GetValue(inputs[input]);
+        if (value == delay_value) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+        }
+        outputs[output] = CreateValueMat(value * scale);
+        return Status(TNN_OK);
+    };
+}
+
+TEST_F(PipelineTest, PopInPushOrder) {
+    PipelineConfig config;
+    config.max_frames = 8;
+    Pipeline pipeline(config);
+    // the first frame is the slowest, the threads of the stage finish the later frames before it
+    ASSERT_EQ((int)pipeline.AddOpStage("slow_first", ScaleOp("x", "y", 2, 0, 50), {"x"}, {"y"}, 3), TNN_OK);
+    ASSERT_EQ((int)pipeline.AddOpStage("scale", ScaleOp("y", "z", 3), {"y"}, {"z"}), TNN_OK);
+    ASSERT_EQ((int)pipeline.Start(), TNN_OK);
+
+    const int frame_count = 8;
+    for (int i = 0; i < frame_count; ++i) {
+        ASSERT_EQ((int)pipeline.Push({{"x", CreateValueMat(i)}}), TNN_OK);
+    }
+    for (int i = 0; i < frame_count; ++i) {
+        MatMap frame;
+        ASSERT_EQ((int)pipeline.Pop(frame), TNN_OK);
+        EXPECT_EQ(GetValue(frame["x"]), i);
+        EXPECT_EQ(GetValue(frame["y"]), i * 2);
+        EXPECT_EQ(GetValue(frame["z"]), i * 6);
+    }
+    EXPECT_EQ((int)pipeline.Stop(), TNN_OK);
+}
+
+TEST_F(PipelineTest, PushBlocksAtMaxFrames) {
+    PipelineConfig config;
+    config.max_frames = 2;
+    Pipeline pipeline(config);
+    std::promise<void> gate;
+    std::shared_future<void> gate_open = gate.get_future().share();
+    auto gated_op = [=](MatMap& inputs, MatMap& outputs) {
+        gate_open.wait();
+        outputs["y"] = inputs["x"];
+        return Status(TNN_OK);
+    };
+    ASSERT_EQ((int)pipeline.AddOpStage("gated", gated_op, {"x"}, {"y"}), TNN_OK);
+    ASSERT_EQ((int)pipeline.Start(), TNN_OK);
+
+    ASSERT_EQ((int)pipeline.Push({{"x", CreateValueMat(0)}}), TNN_OK);
+    ASSERT_EQ((int)pipeline.Push({{"x", CreateValueMat(1)}}), TNN_OK);
+    std::atomic<bool> pushed(false);
+    Status push_status;
+    std::thread pusher([&] {
+        push_status = pipeline.Push({{"x", CreateValueMat(2)}});
+        pushed      = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed);
+
+    // the frames are done once the gate opens, the push waits until a frame is popped
+    gate.set_value();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed);
+    MatMap frame;
+    ASSERT_EQ((int)pipeline.Pop(frame), TNN_OK);
+    EXPECT_EQ(GetValue(frame["y"]), 0);
+    pusher.join();
+    EXPECT_TRUE(pushed);
+    EXPECT_EQ((int)push_status, TNN_OK);
+
+    for (int i = 1; i < 3; ++i) {
+        ASSERT_EQ((int)pipeline.Pop(frame), TNN_OK);
+        EXPECT_EQ(GetValue(frame["y"]), i);
+    }
+    EXPECT_EQ((int)pipeline.Stop(), TNN_OK);
+}
+
+TEST_F(PipelineTest, FailedStageSkipsLaterStages) {
+    Pipeline pipeline;
+    auto fail_op = [](MatMap& inputs, MatMap& outputs) {
+        float value = GetValue(inputs["x"]);
+        if (value == 1) {
+            return Status(TNNERR_INVALID_INPUT, "frame 1 fails");
+        }
+        outputs["y"] = CreateValueMat(value * 2);
+        return Status(TNN_OK);
+    };
+    std::atomic<int> count_calls(0);
+    auto count_op = [&](MatMap& inputs, MatMap& outputs) {
+        count_calls++;
+        outputs["z"] = CreateValueMat(GetValue(inputs["y"]) + 1);
+        return Status(TNN_OK);
+    };
+    ASSERT_EQ((int)pipeline.AddOpStage("fail", fail_op, {"x"}, {"y"}), TNN_OK);
+    ASSERT_EQ((int)pipeline.AddOpStage("count", count_op, {"y"}, {"z"}), TNN_OK);
+    ASSERT_EQ((int)pipeline.Start(), TNN_OK);
+
+    // frames must hold the mats no stage produces
+    EXPECT_NE((int)pipeline.Push({{"y", CreateValueMat(0)}}), TNN_OK);
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQ((int)pipeline.Push({{"x", CreateValueMat(i)}}), TNN_OK);
+    }
+
+    MatMap frame;
+    ASSERT_EQ((int)pipeline.Pop(frame), TNN_OK);
+    EXPECT_EQ(GetValue(frame["z"]), 1);
+    EXPECT_EQ((int)pipeline.Pop(frame), TNNERR_INVALID_INPUT);
+    EXPECT_TRUE(frame.find("y") == frame.end());
+    EXPECT_TRUE(frame.find("z") == frame.end());
+    ASSERT_EQ((int)pipeline.Pop(frame), TNN_OK);
+    EXPECT_EQ(GetValue(frame["z"]), 5);
+    EXPECT_EQ((int)pipeline.Stop(), TNN_OK);
+
+    EXPECT_EQ(count_calls, 2);
+    std::vector<PipelineStageStats> stats;
+    ASSERT_EQ((int)pipeline.GetStageStats(stats), TNN_OK);
+    ASSERT_EQ(stats.size(), 2);
+    EXPECT_EQ(stats[0].name, "fail");
+    EXPECT_EQ(stats[0].frame_count, 3);
+    EXPECT_EQ(stats[1].name, "count");
+    EXPECT_EQ(stats[1].frame_count, 2);
+}
+
+TEST_F(PipelineTest, StartRejectsInvalidGraph) {
+    {
+        Pipeline pipeline;
+        ASSERT_EQ((int)pipeline.AddOpStage("a", ScaleOp("b_out", "a_out", 1), {"x", "b_out"}, {"a_out"}), TNN_OK);
+        ASSERT_EQ((int)pipeline.AddOpStage("b", ScaleOp("a_out", "b_out", 1), {"a_out"}, {"b_out"}), TNN_OK);
+        EXPECT_NE((int)pipeline.Start(), TNN_OK);
+    }
+    {
+        Pipeline pipeline;
+        ASSERT_EQ((int)pipeline.AddOpStage("a", ScaleOp("x", "y", 1), {"x"}, {"y"}), TNN_OK);
+        ASSERT_EQ((int)pipeline.AddOpStage("b", ScaleOp("x", "y", 2), {"x"}, {"y"}), TNN_OK);
+        EXPECT_NE((int)pipeline.Start(), TNN_OK);
+    }
+    {
+        Pipeline pipeline;
+        ASSERT_EQ((int)pipeline.AddOpStage("a", ScaleOp("x", "y", 1), {"x"}, {"y"}), TNN_OK);
+        EXPECT_NE((int)pipeline.AddOpStage("a", ScaleOp("y", "z", 1), {"y"}, {"z"}), TNN_OK);
+    }
+    {
+        Pipeline pipeline;
+        EXPECT_NE((int)pipeline.Start(), TNN_OK);
+    }
+}
+
+TEST_F(PipelineTest, StopFinishesFramesInFlight) {
+    Pipeline pipeline;
+    std::atomic<int> done_frames(0);
+    auto slow_op = [&](MatMap& inputs, MatMap& outputs) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        outputs["y"] = CreateValueMat(GetValue(inputs["x"]) * 2);
+        done_frames++;
+        return Status(TNN_OK);
+    };
+    ASSERT_EQ((int)pipeline.AddOpStage("slow", slow_op, {"x"}, {"y"}), TNN_OK);
+    ASSERT_EQ((int)pipeline.Start(), TNN_OK);
+
+    const int frame_count = 4;
+    for (int i = 0; i < frame_count; ++i) {
+        ASSERT_EQ((int)pipeline.Push({{"x", CreateValueMat(i)}}), TNN_OK);
+    }
+    ASSERT_EQ((int)pipeline.Stop(), TNN_OK);
+    EXPECT_EQ(done_frames, frame_count);
+    EXPECT_NE((int)pipeline.Push({{"x", CreateValueMat(0)}}), TNN_OK);
+
+    // the done frames can still be popped
+    MatMap frame;
+    for (int i = 0; i < frame_count; ++i) {
+        ASSERT_EQ((int)pipeline.Pop(frame), TNN_OK);
+        EXPECT_EQ(GetValue(frame["y"]), i * 2);
+    }
+    EXPECT_EQ((int)pipeline.Pop(frame), TNNERR_NO_RESULT);
+}
+
+}  // namespace TNN_NS
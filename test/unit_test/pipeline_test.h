@@ -0,0 +1,41 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef TNN_TEST_UNIT_TEST_PIPELINE_TEST_H_
+#define TNN_TEST_UNIT_TEST_PIPELINE_TEST_H_
+
+#include <gtest/gtest.h>
+
+#include "tnn/core/macro.h"
+#include "tnn/core/mat.h"
+#include "tnn/core/pipeline.h"
+#include "tnn/core/status.h"
+
+namespace TNN_NS {
+
+class PipelineTest : public ::testing::Test {
+protected:
+    // 1x1x1x1 NCHW_FLOAT mat holding value
+    static std::shared_ptr<Mat> CreateValueMat(float value);
+
+    static float GetValue(std::shared_ptr<Mat> mat);
+
+    // op stage writing input * scale to output, frames whose input value is delay_value sleep delay_ms first
+    static Pipeline::OpFunc ScaleOp(const std::string& input, const std::string& output, float scale,
+                                    float delay_value = -1, int delay_ms = 0);
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_TEST_UNIT_TEST_PIPELINE_TEST_H_
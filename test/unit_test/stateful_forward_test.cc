@@ -0,0 +1,139 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "test/unit_test/instance_test.h"
+#include "test/unit_test/unit_test_common.h"
+#include "tnn/interpreter/default_model_interpreter.h"
+#include "tnn/utils/dims_utils.h"
+
+namespace TNN_NS {
+
+class StatefulForwardTest : public InstanceTest {
+protected:
+    // the weights of lstm and gru are model inputs, the same random constants are used by every instance
+    static void AddConstant(std::shared_ptr<AbstractModelInterpreter> interpreter, std::string name,
+                            DimsVector dims) {
+        int count   = DimsVectorUtils::Count(dims);
+        auto buffer = std::make_shared<RawBuffer>(count * sizeof(float));
+        buffer->SetBufferDims(dims);
+        buffer->SetDataType(DATA_TYPE_FLOAT);
+        InitRandom(buffer->force_to<float*>(), count, 1.0f);
+        auto default_interpreter = dynamic_cast<DefaultModelInterpreter*>(interpreter.get());
+        default_interpreter->GetNetResource()->constant_map[name] = buffer;
+    }
+
+    // forward input0 chunk by chunk along axis in stateful forward, the output of each chunk must be the same frames
+    // of output0 as one forward of the whole input. the stream is fed twice with ResetState in between.
+    static void ExpectChunksMatchWhole(std::shared_ptr<AbstractModelInterpreter> interpreter, DimsVector dims,
+                                       int axis, std::vector<int> chunks) {
+        auto config = GetDeviceConfig();
+        std::shared_ptr<Instance> instance, stream_instance;
+        ASSERT_EQ((int)CreateInstance(interpreter, config, {}, instance), TNN_OK);
+        config.enable_stateful_forward = true;
+        ASSERT_EQ((int)CreateInstance(interpreter, config, {}, stream_instance), TNN_OK);
+
+        auto input = CreateRandomMat(dims);
+        std::shared_ptr<Mat> expected;
+        ASSERT_EQ((int)ForwardMat(instance.get(), input, expected, "input0", "output0"), TNN_OK);
+
+        for (int pass = 0; pass < 2; ++pass) {
+            int begin = 0;
+            for (int chunk : chunks) {
+                auto chunk_input = SliceMat(input, axis, begin, begin + chunk);
+                ASSERT_EQ((int)stream_instance->Reshape({{"input0", chunk_input->GetDims()}}), TNN_OK);
+                std::shared_ptr<Mat> output;
+                ASSERT_EQ((int)ForwardMat(stream_instance.get(), chunk_input, output, "input0", "output0"), TNN_OK);
+                EXPECT_EQ(0, CompareMat(SliceMat(expected, axis, begin, begin + chunk), output))
+                    << "pass " << pass << " frame " << begin;
+                begin += chunk;
+            }
+            ASSERT_EQ((int)stream_instance->ResetState(), TNN_OK);
+        }
+    }
+};
+
+TEST_F(StatefulForwardTest, LSTMChunksMatchWhole) {
+    if (GetDeviceConfig().device_type != DEVICE_X86) {
+        GTEST_SKIP();
+    }
+
+    const int seq_len = 8, batch = 2, input_size = 5, hidden_size = 7;
+    auto param         = std::make_shared<LSTMONNXLayerParam>();
+    param->hidden_size = hidden_size;
+    param->direction   = 0;
+    DimsVector dims    = {seq_len, batch, input_size};
+    DimsVector w_dims  = {1, 4 * hidden_size, input_size};
+    DimsVector r_dims  = {1, 4 * hidden_size, hidden_size};
+    DimsVector b_dims  = {1, 8 * hidden_size};
+    auto interpreter   = GenerateInterpreter("LSTMONNX", {dims, w_dims, r_dims, b_dims}, param, nullptr, 3);
+    AddConstant(interpreter, "input1", w_dims);
+    AddConstant(interpreter, "input2", r_dims);
+    AddConstant(interpreter, "input3", b_dims);
+
+    ExpectChunksMatchWhole(interpreter, dims, 0, {3, 3, 2});
+}
+
+TEST_F(StatefulForwardTest, GRUChunksMatchWhole) {
+    if (GetDeviceConfig().device_type != DEVICE_X86) {
+        GTEST_SKIP();
+    }
+
+    const int seq_len = 8, batch = 2, input_size = 5, hidden_size = 7;
+    auto param                 = std::make_shared<GRUONNXLayerParam>();
+    param->hidden_size         = hidden_size;
+    param->direction           = 0;
+    param->linear_before_reset = 1;
+    DimsVector dims            = {seq_len, batch, input_size};
+    DimsVector w_dims          = {1, 3 * hidden_size, input_size};
+    DimsVector r_dims          = {1, 3 * hidden_size, hidden_size};
+    DimsVector b_dims          = {1, 6 * hidden_size};
+    auto interpreter           = GenerateInterpreter("GRUONNX", {dims, w_dims, r_dims, b_dims}, param, nullptr, 2);
+    AddConstant(interpreter, "input1", w_dims);
+    AddConstant(interpreter, "input2", r_dims);
+    AddConstant(interpreter, "input3", b_dims);
+
+    ExpectChunksMatchWhole(interpreter, dims, 0, {3, 3, 2});
+}
+
+TEST_F(StatefulForwardTest, CausalConv1DChunksMatchWhole) {
+    if (GetDeviceConfig().device_type != DEVICE_X86) {
+        GTEST_SKIP();
+    }
+
+    // the left pads cover the kernel extent, the first frames of a chunk see the last frames of the previous one
+    const int channel = 4, kernel = 3, dilation = 2;
+    auto param            = std::make_shared<ConvLayerParam>();
+    param->input_channel  = channel;
+    param->output_channel = channel;
+    param->group          = 1;
+    param->kernels        = {kernel};
+    param->dialations     = {dilation};
+    param->strides        = {1};
+    param->pads           = {dilation * (kernel - 1), 0};
+    param->bias           = 1;
+    auto resource         = std::make_shared<ConvLayerResource>();
+    RawBuffer filter(channel * channel * kernel * sizeof(float));
+    InitRandom(filter.force_to<float*>(), channel * channel * kernel, 1.0f);
+    RawBuffer bias(channel * sizeof(float));
+    InitRandom(bias.force_to<float*>(), channel, 1.0f);
+    resource->filter_handle = filter;
+    resource->bias_handle   = bias;
+    DimsVector dims         = {2, channel, 16};
+    auto interpreter        = GenerateInterpreter("Convolution1D", {dims}, param, resource);
+
+    // chunks shorter than the history too
+    ExpectChunksMatchWhole(interpreter, dims, 2, {6, 2, 5, 3});
+}
+
+}  // namespace TNN_NS
@@ -15,6 +15,7 @@
 #include "test/unit_test/unit_test_common.h"
 
 #include <iostream>
+#include <set>
 #include <sstream>
 
 #include "test/flags.h"
@@ -135,4 +136,58 @@ std::shared_ptr<AbstractModelInterpreter> GenerateInterpreter(std::string layer_
     return std::shared_ptr<AbstractModelInterpreter>(interpreter);
 }
 
+std::shared_ptr<LayerInfo> CreateLayerInfo(std::string layer_type_str, std::string name,
+                                           std::vector<std::string> inputs, std::vector<std::string> outputs,
+                                           std::shared_ptr<LayerParam> param) {
+    std::shared_ptr<LayerInfo> layer_info = std::make_shared<LayerInfo>();
+    layer_info->type                      = GlobalConvertLayerType(layer_type_str);
+    layer_info->type_str                  = layer_type_str;
+    layer_info->name                      = name;
+    layer_info->inputs                    = inputs;
+    layer_info->outputs                   = outputs;
+    layer_info->param                     = param;
+    if (param) {
+        param->type = layer_type_str;
+        param->name = name;
+    }
+    return layer_info;
+}
+
+std::shared_ptr<AbstractModelInterpreter> GenerateInterpreter(
+    std::vector<std::vector<int>> input_vec, std::vector<std::shared_ptr<LayerInfo>> layers,
+    std::map<std::string, std::shared_ptr<LayerResource>> resources) {
+    auto interpreter = CreateModelInterpreter(MODEL_TYPE_TNN);
+    if (!interpreter) {
+        return nullptr;
+    }
+    DefaultModelInterpreter* default_interpreter = dynamic_cast<DefaultModelInterpreter*>(interpreter);
+    if (!default_interpreter) {
+        return nullptr;
+    }
+
+    NetStructure* net_structure = default_interpreter->GetNetStructure();
+    NetResource* net_resource   = default_interpreter->GetNetResource();
+
+    net_structure->inputs_shape_map = GenerateInputShapeMap(input_vec);
+    for (auto item : net_structure->inputs_shape_map) {
+        net_structure->blobs.insert(item.first);
+    }
+    std::set<std::string> consumed;
+    for (auto layer_info : layers) {
+        consumed.insert(layer_info->inputs.begin(), layer_info->inputs.end());
+        net_structure->blobs.insert(layer_info->outputs.begin(), layer_info->outputs.end());
+        net_structure->layers.push_back(layer_info);
+    }
+    for (auto layer_info : layers) {
+        for (auto name : layer_info->outputs) {
+            if (consumed.find(name) == consumed.end()) {
+                net_structure->outputs.insert(name);
+            }
+        }
+    }
+    net_resource->resource_map = resources;
+
+    return std::shared_ptr<AbstractModelInterpreter>(interpreter);
+}
+
 }  // namespace TNN_NS
@@ -16,6 +16,7 @@
 #define TNN_TEST_UNIT_TEST_COMMON_H_
 
 #include <chrono>
+#include <map>
 #include <random>
 #include <string>
 #include <vector>
@@ -26,6 +27,7 @@
 #include "tnn/interpreter/abstract_model_interpreter.h"
 #include "tnn/interpreter/layer_param.h"
 #include "tnn/interpreter/layer_resource.h"
+#include "tnn/interpreter/net_structure.h"
 #include "tnn/utils/random_data_utils.h"
 
 namespace TNN_NS {
@@ -39,6 +41,17 @@ std::shared_ptr<AbstractModelInterpreter> GenerateInterpreter(std::string layer_
                                                               std::shared_ptr<LayerResource> resource = nullptr,
                                                               int output_count                        = 1);
 
+// @brief layer of a model built by GenerateInterpreter, the layer param is named after the layer
+std::shared_ptr<LayerInfo> CreateLayerInfo(std::string layer_type_str, std::string name,
+                                           std::vector<std::string> inputs, std::vector<std::string> outputs,
+                                           std::shared_ptr<LayerParam> param);
+
+// @brief generate a model of several layers, the inputs are named input0, input1, ... and the outputs are the
+// layer outputs no layer reads. resources are given by layer name.
+std::shared_ptr<AbstractModelInterpreter> GenerateInterpreter(
+    std::vector<std::vector<int>> input_vec, std::vector<std::shared_ptr<LayerInfo>> layers,
+    std::map<std::string, std::shared_ptr<LayerResource>> resources = {});
+
 }  // namespace TNN_NS
 
 #endif  // TNN_TEST_UNIT_TEST_COMMON_H_
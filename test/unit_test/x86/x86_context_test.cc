@@ -0,0 +1,288 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "test/unit_test/instance_test.h"
+#include "test/unit_test/unit_test_common.h"
+#include "tnn/device/x86/acc/x86_inner_product_layer_acc.h"
+#include "tnn/device/x86/x86_context.h"
+#include "tnn/memory_manager/shared_workspace_manager.h"
+#include "tnn/utils/cpu_utils.h"
+#include "tnn/utils/random_data_utils.h"
+
+namespace TNN_NS {
+
+class X86ContextTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        cache_file_ = "x86_context_test";
+        remove(GetTuneFilePath().c_str());
+    }
+
+    void TearDown() override {
+        remove(GetTuneFilePath().c_str());
+    }
+
+    // the file X86Context stores the kernel tune results of the contexts set up by SetUpTuneCache in
+    std::string GetTuneFilePath() {
+        return ::testing::TempDir() + "/" + cache_file_ + "_kernel_tune";
+    }
+
+    void SetUpTuneCache(X86Context& context) {
+        context.SetEnableTuneKernel(true);
+        context.SetCachePath(::testing::TempDir());
+        context.SetCacheFilePath(cache_file_);
+    }
+
+    // tune map a new context loads from the cache file
+    std::map<std::string, std::vector<int>> LoadTuneCache() {
+        X86Context context;
+        SetUpTuneCache(context);
+        EXPECT_EQ((int)context.OnInstanceReshapeBegin(), TNN_OK);
+        return context.GetTuneMap();
+    }
+
+    void WriteTuneCache(const std::string& content) {
+        std::ofstream stream(GetTuneFilePath());
+        stream << content;
+    }
+
+    std::string cache_file_;
+};
+
+TEST_F(X86ContextTest, TuneCacheRoundTrip) {
+    X86Context context;
+    SetUpTuneCache(context);
+    ASSERT_EQ((int)context.OnInstanceReshapeBegin(), TNN_OK);
+    context.GetTuneMap()["conv_1_8_16_16_1_8_16_16_k_3_3"] = {1, 64, 256};
+    context.GetTuneMap()["inner_product_64_256_1_1_64_256_t_1"] = {1, 32, 128};
+    ASSERT_EQ((int)context.OnInstanceReshapeEnd(), TNN_OK);
+
+    EXPECT_EQ(LoadTuneCache(), context.GetTuneMap());
+}
+
+TEST_F(X86ContextTest, CorruptTuneCacheIsIgnored) {
+    // a valid result followed by one of the wrong size
+    WriteTuneCache("2\nconv_a 3 1 64 256\nconv_b 2 1 64\n");
+    EXPECT_TRUE(LoadTuneCache().empty());
+
+    // truncated
+    WriteTuneCache("2\nconv_a 3 1 64 256\nconv_b 3 1");
+    EXPECT_TRUE(LoadTuneCache().empty());
+
+    // a value count that is not allocated
+    WriteTuneCache("1\nconv_a 1000000000 1 64 256\n");
+    EXPECT_TRUE(LoadTuneCache().empty());
+
+    // not a number
+    WriteTuneCache("1\nconv_a 3 1 sixty_four 256\n");
+    EXPECT_TRUE(LoadTuneCache().empty());
+
+    WriteTuneCache("1\nconv_a 3 1 64 256\n");
+    EXPECT_EQ(LoadTuneCache().size(), 1);
+}
+
+TEST_F(X86ContextTest, TuneInnerProductGemmBlockSize) {
+    // large enough for the gemm kernel
+    const int batch = 64, input_channel = 256, output_channel = 256;
+    InnerProductLayerParam param;
+    param.name       = "inner_product";
+    param.num_output = output_channel;
+    param.has_bias   = 1;
+    param.axis       = 1;
+    InnerProductLayerResource resource;
+    resource.weight_handle = RawBuffer(output_channel * input_channel * sizeof(float));
+    InitRandom(resource.weight_handle.force_to<float*>(), output_channel * input_channel, 1.0f);
+    resource.bias_handle = RawBuffer(output_channel * sizeof(float));
+    InitRandom(resource.bias_handle.force_to<float*>(), output_channel, 1.0f);
+
+    BlobDesc input_desc;
+    input_desc.device_type = DEVICE_X86;
+    input_desc.data_type   = DATA_TYPE_FLOAT;
+    input_desc.data_format = DATA_FORMAT_NCHW;
+    input_desc.dims        = {batch, input_channel, 1, 1};
+    BlobDesc output_desc   = input_desc;
+    output_desc.dims       = {batch, output_channel, 1, 1};
+    Blob input(input_desc, true);
+    InitRandom(static_cast<float*>(input.GetHandle().base), batch * input_channel, 1.0f);
+    std::vector<Blob*> inputs = {&input};
+
+    // output of the default block sizes
+    X86Context context;
+    context.SetEnableTuneKernel(false);
+    X86InnerProductLayerAcc acc;
+    Blob expected(output_desc, true);
+    ASSERT_EQ((int)acc.Init(&context, &param, &resource, inputs, {&expected}), TNN_OK);
+    ASSERT_EQ((int)acc.DoForward(inputs, {&expected}), TNN_OK);
+
+    X86Context tune_context;
+    tune_context.SetEnableTuneKernel(true);
+    X86InnerProductLayerAcc tune_acc;
+    Blob output(output_desc, true);
+    ASSERT_EQ((int)tune_acc.Init(&tune_context, &param, &resource, inputs, {&output}), TNN_OK);
+    ASSERT_EQ((int)tune_acc.Reshape(inputs, {&output}), TNN_OK);
+    ASSERT_EQ((int)tune_acc.DoForward(inputs, {&output}), TNN_OK);
+
+    auto& tune_map = tune_context.GetTuneMap();
+    ASSERT_EQ(tune_map.size(), 1);
+    EXPECT_EQ(tune_map.begin()->first.find("inner_product"), 0);
+    EXPECT_EQ(tune_map.begin()->second.size(), 3);
+    // the weights packed for the block sizes that lost are released
+    EXPECT_EQ(tune_acc.GetSharedWeightKeys().size(), 1);
+
+    const float* expected_data = static_cast<float*>(expected.GetHandle().base);
+    const float* output_data   = static_cast<float*>(output.GetHandle().base);
+    for (int i = 0; i < batch * output_channel; ++i) {
+        ASSERT_NEAR(expected_data[i], output_data[i], 1e-3 * (1 + std::fabs(expected_data[i])));
+    }
+}
+
+// listener of the workspaces of the test thread
+class WorkSpaceSpy : public ISharedWorkSpaceChangeListener {
+public:
+    virtual void OnSharedWorkSpaceChanged(int index, void* memory, size_t size) override {
+        memory_ = memory;
+        size_   = size;
+        count_++;
+    }
+
+    void* memory_ = nullptr;
+    size_t size_  = 0;
+    int count_    = 0;
+};
+
+TEST_F(X86ContextTest, ShareWorkSpaceInOneThread) {
+    const auto thread_id = std::this_thread::get_id();
+    const size_t listener_count = SharedWorkSpaceManager::GetListenerCount(thread_id, DEVICE_X86, 0);
+    auto first  = std::make_shared<X86Context>();
+    auto second = std::make_shared<X86Context>();
+    first->SetShareMemoryMode(SHARE_MEMORY_MODE_SHARE_ONE_THREAD);
+    second->SetShareMemoryMode(SHARE_MEMORY_MODE_SHARE_ONE_THREAD);
+    void* memory = first->GetSharedWorkSpace(1024);
+    ASSERT_NE(memory, nullptr);
+    EXPECT_EQ(second->GetSharedWorkSpace(512), memory);
+    EXPECT_EQ(SharedWorkSpaceManager::GetListenerCount(thread_id, DEVICE_X86, 0), listener_count + 2);
+
+    // the growth by the second context is seen by the first one
+    WorkSpaceSpy spy;
+    SharedWorkSpaceManager::RegisterListener(thread_id, DEVICE_X86, 0, &spy);
+    void* grown = second->GetSharedWorkSpace(1 << 20);
+    EXPECT_EQ(spy.count_, 1);
+    EXPECT_EQ(spy.memory_, grown);
+    EXPECT_EQ(spy.size_, 1 << 20);
+    EXPECT_EQ(first->GetSharedWorkSpace(1024), grown);
+    EXPECT_EQ(first->GetSharedWorkSpace(1 << 20), grown);
+    EXPECT_EQ(spy.count_, 1);
+
+    // the contexts deregister when they are destroyed
+    first.reset();
+    EXPECT_EQ(SharedWorkSpaceManager::GetListenerCount(thread_id, DEVICE_X86, 0), listener_count + 2);
+    second->GetSharedWorkSpace(2 << 20);
+    EXPECT_EQ(spy.count_, 2);
+    second.reset();
+    EXPECT_EQ(SharedWorkSpaceManager::GetListenerCount(thread_id, DEVICE_X86, 0), listener_count + 1);
+    SharedWorkSpaceManager::ReleaseListener(thread_id, DEVICE_X86, 0, &spy);
+    EXPECT_EQ(SharedWorkSpaceManager::GetListenerCount(thread_id, DEVICE_X86, 0), listener_count);
+}
+
+TEST_F(X86ContextTest, SetNumaNodeOutOfRange) {
+    X86Context context;
+    EXPECT_NE((int)context.SetNumaNode(CpuUtils::GetNumaNodeCount()), TNN_OK);
+    EXPECT_NE((int)context.SetNumaNode(CpuUtils::GetNumaNodeCount() + 7), TNN_OK);
+    // -1 does not bind the context
+    EXPECT_EQ((int)context.SetNumaNode(-1), TNN_OK);
+}
+
+/*
+the calling thread is bound to the numa node only while it works for the context, the affinity and the memory policy
+it had before are restored after
+*/
+class X86NumaTest : public InstanceTest {
+protected:
+    void SetUp() override {
+        if (CpuUtils::GetNumaNodeCount() < 1 || CpuUtils::GetCpuAffinity(cpu_list_) != TNN_OK ||
+            CpuUtils::GetMemoryPolicy(memory_mode_, node_mask_) != TNN_OK) {
+            GTEST_SKIP();
+        }
+        ASSERT_EQ((int)CpuUtils::GetNumaNodeCpus(0, node_cpu_list_), TNN_OK);
+    }
+
+    void ExpectUnbound() {
+        std::vector<int> cpu_list;
+        int memory_mode;
+        std::vector<unsigned long> node_mask;
+        ASSERT_EQ((int)CpuUtils::GetCpuAffinity(cpu_list), TNN_OK);
+        ASSERT_EQ((int)CpuUtils::GetMemoryPolicy(memory_mode, node_mask), TNN_OK);
+        EXPECT_EQ(cpu_list, cpu_list_);
+        EXPECT_EQ(memory_mode, memory_mode_);
+        EXPECT_EQ(node_mask, node_mask_);
+    }
+
+    void ExpectBound() {
+        std::vector<int> cpu_list;
+        ASSERT_EQ((int)CpuUtils::GetCpuAffinity(cpu_list), TNN_OK);
+        EXPECT_EQ(cpu_list, node_cpu_list_);
+    }
+
+    std::vector<int> cpu_list_;
+    int memory_mode_ = 0;
+    std::vector<unsigned long> node_mask_;
+    std::vector<int> node_cpu_list_;
+};
+
+TEST_F(X86NumaTest, NestedBind) {
+    X86Context context;
+    ASSERT_EQ((int)context.SetNumaNode(0), TNN_OK);
+    ASSERT_EQ((int)context.BindNumaNode(), TNN_OK);
+    ExpectBound();
+    ASSERT_EQ((int)context.BindNumaNode(), TNN_OK);
+    ExpectBound();
+    ASSERT_EQ((int)context.UnbindNumaNode(), TNN_OK);
+    // the outer bind is still active
+    ExpectBound();
+    ASSERT_EQ((int)context.UnbindNumaNode(), TNN_OK);
+    ExpectUnbound();
+    // unbalanced unbinds are ignored
+    ASSERT_EQ((int)context.UnbindNumaNode(), TNN_OK);
+    ExpectUnbound();
+}
+
+TEST_F(X86NumaTest, ForwardRestoresAffinity) {
+    DimsVector dims  = {1, 8, 16, 16};
+    auto param       = CreateConvParam(8, 8, 3, 1);
+    auto interpreter = GenerateInterpreter(
+        {dims}, {CreateLayerInfo("Convolution", "conv", {"input0"}, {"output"}, param)},
+        {{"conv", CreateConvResource(param)}});
+    NetworkConfig config;
+    config.device_type = DEVICE_X86;
+    config.numa_node   = 0;
+    std::shared_ptr<Instance> instance;
+    ASSERT_EQ((int)CreateInstance(interpreter, config, {}, instance), TNN_OK);
+    ExpectUnbound();
+
+    std::shared_ptr<Mat> output;
+    ASSERT_EQ((int)ForwardMat(instance.get(), CreateRandomMat(dims), output), TNN_OK);
+    ExpectUnbound();
+    ASSERT_EQ((int)instance->Reshape({{"input0", {2, 8, 16, 16}}}), TNN_OK);
+    ExpectUnbound();
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,35 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "tnn/device/x86/acc/convolution/x86_conv_layer_3x3.h"
+
+namespace TNN_NS {
+
+// the output sizes of Conv3x3LayerTest run every winograd output tile
+TEST(X86ConvLayer3x3Test, SelectDstUnit) {
+    // 16 channels in packs of 8 for avx2 and of 4 for sse
+    for (int ch_pack : {8, 4}) {
+        const int pack = 16 / ch_pack;
+        EXPECT_EQ(X86ConvLayer3x3::SelectDstUnit(pack, pack, ch_pack, 8, 8), 4);
+        EXPECT_EQ(X86ConvLayer3x3::SelectDstUnit(pack, pack, ch_pack, 16, 16), 4);
+        EXPECT_EQ(X86ConvLayer3x3::SelectDstUnit(pack, pack, ch_pack, 12, 12), 6);
+        EXPECT_EQ(X86ConvLayer3x3::SelectDstUnit(pack, pack, ch_pack, 24, 24), 6);
+    }
+    // the transformed block of a larger tile does not fit in the cache
+    EXPECT_EQ(X86ConvLayer3x3::SelectDstUnit(4096, 4096, 8, 24, 24), 2);
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,132 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "tnn/device/x86/x86_thread_pool.h"
+
+namespace TNN_NS {
+
+class X86ThreadPoolTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        X86ThreadPool::SetCurrent(nullptr);
+    }
+
+    // number of times each thread id ran the task of one Run
+    static std::vector<int> CountThreadIds(X86ThreadPool& pool, int max_threads) {
+        std::vector<std::atomic<int>> counts(max_threads);
+        for (auto& count : counts) {
+            count = 0;
+        }
+        pool.Run([&](int thread_id) {
+            if (thread_id < max_threads) {
+                counts[thread_id]++;
+            }
+        });
+        std::vector<int> result;
+        for (auto& count : counts) {
+            result.push_back(count);
+        }
+        return result;
+    }
+};
+
+TEST_F(X86ThreadPoolTest, ParallelForCoversEveryIndexOnce) {
+    X86ThreadPool pool;
+    ASSERT_EQ((int)pool.SetNumThreads(4), TNN_OK);
+    X86ThreadPool::SetCurrent(&pool);
+
+    const int begin = 3, end = 1000, step = 3;
+    std::vector<std::atomic<int>> hits(end);
+    for (auto& hit : hits) {
+        hit = 0;
+    }
+    std::atomic<bool> thread_id_in_range(true);
+    X86ParallelFor(begin, end, step, [&](int index, int thread_id) {
+        hits[index]++;
+        if (thread_id < 0 || thread_id >= pool.GetNumThreads()) {
+            thread_id_in_range = false;
+        }
+    });
+    for (int i = 0; i < end; ++i) {
+        bool visited = i >= begin && (i - begin) % step == 0;
+        EXPECT_EQ(hits[i], visited ? 1 : 0) << "index " << i;
+    }
+    EXPECT_TRUE(thread_id_in_range);
+}
+
+TEST_F(X86ThreadPoolTest, RunOnEveryThreadOnce) {
+    X86ThreadPool pool;
+    ASSERT_EQ((int)pool.SetNumThreads(4), TNN_OK);
+    // the extra slot stays zero, thread ids are below the number of threads
+    EXPECT_EQ(CountThreadIds(pool, 5), std::vector<int>({1, 1, 1, 1, 0}));
+}
+
+TEST_F(X86ThreadPoolTest, NestedParallelForRunsSerially) {
+    X86ThreadPool pool;
+    ASSERT_EQ((int)pool.SetNumThreads(4), TNN_OK);
+    X86ThreadPool::SetCurrent(&pool);
+
+    std::atomic<int> inner_count(0);
+    std::atomic<bool> same_thread(true);
+    X86ParallelFor(0, 8, [&](int, int thread_id) {
+        auto outer_thread = std::this_thread::get_id();
+        X86ParallelFor(0, 16, [&](int, int inner_thread_id) {
+            inner_count++;
+            if (inner_thread_id != thread_id || std::this_thread::get_id() != outer_thread) {
+                same_thread = false;
+            }
+        });
+    });
+    EXPECT_EQ(inner_count, 8 * 16);
+    EXPECT_TRUE(same_thread);
+}
+
+TEST_F(X86ThreadPoolTest, Resize) {
+    X86ThreadPool pool;
+    for (int num_threads : {2, 5, 1, 3}) {
+        ASSERT_EQ((int)pool.SetNumThreads(num_threads), TNN_OK);
+        EXPECT_EQ(pool.GetNumThreads(), num_threads);
+        std::vector<int> expected(6, 0);
+        for (int i = 0; i < num_threads; ++i) {
+            expected[i] = 1;
+        }
+        EXPECT_EQ(CountThreadIds(pool, 6), expected) << num_threads << " threads";
+    }
+}
+
+TEST_F(X86ThreadPoolTest, RunWaitsForSlowWorker) {
+    X86ThreadPool pool;
+    ASSERT_EQ((int)pool.SetNumThreads(3), TNN_OK);
+
+    // the caller parks once it is done spinning, the slow worker must wake it
+    for (int i = 0; i < 3; ++i) {
+        std::atomic<int> finished(0);
+        pool.Run([&](int thread_id) {
+            if (thread_id == 1) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+            finished++;
+        });
+        EXPECT_EQ(finished, 3);
+    }
+}
+
+}  // namespace TNN_NS
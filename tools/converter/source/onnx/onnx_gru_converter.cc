@@ -0,0 +1,150 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "onnx_base_converter.h"
+#include "onnx_utils.h"
+
+namespace TNN_CONVERTER {
+
+DECLARE_OP_CONVERTER(GRU);
+
+std::string OnnxGRUConverter::TNNOpType(const onnx::NodeProto &node, bool quantized_model) {
+    return "GRUONNX";
+}
+
+TNN_NS::ActivationType OnnxGRUConverter::ActivationType(const onnx::NodeProto &node) {
+    return TNN_NS::ActivationType_None;
+}
+
+static std::shared_ptr<TNN_NS::LayerInfo> CreateLayerInfo(const std::string &name, const std::string &type_str,
+                                                          const std::string &input, const std::string &output,
+                                                          TNN_NS::LayerParam *param) {
+    auto layer_info      = std::make_shared<TNN_NS::LayerInfo>();
+    layer_info->name     = name;
+    layer_info->type_str = type_str;
+    layer_info->type     = TNN_NS::GlobalConvertLayerType(type_str);
+    layer_info->inputs.push_back(input);
+    layer_info->outputs.push_back(output);
+    layer_info->param = std::shared_ptr<TNN_NS::LayerParam>(param);
+    param->type       = type_str;
+    param->name       = name;
+    param->quantized  = false;
+    return layer_info;
+}
+
+TNN_NS::Status OnnxGRUConverter::exec(TNN_NS::NetStructure &net_structure, TNN_NS::NetResource &net_resource,
+                                      const onnx::NodeProto &node,
+                                      std::map<std::string, const onnx::TensorProto *> &proxy_initializers_map,
+                                      std::map<std::string, std::shared_ptr<OnnxProxyNode>> &proxy_nodes,
+                                      bool &quantized_model) {
+    auto param       = new TNN_NS::GRUONNXLayerParam;
+    auto cur_layer   = net_structure.layers.back();
+    cur_layer->param = std::shared_ptr<TNN_NS::LayerParam>(param);
+    param->type      = cur_layer->type_str;
+    param->name      = cur_layer->name;
+    param->quantized = false;
+
+    param->hidden_size         = GetAttributeInt(node, "hidden_size", 0);
+    param->linear_before_reset = GetAttributeInt(node, "linear_before_reset", 0);
+    auto direction             = GetAttributeString(node, "direction", "forward");
+    if (direction == "forward") {
+        param->direction = 0;
+    } else if (direction == "reverse") {
+        param->direction = 1;
+    } else if (direction == "bidirectional") {
+        param->direction = 2;
+    } else {
+        LOGE("GRU: unsupported direction %s\n", direction.c_str());
+        return TNN_NS::TNNERR_CONVERT_UNSUPPORT_LAYER;
+    }
+    const int num_directions = param->direction == 2 ? 2 : 1;
+    const int hidden_size    = param->hidden_size;
+    auto activations         = GetAttributeStringVector(node, "activations");
+    for (int i = 0; i < activations.size(); i++) {
+        if (activations[i] != (i % 2 == 0 ? "Sigmoid" : "Tanh")) {
+            LOGE("GRU: unsupported activation %s\n", activations[i].c_str());
+            return TNN_NS::TNNERR_CONVERT_UNSUPPORT_LAYER;
+        }
+    }
+    if (GetAttributeFloat(node, "clip", 0.f) != 0.f) {
+        LOGE("GRU: clip is not supported\n");
+        return TNN_NS::TNNERR_CONVERT_UNSUPPORT_LAYER;
+    }
+    if (node.input_size() > 4 && !node.input(4).empty()) {
+        LOGE("GRU: sequence_lens is not supported\n");
+        return TNN_NS::TNNERR_CONVERT_UNSUPPORT_LAYER;
+    }
+
+    // inputs: X, W, R, B, initial_h, W, R and B are saved in constant map
+    std::string bias_name = node.input_size() > 3 ? node.input(3) : "";
+    if (bias_name.empty()) {
+        bias_name   = cur_layer->name + "_bias";
+        auto buffer = std::make_shared<TNN_NS::RawBuffer>(num_directions * 6 * hidden_size * sizeof(float),
+                                                          TNN_NS::DimsVector({num_directions, 6 * hidden_size}));
+        buffer->SetDataType(TNN_NS::DATA_TYPE_FLOAT);
+        net_resource.constant_map[bias_name] = buffer;
+    }
+    cur_layer->inputs = {node.input(0), node.input(1), node.input(2), bias_name};
+    if (node.input_size() > 5 && !node.input(5).empty()) {
+        cur_layer->inputs.push_back(node.input(5));
+    }
+    for (const auto &input : cur_layer->inputs) {
+        if (proxy_initializers_map.find(input) != proxy_initializers_map.end()) {
+            auto const_tensor                   = proxy_initializers_map[input];
+            TNN_NS::RawBuffer *const_raw_buffer = nullptr;
+            CreateRawBufferFromTensor(*const_tensor, &const_raw_buffer);
+            net_resource.constant_map[input] = std::shared_ptr<TNN_NS::RawBuffer>(const_raw_buffer);
+        }
+    }
+
+    // outputs: Y, Y_h. GRUONNX writes Y as [seq_length, batch_size, num_directions * hidden_size] like LSTMONNX,
+    // onnx Y [seq_length, num_directions, batch_size, hidden_size] is restored by Reshape and Permute
+    const std::string y_name   = node.output_size() > 0 ? node.output(0) : "";
+    const std::string y_h_name = node.output_size() > 1 ? node.output(1) : "";
+    const std::string gru_y    = y_name.empty() ? cur_layer->name + "_y" : y_name + "_gru_output";
+    cur_layer->outputs         = {gru_y};
+    if (!y_h_name.empty()) {
+        cur_layer->outputs.push_back(y_h_name);
+    }
+    for (const auto &blob_name : cur_layer->inputs) {
+        net_structure.blobs.insert(blob_name);
+    }
+    for (const auto &blob_name : cur_layer->outputs) {
+        net_structure.blobs.insert(blob_name);
+    }
+
+    if (!y_name.empty()) {
+        const std::string reshape_y = y_name + "_gru_reshape";
+        auto reshape_param          = new TNN_NS::ReshapeLayerParam;
+        reshape_param->axis         = 0;
+        reshape_param->num_axes     = 4;
+        reshape_param->shape        = {0, 0, num_directions, hidden_size};
+        reshape_param->reshape_type = 0;
+        auto reshape_layer = CreateLayerInfo(reshape_y, "Reshape", gru_y, reshape_y, reshape_param);
+        net_structure.layers.push_back(reshape_layer);
+        net_structure.blobs.insert(reshape_y);
+
+        auto permute_param    = new TNN_NS::PermuteLayerParam;
+        permute_param->orders = {0, 2, 1, 3};
+        auto permute_layer = CreateLayerInfo(y_name + "_gru_permute", "Permute", reshape_y, y_name, permute_param);
+        net_structure.layers.push_back(permute_layer);
+    }
+
+    return TNN_NS::TNN_CONVERT_OK;
+}
+
+REGISTER_CONVERTER(GRU, GRU);
+
+}  // namespace TNN_CONVERTER
@@ -18,6 +18,7 @@
 
 #include "include/tnn/core/common.h"
 #include "include/tnn/core/instance.h"
+#include "tnn/core/abstract_device.h"
 #include "tnn/core/const_folder.h"
 #include "tnn/utils/blob_converter.h"
 #include "tnn/utils/data_type_utils.h"
@@ -30,6 +31,10 @@ TnnRuntime::TnnRuntime() {
     // initial network config
     network_config_.network_type = TNN_NS::NETWORK_TYPE_DEFAULT;
     network_config_.device_type  = TNN_NS::DEVICE_NAIVE;
+    // run on x86 if it is built, constant folding falls back to naive per layer, AlignModel per network
+    if (TNN_NS::GetDevice(TNN_NS::DEVICE_X86) != nullptr) {
+        network_config_.device_type = TNN_NS::DEVICE_X86;
+    }
     network_config_.precision    = TNN_NS::PRECISION_AUTO;
     network_config_.library_path = {};
     // initial model config
@@ -64,6 +69,18 @@ TNN_NS::Status TnnRuntime::AlignModel(const std::shared_ptr<TNN_NS::AbstractMode
     TNN_NS::InputShapesMap& input_shapes_map = tnn_interpreter->GetNetStructure()->inputs_shape_map;
     auto instance                            = std::make_shared<TNN_NS::Instance>(network_config_, model_config_);
     auto status                              = instance->Init(interpreter, input_shapes_map);
+    if (status != TNN_NS::TNN_OK && network_config_.device_type != TNN_NS::DEVICE_NAIVE) {
+        // e.g. a layer type without x86 implementation
+        LOGD("Converter Runtime: instance init failed on device %d, run on naive\n", network_config_.device_type);
+        auto naive_config        = network_config_;
+        naive_config.device_type = TNN_NS::DEVICE_NAIVE;
+        instance                 = std::make_shared<TNN_NS::Instance>(naive_config, model_config_);
+        status                   = instance->Init(interpreter, input_shapes_map);
+    }
+    if (status != TNN_NS::TNN_OK) {
+        LOGE("Converter Runtime: instance init failed!\n");
+        return status;
+    }
     TNN_NS::BlobMap input_blob_map;
     TNN_NS::BlobMap output_blob_map;
     void* command_queue;
@@ -14,8 +14,14 @@
 
 #include "calibration.h"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <queue>
 #include <random>
+#include <thread>
 #include "file_reader.h"
 #include "tnn/core/macro.h"
 #include "tnn/core/tnn.h"
@@ -30,6 +36,51 @@ static const std::set<LayerType> kQuantizedLayerTypeStr = {LAYER_CONVOLUTION, LA
 
 static const std::set<LayerType> kBlobScaleMergeLayerTypeStr = {LAYER_RELU, LAYER_POOLING};
 
+// max number of decoded inputs waiting for a free instance
+static const size_t kPrefetchQueueSize = 4;
+
+// decoded calibration inputs, filled by the prefetch thread and drained by the forward threads
+class CalibrationInputQueue {
+public:
+    explicit CalibrationInputQueue(size_t capacity) : capacity_(capacity) {}
+
+    // @brief push one input, block while the queue is full
+    void Push(std::shared_ptr<Blob> blob) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [&] { return queue_.size() < capacity_; });
+        queue_.push(blob);
+        not_empty_.notify_one();
+    }
+
+    // @brief pop one input, return false if the queue is closed and empty
+    bool Pop(std::shared_ptr<Blob>& blob) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [&] { return !queue_.empty() || closed_; });
+        if (queue_.empty()) {
+            return false;
+        }
+        blob = queue_.front();
+        queue_.pop();
+        not_full_.notify_one();
+        return true;
+    }
+
+    // @brief no more inputs will be pushed
+    void Close() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_all();
+    }
+
+private:
+    size_t capacity_;
+    bool closed_ = false;
+    std::queue<std::shared_ptr<Blob>> queue_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+};
+
 static void InitWeightScaleADMM(const float* weights, const int size, const int output_channel, bool merge_channel,
                                 float* weight_scale, const int quantize_bits) {
     int weight_scale_count = merge_channel ? 1 : output_channel;
@@ -98,13 +149,15 @@ Calibration::Calibration() {}
 Calibration::~Calibration() {}
 
 Status Calibration::Init(NetworkConfig& net_config, ModelConfig& model_config, InputShapesMap inputs_shape) {
-    TNN tnn;
-    Status status = tnn.Init(model_config);
+    // keep tnn and config alive, calibration threads create more instances from them
+    tnn_          = std::make_shared<TNN>();
+    net_config_   = net_config;
+    Status status = tnn_->Init(model_config);
     if (status != TNN_OK) {
         LOGE("tnn init failed!\n");
         return TNNERR_INVALID_MODEL;
     }
-    instance_ = tnn.CreateInst(net_config, status);
+    instance_ = tnn_->CreateInst(net_config_, status);
     if (status != TNN_OK) {
         LOGE("tnn create instance failed!\n");
         return TNNERR_INST_ERR;
@@ -199,32 +252,23 @@ int Calibration::CalBlobScale(DataSet& dataset) {
     }
     printf("\tInit Feature Map done!\n");
 
-    // Collect the Range of Feature map
-    ret = UpdateBlobRange(dataset);
+    // Collect the Range and Distribution of Feature map in one pass
+    ret = UpdateBlobStatistic(dataset);
     if (ret != 0) {
-        LOGE("collect feautre map range failed!\n");
+        LOGE("collect feautre map statistic failed!\n");
         return ret;
     }
-    printf("\tCollect Blob Range done!\n");
+    printf("\tCollect Blob Range and Distribution done!\n");
 
-    // Calculate Distribute of Feature map
-    ret = UpdateBlobDistribute(dataset);
+    // Compute Scale of Feature map and save to resource map
+    std::map<Blob*, std::vector<float>> scale_map;
+    ret = CalculateFeatureMapScale(scale_map);
     if (ret != 0) {
-        LOGE("update feautre map distribute failed!\n");
         return ret;
     }
-    printf("\tCollect Blob Distribution done!\n");
-
-    // Compute Scale of Feature map and save to resource map
-    for (auto& item : feature_map_) {
-        std::vector<float> scale_vec;
-        std::string input_scale_name = item.first->GetBlobDesc().name + BLOB_SCALE_SUFFIX;
-        int ret                      = item.second->CalculateScale(scale_vec);
-        if (ret != 0) {
-            LOGE("CalculateScale (%s) failed\n", input_scale_name.c_str());
-            return ret;
-        }
-        LayerResource* blob_scale_res                = CreateIntScale(scale_vec);
+    for (auto& item : scale_map) {
+        std::string input_scale_name                 = item.first->GetBlobDesc().name + BLOB_SCALE_SUFFIX;
+        LayerResource* blob_scale_res                = CreateIntScale(item.second);
         net_resource->resource_map[input_scale_name] = std::shared_ptr<LayerResource>(blob_scale_res);
         printf("\t====> Calculate (%s) done!\n", input_scale_name.c_str());
     }
@@ -276,79 +320,156 @@ int Calibration::InitFeatureMap() {
     return 0;
 }
 
-int Calibration::UpdateBlobRange(DataSet& dataset) {
+int Calibration::UpdateBlobStatistic(DataSet& dataset) {
     BlobMap input_blobs;
     Status status = instance_->GetAllInputBlobs(input_blobs);
     if (status != TNN_OK) {
         LOGE("instance get input blobs failed!\n");
         return -1;
     }
-    Blob* input_blob = input_blobs.begin()->second;
+    BlobDesc input_desc = input_blobs.begin()->second->GetBlobDesc();
+    size_t input_bytes  = DimsVectorUtils::Count(input_desc.dims) * sizeof(float);
+
+    // instance 0 is the one being quantized, the others only collect statistic
+    int num_threads = std::max(1, std::min(cali_params_.num_threads, (int)dataset.file_list.size()));
+    std::vector<std::shared_ptr<Instance>> instances = {instance_};
+    for (int i = 1; i < num_threads; ++i) {
+        auto instance = tnn_->CreateInst(net_config_, status);
+        if (status != TNN_OK || instance == nullptr) {
+            LOGE("tnn create calibration instance failed!\n");
+            return -1;
+        }
+        status = instance->Reshape(dataset.input_shape);
+        if (status != TNN_OK) {
+            LOGE("calibration instance reshape failed!\n");
+            return -1;
+        }
+        instances.push_back(instance);
+    }
 
-    BlobStatisticCallback func = [&](std::vector<Blob*>& blobs, LayerInfo* info) {
-        for (auto blob : blobs) {
-            if (feature_map_.find(blob) != feature_map_.end()) {
-                feature_map_[blob]->UpdateRange();
+    std::map<std::string, std::shared_ptr<ScaleCalculator>> name_map;
+    for (auto& item : feature_map_) {
+        name_map[item.first->GetBlobDesc().name] = item.second;
+    }
+
+    // every thread owns its calculators, they are merged into feature_map_ after all inputs are done
+    std::vector<std::map<std::string, std::shared_ptr<ScaleCalculator>>> thread_calculators(num_threads);
+    std::vector<int> thread_rets(num_threads, 0);
+
+    CalibrationInputQueue input_queue(kPrefetchQueueSize);
+    std::thread prefetch_thread([&]() {
+        FileReader file_reader;
+        file_reader.SetBiasValue(cali_params_.input_bias);
+        file_reader.SetScaleValue(cali_params_.input_scale);
+        file_reader.SetReverseChannel(cali_params_.reverse_channel);
+        for (auto& file_pack : dataset.file_list) {
+            std::shared_ptr<Blob> blob(new Blob(input_desc, true));
+            Status read_status = file_reader.Read(blob.get(), file_pack.first, file_pack.second);
+            if (read_status != TNN_OK) {
+                LOGE("read input file (%s) failed!\n", file_pack.first.c_str());
+                continue;
             }
+            input_queue.Push(blob);
         }
-    };
+        input_queue.Close();
+    });
+
+    auto forward_func = [&](int thread_id) {
+        auto instance     = instances[thread_id];
+        auto& calculators = thread_calculators[thread_id];
+
+        BlobMap instance_inputs;
+        instance->GetAllInputBlobs(instance_inputs);
+        Blob* input_blob = instance_inputs.begin()->second;
+
+        BlobStatisticCallback func = [&](std::vector<Blob*>& blobs, LayerInfo* info) {
+            for (auto blob : blobs) {
+                auto name = blob->GetBlobDesc().name;
+                if (name_map.find(name) == name_map.end()) {
+                    continue;
+                }
+                auto& calculator = calculators[name];
+                if (calculator == nullptr) {
+                    auto& origin = name_map[name];
+                    calculator   = std::make_shared<ScaleCalculator>();
+                    if (calculator->Init(blob, origin->GetMergeChannel(), origin->GetQuantizeMethod()) != 0) {
+                        calculators.erase(name);
+                        continue;
+                    }
+                }
+                calculator->Update();
+            }
+        };
 
-    FileReader file_reader;
-    file_reader.SetBiasValue(cali_params_.input_bias);
-    file_reader.SetScaleValue(cali_params_.input_scale);
-    file_reader.SetReverseChannel(cali_params_.reverse_channel);
-    for (auto file_pack : dataset.file_list) {
-        for (auto item : feature_map_) {
-            item.second->ClearRangeFlag();
+        std::shared_ptr<Blob> input;
+        while (input_queue.Pop(input)) {
+            memcpy(input_blob->GetHandle().base, input->GetHandle().base, input_bytes);
+            for (auto& item : calculators) {
+                item.second->ClearUpdateFlag();
+            }
+            Status ret = instance->ForwardWithCallback(func, func);
+            if (ret != TNN_OK) {
+                LOGE("calibration forward failed: %s\n", ret.description().c_str());
+                thread_rets[thread_id] = -1;
+            }
         }
+    };
 
-        status = file_reader.Read(input_blob, file_pack.first, file_pack.second);
-        if (status != TNN_OK) {
-            LOGE("read input file (%s) failed!\n", file_pack.first.c_str());
-            continue;
+    std::vector<std::thread> forward_threads;
+    for (int i = 1; i < num_threads; ++i) {
+        forward_threads.emplace_back(forward_func, i);
+    }
+    forward_func(0);
+    for (auto& thread : forward_threads) {
+        thread.join();
+    }
+    prefetch_thread.join();
+
+    for (int i = 0; i < num_threads; ++i) {
+        if (thread_rets[i] != 0) {
+            return thread_rets[i];
+        }
+        for (auto& item : thread_calculators[i]) {
+            int ret = name_map[item.first]->Merge(*item.second);
+            if (ret != 0) {
+                LOGE("merge statistic of blob (%s) failed!\n", item.first.c_str());
+                return ret;
+            }
         }
-        instance_->ForwardWithCallback(func, func);
     }
 
     return 0;
 }
 
-int Calibration::UpdateBlobDistribute(DataSet& dataset) {
-    for (auto& item : feature_map_) {
-        item.second->ResetDistribute();
-    }
-
-    BlobMap input_blobs;
-    Status status = instance_->GetAllInputBlobs(input_blobs);
-    if (status != TNN_OK) {
-        LOGE("instance get input blobs failed!\n");
-        return -1;
-    }
-    Blob* input_blob = input_blobs.begin()->second;
+int Calibration::CalculateFeatureMapScale(std::map<Blob*, std::vector<float>>& scale_map) {
+    std::vector<std::pair<Blob*, std::shared_ptr<ScaleCalculator>>> items(feature_map_.begin(), feature_map_.end());
+    std::vector<std::vector<float>> scales(items.size());
+    std::vector<int> rets(items.size(), 0);
 
-    BlobStatisticCallback func = [&](std::vector<Blob*>& blobs, LayerInfo* info) {
-        for (auto blob : blobs) {
-            if (feature_map_.find(blob) != feature_map_.end()) {
-                feature_map_[blob]->UpdateDistribute();
-            }
+    // the kl search of every blob is independent, spread the blobs over the threads
+    std::atomic<int> next_index(0);
+    auto calculate_func = [&]() {
+        for (int i = next_index++; i < (int)items.size(); i = next_index++) {
+            rets[i] = items[i].second->CalculateScale(scales[i]);
         }
     };
 
-    FileReader file_reader;
-    file_reader.SetBiasValue(cali_params_.input_bias);
-    file_reader.SetScaleValue(cali_params_.input_scale);
-    file_reader.SetReverseChannel(cali_params_.reverse_channel);
-    for (auto file_pack : dataset.file_list) {
-        for (auto& item : feature_map_) {
-            item.second->ClearDistributeFlag();
-        }
+    int num_threads = std::max(1, std::min(cali_params_.num_threads, (int)items.size()));
+    std::vector<std::thread> threads;
+    for (int i = 1; i < num_threads; ++i) {
+        threads.emplace_back(calculate_func);
+    }
+    calculate_func();
+    for (auto& thread : threads) {
+        thread.join();
+    }
 
-        status = file_reader.Read(input_blob, file_pack.first, file_pack.second);
-        if (status != TNN_OK) {
-            LOGE("read input file (%s) failed!\n", file_pack.first.c_str());
-            continue;
+    for (int i = 0; i < (int)items.size(); ++i) {
+        if (rets[i] != 0) {
+            LOGE("CalculateScale (%s) failed\n", items[i].first->GetBlobDesc().name.c_str());
+            return rets[i];
         }
-        instance_->ForwardWithCallback(func, func);
+        scale_map[items[i].first] = scales[i];
     }
 
     return 0;
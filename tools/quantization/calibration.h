@@ -20,6 +20,7 @@
 #include "tnn/core/instance.h"
 #include "tnn/core/layer_type.h"
 #include "tnn/core/status.h"
+#include "tnn/core/tnn.h"
 #include "tnn/interpreter/default_model_interpreter.h"
 
 #include "calibration_common.h"
@@ -58,8 +59,8 @@ public:
 private:
     int CalBlobScale(DataSet& dataset);
     int InitFeatureMap();
-    int UpdateBlobRange(DataSet& dataset);
-    int UpdateBlobDistribute(DataSet& dataset);
+    int UpdateBlobStatistic(DataSet& dataset);
+    int CalculateFeatureMapScale(std::map<Blob*, std::vector<float>>& scale_map);
     IntScaleResource* CreateIntScale(std::vector<float> scale_vec);
 
     int QuantizeParams();
@@ -73,6 +74,8 @@ private:
     void MergeBlobScaleRecursion(LayerInfo* layer_info, NetStructure* net_struct, NetResource* net_resource);
     LayerInfo* GetLayerInfoFromOutpubBlobName(std::string blob_name, NetStructure* net_struct);
 
+    std::shared_ptr<TNN> tnn_;
+    NetworkConfig net_config_;
     std::shared_ptr<DefaultModelInterpreter> interpreter_;
     std::shared_ptr<Instance> instance_;
     std::map<Blob*, std::shared_ptr<ScaleCalculator>> feature_map_;
@@ -48,6 +48,8 @@ struct CalibrationParam {
     std::vector<float> input_bias             = {0, 0, 0, 0};
     std::vector<float> input_scale            = {1.0f, 1.0f, 1.0f, 1.0f};
     bool reverse_channel                      = false;
+    /* number of instances running the calibration data in parallel */
+    int num_threads                           = 1;
 };
 
 }  // namespace TNN_NS
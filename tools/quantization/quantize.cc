@@ -178,7 +178,7 @@ bool CheckFileName(std::string name) {
 void PrintConfig() {
     printf(
         "usage:\n./quantization_cmd [-h] [-p] <proto file> [-m] <model file> [-i] <input folder> [-b] <val> [-w] <val> "
-        "[-n] <val> [-s] <val> [-t] <val> [-o] <output_name>\n"
+        "[-n] <val> [-s] <val> [-t] <val> [-j] <val> [-o] <output_name>\n"
         "\t-h, --help        \t show this message\n"
         "\t-p, --proto       \t(require) tnn proto file name\n"
         "\t-m, --model       \t(require) tnn model file name\n"
@@ -203,6 +203,7 @@ void PrintConfig() {
         "\t\t0: per-channel mode  (default)\n"
         "\t\t1: mix mode          weight: per-channel  blob: per-tensor\n"
         "\t\t2: per-tersor mode\n"
+        "\t-j, --num_threads \t(optional) number of instances collecting blob statistic in parallel, 1 by default\n"
         "\t-o, --output       \t(optional) specify the name of output\n");
 }
 
@@ -224,11 +225,12 @@ int main(int argc, char* argv[]) {
                                     {"bias", required_argument, 0, 'n'},
                                     {"scale", required_argument, 0, 's'},
                                     {"merge_type", required_argument, 0, 't'},
+                                    {"num_threads", required_argument, 0, 'j'},
                                     {"output", required_argument, 0, 'o'},
                                     {"help", no_argument, 0, 'h'},
                                     {0, 0, 0, 0}};
 
-    const char* optstring = "p:m:i:b:w:r:n:s:t:o:h";
+    const char* optstring = "p:m:i:b:w:r:n:s:t:j:o:h";
 
     if (argc == 1) {
         PrintConfig();
@@ -313,6 +315,10 @@ int main(int argc, char* argv[]) {
                     cali_params.merge_weights_channel = false;
                 }
             } break;
+            case 'j':
+                printf("num threads: %s\n", optarg);
+                cali_params.num_threads = std::max(1, atoi(optarg));
+                break;
             case 'o':
                 printf("output name: %s\n", optarg);
                 output_name = optarg;
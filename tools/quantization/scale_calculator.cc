@@ -41,11 +41,72 @@ static float KlDivergence(const std::vector<float>& dis_ref, const std::vector<f
     return result;
 }
 
+// the smallest power of two not less than val
+static float RoundUpPowerOfTwo(float val) {
+    return std::pow(2.0f, std::ceil(std::log2(val)));
+}
+
+// move a histogram of range from_max to the larger range to_max, both are powers of two,
+// so every new bin is the sum of a whole number of old bins
+static void RebinDistribute(std::vector<float>& distribute, float from_max, float to_max) {
+    if (from_max <= 0 || to_max <= from_max) {
+        return;
+    }
+    const int bin_nums = distribute.size();
+    const double ratio = (double)to_max / (double)from_max;
+    if (ratio >= bin_nums) {
+        float sum = 0;
+        std::for_each(distribute.begin(), distribute.end(), [&](float n) { sum += n; });
+        std::fill(distribute.begin(), distribute.end(), 0.0f);
+        distribute[0] = sum;
+        return;
+    }
+
+    const int factor = static_cast<int>(ratio + 0.5);
+    for (int i = 0; i < bin_nums; ++i) {
+        float val       = distribute[i];
+        distribute[i]   = 0.0f;
+        distribute[i / factor] += val;
+    }
+}
+
+// spread a histogram of range src_max over dst_bins bins of range dst_max (dst_max <= src_max),
+// every source bin is split over the bins it overlaps in proportion to the overlap
+static std::vector<float> ResampleDistribute(const std::vector<float>& src, float src_max, int dst_bins,
+                                             float dst_max) {
+    std::vector<float> dst(dst_bins, 0.0f);
+    const double src_width = (double)src_max / src.size();
+    const double dst_width = (double)dst_max / dst_bins;
+    for (int i = 0; i < src.size(); ++i) {
+        if (src[i] == 0) {
+            continue;
+        }
+        const double start = i * src_width;
+        const double end   = start + src_width;
+        int j              = std::min(static_cast<int>(start / dst_width), dst_bins - 1);
+        if (start >= dst_max || j == dst_bins - 1) {
+            dst[dst_bins - 1] += src[i];
+            continue;
+        }
+        for (; j < dst_bins; ++j) {
+            const double overlap = std::min(end, (j + 1) * dst_width) - std::max(start, j * dst_width);
+            if (overlap <= 0) {
+                break;
+            }
+            dst[j] += src[i] * overlap / src_width;
+        }
+        // the part beyond dst_max belongs to the last bin
+        if (end > dst_max) {
+            dst[dst_bins - 1] += src[i] * (end - std::max(start, (double)dst_max)) / src_width;
+        }
+    }
+    return dst;
+}
+
 ScaleCalculator::ScaleCalculator() {
-    origin_blob_          = nullptr;
-    range_done_flag_      = false;
-    distribute_done_flag_ = false;
-    bin_nums_             = 2048;
+    origin_blob_      = nullptr;
+    update_done_flag_ = false;
+    bin_nums_         = 2048;
 }
 
 ScaleCalculator::~ScaleCalculator() {}
@@ -68,11 +129,10 @@ int ScaleCalculator::Init(Blob* blob, bool merge_channel, CalibrationMethod meth
             item.second = -1e6;  // init max
         }
 
-        interval_per_channel_.resize(channel);
-        valid_channel_.resize(channel);
+        distribute_max_per_channel_.resize(channel, 0.0f);
         distribute_per_channel_.resize(channel);
         for (auto& item : distribute_per_channel_) {
-            item.resize(bin_nums_);
+            item.resize(bin_nums_ * 2, 0.0f);
         }
 
         if (height * width < 100) {
@@ -97,20 +157,34 @@ int ScaleCalculator::SetQuantizeMethod(CalibrationMethod method) {
     return 0;
 }
 
+CalibrationMethod ScaleCalculator::GetQuantizeMethod() {
+    return cali_method_;
+}
+
 void ScaleCalculator::SetMergeChannel(bool merge) {
     merge_channel_ = merge;
 }
 
-void ScaleCalculator::ClearRangeFlag() {
-    range_done_flag_ = false;
+bool ScaleCalculator::GetMergeChannel() {
+    return merge_channel_;
+}
+
+void ScaleCalculator::ClearUpdateFlag() {
+    update_done_flag_ = false;
 }
 
-void ScaleCalculator::ClearDistributeFlag() {
-    distribute_done_flag_ = false;
+void ScaleCalculator::GrowDistribute(int channel, float max_abs) {
+    float& distribute_max = distribute_max_per_channel_[channel];
+    if (max_abs <= distribute_max) {
+        return;
+    }
+    float new_max = RoundUpPowerOfTwo(max_abs);
+    RebinDistribute(distribute_per_channel_[channel], distribute_max, new_max);
+    distribute_max = new_max;
 }
 
-int ScaleCalculator::UpdateRange() {
-    if (range_done_flag_) {
+int ScaleCalculator::Update() {
+    if (update_done_flag_) {
         return 0;
     }
 
@@ -127,65 +201,26 @@ int ScaleCalculator::UpdateRange() {
                 channel_idx = 0;
             }
 
-            float* p = data_ptr + b * channel * hxw + c * hxw;
+            float* p    = data_ptr + b * channel * hxw + c * hxw;
+            auto& range = range_per_channel_[channel_idx];
+            float min_val = range.first;
+            float max_val = range.second;
+            float max_abs = 0.0f;
             for (int i = 0; i < hxw; ++i) {
-                float val = p[i];
-
-                if (val < range_per_channel_[channel_idx].first) {
-                    range_per_channel_[channel_idx].first = val;
-                }
-                if (val > range_per_channel_[channel_idx].second) {
-                    range_per_channel_[channel_idx].second = val;
-                }
+                min_val = std::min(min_val, p[i]);
+                max_val = std::max(max_val, p[i]);
+                max_abs = std::max(max_abs, std::abs(p[i]));
             }
-        }
-    }
-
-    range_done_flag_ = true;
-    return 0;
-}
-
-int ScaleCalculator::ResetDistribute() {
-    for (unsigned int i = 0; i < interval_per_channel_.size(); ++i) {
-        float max_val     = std::max(std::abs(range_per_channel_[i].first), std::abs(range_per_channel_[i].second));
-        valid_channel_[i] = max_val > 0.00001;
-        if (valid_channel_[i]) {
-            interval_per_channel_[i] = (float)bin_nums_ / max_val;
-        }
-
-        if (merge_channel_)
-            break;
-    }
-
-    for (auto& item : distribute_per_channel_) {
-        std::fill(item.begin(), item.end(), 1.0e-7);
-    }
-
-    return 0;
-}
-
-int ScaleCalculator::UpdateDistribute() {
-    if (distribute_done_flag_) {
-        return 0;
-    }
-
-    int batch       = origin_blob_->GetBlobDesc().dims[0];
-    int channel     = origin_blob_->GetBlobDesc().dims[1];
-    int hxw         = DimsVectorUtils::Count(origin_blob_->GetBlobDesc().dims, 2);
-    float* data_ptr = reinterpret_cast<float*>(static_cast<char*>(origin_blob_->GetHandle().base) +
-                                               origin_blob_->GetHandle().bytes_offset);
+            range.first  = min_val;
+            range.second = max_val;
 
-    for (int b = 0; b < batch; ++b) {
-        for (int c = 0; c < channel; ++c) {
-            int channel_idx = c;
-            if (merge_channel_) {
-                channel_idx = 0;
-            }
-            if (!valid_channel_[channel_idx]) {
+            if (max_abs <= 0.0f) {
                 continue;
             }
+            GrowDistribute(channel_idx, max_abs);
 
-            float* p               = data_ptr + b * channel * hxw + c * hxw;
+            const int hist_bins    = distribute_per_channel_[channel_idx].size();
+            const float interval   = (float)hist_bins / distribute_max_per_channel_[channel_idx];
             float* distribute_data = distribute_per_channel_[channel_idx].data();
             for (int i = 0; i < hxw; ++i) {
                 float val = p[i];
@@ -193,45 +228,72 @@ int ScaleCalculator::UpdateDistribute() {
                     continue;
                 }
 
-                int index = static_cast<int>(std::abs(val) * interval_per_channel_[channel_idx]);
-                index     = std::min(index, bin_nums_ - 1);
+                int index = static_cast<int>(std::abs(val) * interval);
+                index     = std::min(index, hist_bins - 1);
                 distribute_data[index] += 1.0;
             }
         }
     }
 
-    distribute_done_flag_ = true;
+    update_done_flag_ = true;
+    return 0;
+}
+
+int ScaleCalculator::Merge(ScaleCalculator& other) {
+    if (other.range_per_channel_.size() != range_per_channel_.size() || other.bin_nums_ != bin_nums_) {
+        LOGE("merge calculators of different blobs!\n");
+        return -1;
+    }
+
+    for (unsigned int c = 0; c < range_per_channel_.size(); ++c) {
+        range_per_channel_[c].first  = std::min(range_per_channel_[c].first, other.range_per_channel_[c].first);
+        range_per_channel_[c].second = std::max(range_per_channel_[c].second, other.range_per_channel_[c].second);
+
+        float other_max = other.distribute_max_per_channel_[c];
+        if (other_max <= 0.0f) {
+            continue;
+        }
+        GrowDistribute(c, other_max);
+
+        std::vector<float> other_distribute = other.distribute_per_channel_[c];
+        RebinDistribute(other_distribute, other_max, distribute_max_per_channel_[c]);
+        auto& distribute = distribute_per_channel_[c];
+        for (int i = 0; i < distribute.size(); ++i) {
+            distribute[i] += other_distribute[i];
+        }
+    }
+
     return 0;
 }
 
 int ScaleCalculator::CalculateScale(std::vector<float>& val) {
     val.clear();
 
-    if (merge_channel_) {
-        val.push_back(0.0f);
-        if (!valid_channel_[0]) {
-            LOGE("blob val is invalid in this merge channel mode (all zero)\n");
-            return -1;
+    const int channel_nums = merge_channel_ ? 1 : range_per_channel_.size();
+    val.resize(channel_nums);
+    std::fill(val.begin(), val.end(), 0.0f);
+
+    for (int c = 0; c < channel_nums; ++c) {
+        float max_abs = std::max(std::abs(range_per_channel_[c].first), std::abs(range_per_channel_[c].second));
+        if (max_abs <= 0.00001) {
+            if (merge_channel_) {
+                LOGE("blob val is invalid in this merge channel mode (all zero)\n");
+                return -1;
+            }
+            continue;
         }
-        int ret = CalculateScalePerDis(distribute_per_channel_[0], interval_per_channel_[0], val[0]);
+
+        // the histogram range is up to twice the max, map it back to bin_nums_ bins of the exact range
+        const float interval = (float)bin_nums_ / max_abs;
+        auto distribute =
+            ResampleDistribute(distribute_per_channel_[c], distribute_max_per_channel_[c], bin_nums_, max_abs);
+        std::for_each(distribute.begin(), distribute.end(), [](float& n) { n += 1.0e-7; });
+
+        int ret = CalculateScalePerDis(distribute, interval, val[c]);
         if (ret != 0) {
             LOGE("CalculateScalePerDis() failed\n");
             return -1;
         }
-    } else {
-        val.resize(valid_channel_.size());
-        std::fill(val.begin(), val.end(), 0.0f);
-
-        for (unsigned int c = 0; c < distribute_per_channel_.size(); ++c) {
-            if (!valid_channel_[c]) {
-                continue;
-            }
-            int ret = CalculateScalePerDis(distribute_per_channel_[c], interval_per_channel_[c], val[c]);
-            if (ret != 0) {
-                LOGE("CalculateScalePerDis() failed\n");
-                return -1;
-            }
-        }
     }
 
     return 0;
@@ -45,24 +45,26 @@ public:
     // param 0 : method, the method to set
     int SetQuantizeMethod(CalibrationMethod method);
 
+    // @brief: get the quantize method
+    CalibrationMethod GetQuantizeMethod();
+
     // @brief: set merge channel param
     // param 0 : method, the method to set
     void SetMergeChannel(bool merge);
 
-    // @brief: clear range_done_flag_.
-    void ClearRangeFlag();
-
-    // @brief: clear distribute_done_flag_.
-    void ClearDistributeFlag();
+    // @brief: get merge channel param
+    bool GetMergeChannel();
 
-    // @brief: update the blob data.
-    int UpdateRange();
+    // @brief: clear update_done_flag_, call it before every forward.
+    void ClearUpdateFlag();
 
-    // @brief: reset distribute according range.
-    int ResetDistribute();
+    // @brief: update range and distribute with the blob data in one pass.
+    // the histogram has 2 * bin_nums_ bins over a power-of-two range, which grows by merging bins when larger
+    // values arrive. CalculateScale maps it back to bin_nums_ bins of the exact range.
+    int Update();
 
-    // @brief: update distribute.
-    int UpdateDistribute();
+    // @brief: merge the range and distribute collected by another calculator of the same blob.
+    int Merge(ScaleCalculator& other);
 
     // @brief: get the per-channel scale of the given blob
     int CalculateScale(std::vector<float>& val);
@@ -70,15 +72,17 @@ public:
 private:
     int CalculateScalePerDis(std::vector<float>& distribute, float interval, float& output);
 
+    // @brief: grow the histogram range of channel to cover max_abs, merging the old bins.
+    void GrowDistribute(int channel, float max_abs);
+
     Blob* origin_blob_;
     bool merge_channel_;
     CalibrationMethod cali_method_;
     int bin_nums_;
-    bool range_done_flag_;
-    bool distribute_done_flag_;
+    bool update_done_flag_;
     std::vector<std::pair<float, float>> range_per_channel_;
-    std::vector<float> interval_per_channel_;
-    std::vector<bool> valid_channel_;
+    // histogram range of each channel, 0 before the first valid value
+    std::vector<float> distribute_max_per_channel_;
     std::vector<std::vector<float>> distribute_per_channel_;
 };
 